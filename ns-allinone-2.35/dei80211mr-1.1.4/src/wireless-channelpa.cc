@@ -92,6 +92,13 @@ int PAWirelessChannel::command(int argc, const char*const* argv)
 			removeNodeFromList((MobileNode*) obj);
 			return TCL_OK;
 		}
+		else if (strcmp(argv[1], "addif") == 0) {
+			int rv = Channel::command(argc, argv);
+			// interfaces are normally bound to their node first
+			if (((Phy*) obj)->node() != 0)
+				addIfToList((Phy*) obj);
+			return rv;
+		}
 	}
 	return Channel::command(argc, argv);
 }
@@ -101,12 +108,14 @@ void
 PAWirelessChannel::sendUp(Packet* p, Phy *tifp)
 {
 	Scheduler &s = Scheduler::instance();
-	Phy *rifp = ifhead_.lh_first;
+	Phy *rifp;
 	Node *tnode = tifp->node();
 	Node *rnode = 0;
+	ChannelNode *rcn;
 	Packet *newp;
 	double propdelay = 0.0;
 	struct hdr_cmn *hdr = HDR_CMN(p);
+	int i, j;
 
 	// Unused - see comments in wireless-channelpa.h
 //       /* list-based improvement */
@@ -118,9 +127,12 @@ PAWirelessChannel::sendUp(Packet* p, Phy *tifp)
 	
 	 hdr->direction() = hdr_cmn::UP;
 
+	 /*
+	  * Each receiving interface gets its own copy of the packet, but
+	  * only the interfaces of a node that are on this channel do.
+	  */
 	 // still keep grid-keeper around ??
 	 if (GridKeeper::instance()) {
-	    int i;
 	    GridKeeper* gk = GridKeeper::instance();
 	    int size = gk->size_; 
 	    
@@ -130,44 +142,47 @@ PAWirelessChannel::sendUp(Packet* p, Phy *tifp)
 						         outlist);
 	    for (i=0; i < out_index; i ++) {
 		
-		  newp = p->copy();
 		  rnode = outlist[i];
+		  if ((rcn = ChannelNode::find(outlist[i], this)) == NULL)
+			  continue;
 		  propdelay = get_pdelay(tnode, rnode);
 
-		  rifp = (rnode->ifhead()).lh_first; 
-		  for(; rifp; rifp = rifp->nextnode()){
-			  if (rifp->channel() == this){
-				 s.schedule(rifp, newp, propdelay); 
-				 break;
-			  }
+		  for (j = 0; j < rcn->nifs_; j++) {
+			  newp = p->copy();
+			  s.schedule(rcn->ifs_[j], newp, propdelay);
 		  }
  	    }
 	    delete [] outlist; 
 	 
 	 } else { // use list-based improvement
 	 
-		 MobileNode *mtnode = (MobileNode *) tnode;
-		 MobileNode **affectedNodes;// **aN;
+		 ChannelNode *tcn = ChannelNode::find((MobileNode *) tnode, this);
+		 ChannelNode **affectedNodes;
 		 int numAffectedNodes = -1;
-		 int i;
 		 
+		 if (tcn == NULL) {
+			 fprintf(stderr, "PAWirelessChannel: node %d sends on channel %d without add-node\n",
+				 tnode->address(), index_);
+			 Packet::free(p);
+			 return;
+		 }
 		 if(!sorted_){
 			 sortLists();
 		 }
 		 
-		 affectedNodes = getAffectedNodes(mtnode, distInterference_, &numAffectedNodes);
+		 affectedNodes = getAffectedNodes(tcn, distInterference_, &numAffectedNodes);
 		 for (i=0; i < numAffectedNodes; i++) {
-			 rnode = affectedNodes[i];
+			 rcn = affectedNodes[i];
+			 rnode = rcn->node_;
 			 
 			 if(rnode == tnode)
 				 continue;
 			 
-			 newp = p->copy();
-			 
 			 propdelay = get_pdelay(tnode, rnode);
 			 
-			 rifp = (rnode->ifhead()).lh_first;
-			 for(; rifp; rifp = rifp->nextnode()){
+			 for (j = 0; j < rcn->nifs_; j++) {
+				 rifp = rcn->ifs_[j];
+				 newp = p->copy();
 				 s.schedule(rifp, newp, propdelay);
 			 }
 		 }
@@ -177,54 +192,75 @@ PAWirelessChannel::sendUp(Packet* p, Phy *tifp)
 }
 
 
-void
+ChannelNode *
 PAWirelessChannel::addNodeToList(MobileNode *mn)
 {
-	MobileNode *tmp;
+	ChannelNode *cn, *tmp;
+
+	// a node with several radios on this channel is listed once
+	if ((cn = ChannelNode::find(mn, this)) != NULL) {
+		if (cn->nifs_ == 0)
+			findIfs(cn);
+		return cn;
+	}
+	cn = ChannelNode::create(mn, this);
 
 	// create list of mobilenodes for this channel
 	if (xListHead_ == NULL) {
 		fprintf(stderr, "INITIALIZE THE LIST xListHead\n");
-		xListHead_ = mn;
+		xListHead_ = cn;
 		xListHead_->nextX_ = NULL;
 		xListHead_->prevX_ = NULL;
 	} else {
 		for (tmp = xListHead_; tmp->nextX_ != NULL; tmp=tmp->nextX_);
-		tmp->nextX_ = mn;
-		mn->prevX_ = tmp;
-		mn->nextX_ = NULL;
+		tmp->nextX_ = cn;
+		cn->prevX_ = tmp;
+		cn->nextX_ = NULL;
 	}
 	numNodes_++;
+	sorted_ = false;
+	return cn;
+}
+
+/* record an interface under its node's entry */
+void
+PAWirelessChannel::addIfToList(Phy *ifp)
+{
+	addNodeToList((MobileNode*) ifp->node())->addif(ifp);
+}
+
+/* for scripts that attach an interface before binding it to a node */
+void
+PAWirelessChannel::findIfs(ChannelNode *cn)
+{
+	for (Phy *ifp = ifhead_.lh_first; ifp; ifp = ifp->nextchnl())
+		if (ifp->node() == cn->node_)
+			addIfToList(ifp);
 }
 
 void
 PAWirelessChannel::removeNodeFromList(MobileNode *mn) {
 	
-	MobileNode *tmp;
-	// Find node in list
-	for (tmp = xListHead_; tmp->nextX_ != NULL; tmp=tmp->nextX_) {
-		if (tmp == mn) {
-			if (tmp == xListHead_) {
-				xListHead_ = tmp->nextX_;
-				if (tmp->nextX_ != NULL)
-					tmp->nextX_->prevX_ = NULL;
-			} else if (tmp->nextX_ == NULL) 
-				tmp->prevX_->nextX_ = NULL;
-			else {
-				tmp->prevX_->nextX_ = tmp->nextX_;
-				tmp->nextX_->prevX_ = tmp->prevX_;
-			}
-			numNodes_--;
-			return;
-		}
+	ChannelNode *cn;
+
+	if ((cn = ChannelNode::find(mn, this)) == NULL) {
+		fprintf(stderr, "Channel: node not found in list\n");
+		return;
 	}
-	fprintf(stderr, "Channel: node not found in list\n");
+	if (cn->prevX_ != NULL)
+		cn->prevX_->nextX_ = cn->nextX_;
+	else
+		xListHead_ = cn->nextX_;
+	if (cn->nextX_ != NULL)
+		cn->nextX_->prevX_ = cn->prevX_;
+	cn->destroy();
+	numNodes_--;
 }
 
 void
 PAWirelessChannel::sortLists(void) {
 	bool flag = true;
-	MobileNode *m, *q;
+	ChannelNode *m, *q;
 
 	sorted_ = true;
 	
@@ -236,7 +272,7 @@ PAWirelessChannel::sortLists(void) {
 		m = xListHead_;
 		while (m != NULL){
 			if(m->nextX_ != NULL)
-				if ( m->X() > m->nextX_->X() ){
+				if ( m->node_->X() > m->nextX_->node_->X() ){
 					flag = true;
 					//delete_after m;
 					q = m->nextX_;
@@ -263,10 +299,10 @@ PAWirelessChannel::sortLists(void) {
 }
 
 void
-PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
+PAWirelessChannel::updateNodesList(ChannelNode *mn, double oldX) {
 	
-	MobileNode* tmp;
-	double X = mn->X();
+	ChannelNode* tmp;
+	double X = mn->node_->X();
 	bool skipX=false;
 	
 	if(!sorted_) {
@@ -280,7 +316,7 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	// deleting mn from x-list
 	if(mn->nextX_ != NULL) {
 		if(mn->prevX_ != NULL){
-			if((mn->nextX_->X() >= X) && (mn->prevX_->X() <= X)) skipX = true; // the node doesn't change its position in the list
+			if((mn->nextX_->node_->X() >= X) && (mn->prevX_->node_->X() <= X)) skipX = true; // the node doesn't change its position in the list
 			else{
 				mn->nextX_->prevX_ = mn->prevX_;
 				mn->prevX_->nextX_ = mn->nextX_;
@@ -288,7 +324,7 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 		}
 		
 		else{
-			if(mn->nextX_->X() >= X) skipX = true; // skip updating the first element
+			if(mn->nextX_->node_->X() >= X) skipX = true; // skip updating the first element
 			else{
 				mn->nextX_->prevX_ = NULL;
 				xListHead_ = mn->nextX_;
@@ -297,7 +333,7 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	}
 	
 	else if(mn->prevX_ !=NULL){
-		if(mn->prevX_->X() <= X) skipX = true; // skip updating the last element
+		if(mn->prevX_->node_->X() <= X) skipX = true; // skip updating the last element
 		else mn->prevX_->nextX_ = NULL;
 	}
 	
@@ -307,16 +343,13 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	//inserting mn in x-list
 	if(!skipX){
 		if(X > oldX){			
-			for(tmp = mn; tmp->nextX_ != NULL && tmp->nextX_->X() < X; tmp = tmp->nextX_);
-			//fprintf(stdout,"Scanning the element addr %d X=%0.f, next addr %d X=%0.f\n", tmp, tmp->X(), tmp->nextX_, tmp->nextX_->X());
+			for(tmp = mn; tmp->nextX_ != NULL && tmp->nextX_->node_->X() < X; tmp = tmp->nextX_);
 			if(tmp->nextX_ == NULL) { 
-				//fprintf(stdout, "tmp->nextX_ is NULL\n");
 				tmp->nextX_ = mn;
 				mn->prevX_ = tmp;
 				mn->nextX_ = NULL;
 			} 
 			else{ 
-				//fprintf(stdout, "tmp->nextX_ is not NULL, tmp->nextX_->X()=%0.f\n", tmp->nextX_->X());
 				mn->prevX_ = tmp->nextX_->prevX_;
 				mn->nextX_ = tmp->nextX_;
 				tmp->nextX_->prevX_ = mn;  	
@@ -324,17 +357,14 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 			} 
 		}
 		else{
-			for(tmp = mn; tmp->prevX_ != NULL && tmp->prevX_->X() > X; tmp = tmp->prevX_);
-				//fprintf(stdout,"Scanning the element addr %d X=%0.f, prev addr %d X=%0.f\n", tmp, tmp->X(), tmp->prevX_, tmp->prevX_->X());
+			for(tmp = mn; tmp->prevX_ != NULL && tmp->prevX_->node_->X() > X; tmp = tmp->prevX_);
 			if(tmp->prevX_ == NULL) {
-				//fprintf(stdout, "tmp->prevX_ is NULL\n");
 				tmp->prevX_ = mn;
 				mn->nextX_ = tmp;
 				mn->prevX_ = NULL;
 				xListHead_ = mn;
 			} 
 			else{
-				//fprintf(stdout, "tmp->prevX_ is not NULL, tmp->prevX_->X()=%0.f\n", tmp->prevX_->X());
 				mn->nextX_ = tmp->prevX_->nextX_;
 				mn->prevX_ = tmp->prevX_;
 				tmp->prevX_->nextX_ = mn;  	
@@ -345,13 +375,14 @@ PAWirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 }
 
 
-MobileNode **
-PAWirelessChannel::getAffectedNodes(MobileNode *mn, double radius,
+ChannelNode **
+PAWirelessChannel::getAffectedNodes(ChannelNode *cn, double radius,
 				  int *numAffectedNodes)
 {
 	double xmin, xmax, ymin, ymax;
 	int n = 0;
-	MobileNode *tmp, **list, **tmpList;
+	MobileNode *mn = cn->node_;
+	ChannelNode *tmp, **list, **tmpList;
 
 	if (xListHead_ == NULL) {
 		*numAffectedNodes=-1;
@@ -365,27 +396,27 @@ PAWirelessChannel::getAffectedNodes(MobileNode *mn, double radius,
 	ymax = mn->Y() + radius;
 	
 	// First allocate as much as possibly needed
-	tmpList = new MobileNode*[numNodes_];
+	tmpList = new ChannelNode*[numNodes_];
 	
 	for(tmp = xListHead_; tmp != NULL; tmp = tmp->nextX_) tmpList[n++] = tmp;
 	for(int i = 0; i < n; ++i)
-		if(tmpList[i]->speed()!=0.0 && (Scheduler::instance().clock() -
-						tmpList[i]->getUpdateTime()) > XLIST_POSITION_UPDATE_INTERVAL )
-			tmpList[i]->update_position();
+		if(tmpList[i]->node_->speed()!=0.0 && (Scheduler::instance().clock() -
+						tmpList[i]->node_->getUpdateTime()) > XLIST_POSITION_UPDATE_INTERVAL )
+			tmpList[i]->node_->update_position();
 	n=0;
 	
-	for(tmp = mn; tmp != NULL && tmp->X() >= xmin; tmp=tmp->prevX_)
-		if(tmp->Y() >= ymin && tmp->Y() <= ymax){
+	for(tmp = cn; tmp != NULL && tmp->node_->X() >= xmin; tmp=tmp->prevX_)
+		if(tmp->node_->Y() >= ymin && tmp->node_->Y() <= ymax){
 			tmpList[n++] = tmp;
 		}
-	for(tmp = mn->nextX_; tmp != NULL && tmp->X() <= xmax; tmp=tmp->nextX_){
-		if(tmp->Y() >= ymin && tmp->Y() <= ymax){
+	for(tmp = cn->nextX_; tmp != NULL && tmp->node_->X() <= xmax; tmp=tmp->nextX_){
+		if(tmp->node_->Y() >= ymin && tmp->node_->Y() <= ymax){
 			tmpList[n++] = tmp;
 		}
 	}
 	
-	list = new MobileNode*[n];
-	memcpy(list, tmpList, n * sizeof(MobileNode *));
+	list = new ChannelNode*[n];
+	memcpy(list, tmpList, n * sizeof(ChannelNode *));
 	delete [] tmpList;
          
 	*numAffectedNodes = n;
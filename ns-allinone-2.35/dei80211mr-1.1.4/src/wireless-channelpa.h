@@ -57,16 +57,20 @@ private:
 	double get_pdelay(Node* tnode, Node* rnode);
 	
 	/* For list-keeper, channel keeps list of mobilenodes 
-	   listening on to it */
+	   listening on to it, one ChannelNode each (see channel.h) */
 	int numNodes_;
-	MobileNode *xListHead_;
+	ChannelNode *xListHead_;
 	bool sorted_;
-	void addNodeToList(MobileNode *mn);
+	ChannelNode *addNodeToList(MobileNode *mn);
+	void addIfToList(Phy *ifp);
+	void findIfs(ChannelNode *cn);
 	void removeNodeFromList(MobileNode *mn);
 	void sortLists(void);
-	void updateNodesList(class MobileNode *mn, double oldX);
-	MobileNode **getAffectedNodes(MobileNode *mn, double radius, int *numAffectedNodes);
+	ChannelNode **getAffectedNodes(ChannelNode *cn, double radius, int *numAffectedNodes);
 	
+public:
+	virtual void updateNodesList(ChannelNode *cn, double oldX);
+
 protected:
 
 	// CS threshold is no more used to determined affected nodes
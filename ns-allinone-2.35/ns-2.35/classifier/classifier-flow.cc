@@ -0,0 +1,343 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * classifier-flow.cc
+ *
+ * Per-flow statistics in columns, found through an open-addressing
+ * hash table; see classifier-flow.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "classifier-flow.h"
+#include "scheduler.h"
+
+static class FlowHashClassifierClass : public TclClass {
+public:
+	FlowHashClassifierClass() : TclClass("Classifier/Hash/Flow") {}
+	TclObject* create(int, const char*const*) {
+		return (new FlowHashClassifier);
+	}
+} class_hash_flow_classifier;
+
+FlowHashClassifier::FlowHashClassifier() : table_(0), tsize_(0),
+	default_(-1), nextsweep_(0), expch_(0)
+{
+	bind("default_", &default_);
+	bind_bool("ports_", &ports_);
+	bind_time("idle_timeout_", &idle_);
+	grow();
+}
+
+FlowHashClassifier::~FlowHashClassifier()
+{
+	delete [] table_;
+}
+
+/*
+ * The flows are the classifier's state; the slot is only default_,
+ * so that the classifier can also sit in a packet's path.
+ */
+int FlowHashClassifier::classify(Packet* p)
+{
+	(void)flow(p);
+	return (default_);
+}
+
+int FlowHashClassifier::flow(Packet* p)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	double now = Scheduler::instance().clock();
+	int sport = ports_ ? iph->sport() : 0;
+	int dport = ports_ ? iph->dport() : 0;
+	unsigned int h = hash(iph->saddr(), sport, iph->daddr(), dport,
+			      iph->flowid());
+	FlowTable& t = flows_;
+
+	if (idle_ > 0 && now >= nextsweep_)
+		expire(now);
+	for (int i = h & (tsize_ - 1); table_[i] != 0;
+	     i = (i + 1) & (tsize_ - 1)) {
+		int k = table_[i] - 1;
+		if (t.hash_[k] == h && t.src_[k] == iph->saddr() &&
+		    t.dst_[k] == iph->daddr() && t.sport_[k] == sport &&
+		    t.dport_[k] == dport && t.fid_[k] == iph->flowid()) {
+			t.type_[k] = hdr_cmn::access(p)->ptype();
+			t.last_[k] = now;
+			return (k);
+		}
+	}
+
+	// a new flow
+	if (2 * (t.size() + 1) > tsize_)
+		grow();
+	t.push(h, iph->saddr(), sport, iph->daddr(), dport, iph->flowid(),
+	       hdr_cmn::access(p)->ptype(), now);
+	insert(t.size() - 1);
+	return (t.size() - 1);
+}
+
+/* the table slot holding flow k */
+int FlowHashClassifier::slotof(int k)
+{
+	int i = flows_.hash_[k] & (tsize_ - 1);
+	while (table_[i] != k + 1)
+		i = (i + 1) & (tsize_ - 1);
+	return (i);
+}
+
+void FlowHashClassifier::insert(int k)
+{
+	int i = flows_.hash_[k] & (tsize_ - 1);
+	while (table_[i] != 0)
+		i = (i + 1) & (tsize_ - 1);
+	table_[i] = k + 1;
+}
+
+/*
+ * Take flow k out of the table, closing the gap by moving back the
+ * entries after it that may not stay where they are, then fill its
+ * place in the columns with the last flow.
+ */
+void FlowHashClassifier::remove(int k)
+{
+	int m = tsize_ - 1;
+	int i = slotof(k);
+	int j = i;
+
+	for (;;) {
+		j = (j + 1) & m;
+		if (table_[j] == 0)
+			break;
+		int h = flows_.hash_[table_[j] - 1] & m;
+		if (i <= j ? (i < h && h <= j) : (i < h || h <= j))
+			continue;
+		table_[i] = table_[j];
+		i = j;
+	}
+	table_[i] = 0;
+
+	int last = flows_.size() - 1;
+	if (k != last) {
+		table_[slotof(last)] = k + 1;
+		flows_.move(k, last);
+	}
+	flows_.pop();
+}
+
+void FlowHashClassifier::grow()
+{
+	tsize_ = tsize_ ? 2 * tsize_ : 256;
+	delete [] table_;
+	table_ = new int[tsize_];
+	memset(table_, 0, tsize_ * sizeof(int));
+	for (int k = 0; k < flows_.size(); k++)
+		insert(k);
+}
+
+/*
+ * Remove the flows idle for more than idle_.  Going down from the end,
+ * the flow remove() moves into a hole has been looked at.
+ */
+void FlowHashClassifier::expire(double now)
+{
+	char buf[256];
+
+	for (int k = flows_.size() - 1; k >= 0; k--) {
+		if (now - flows_.last_[k] <= idle_)
+			continue;
+		if (expch_) {
+			flows_.format(buf, k, now);
+			(void)Tcl_Write(expch_, buf, -1);
+		} else
+			expired_.append(flows_, k);
+		remove(k);
+	}
+	nextsweep_ = now + idle_;
+}
+
+int FlowHashClassifier::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "nflows") == 0) {
+			// flows in the table, then expired ones kept
+			tcl.resultf("%d %d", flows_.size(), expired_.size());
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "reset") == 0) {
+			flows_.clear();
+			expired_.clear();
+			memset(table_, 0, tsize_ * sizeof(int));
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "expire-to") == 0) {
+			int mode;
+			expch_ = Tcl_GetChannel(tcl.interp(), (char*)argv[2],
+						&mode);
+			if (expch_ == 0) {
+				tcl.resultf("%s: can't write to %s", name(),
+					    argv[2]);
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "export") == 0) {
+			int mode;
+			Tcl_Channel ch = Tcl_GetChannel(tcl.interp(),
+				(char*)argv[2], &mode);
+			if (ch == 0) {
+				tcl.resultf("%s: can't write to %s", name(),
+					    argv[2]);
+				return (TCL_ERROR);
+			}
+			double now = Scheduler::instance().clock();
+			char buf[256];
+			int k;
+			for (k = 0; k < expired_.size(); k++) {
+				expired_.format(buf, k, now);
+				(void)Tcl_Write(ch, buf, -1);
+			}
+			expired_.clear();
+			for (k = 0; k < flows_.size(); k++) {
+				flows_.format(buf, k, now);
+				(void)Tcl_Write(ch, buf, -1);
+			}
+			return (TCL_OK);
+		}
+	}
+	return (Classifier::command(argc, argv));
+}
+
+/****************** FlowTable Methods ************/
+
+void FlowTable::push(unsigned int h, nsaddr_t src, int sport, nsaddr_t dst,
+		     int dport, int fid, packet_t type, double now)
+{
+	hash_.push_back(h);
+	src_.push_back(src);
+	sport_.push_back(sport);
+	dst_.push_back(dst);
+	dport_.push_back(dport);
+	fid_.push_back(fid);
+	type_.push_back(type);
+	start_.push_back(now);
+	last_.push_back(now);
+	parrivals_.push_back(0);
+	barrivals_.push_back(0);
+	pdepartures_.push_back(0);
+	bdepartures_.push_back(0);
+	pdrops_.push_back(0);
+	bdrops_.push_back(0);
+	epdrops_.push_back(0);
+	ebdrops_.push_back(0);
+	rttsum_.push_back(0);
+	rttn_.push_back(0);
+}
+
+/* add flow k of t at the end */
+void FlowTable::append(const FlowTable& t, int k)
+{
+	hash_.push_back(t.hash_[k]);
+	src_.push_back(t.src_[k]);
+	sport_.push_back(t.sport_[k]);
+	dst_.push_back(t.dst_[k]);
+	dport_.push_back(t.dport_[k]);
+	fid_.push_back(t.fid_[k]);
+	type_.push_back(t.type_[k]);
+	start_.push_back(t.start_[k]);
+	last_.push_back(t.last_[k]);
+	parrivals_.push_back(t.parrivals_[k]);
+	barrivals_.push_back(t.barrivals_[k]);
+	pdepartures_.push_back(t.pdepartures_[k]);
+	bdepartures_.push_back(t.bdepartures_[k]);
+	pdrops_.push_back(t.pdrops_[k]);
+	bdrops_.push_back(t.bdrops_[k]);
+	epdrops_.push_back(t.epdrops_[k]);
+	ebdrops_.push_back(t.ebdrops_[k]);
+	rttsum_.push_back(t.rttsum_[k]);
+	rttn_.push_back(t.rttn_[k]);
+}
+
+void FlowTable::move(int to, int from)
+{
+	hash_[to] = hash_[from];
+	src_[to] = src_[from];
+	sport_[to] = sport_[from];
+	dst_[to] = dst_[from];
+	dport_[to] = dport_[from];
+	fid_[to] = fid_[from];
+	type_[to] = type_[from];
+	start_[to] = start_[from];
+	last_[to] = last_[from];
+	parrivals_[to] = parrivals_[from];
+	barrivals_[to] = barrivals_[from];
+	pdepartures_[to] = pdepartures_[from];
+	bdepartures_[to] = bdepartures_[from];
+	pdrops_[to] = pdrops_[from];
+	bdrops_[to] = bdrops_[from];
+	epdrops_[to] = epdrops_[from];
+	ebdrops_[to] = ebdrops_[from];
+	rttsum_[to] = rttsum_[from];
+	rttn_[to] = rttn_[from];
+}
+
+void FlowTable::pop()
+{
+	hash_.pop_back();
+	src_.pop_back();
+	sport_.pop_back();
+	dst_.pop_back();
+	dport_.pop_back();
+	fid_.pop_back();
+	type_.pop_back();
+	start_.pop_back();
+	last_.pop_back();
+	parrivals_.pop_back();
+	barrivals_.pop_back();
+	pdepartures_.pop_back();
+	bdepartures_.pop_back();
+	pdrops_.pop_back();
+	bdrops_.pop_back();
+	epdrops_.pop_back();
+	ebdrops_.pop_back();
+	rttsum_.pop_back();
+	rttn_.pop_back();
+}
+
+void FlowTable::clear()
+{
+	hash_.clear();
+	src_.clear();
+	sport_.clear();
+	dst_.clear();
+	dport_.clear();
+	fid_.clear();
+	type_.clear();
+	start_.clear();
+	last_.clear();
+	parrivals_.clear();
+	barrivals_.clear();
+	pdepartures_.clear();
+	bdepartures_.clear();
+	pdrops_.clear();
+	bdrops_.clear();
+	epdrops_.clear();
+	ebdrops_.clear();
+	rttsum_.clear();
+	rttn_.clear();
+}
+
+void FlowTable::format(char* buf, int k, double now) const
+{
+	sprintf(buf, "%8.3f %d %d %d %d %d %d %.6f %.6f "
+		FLOWCNT_FMTSTR " " FLOWCNT_FMTSTR " "
+		FLOWCNT_FMTSTR " " FLOWCNT_FMTSTR " %d %d %d %d %g\n",
+		now, src_[k], sport_[k], dst_[k], dport_[k], fid_[k],
+		type_[k], start_[k], last_[k], parrivals_[k], barrivals_[k],
+		pdepartures_[k], bdepartures_[k], pdrops_[k], bdrops_[k],
+		epdrops_[k], ebdrops_[k],
+		rttn_[k] ? rttsum_[k] / rttn_[k] : -1.0);
+}
@@ -0,0 +1,125 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * classifier-flow.h
+ *
+ * Classifier/Hash/Flow: per-flow statistics kept in C++.
+ *
+ * HashClassifier maps (src, dst, fid) to a slot through a Tcl hash
+ * table, and a packet of a flow it has not seen calls "unknown-flow"
+ * in Tcl, which creates a Flow object for it.  With many short flows
+ * (PackMime, Tmix) those upcalls and objects cost more than the rest of
+ * the simulation.  FlowHashClassifier numbers the 5-tuples (src, sport,
+ * dst, dport, fid; with ports_ false, src, dst, fid) it sees in an
+ * open-addressing table, and keeps the flows' statistics in a
+ * FlowTable, one array per counter, so that counting a packet touches
+ * only the counters it changes.  A FlowMon given this classifier
+ * counts into the table instead of into Flow objects:
+ *
+ *	set fm [$ns makeflowmon Flow]
+ *
+ * Flows not seen for idle_timeout_ seconds (0: never) are removed and
+ * written to the "expire-to" channel if there is one, or else kept
+ * until the next "export" or FlowMon snapshot.  "export <channel>"
+ * writes all the flows, expired ones first, one line each:
+ *
+ *	time src sport dst dport fid type start last parrivals barrivals
+ *	pdepartures bdepartures pdrops bdrops epdrops ebdrops rtt
+ *
+ * where drops include early drops, as for Flow, and rtt is the mean of
+ * the RTTs TCP senders put in their departing packets, in ms, or -1.
+ */
+
+#ifndef ns_classifier_flow_h
+#define ns_classifier_flow_h
+
+#include <vector>
+
+#include "config.h"
+#include "classifier.h"
+#include "packet.h"
+#include "ip.h"
+
+#if defined(HAVE_INT64)
+typedef int64_t flowcnt_t;
+#define FLOWCNT_FMTSTR	STRTOI64_FMTSTR
+#else /* no 64-bit integer */
+typedef int flowcnt_t;
+#define FLOWCNT_FMTSTR	"%d"
+#endif
+
+/*
+ * The columns of the flow statistics, in the order of a FlowMon
+ * snapshot; see FlowMon::snapshot().
+ */
+class FlowTable {
+public:
+	int size() const { return (hash_.size()); }
+	void push(unsigned int h, nsaddr_t src, int sport, nsaddr_t dst,
+		  int dport, int fid, packet_t type, double now);
+	void append(const FlowTable& t, int k);
+	void move(int to, int from);
+	void pop();
+	void clear();
+	void format(char* buf, int k, double now) const;
+
+	std::vector<unsigned int> hash_;	// not exported
+	std::vector<int32_t> src_;
+	std::vector<int32_t> sport_;
+	std::vector<int32_t> dst_;
+	std::vector<int32_t> dport_;
+	std::vector<int32_t> fid_;
+	std::vector<int32_t> type_;		// packet_t of the latest packet
+	std::vector<double> start_;		// first packet
+	std::vector<double> last_;		// latest packet
+	std::vector<flowcnt_t> parrivals_;
+	std::vector<flowcnt_t> barrivals_;
+	std::vector<flowcnt_t> pdepartures_;
+	std::vector<flowcnt_t> bdepartures_;
+	std::vector<int32_t> pdrops_;
+	std::vector<int32_t> bdrops_;
+	std::vector<int32_t> epdrops_;
+	std::vector<int32_t> ebdrops_;
+	std::vector<double> rttsum_;		// ms
+	std::vector<int32_t> rttn_;
+};
+
+class FlowHashClassifier : public Classifier {
+public:
+	FlowHashClassifier();
+	~FlowHashClassifier();
+	int classify(Packet* p);
+	/* the index in table() of p's flow, added if need be */
+	int flow(Packet* p);
+	FlowTable& table() { return (flows_); }
+	/* flows expired since the last drain() */
+	FlowTable& expired() { return (expired_); }
+	void drain() { expired_.clear(); }
+protected:
+	int command(int argc, const char*const* argv);
+	unsigned int hash(nsaddr_t src, int sport, nsaddr_t dst, int dport,
+			  int fid) {
+		unsigned int h = src * 0x9e3779b1U;
+		h = (h ^ dst) * 0x85ebca6bU;
+		h = (h ^ (unsigned int)sport) * 0xc2b2ae35U;
+		h = (h ^ (unsigned int)dport) * 0x27d4eb2fU;
+		h = (h ^ (unsigned int)fid) * 0x165667b1U;
+		return (h ^ (h >> 16));
+	}
+	int slotof(int k);
+	void insert(int k);
+	void remove(int k);
+	void grow();
+	void expire(double now);
+
+	int* table_;		// flow index + 1, or 0 if empty
+	int tsize_;		// a power of 2, at least twice the flows
+	FlowTable flows_;
+	FlowTable expired_;
+	int default_;
+	int ports_;
+	double idle_;		// idle_timeout_
+	double nextsweep_;
+	Tcl_Channel expch_;
+};
+
+#endif
@@ -172,9 +172,14 @@ class DestHashClassifier : public HashClassifier {
 public:
 	DestHashClassifier() : HashClassifier(TCL_ONE_WORD_KEYS) {}
 	virtual int command(int argc, const char*const* argv);
+	void recvtrain(Packet* p) { findtrain(p); }
 	int classify(Packet *p);
 	virtual void do_install(char *dst, NsObject *target);
 protected:
+	int samekey(Packet* a, Packet* b) {
+		return (hdr_ip::access(a)->daddr() ==
+			hdr_ip::access(b)->daddr());
+	}
 	const char* hashkey(nsaddr_t, nsaddr_t dst, int) {
 		long key = mshift(dst);
 		return (const char*) key;
@@ -57,8 +57,14 @@
 #include "classifier.h"
 
 class PortClassifier : public Classifier {
+public:
+	void recvtrain(Packet* p) { findtrain(p); }
 protected:
 	int classify(Packet *p);
+	int samekey(Packet* a, Packet* b) {
+		return (hdr_ip::access(a)->dport() ==
+			hdr_ip::access(b)->dport());
+	}
 // 	void clear(int slot);
 // 	int getnxt(NsObject *);
 //	int command(int argc, const char*const* argv);
@@ -0,0 +1,234 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * classifier-trie.cc
+ *
+ * Longest-prefix match in a multibit trie; see classifier-trie.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "classifier-trie.h"
+#include "addr-params.h"
+#include "ip.h"
+
+static class TrieClassifierClass : public TclClass {
+public:
+	TrieClassifierClass() : TclClass("Classifier/Trie") {}
+	TclObject* create(int, const char*const*) {
+		return (new TrieClassifier);
+	}
+} class_trie_classifier;
+
+TrieClassifier::TrieClassifier() : s_(0), bits_(0), lshift_(0)
+{
+	bind("stride_", &stride_);
+}
+
+int TrieClassifier::classify(Packet* p)
+{
+	if (s_ == 0)
+		return (-1);
+	return (lookup(hdr_ip::access(p)->daddr()));
+}
+
+/*
+ * Take the address layout from AddrParams and the stride from
+ * stride_, when the first route is installed.
+ */
+void TrieClassifier::layout()
+{
+	AddrParamsClass& ap = AddrParamsClass::instance();
+	int top = ap.node_shift(0);
+	for (unsigned int m = ap.node_mask(0); m != 0; m >>= 1)
+		top++;
+	bits_ = top > 32 ? 32 : top;
+	lshift_ = 32 - bits_;
+	s_ = stride_;
+	if (s_ < 1)
+		s_ = 1;
+	if (s_ > 16)
+		s_ = 16;
+	rebuild();
+}
+
+/*
+ * The left-aligned key and length in bits of the prefix for "a.b.c",
+ * "a.b" or "a", or of the default route for "default"; 0 if dst is
+ * not an address.
+ */
+int TrieClassifier::parse(const char* dst, unsigned int* key, int* plen)
+{
+	AddrParamsClass& ap = AddrParamsClass::instance();
+	unsigned int k = 0;
+	int level = 0;
+
+	if (strcmp(dst, "default") == 0) {
+		*key = 0;
+		*plen = 0;
+		return (1);
+	}
+	const char* s = dst;
+	for (;;) {
+		char* e;
+		long v = strtol(s, &e, 10);
+		if (e == s || v < 0 || level >= ap.hlevel() ||
+		    v > ap.node_mask(level))
+			return (0);
+		k |= (unsigned int)v << ap.node_shift(level);
+		level++;
+		if (*e == '\0')
+			break;
+		if (*e != '.')
+			return (0);
+		s = e + 1;
+	}
+	*plen = bits_ - ap.node_shift(level - 1);
+	*key = *plen == 0 ? 0 : k << lshift_;
+	return (1);
+}
+
+/* the slot of target, installing it in a free one if it has none */
+int TrieClassifier::slotfor(NsObject* target)
+{
+	for (int i = 0; i <= maxslot_; i++)
+		if (slot_[i] == target)
+			return (i);
+	return (install_next(target));
+}
+
+void TrieClassifier::do_install(char* dst, NsObject* target)
+{
+	unsigned int key;
+	int plen;
+
+	if (s_ == 0)
+		layout();
+	if (!parse(dst, &key, &plen)) {
+		fprintf(stderr, "%s: bad destination %s\n", name(), dst);
+		return;
+	}
+	add(key, plen, slotfor(target));
+}
+
+/* add a prefix, or change its target */
+void TrieClassifier::add(unsigned int key, int plen, int slot)
+{
+	if (slot > 32767) {
+		fprintf(stderr, "%s: too many targets\n", name());
+		abort();
+	}
+	for (size_t i = 0; i < prefixes_.size(); i++) {
+		if (prefixes_[i].key_ == key && prefixes_[i].plen_ == plen) {
+			prefixes_[i].slot_ = slot;
+			rebuild();
+			return;
+		}
+	}
+	TriePrefix p;
+	p.key_ = key;
+	p.plen_ = plen;
+	p.slot_ = slot;
+	prefixes_.push_back(p);
+	insert(p);
+}
+
+/*
+ * Walk down to the node where the prefix ends, making the nodes on the
+ * way, and give it the entries it covers there unless a longer prefix
+ * already has them.
+ */
+void TrieClassifier::insert(const TriePrefix& p)
+{
+	TrieEntry empty = { 0, -1, -1 };
+	int n = 0;
+	int depth = 0;
+
+	while (p.plen_ - depth > s_) {
+		int i = (n << s_) + ((p.key_ << depth) >> (32 - s_));
+		if (nodes_[i].child_ == 0) {
+			int c = nodes_.size() >> s_;
+			nodes_.resize(nodes_.size() + (1 << s_), empty);
+			nodes_[i].child_ = c;
+		}
+		n = nodes_[i].child_;
+		depth += s_;
+	}
+	int span = 1 << (s_ - (p.plen_ - depth));
+	int first = ((p.key_ << depth) >> (32 - s_)) & ~(span - 1);
+	for (int j = 0; j < span; j++) {
+		TrieEntry& e = nodes_[(n << s_) + first + j];
+		if (e.plen_ <= p.plen_) {
+			e.slot_ = p.slot_;
+			e.plen_ = p.plen_;
+		}
+	}
+}
+
+/* routes are seldom removed, so removing one builds the trie anew */
+void TrieClassifier::rebuild()
+{
+	TrieEntry empty = { 0, -1, -1 };
+	nodes_.assign(1 << s_, empty);
+	for (size_t i = 0; i < prefixes_.size(); i++)
+		insert(prefixes_[i]);
+}
+
+int TrieClassifier::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "stats") == 0) {
+			// prefixes, trie nodes, bytes
+			tcl.resultf("%d %d %d", (int)prefixes_.size(),
+				    (int)(nodes_.size() >> s_),
+				    (int)(nodes_.size() * sizeof(TrieEntry)));
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "clear-prefix") == 0) {
+			unsigned int key;
+			int plen;
+			if (s_ == 0)
+				return (TCL_OK);
+			if (!parse(argv[2], &key, &plen)) {
+				tcl.resultf("%s: bad destination %s", name(),
+					    argv[2]);
+				return (TCL_ERROR);
+			}
+			for (size_t i = 0; i < prefixes_.size(); i++) {
+				if (prefixes_[i].key_ == key &&
+				    prefixes_[i].plen_ == plen) {
+					prefixes_.erase(prefixes_.begin() + i);
+					rebuild();
+					break;
+				}
+			}
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "lookup") == 0) {
+			// the target for a destination address (an integer)
+			int slot = s_ ? lookup(atoi(argv[2])) : -1;
+			if (slot >= 0 && slot <= maxslot_ && slot_[slot])
+				tcl.resultf("%s", slot_[slot]->name());
+			else
+				tcl.result("");
+			return (TCL_OK);
+		}
+	} else if (argc == 4) {
+		if (strcmp(argv[1], "install") == 0) {
+			NsObject* target = (NsObject*)TclObject::lookup(argv[3]);
+			if (target == 0) {
+				tcl.resultf("%s: no target %s", name(), argv[3]);
+				return (TCL_ERROR);
+			}
+			char dst[SMALL_LEN];
+			strncpy(dst, argv[2], SMALL_LEN - 1);
+			dst[SMALL_LEN - 1] = '\0';
+			do_install(dst, target);
+			return (TCL_OK);
+		}
+	}
+	return (Classifier::command(argc, argv));
+}
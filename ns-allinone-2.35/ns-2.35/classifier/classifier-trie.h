@@ -0,0 +1,84 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * classifier-trie.h
+ *
+ * Classifier/Trie: longest-prefix match on destination addresses.
+ *
+ * Classifier/Hier chains one Classifier/Addr per address level, each
+ * with a slot array as large as the highest index installed at that
+ * level, and a packet takes a shift, a mask and a virtual call per
+ * level.  TrieClassifier instead keeps the prefixes of a node's routing
+ * table in one multibit trie with stride_ bits per node, its nodes in
+ * a single array, and classifies a packet with one loop over at most
+ * ceil(bits / stride_) entries.  A prefix ending inside a node's stride
+ * is expanded to the entries it covers, so the trie holds one entry
+ * set per stride actually used, and a hierarchical table (its own
+ * cluster's nodes, the other clusters of its domain, the other
+ * domains) takes a few nodes whatever the size of the topology.
+ *
+ * Destinations are installed as address strings: "a.b.c" is the host
+ * route to node a.b.c, and "a" or "a.b" the route to the domain or
+ * cluster, as with Classifier/Hier; a flat address is a host route.
+ * The addresses are laid out as AddrParams says when the first route
+ * is installed.  With "RtModule/Hier set trie_ true", hierarchical
+ * nodes use this classifier in place of Classifier/Hier.
+ */
+
+#ifndef ns_classifier_trie_h
+#define ns_classifier_trie_h
+
+#include <vector>
+
+#include "classifier.h"
+
+struct TrieEntry {
+	int child_;		// node index, or 0 (the root is never a child)
+	short slot_;		// -1 if no prefix covers the entry
+	short plen_;		// length of that prefix
+};
+
+struct TriePrefix {
+	unsigned int key_;	// left-aligned, bits past plen_ zero
+	int plen_;
+	int slot_;
+};
+
+class TrieClassifier : public Classifier {
+public:
+	TrieClassifier();
+	int classify(Packet* p);
+	void do_install(char* dst, NsObject* target);
+	int lookup(nsaddr_t addr) {
+		unsigned int key = (unsigned int)addr << lshift_;
+		int best = -1;
+		int n = 0;
+		int depth = 0;
+		for (;;) {
+			const TrieEntry& e = nodes_[(n << s_) +
+				((key << depth) >> (32 - s_))];
+			if (e.slot_ >= 0)
+				best = e.slot_;
+			if (e.child_ == 0)
+				return (best);
+			n = e.child_;
+			depth += s_;
+		}
+	}
+protected:
+	int command(int argc, const char*const* argv);
+	void layout();
+	int parse(const char* dst, unsigned int* key, int* plen);
+	int slotfor(NsObject* target);
+	void add(unsigned int key, int plen, int slot);
+	void insert(const TriePrefix& p);
+	void rebuild();
+
+	int stride_;
+	int s_;			// stride_ when the first route went in
+	int bits_;		// address bits used by AddrParams
+	int lshift_;		// 32 - bits_
+	std::vector<TrieEntry> nodes_;	// 2^s_ entries per node
+	std::vector<TriePrefix> prefixes_;
+};
+
+#endif
@@ -153,6 +153,31 @@ void Classifier::recv(Packet* p, Handler*h)
 	node->recv(p,h);
 }
 
+/*
+ * A train goes on as a train to the object its first packet maps to,
+ * for subclasses whose recv() is the one above.  The packets after it
+ * with the same key go along; the train is split at the first with
+ * another, and that part comes back to the classifier at its time.
+ */
+void Classifier::findtrain(Packet* p)
+{
+	NsObject* node = find(p);
+	Packet* q = p;
+	while (q->next_ != 0 && samekey(q, q->next_))
+		q = q->next_;
+	if (q->next_ != 0) {
+		defertrain(q->next_);
+		q->next_ = 0;
+	}
+	if (node != 0)
+		node->recvtrain(p);
+	else
+		while ((q = p) != 0) {	/* as in recv() */
+			p = q->next_;
+			Packet::free(q);
+		}
+}
+
 /*
  * perform the mapping from packet to object
  * perform upcall if no mapping
@@ -78,6 +78,8 @@ public:
 protected:
 	virtual int getnxt(NsObject *);
 	virtual int command(int argc, const char*const* argv);
+	void findtrain(Packet*);	/* recvtrain() for a plain recv() */
+	virtual int samekey(Packet*, Packet*) { return (0); }
 	void alloc(int);
 	NsObject** slot_;	/* table that maps slot number to a NsObject */
 	int nslot_;
@@ -65,7 +65,8 @@ public:
 	}
 } class_agent;
 
-int Agent::uidcnt_;		/* running unique id */
+NS_TLS int Agent::uidcnt_;	/* running unique id */
+int Agent::uidstep_ = 1;
 
 Agent::Agent(packet_t pkttype) : 
 	size_(0), type_(pkttype), 
@@ -454,6 +455,29 @@ void Agent::recv(Packet* p, Handler*)
 	Packet::free(p);
 }
 
+/*
+ * For an agent that takes a train in one piece: each packet goes to
+ * recv() with the clock set to its time, for as long as no other
+ * event is due first (see Scheduler::runahead), and the rest of the
+ * train comes back later.  An agent that writes a trace takes the
+ * packets at their own times instead, so its lines stay in order.
+ */
+void Agent::recveach(Packet* p)
+{
+	if (channel_ != 0 || et_ != 0) {
+		NsObject::recvtrain(p);
+		return;
+	}
+	Scheduler& s = Scheduler::instance();
+	do {
+		Packet* q = p;
+		p = q->next_;
+		recv(q, 0);
+	} while (p != 0 && s.runahead(p->time_));
+	if (p != 0)
+		defertrain(p);
+}
+
 /*
  * initpkt: fill in all the generic fields of a pkt
  */
@@ -462,7 +486,8 @@ void
 Agent::initpkt(Packet* p) const
 {
 	hdr_cmn* ch = hdr_cmn::access(p);
-	ch->uid() = uidcnt_++;
+	ch->uid() = uidcnt_;
+	uidcnt_ += uidstep_;
 	ch->ptype() = type_;
 	ch->size() = size_;
 	ch->timestamp() = Scheduler::instance().clock();
@@ -500,7 +525,6 @@ Agent::initpkt(Packet* p) const
 	hf->qs_ = 0;
 #ifdef HAVE_STL
 
- 	hdr_nv* nv = hdr_nv::access(p);
  	if (0)
 		printf("Off hdr_nv %d, ip_hdr %d myaddr %d\n",
 		       hdr_nv::offset(), hdr_ip::offset(), here_.addr_);
@@ -508,6 +532,8 @@ Agent::initpkt(Packet* p) const
 	// 	if (0)
 	//		printf("Node Object %p\n", reinterpret_cast<void *>(pNixNode) );
  	if (pNixNode) { 
+		// Only nix-vector routing needs the header
+ 		hdr_nv* nv = hdr_nv::access(p);
  		// If we get non-null, indicates nixvector routing in use
  		// Delete any left over nv in the packet
  		// Get a nixvector to the target (may create new)
@@ -112,6 +112,7 @@ class Agent : public Connector {
 	virtual void delay_bind_init_all();
 	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
 
+	void recveach(Packet*);		// a recvtrain() that works through it
 	virtual void recvBytes(int bytes);
 	virtual void idle();
 	Packet* allocpkt() const;	// alloc + set up new pkt
@@ -135,7 +136,9 @@ class Agent : public Connector {
 	int class_;		/* class to place in packet header */
 #endif
 
-	static int uidcnt_;
+	static NS_TLS int uidcnt_;
+	static int uidstep_;	/* 1, or the number of partitions */
+	friend class ParallelScheduler;	/* keeps one per partition */
 
 	Tcl_Channel channel_;
 	char *traceName_;		// name used in agent traces
@@ -0,0 +1,735 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * checkpoint.cc
+ *
+ * Checkpoint and restore of a whole simulation.
+ *
+ * The state of a simulation is spread over the scheduler, the packets
+ * in flight, the random number generators, the objects of hundreds of
+ * C++ classes and the Tcl interpreter (procs, variables, "$ns at"
+ * scripts).  Rather than serializing it one class at a time,
+ * "ns-checkpoint file" (Simulator checkpoint) writes the memory image
+ * of the process: every private mapping that may have changed, the
+ * registers (a jmp_buf) and the open files.  "ns -restore file
+ * [-branch tag] args..." maps the image back at the same addresses and
+ * returns from ns-checkpoint a second time, with 1 instead of 0 and
+ * argv set to args, so the rest of the run is that of the original
+ * process.
+ *
+ * This needs the same addresses in both processes: Linux on x86-64,
+ * the same ns binary and shared libraries, address space randomization
+ * off (start ns with -checkpointable, or under setarch -R) and a
+ * single thread, so not while Scheduler/Parallel runs partitions on
+ * threads.  Elsewhere both options and ns-checkpoint fail, and the
+ * build warns.
+ *
+ * Every restore is a branch of its own.  A file open for writing at
+ * the checkpoint, say out.tr, is copied as it was then to out.tr.tag
+ * (tag defaults to the pid), and the branch writes there.  So branches
+ * restored from one image, and the original run, do not write over
+ * each other's traces.  Read-only files are reopened at the same
+ * offset.  Pipes, sockets and devices cannot be, so ns-checkpoint
+ * refuses while any but 0, 1 and 2 is open.
+ *
+ * tcl/test/test-suite-checkpoint.tcl restores a run and compares its
+ * trace with the uninterrupted run's.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "parallel.h"
+
+#if defined(__linux__) && defined(__x86_64__)
+#define CKPT_SUPPORTED
+#endif
+
+#ifdef CKPT_SUPPORTED
+
+#include <errno.h>
+#include <setjmp.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/personality.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <asm/prctl.h>
+
+#define CKPT_MAGIC	"nsckpt1"
+#define CKPT_PATHLEN	256
+#define CKPT_MAXFD	1024
+#define CKPT_MAXREGIONS	8192
+#define CKPT_MAPSLEN	(1024 * 1024)
+#define CKPT_STACK	(256 * 1024)
+
+struct CkptHeader {
+	char magic_[8];
+	dev_t dev_;		// the ns binary
+	ino_t ino_;
+	off_t size_;
+	time_t mtime_;
+	unsigned long fs_;	// thread pointer
+	int nregions_;
+	int nfds_;
+};
+
+enum { CR_CODE, CR_DATA, CR_HEAP, CR_STACK, CR_NONE };
+
+struct CkptRegion {
+	unsigned long start_;
+	unsigned long end_;
+	int prot_;
+	int kind_;		// CR_DATA, CR_HEAP and CR_STACK are saved
+	int mapped_;		// writable in the restoring process too
+	char path_[CKPT_PATHLEN];
+};
+
+struct CkptFd {
+	int fd_;
+	int flags_;
+	off_t offset_;
+	off_t size_;
+	char path_[CKPT_PATHLEN];
+};
+
+/* what the restoring code needs once the heap and statics are gone */
+struct CkptScratch {
+	int fd_;
+	int nregions_;
+	int nfds_;
+	int argc_;
+	CkptRegion* regions_;
+	CkptFd* fds_;
+	char** argv_;
+};
+
+static jmp_buf ckpt_jb;
+static int ckpt_argc;
+static char** ckpt_argv;
+
+static unsigned long thread_pointer()
+{
+	unsigned long fs = 0;
+	syscall(SYS_arch_prctl, ARCH_GET_FS, &fs);
+	return (fs);
+}
+
+static int binary(CkptHeader* h)
+{
+	struct stat st;
+	if (stat("/proc/self/exe", &st) < 0)
+		return (-1);
+	h->dev_ = st.st_dev;
+	h->ino_ = st.st_ino;
+	h->size_ = st.st_size;
+	h->mtime_ = st.st_mtime;
+	return (0);
+}
+
+/* /proc/self/maps into buf; -1 if it does not fit */
+static int readmaps(char* buf, int size)
+{
+	int fd = open("/proc/self/maps", O_RDONLY);
+	if (fd < 0)
+		return (-1);
+	int len = 0, n;
+	while (len < size - 1 && (n = read(fd, buf + len, size - len - 1)) > 0)
+		len += n;
+	close(fd);
+	buf[len] = '\0';
+	return (len < size - 1 ? 0 : -1);
+}
+
+/* the mappings in maps, at most max; -1 on a shared writable one */
+static int regions(char* maps, CkptRegion* r, int max)
+{
+	int n = 0;
+	for (char* line = strtok(maps, "\n"); line != 0 && n < max;
+	     line = strtok(0, "\n")) {
+		unsigned long start, end;
+		char perms[8];
+		int off = 0;
+		if (sscanf(line, "%lx-%lx %7s %*s %*s %*s %n", &start, &end,
+			   perms, &off) < 3)
+			continue;
+		const char* path = off > 0 ? line + off : "";
+		if (strcmp(path, "[vdso]") == 0 ||
+		    strncmp(path, "[vvar", 5) == 0 ||
+		    strcmp(path, "[vsyscall]") == 0)
+			continue;
+		CkptRegion& c = r[n++];
+		c.start_ = start;
+		c.end_ = end;
+		c.mapped_ = 0;
+		c.prot_ = (perms[0] == 'r' ? PROT_READ : 0) |
+			(perms[1] == 'w' ? PROT_WRITE : 0) |
+			(perms[2] == 'x' ? PROT_EXEC : 0);
+		strncpy(c.path_, path, CKPT_PATHLEN - 1);
+		c.path_[CKPT_PATHLEN - 1] = '\0';
+		if (perms[3] == 's' && (c.prot_ & PROT_WRITE))
+			return (-1);
+		if (strcmp(path, "[heap]") == 0)
+			c.kind_ = CR_HEAP;
+		else if (strcmp(path, "[stack]") == 0)
+			c.kind_ = CR_STACK;
+		else if ((c.prot_ & PROT_READ) == 0)
+			c.kind_ = CR_NONE;
+		else if ((c.prot_ & PROT_WRITE) || path[0] != '/')
+			c.kind_ = CR_DATA;
+		else
+			c.kind_ = CR_CODE;
+	}
+	return (n);
+}
+
+/*
+ * The regular files open, in a malloc'd array; -1, with the reason in
+ * err, if another kind of descriptor is.
+ */
+static int files(int skip, CkptFd** fp, const char** err)
+{
+	static char why[64 + CKPT_PATHLEN];
+	int n = 0;
+	CkptFd* f = (CkptFd*)malloc(CKPT_MAXFD * sizeof(CkptFd));
+	DIR* d = opendir("/proc/self/fd");
+	struct dirent* e;
+	while (d != 0 && (e = readdir(d)) != 0) {
+		char* end;
+		int fd = strtol(e->d_name, &end, 10);
+		if (end == e->d_name || *end != '\0' || fd == skip ||
+		    fd == dirfd(d) || fd <= 2 || n == CKPT_MAXFD)
+			continue;
+		struct stat st;
+		char link[64];
+		if (fstat(fd, &st) < 0)
+			continue;
+		CkptFd& c = f[n];
+		sprintf(link, "/proc/self/fd/%d", fd);
+		int len = readlink(link, c.path_, CKPT_PATHLEN - 1);
+		if (len < 0)
+			continue;
+		c.path_[len] = '\0';
+		if (!S_ISREG(st.st_mode)) {
+			sprintf(why, "descriptor %d (%s) is not a file and "
+				"could not be restored", fd, c.path_);
+			*err = why;
+			n = -1;
+			break;
+		}
+		c.fd_ = fd;
+		c.flags_ = fcntl(fd, F_GETFL);
+		c.offset_ = lseek(fd, 0, SEEK_CUR);
+		c.size_ = st.st_size;
+		n++;
+	}
+	if (d != 0)
+		closedir(d);
+	if (n < 0) {
+		free(f);
+		f = 0;
+	}
+	*fp = f;
+	return (n);
+}
+
+static int writeall(int fd, const void* p, unsigned long n)
+{
+	const char* s = (const char*)p;
+	while (n > 0) {
+		long k = write(fd, s, n > (1UL << 30) ? (1UL << 30) : n);
+		if (k <= 0)
+			return (-1);
+		s += k;
+		n -= k;
+	}
+	return (0);
+}
+
+static long readall(int fd, void* p, unsigned long n)
+{
+	char* s = (char*)p;
+	while (n > 0) {
+		long k = syscall(SYS_read, fd, s,
+				 n > (1UL << 30) ? (1UL << 30) : n);
+		if (k <= 0)
+			return (-1);
+		s += k;
+		n -= k;
+	}
+	return (0);
+}
+
+static void die(const char* msg)
+{
+	syscall(SYS_write, 2, msg, strlen(msg));
+	syscall(SYS_exit_group, 1);
+}
+
+/*
+ * Write the image to file and return 0, or return 1 in the process
+ * restored from it; -1 with the reason in err on failure.
+ */
+static int save(const char* file, const char** err)
+{
+	static CkptRegion* r;
+	static CkptFd* f;
+	static char* maps;
+	static int fd;
+
+	if ((personality(0xffffffff) & ADDR_NO_RANDOMIZE) == 0) {
+		*err = "start ns with -checkpointable to take checkpoints";
+		return (-1);
+	}
+	if (ParallelScheduler::workers() > 0) {
+		*err = "Scheduler/Parallel is running partitions on threads";
+		return (-1);
+	}
+	DIR* d = opendir("/proc/self/task");
+	int ntasks = 0;
+	while (d != 0 && readdir(d) != 0)
+		ntasks++;
+	if (d != 0)
+		closedir(d);
+	if (ntasks > 3) {	// ".", ".." and the main thread
+		*err = "ns has more than one thread";
+		return (-1);
+	}
+	fflush(0);
+	fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		*err = strerror(errno);
+		return (-1);
+	}
+	CkptHeader h;
+	memset(&h, 0, sizeof(h));
+	if ((h.nfds_ = files(fd, &f, err)) < 0) {
+		close(fd);
+		unlink(file);
+		return (-1);
+	}
+	// bind syscall() now, for restore_image() to use it through the image
+	syscall(SYS_getpid);
+	memcpy(h.magic_, CKPT_MAGIC, sizeof(h.magic_));
+	binary(&h);
+	h.fs_ = thread_pointer();
+	maps = (char*)malloc(CKPT_MAPSLEN);
+	r = (CkptRegion*)malloc(CKPT_MAXREGIONS * sizeof(CkptRegion));
+
+	/* nothing may allocate memory from here to the end of the image */
+	if (readmaps(maps, CKPT_MAPSLEN) < 0 ||
+	    (h.nregions_ = regions(maps, r, CKPT_MAXREGIONS)) < 0) {
+		*err = "cannot list or save ns's memory mappings";
+		close(fd);
+		free(r);
+		free(f);
+		free(maps);
+		return (-1);
+	}
+	if (setjmp(ckpt_jb) != 0) {
+		free(r);
+		free(f);
+		free(maps);
+		return (1);
+	}
+	int ok = writeall(fd, &h, sizeof(h)) == 0 &&
+		writeall(fd, r, h.nregions_ * sizeof(CkptRegion)) == 0 &&
+		writeall(fd, f, h.nfds_ * sizeof(CkptFd)) == 0;
+	for (int i = 0; ok && i < h.nregions_; i++) {
+		int k = r[i].kind_;
+		if (k == CR_DATA || k == CR_HEAP || k == CR_STACK)
+			ok = writeall(fd, (void*)r[i].start_,
+				      r[i].end_ - r[i].start_) == 0;
+	}
+	if (close(fd) < 0)
+		ok = 0;
+	free(r);
+	free(f);
+	free(maps);
+	if (!ok) {
+		*err = strerror(errno);
+		return (-1);
+	}
+	return (0);
+}
+
+/*
+ * Runs on a stack of its own, outside the image, and never returns:
+ * it overwrites the heap, statics and thread data that the code it
+ * calls would use, so only system calls are made until longjmp().
+ */
+static void restore_image(unsigned int hi, unsigned int lo)
+{
+	CkptScratch* s = (CkptScratch*)(((unsigned long)hi << 32) | lo);
+	const unsigned long pg = sysconf(_SC_PAGESIZE);
+
+	for (int i = 0; i < s->nregions_; i++) {
+		CkptRegion& r = s->regions_[i];
+		unsigned long len = r.end_ - r.start_;
+		switch (r.kind_) {
+		case CR_CODE:
+			continue;
+		case CR_NONE:
+			if ((long)syscall(SYS_mmap, r.start_, len, PROT_NONE,
+				    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+				    -1, 0) == -1)
+				die("ns -restore: cannot map memory\n");
+			continue;
+		case CR_HEAP:
+			if ((unsigned long)syscall(SYS_brk, r.end_) < r.end_)
+				die("ns -restore: cannot grow the heap\n");
+			syscall(SYS_mprotect, r.start_, len,
+				PROT_READ | PROT_WRITE);
+			break;
+		case CR_STACK:
+			// grow the stack down to the saved one's start
+			for (unsigned long a = r.end_ - pg; a >= r.start_;
+			     a -= pg)
+				*(volatile char*)a = 0;
+			break;
+		default:
+			// a fresh mapping over ns's or a library's data would
+			// take its GOT away before the read put it back
+			if (r.mapped_)
+				break;
+			if ((long)syscall(SYS_mmap, r.start_, len,
+				    PROT_READ | PROT_WRITE,
+				    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+				    -1, 0) == -1)
+				die("ns -restore: cannot map memory\n");
+			break;
+		}
+		if (readall(s->fd_, (void*)r.start_, len) < 0)
+			die("ns -restore: short checkpoint file\n");
+	}
+	for (int i = 0; i < s->nregions_; i++) {
+		CkptRegion& r = s->regions_[i];
+		if (r.kind_ != CR_CODE && r.kind_ != CR_NONE)
+			syscall(SYS_mprotect, r.start_, r.end_ - r.start_,
+				r.prot_);
+	}
+
+	for (int fd = 3; fd < CKPT_MAXFD; fd++)
+		if (fd != s->fd_)
+			syscall(SYS_close, fd);
+	for (int i = 0; i < s->nfds_; i++) {
+		CkptFd& c = s->fds_[i];
+		int fd = syscall(SYS_open, c.path_,
+				 c.flags_ & (O_ACCMODE | O_APPEND), 0);
+		if (fd < 0) {
+			die("ns -restore: cannot reopen a file "
+			    "open at the checkpoint\n");
+		}
+		syscall(SYS_lseek, fd, c.offset_, SEEK_SET);
+		if (fd != c.fd_) {
+			syscall(SYS_dup2, fd, c.fd_);
+			syscall(SYS_close, fd);
+		}
+	}
+	syscall(SYS_close, s->fd_);
+
+	ckpt_argc = s->argc_;
+	ckpt_argv = s->argv_;
+	longjmp(ckpt_jb, 1);
+}
+
+/*
+ * Copy an output file, as it was at the checkpoint, to path.tag, for
+ * the restored process to write to instead.
+ */
+static void branch(const char* file, CkptFd* c, const char* tag)
+{
+	char path[CKPT_PATHLEN];
+	if (snprintf(path, sizeof(path), "%s.%s", c->path_, tag) >=
+	    (int)sizeof(path)) {
+		fprintf(stderr, "%s: the name of %s.%s is too long\n", file,
+			c->path_, tag);
+		exit(1);
+	}
+	int from = open(c->path_, O_RDONLY);
+	if (from < 0) {
+		perror(c->path_);
+		exit(1);
+	}
+	int to = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (to < 0) {
+		perror(path);
+		exit(1);
+	}
+	char buf[65536];
+	off_t left = c->size_;
+	while (left > 0) {
+		long n = read(from, buf, left < (off_t)sizeof(buf) ?
+			      left : (off_t)sizeof(buf));
+		if (n <= 0) {
+			fprintf(stderr, "%s: %s is shorter than at the "
+				"checkpoint\n", file, c->path_);
+			exit(1);
+		}
+		if (writeall(to, buf, n) < 0) {
+			perror(path);
+			exit(1);
+		}
+		left -= n;
+	}
+	close(from);
+	if (close(to) < 0) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(stderr, "ns -restore: %s continues in %s\n", c->path_, path);
+	strcpy(c->path_, path);
+}
+
+static int overlaps(unsigned long a, unsigned long b, CkptRegion* r, int n)
+{
+	for (int i = 0; i < n; i++)
+		if (a < r[i].end_ && r[i].start_ < b)
+			return (1);
+	return (0);
+}
+
+static void restore(const char* file, const char* tag, int argc,
+		    char** argv)
+{
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) {
+		perror(file);
+		exit(1);
+	}
+	int hfd = fcntl(fd, F_DUPFD, CKPT_MAXFD - 1);
+	if (hfd >= 0) {
+		close(fd);
+		fd = hfd;
+	}
+	CkptHeader h, me;
+	if (readall(fd, &h, sizeof(h)) < 0 ||
+	    memcmp(h.magic_, CKPT_MAGIC, sizeof(h.magic_)) != 0) {
+		fprintf(stderr, "%s: not an ns checkpoint\n", file);
+		exit(1);
+	}
+	if (binary(&me) < 0 || h.dev_ != me.dev_ || h.ino_ != me.ino_ ||
+	    h.size_ != me.size_ || h.mtime_ != me.mtime_) {
+		fprintf(stderr, "%s: written by another ns binary\n", file);
+		exit(1);
+	}
+	if (h.fs_ != thread_pointer()) {
+		fprintf(stderr, "%s: the thread data has moved\n", file);
+		exit(1);
+	}
+
+	/* the scratch area: arguments, tables and a stack, out of the way */
+	unsigned long size = sizeof(CkptScratch) +
+		h.nregions_ * sizeof(CkptRegion) + h.nfds_ * sizeof(CkptFd) +
+		(argc + 1) * sizeof(char*) + CKPT_STACK;
+	for (int i = 0; i < argc; i++)
+		size += strlen(argv[i]) + 1;
+	size = (size + 0xffff) & ~0xffffUL;
+	char* p = (char*)malloc(h.nregions_ * sizeof(CkptRegion) +
+				h.nfds_ * sizeof(CkptFd));
+	CkptRegion* saved = (CkptRegion*)p;
+	if (readall(fd, p, h.nregions_ * sizeof(CkptRegion) +
+		    h.nfds_ * sizeof(CkptFd)) < 0) {
+		fprintf(stderr, "%s: short checkpoint file\n", file);
+		exit(1);
+	}
+	CkptFd* fds = (CkptFd*)(p + h.nregions_ * sizeof(CkptRegion));
+	for (int i = 0; i < h.nfds_; i++)
+		if ((fds[i].flags_ & O_ACCMODE) != O_RDONLY)
+			branch(file, &fds[i], tag);
+	CkptRegion* cur = (CkptRegion*)malloc(CKPT_MAXREGIONS *
+					      sizeof(CkptRegion));
+	char* maps = (char*)malloc(CKPT_MAPSLEN);
+	int ncur = -1;
+	if (readmaps(maps, CKPT_MAPSLEN) == 0)
+		ncur = regions(maps, cur, CKPT_MAXREGIONS);
+	if (ncur < 0) {
+		fprintf(stderr, "ns -restore: cannot list the mappings\n");
+		exit(1);
+	}
+	unsigned long heap = syscall(SYS_brk, 0), stack = 0;
+	for (int j = 0; j < ncur; j++) {
+		if (cur[j].kind_ == CR_HEAP)
+			heap = cur[j].start_;
+		else if (cur[j].kind_ == CR_STACK)
+			stack = cur[j].end_;
+	}
+	for (int i = 0; i < h.nregions_; i++) {
+		CkptRegion& r = saved[i];
+		int moved = 0;
+		if (r.kind_ == CR_HEAP)
+			moved = r.start_ != heap;
+		else if (r.kind_ == CR_STACK)
+			moved = r.end_ != stack;
+		else if (r.kind_ == CR_CODE) {
+			moved = 1;
+			for (int j = 0; j < ncur; j++)
+				if (cur[j].start_ == r.start_ &&
+				    cur[j].end_ == r.end_ &&
+				    strcmp(cur[j].path_, r.path_) == 0)
+					moved = 0;
+		}
+		if (moved) {
+			fprintf(stderr, "%s: %s is not mapped as it was\n",
+				file, r.path_[0] ? r.path_ : "memory");
+			exit(1);
+		}
+		for (int j = 0; j < ncur; j++)
+			if (cur[j].start_ <= r.start_ && r.end_ <= cur[j].end_ &&
+			    (cur[j].prot_ & PROT_WRITE))
+				r.mapped_ = 1;
+	}
+	unsigned long a;
+	for (a = 0x100000000000UL; a < 0x700000000000UL;
+	     a += 0x10000000000UL)
+		if (!overlaps(a, a + size, saved, h.nregions_) &&
+		    !overlaps(a, a + size, cur, ncur))
+			break;
+	char* base = (char*)mmap((void*)a, size, PROT_READ | PROT_WRITE,
+				 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base != (char*)a) {
+		fprintf(stderr, "ns -restore: no room for the scratch area\n");
+		exit(1);
+	}
+	CkptScratch* s = (CkptScratch*)base;
+	char* q = base + sizeof(CkptScratch);
+	s->fd_ = fd;
+	s->nregions_ = h.nregions_;
+	s->nfds_ = h.nfds_;
+	s->regions_ = (CkptRegion*)q;
+	memcpy(q, p, h.nregions_ * sizeof(CkptRegion) +
+	       h.nfds_ * sizeof(CkptFd));
+	q += h.nregions_ * sizeof(CkptRegion);
+	s->fds_ = (CkptFd*)q;
+	q += h.nfds_ * sizeof(CkptFd);
+	s->argc_ = argc;
+	s->argv_ = (char**)q;
+	q += (argc + 1) * sizeof(char*);
+	for (int i = 0; i < argc; i++) {
+		s->argv_[i] = q;
+		strcpy(q, argv[i]);
+		q += strlen(q) + 1;
+	}
+	s->argv_[argc] = 0;
+	// nothing is freed: that could unmap memory found mapped above
+
+	ucontext_t uc;
+	getcontext(&uc);
+	uc.uc_stack.ss_sp = base + size - CKPT_STACK;
+	uc.uc_stack.ss_size = CKPT_STACK;
+	uc.uc_link = 0;
+	makecontext(&uc, (void (*)())restore_image, 2,
+		    (unsigned int)((unsigned long)s >> 32),
+		    (unsigned int)((unsigned long)s & 0xffffffffUL));
+	setcontext(&uc);
+	die("ns -restore: cannot switch stacks\n");
+}
+
+/* rerun ns with address space randomization off, unless it already is */
+static void norandomize(char** argv)
+{
+	int p = personality(0xffffffff);
+	if (p & ADDR_NO_RANDOMIZE)
+		return;
+	if (personality(p | ADDR_NO_RANDOMIZE) < 0) {
+		perror("personality");
+		exit(1);
+	}
+	execv("/proc/self/exe", argv);
+	perror("execv");
+	exit(1);
+}
+
+/*
+ * ns -checkpointable script args...
+ * ns -restore file [-branch tag] args...
+ */
+void checkpoint_main(int& argc, char**& argv)
+{
+	if (argc > 1 && strcmp(argv[1], "-checkpointable") == 0) {
+		norandomize(argv);
+		argv[1] = argv[0];
+		argv++;
+		argc--;
+	} else if (argc > 2 && strcmp(argv[1], "-restore") == 0) {
+		norandomize(argv);
+		char pid[32];
+		const char* tag = pid;
+		int skip = 3;
+		if (argc > 4 && strcmp(argv[3], "-branch") == 0) {
+			tag = argv[4];
+			skip = 5;
+		} else
+			sprintf(pid, "%d", (int)getpid());
+		if (*tag == '\0' || strchr(tag, '/') != 0) {
+			fprintf(stderr, "ns -restore: bad branch \"%s\"\n",
+				tag);
+			exit(1);
+		}
+		restore(argv[2], tag, argc - skip, argv + skip);
+	}
+}
+
+#else /* !CKPT_SUPPORTED */
+
+#ifdef _MSC_VER
+#pragma message("checkpoint.cc: checkpoints need Linux on x86-64, " \
+		"ns-checkpoint and ns -restore will fail")
+#else
+#warning "checkpoints need Linux on x86-64, ns-checkpoint and ns -restore will fail"
+#endif
+
+void checkpoint_main(int&, char**& argv)
+{
+	if (argv[1] != 0 && (strcmp(argv[1], "-restore") == 0 ||
+			     strcmp(argv[1], "-checkpointable") == 0)) {
+		fprintf(stderr, "ns %s: checkpoints need Linux on x86-64\n",
+			argv[1]);
+		exit(1);
+	}
+}
+
+#endif /* CKPT_SUPPORTED */
+
+class CheckpointCommand : public TclCommand {
+public:
+	CheckpointCommand() : TclCommand("ns-checkpoint") {}
+	virtual int command(int argc, const char*const* argv);
+};
+
+int CheckpointCommand::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc != 2) {
+		tcl.add_error("ns-checkpoint requires a file name.");
+		return (TCL_ERROR);
+	}
+#ifdef CKPT_SUPPORTED
+	const char* err = 0;
+	int r = save(argv[1], &err);
+	if (r < 0) {
+		tcl.resultf("ns-checkpoint %s: %s", argv[1], err);
+		return (TCL_ERROR);
+	}
+	if (r > 0) {
+		char* args = Tcl_Merge(ckpt_argc, ckpt_argv);
+		Tcl_SetVar(tcl.interp(), "argv", args, TCL_GLOBAL_ONLY);
+		Tcl_Free(args);
+		tcl.evalf("set argc %d", ckpt_argc);
+	}
+	tcl.resultf("%d", r);
+	return (TCL_OK);
+#else
+	tcl.resultf("ns-checkpoint: checkpoints need Linux on x86-64");
+	return (TCL_ERROR);
+#endif
+}
+
+void init_checkpoint()
+{
+	(void)new CheckpointCommand;
+}
@@ -0,0 +1,72 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * conn-pool.h
+ *
+ * Idle connection endpoints kept by the node they are attached to.
+ *
+ * Tmix and PackMimeHTTP recycle their TCP agents, but take any idle
+ * agent for a new connection and attach it to the connection's node
+ * again through Tcl, which allocates it another port each time.  A
+ * ConnPool keeps the idle agents of each node apart, so an agent is
+ * attached once and reused on its node.  Like the shared pools, an
+ * agent is handed out again only once it has been idle hold_ seconds
+ * (Tmix waits a second, PackMimeHTTP not at all).
+ */
+
+#ifndef ns_conn_pool_h
+#define ns_conn_pool_h
+
+#include <deque>
+#include <map>
+
+class Node;
+
+template <class T>
+class ConnPool {
+public:
+	ConnPool(double hold) : hold_(hold), size_(0) {}
+	/* an endpoint of n idle for hold_ seconds, or 0 */
+	T get(Node* n, double now) {
+		typename Pools::iterator i = idle_.find(n);
+		if (i == idle_.end() || i->second.empty() ||
+		    now - i->second.front().since_ < hold_)
+			return (0);
+		T t = i->second.front().t_;
+		i->second.pop_front();
+		size_--;
+		return (t);
+	}
+	void put(Node* n, T t, double since) {
+		Idle e;
+		e.t_ = t;
+		e.since_ = since;
+		idle_[n].push_back(e);
+		size_++;
+	}
+	/* any endpoint, to empty the pool */
+	T drain() {
+		for (typename Pools::iterator i = idle_.begin();
+		     i != idle_.end(); i++) {
+			if (!i->second.empty()) {
+				T t = i->second.front().t_;
+				i->second.pop_front();
+				size_--;
+				return (t);
+			}
+		}
+		return (0);
+	}
+	int size() const { return (size_); }
+
+	const double hold_;
+protected:
+	struct Idle {
+		T t_;
+		double since_;
+	};
+	typedef std::map<Node*, std::deque<Idle> > Pools;
+	Pools idle_;
+	int size_;
+};
+
+#endif
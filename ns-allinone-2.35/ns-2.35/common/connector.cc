@@ -37,6 +37,7 @@ static const char rcsid[] =
     "@(#) $Header: /cvsroot/nsnam/ns-2/common/connector.cc,v 1.14 1998/12/08 23:43:05 haldar Exp $ ";
 #endif
 
+#include <typeinfo>
 #include "packet.h"
 #include "connector.h"
 
@@ -103,6 +104,18 @@ void Connector::recv(Packet* p, Handler* h)
 	send(p, h);
 }
 
+/*
+ * A plain Connector passes a train on as it is; a subclass that has
+ * not said otherwise takes it packet by packet.
+ */
+void Connector::recvtrain(Packet* p)
+{
+	if (typeid(*this) == typeid(Connector))
+		target_->recvtrain(p);
+	else
+		NsObject::recvtrain(p);
+}
+
 void Connector::drop(Packet* p)
 {
 	if (drop_ != 0)
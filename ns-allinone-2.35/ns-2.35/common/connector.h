@@ -49,6 +49,7 @@ public:
 	void target (NsObject *target) { target_ = target; }
 	virtual void drop(Packet* p);
 	void setDropTarget(NsObject *dt) {drop_ = dt; } 
+	void recvtrain(Packet*);
 protected:
 	virtual void drop(Packet* p, const char *s);
 	int command(int argc, const char*const* argv);
@@ -151,7 +151,16 @@ public:
 	 * Insert <key, elem> into heap h.
 	 * Adjust heap_size if we hit the limit.
 	 */
-	void heap_insert(heap_key_t key, void* elem);
+	void heap_insert(heap_key_t key, void* elem) {
+		heap_insert(key, h_s_key++, elem);
+	}
+
+	/*
+	 * The same with an explicit secondary key, which orders the
+	 * elements of equal key (by default, the insertion order).
+	 */
+	void heap_insert(heap_key_t key, heap_secondary_key_t skey,
+			 void* elem);
 
 	/*
 	 * void *heap_min(Heap *h)
@@ -162,6 +171,15 @@ public:
 	void* heap_min() {
 		return (h_size > 0 ? h_elems[0].he_elem : 0);
 	};
+
+	/*
+	 * int heap_size(Heap *h)
+	 *
+	 *	Returns the number of elements in the heap.
+	 */
+	int heap_size() {
+		return (h_size);
+	};
 			
 	/*
 	 * void *heap_extract_min(Heap *h)
@@ -125,6 +125,7 @@ MobileNode::MobileNode(void) :
 	random_motion_ = 0;
 	base_stn_ = -1;
 	T_ = 0;
+	chanlist_ = 0;
 
 	log_target_ = 0;
 	next_ = 0;
@@ -487,7 +488,8 @@ MobileNode::update_position()
 	
 	/* list based improvement */
 	if(oldX != X_)// || oldY != Y_)
-		T_->updateNodesList(this, oldX);//, oldY);
+		for (ChannelNode *cn = chanlist_; cn; cn = cn->nextchan_)
+			cn->channel_->updateNodesList(cn, oldX);//, oldY);
 	// COMMENTED BY -VAL- // bound_position();
 
 	// COMMENTED BY -VAL- // Z_ = T_->height(X_, Y_);
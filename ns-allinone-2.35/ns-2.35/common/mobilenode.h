@@ -109,6 +109,7 @@ class MobileNode;
 		 -----------------------
 #endif
 class MobileNode;
+struct ChannelNode;
 
 class PositionHandler : public Handler {
 public:
@@ -159,9 +160,8 @@ public:
 	//void logrttime(double);
 	virtual void idle_energy_patch(float, float);
 
-	/* For list-keeper */
-	MobileNode* nextX_;
-	MobileNode* prevX_;
+	/* For list-keeper: one entry per channel the node is on */
+	ChannelNode* chanlist_;
 	
 protected:
 	/*
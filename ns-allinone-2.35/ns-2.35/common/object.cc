@@ -93,6 +93,65 @@ void NsObject::handle(Event* e)
 	recv((Packet*)e);
 }
 
+/*
+ * Hands the packets of a split train to an object's recv() at their
+ * times, and goes away after the last.
+ */
+class TrainSplitter : public Handler {
+public:
+	TrainSplitter(NsObject* obj, int n) : obj_(obj), n_(n) {}
+	void handle(Event* e) {
+		NsObject* obj = obj_;
+		if (--n_ == 0)
+			delete this;
+		obj->recv((Packet*)e);
+	}
+protected:
+	NsObject* obj_;
+	int n_;
+};
+
+void NsObject::recvtrain(Packet* p)
+{
+	Scheduler& s = Scheduler::instance();
+	double now = s.clock();
+	int n = 0;
+	Packet* q;
+	for (q = p; q != 0; q = q->next_)
+		if (q->time_ > now)
+			n++;
+	TrainSplitter* ts = n > 0 ? new TrainSplitter(this, n) : 0;
+	while ((q = p) != 0) {
+		p = q->next_;
+		if (q->time_ > now)
+			s.schedule_at(ts, q, q->time_);
+		else
+			recv(q);
+	}
+}
+
+/*
+ * Hands a deferred train back to an object's recvtrain(), and goes
+ * away.
+ */
+class TrainDeferrer : public Handler {
+public:
+	TrainDeferrer(NsObject* obj) : obj_(obj) {}
+	void handle(Event* e) {
+		NsObject* obj = obj_;
+		delete this;
+		obj->recvtrain((Packet*)e);
+	}
+protected:
+	NsObject* obj_;
+};
+
+void NsObject::defertrain(Packet* p)
+{
+	Scheduler::instance().schedule_at(new TrainDeferrer(this), p,
+					  p->time_);
+}
+
 void NsObject::recv(Packet *p, const char*)
 {
 	Packet::free(p);
@@ -55,6 +55,22 @@ public:
 	//added for queue tracing -  ratul
 	virtual void recvOnly(Packet *) {};
 
+	/*
+	 * A packet train: p and the packets chained after it by next_,
+	 * each due at its time_, p now.  An object that can take a train
+	 * in one piece passes it on, or works through it with the clock
+	 * set to each packet's time for as long as nothing else is due
+	 * first; by default each packet is handed to recv() at its own
+	 * time.
+	 */
+	virtual void recvtrain(Packet* p);
+	/*
+	 * Hand the rest of a train, from p on, back to recvtrain() at the
+	 * time of p: what an object does when it may not take p yet (see
+	 * Scheduler::runahead).
+	 */
+	void defertrain(Packet* p);
+
 	virtual int command(int argc, const char*const* argv);
 	virtual void delay_bind_init_all();
 	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
@@ -58,14 +58,42 @@ int p_info::addPacket(char *name)
 }
 
 int Packet::hdrlen_ = 0;		// size of a packet's header
-Packet* Packet::free_;			// free list
+NS_TLS Packet* Packet::free_;		// free list
 int hdr_cmn::offset_;			// static offset of common header
 int hdr_flags::offset_;			// static offset of flags header
 
 
+PacketHeaderClass* PacketHeaderClass::all_;
+
 PacketHeaderClass::PacketHeaderClass(const char* classname, int hdrlen) : 
-	TclClass(classname), hdrlen_(hdrlen), offset_(0)
+	TclClass(classname), hdrlen_(hdrlen), offset_(0), next_(all_)
+{
+	all_ = this;
+}
+
+/* the header at offset, if any */
+const char* PacketHeaderClass::name(int offset)
+{
+	for (PacketHeaderClass* p = all_; p != 0; p = p->next_)
+		if (p->offset_ != 0 && *p->offset_ == offset)
+			return (p->classname_);
+	return (0);
+}
+
+/*
+ * A header left out of a compacted packet format has a negative offset
+ * (see compact-packet-headers in ns-packet.tcl), so touching it ends up
+ * here instead of in some other header.
+ */
+void Packet::badoffset(int off)
 {
+	const char* name = PacketHeaderClass::name(off);
+	if (name != 0)
+		fprintf(stderr, "%s is not in the packet format; "
+			"add it to compact-packet-headers\n", name);
+	else
+		fprintf(stderr, "bad packet header offset %d\n", off);
+	abort();
 }
 
 
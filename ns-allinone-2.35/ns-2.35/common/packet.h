@@ -503,7 +503,7 @@ private:
 	static void init(Packet*);     // initialize pkt hdr 
 	bool fflag_;
 protected:
-	static Packet* free_;	// packet free list
+	static NS_TLS Packet* free_;	// packet free list
 	int	ref_count_;	// free the pkt until count to 0
 public:
 	Packet* next_;		// for queues and the free list
@@ -522,9 +522,10 @@ public:
 	static inline void free(Packet*);
 	inline unsigned char* access(int off) const {
 		if (off < 0)
-			abort();
+			badoffset(off);
 		return (&bits_[off]);
 	}
+	static void badoffset(int off);
 	// This is used for backward compatibility, i.e., assuming user data
 	// is PacketData and return its pointer.
 	inline unsigned char* accessdata() const { 
@@ -690,10 +691,13 @@ protected:
 	inline void offset(int* off) {offset_= off;}
 	int hdrlen_;		// # of bytes for this header
 	int* offset_;		// offset for this header
+	PacketHeaderClass* next_;
+	static PacketHeaderClass* all_;
 public:
 	virtual void bind();
 	virtual void export_offsets();
 	TclObject* create(int argc, const char*const* argv);
+	static const char* name(int offset);
 };
 
 
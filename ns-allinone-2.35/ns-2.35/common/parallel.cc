@@ -0,0 +1,532 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * parallel.cc
+ *
+ * Conservative parallel scheduler partitioned by link delay; see
+ * parallel.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "parallel.h"
+
+static class ParallelSchedulerClass : public TclClass {
+public:
+	ParallelSchedulerClass() : TclClass("Scheduler/Parallel") {}
+	TclObject* create(int /* argc */, const char*const* /* argv */) {
+		return (new ParallelScheduler);
+	}
+} class_parallel_sched;
+
+#ifndef NS_PARALLEL
+
+ParallelScheduler::ParallelScheduler()
+{
+	bind_time("lookahead_", &lookahead_);
+	bind("threads_", &threads_);
+}
+
+int
+ParallelScheduler::command(int argc, const char*const* argv)
+{
+	if (argc == 3 && strcmp(argv[1], "partitions") == 0) {
+		Tcl::instance().result("Scheduler/Parallel: ns was built "
+		    "without NS_PARALLEL (configure --enable-parallel)");
+		return (TCL_ERROR);
+	}
+	return (CalendarScheduler::command(argc, argv));
+}
+
+#else /* NS_PARALLEL */
+
+#include "agent.h"
+#include "rng.h"
+
+NS_TLS ParallelLP* ParallelScheduler::current_;
+int ParallelScheduler::workers_;
+
+static class LPSchedulerClass : public TclClass {
+public:
+	LPSchedulerClass() : TclClass("Scheduler/Parallel/LP") {}
+	TclObject* create(int /* argc */, const char*const* /* argv */) {
+		return (new LPScheduler);
+	}
+} class_lp_sched;
+
+/* the order of the sequential run: time, then stime and uid */
+template <class T> static inline int
+earlier(const T& a, const T& b)
+{
+	return (a.time_ < b.time_ || (a.time_ == b.time_ &&
+		(a.stime_ < b.stime_ ||
+		 (a.stime_ == b.stime_ && a.uid_ < b.uid_))));
+}
+
+struct ParallelWorker {
+	ParallelScheduler* par_;
+	int id_;
+};
+
+ParallelScheduler::ParallelScheduler() : nlp_(0), base_(0), half_(0),
+	inhalf_(1), end_(0), nthreads_(1), quit_(0), windows_(0), serial_(0)
+{
+	bind_time("lookahead_", &lookahead_);
+	bind("threads_", &threads_);
+	pthread_mutex_init(&lock0_, 0);
+}
+
+int
+ParallelScheduler::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "stats") == 0) {
+			// windows, serial events, then events per partition
+			char buf[PAR_MAXLP * 24 + 48];
+			int n = sprintf(buf, "%ld %ld", windows_, serial_);
+			for (int i = 1; i < nlp_; i++)
+				n += sprintf(buf + n, " %ld", lp_[i]->events_);
+			tcl.result(buf);
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "partitions") == 0) {
+			int n = atoi(argv[2]);
+			if (nlp_ != 0) {
+				tcl.result("already partitioned");
+				return (TCL_ERROR);
+			}
+			if (n < 1 || n > PAR_MAXLP) {
+				tcl.resultf("partitions must be 1..%d",
+					    PAR_MAXLP);
+				return (TCL_ERROR);
+			}
+			partitions(n);
+			return (TCL_OK);
+		}
+	}
+	return (CalendarScheduler::command(argc, argv));
+}
+
+/*
+ * Create partitions 0 .. n-1.  From here on every queue hands out uids
+ * that are its partition's number modulo PAR_MAXLP, so that a cancel
+ * can find the queue an event is in, and packet uids that are its
+ * number modulo n.  Partition 0 keeps the default RNG; the others
+ * take the next streams, which follow the seed as well.
+ */
+void
+ParallelScheduler::partitions(int n)
+{
+	instance_ = this;
+	base_ = (uid_ + PAR_MAXLP - 1) / PAR_MAXLP * PAR_MAXLP;
+	int pktbase = Agent::uidcnt_;
+	for (int i = 0; i < n; i++) {
+		ParallelLP* lp = new ParallelLP;
+		lp->id_ = i;
+		lp->par_ = this;
+		lp->uid_ = base_ + i;
+		lp->pktuid_ = pktbase + i;
+		if (i == 0) {
+			lp->sched_ = this;
+			lp->rng_ = RNG::defaultrng();
+		} else {
+			LPScheduler* s = (LPScheduler*)
+				TclObject::New("Scheduler/Parallel/LP");
+			s->par_ = this;
+			s->lp_ = lp;
+			lp->sched_ = s;
+			lp->rng_ = new RNG;
+		}
+		for (int h = 0; h < 2; h++)
+			for (int j = 0; j < PAR_MAXLP; j++)
+				lp->outmin_[h][j] = HUGE_VAL;
+		lp->stime_ = 0;
+		lp->evuid_ = 0;
+		lp->buffer_ = 0;
+		lp->events_ = 0;
+		lp_[i] = lp;
+	}
+	nlp_ = n;
+	Agent::uidstep_ = n;
+	RNG::shared_ = lp_[0]->rng_;
+	enter(lp_[0]);
+}
+
+void
+ParallelScheduler::enter(ParallelLP* lp)
+{
+	instance_ = lp->sched_;
+	uid_ = lp->uid_;
+	uidstep_ = PAR_MAXLP;
+	Agent::uidcnt_ = lp->pktuid_;
+	RNG::defaultrng(lp->rng_);
+	current_ = lp;
+}
+
+void
+ParallelScheduler::leave(ParallelLP* lp)
+{
+	lp->uid_ = uid_;
+	lp->pktuid_ = Agent::uidcnt_;
+	lp->rng_ = RNG::defaultrng();
+}
+
+int
+ParallelScheduler::post(int dst, Handler* h, Event* e, double t)
+{
+	ParallelLP* cur = current_;
+	if (cur == 0 || dst >= cur->par_->nlp_)
+		return (0);
+	Scheduler& s = instance();
+	if (dst == cur->id_) {
+		s.schedule_at(h, e, t);
+		return (1);
+	}
+	ParallelScheduler* par = cur->par_;
+	ParallelMsg m;
+	m.handler_ = h;
+	m.event_ = e;
+	m.time_ = t;
+	m.stime_ = s.clock();
+	m.uid_ = s.nextuid();
+	if (!cur->buffer_) {
+		// outside a window the other partitions are stopped
+		put(par->lp_[dst]->sched_, m);
+		return (1);
+	}
+	if (t < par->end_) {
+		fprintf(stderr, "Scheduler/Parallel: partition %d sends to "
+			"partition %d for %f, before the end of the window "
+			"at %f; a link between them is shorter than "
+			"lookahead_\n", cur->id_, dst, t, par->end_);
+		abort();
+	}
+	cur->out_[par->half_][dst].push_back(m);
+	if (t < cur->outmin_[par->half_][dst])
+		cur->outmin_[par->half_][dst] = t;
+	return (1);
+}
+
+/*
+ * Queue a message with the sender's stime and uid, so that it goes
+ * where it would have gone had the sender scheduled it itself.
+ */
+void
+ParallelScheduler::put(CalendarScheduler* s, const ParallelMsg& m)
+{
+	Event* e = m.event_;
+	e->handler_ = m.handler_;
+	e->time_ = m.time_;
+	e->stime_ = m.stime_;
+	e->uid_ = m.uid_;
+	s->insert(e);
+}
+
+void
+ParallelScheduler::deliver(ParallelLP* lp, int half)
+{
+	for (int j = 0; j < nlp_; j++) {
+		std::vector<ParallelMsg>& v = lp_[j]->out_[half][lp->id_];
+		for (size_t i = 0; i < v.size(); i++)
+			put(lp->sched_, v[i]);
+		v.clear();
+		lp_[j]->outmin_[half][lp->id_] = HUGE_VAL;
+	}
+}
+
+/* the earliest event of a partition, queued or still in the mailboxes */
+double
+ParallelScheduler::earliest(ParallelLP* lp)
+{
+	const Event* e = lp->sched_->head();
+	double t = e ? e->time_ : HUGE_VAL;
+	for (int j = 0; j < nlp_; j++)
+		if (lp_[j]->outmin_[half_][lp->id_] < t)
+			t = lp_[j]->outmin_[half_][lp->id_];
+	return (t);
+}
+
+void
+ParallelScheduler::buffer(Tcl_Channel ch, const char* s, int n)
+{
+	ParallelLP* lp = current_;
+	ParallelTraceRec r;
+	r.time_ = lp->sched_->clock();
+	r.stime_ = lp->stime_;
+	r.uid_ = lp->evuid_;
+	r.channel_ = ch;
+	r.off_ = lp->tbuf_.size();
+	r.len_ = n;
+	lp->tbuf_.insert(lp->tbuf_.end(), s, s + n);
+	lp->trec_.push_back(r);
+}
+
+/*
+ * Write the window's trace lines in the order of the events that wrote
+ * them, which is the order of the sequential run.
+ */
+void
+ParallelScheduler::flush()
+{
+	size_t pos[PAR_MAXLP];
+	int i;
+
+	for (i = 1; i < nlp_; i++)
+		pos[i] = 0;
+	for (;;) {
+		int k = 0;
+		for (i = 1; i < nlp_; i++) {
+			if (pos[i] < lp_[i]->trec_.size() &&
+			    (k == 0 || earlier(lp_[i]->trec_[pos[i]],
+					       lp_[k]->trec_[pos[k]])))
+				k = i;
+		}
+		if (k == 0)
+			break;
+		ParallelTraceRec& r = lp_[k]->trec_[pos[k]++];
+		(void)Tcl_Write(r.channel_, &lp_[k]->tbuf_[r.off_], r.len_);
+	}
+	for (i = 1; i < nlp_; i++) {
+		lp_[i]->tbuf_.clear();
+		lp_[i]->trec_.clear();
+	}
+}
+
+void
+LPScheduler::runto(double end)
+{
+	const Event* h;
+	while ((h = head()) != 0 && h->time_ < end)
+		runone();
+}
+
+void
+LPScheduler::runone()
+{
+	Event* e = deque();
+	lp_->stime_ = e->stime_;
+	lp_->evuid_ = e->uid_;
+	lp_->events_++;
+	dispatch(e, e->time_);
+}
+
+/* run the partitions that fall to a thread in the current window */
+void
+ParallelScheduler::runlps(int w)
+{
+	for (int k = 1 + w; k < nlp_; k += nthreads_) {
+		ParallelLP* lp = lp_[k];
+		enter(lp);
+		deliver(lp, inhalf_);
+		lp->buffer_ = 1;
+		((LPScheduler*)lp->sched_)->runto(end_);
+		lp->buffer_ = 0;
+		leave(lp);
+	}
+}
+
+void*
+ParallelScheduler::worker(void* arg)
+{
+	ParallelWorker* w = (ParallelWorker*)arg;
+	ParallelScheduler* par = w->par_;
+
+	for (;;) {
+		pthread_barrier_wait(&par->start_);
+		if (par->quit_)
+			break;
+		par->runlps(w->id_);
+		pthread_barrier_wait(&par->done_);
+	}
+	delete w;
+	return (0);
+}
+
+void
+ParallelScheduler::startthreads()
+{
+	nthreads_ = threads_ < nlp_ - 1 ? threads_ : nlp_ - 1;
+	if (nthreads_ < 2) {
+		nthreads_ = 1;
+		return;
+	}
+	quit_ = 0;
+	pthread_barrier_init(&start_, 0, nthreads_);
+	pthread_barrier_init(&done_, 0, nthreads_);
+	for (int i = 1; i < nthreads_; i++) {
+		ParallelWorker* w = new ParallelWorker;
+		w->par_ = this;
+		w->id_ = i;
+		if (pthread_create(&tid_[i], 0, worker, w) != 0) {
+			fprintf(stderr, "Scheduler/Parallel: can't start "
+				"thread %d\n", i);
+			abort();
+		}
+	}
+	workers_ = nthreads_ - 1;
+}
+
+void
+ParallelScheduler::stopthreads()
+{
+	if (nthreads_ < 2)
+		return;
+	quit_ = 1;
+	pthread_barrier_wait(&start_);
+	for (int i = 1; i < nthreads_; i++)
+		pthread_join(tid_[i], 0);
+	pthread_barrier_destroy(&start_);
+	pthread_barrier_destroy(&done_);
+	nthreads_ = 1;
+	workers_ = 0;
+}
+
+/*
+ * Run every partition but 0 up to (not including) end.  Messages
+ * posted in the window go to the other half of the outboxes, so each
+ * partition can take its own mail while the others post.
+ */
+void
+ParallelScheduler::window(double end)
+{
+	end_ = end;
+	inhalf_ = half_;
+	half_ ^= 1;
+	leave(lp_[0]);
+	if (nthreads_ > 1) {
+		pthread_barrier_wait(&start_);
+		runlps(0);
+		pthread_barrier_wait(&done_);
+	} else
+		runlps(0);
+	enter(lp_[0]);
+	flush();
+	windows_++;
+}
+
+void
+ParallelScheduler::run()
+{
+	if (nlp_ == 0) {
+		CalendarScheduler::run();
+		return;
+	}
+	if (nlp_ > 1 && threads_ > 0 && lookahead_ <= 0) {
+		fprintf(stderr, "Scheduler/Parallel: lookahead_ must be "
+			"positive\n");
+		abort();
+	}
+	enter(lp_[0]);
+	if (threads_ == 0) {
+		serial(HUGE_VAL);
+		return;
+	}
+	startthreads();
+	while (!halted_) {
+		deliver(lp_[0], half_);
+		const Event* e = head();
+		double t0 = e ? e->time_ : HUGE_VAL;
+		double tmin = HUGE_VAL;
+		for (int k = 1; k < nlp_; k++) {
+			double t = earliest(lp_[k]);
+			if (t < tmin)
+				tmin = t;
+		}
+		if (t0 == HUGE_VAL && tmin == HUGE_VAL)
+			break;
+		if (t0 <= tmin) {
+			for (int k = 1; k < nlp_; k++)
+				deliver(lp_[k], half_);
+			serial(t0);
+		} else
+			window(t0 < tmin + lookahead_ ? t0 : tmin + lookahead_);
+	}
+	stopthreads();
+}
+
+/*
+ * Run the earliest event of all partitions, one at a time, each in its
+ * own partition, until there is none left at or before end.  This is
+ * the whole of the sequential run (threads_ 0); with windows, it runs
+ * the instants that partition 0 has events at.
+ */
+void
+ParallelScheduler::serial(double end)
+{
+	ParallelLP* cur = lp_[0];
+
+	while (!halted_) {
+		const Event* best = 0;
+		ParallelLP* lp = 0;
+		for (int k = 0; k < nlp_; k++) {
+			const Event* e = lp_[k]->sched_->head();
+			if (e != 0 && e->time_ <= end &&
+			    (best == 0 || earlier(*e, *best))) {
+				best = e;
+				lp = lp_[k];
+			}
+		}
+		if (lp == 0)
+			break;
+		if (lp != cur) {
+			leave(cur);
+			enter(lp);
+			cur = lp;
+		}
+		serial_++;
+		if (lp->id_ == 0) {
+			Event* p = deque();
+			dispatch(p, p->time_);
+		} else
+			((LPScheduler*)lp->sched_)->runone();
+	}
+	if (cur != lp_[0]) {
+		leave(cur);
+		enter(lp_[0]);
+	}
+}
+
+/*
+ * Only partition 0 calls this, from the main thread while the others
+ * are stopped, so it may take an event out of any queue.
+ */
+void
+ParallelScheduler::cancel(Event* e)
+{
+	if (e->uid_ <= 0)
+		return;
+	int k = nlp_ ? owner(e) : 0;
+	if (k == 0)
+		CalendarScheduler::cancel(e);
+	else
+		lp_[k]->sched_->CalendarScheduler::cancel(e);
+}
+
+/*
+ * A partition may cancel a timer that partition 0 set for one of its
+ * objects, e.g. when Tcl started the agent; partition 0's queue is
+ * shared by all threads of the window, hence the lock.
+ */
+void
+LPScheduler::cancel(Event* e)
+{
+	if (e->uid_ <= 0)
+		return;
+	int k = par_->owner(e);
+	if (k == lp_->id_)
+		CalendarScheduler::cancel(e);
+	else if (k == 0) {
+		pthread_mutex_lock(&par_->lock0_);
+		par_->CalendarScheduler::cancel(e);
+		pthread_mutex_unlock(&par_->lock0_);
+	} else {
+		fprintf(stderr, "Scheduler/Parallel: partition %d cancels an "
+			"event of partition %d at %f\n", lp_->id_, k, clock_);
+		abort();
+	}
+}
+
+#endif /* NS_PARALLEL */
@@ -0,0 +1,214 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * parallel.h
+ *
+ * Scheduler/Parallel: a conservative parallel scheduler for wired
+ * topologies, partitioned by link delay.
+ *
+ * The nodes are split into partitions ("$ns partition", see
+ * tcl/lib/ns-parallel.tcl), each with its own calendar queue.  Packets
+ * only cross from one partition to another over a DelayLink, which
+ * posts them to the far partition's mailbox instead of scheduling
+ * them, so no event of a partition can be caused by another partition
+ * sooner than the smallest delay of the links between them, the
+ * lookahead.  The scheduler runs the partitions in windows: every
+ * partition executes its events up to the earliest pending time plus
+ * the lookahead, in a thread of its own, then the mailboxes are
+ * delivered and the next window starts.  A mailbox is a plain vector
+ * per sender and receiver, filled by the sender during a window and
+ * emptied by the receiver only after the barrier that ends it, so it
+ * needs neither locks nor atomic operations.
+ *
+ * Partition 0 is serial: its events run on the main thread while the
+ * other partitions are stopped.  It holds the Tcl "at" events and
+ * everything they schedule, and the nodes not assigned to another
+ * partition, so that Tcl is only ever called from the main thread.
+ * Work started from Tcl moves to the partitions as packets and timers
+ * are scheduled from inside them; a source driven only by its own
+ * timer (e.g., CBR) stays in partition 0.
+ *
+ * Each partition has its own stream of the default RNG (see
+ * RNG::local) and hands out every nth event and packet uid, so no two
+ * partitions share one.  Events due at the same time run in
+ * (stime_, uid_) order, which within a partition is uid order.
+ * threads_ 0 is the sequential run of the partitioned model: one
+ * event at a time, always the earliest of all partitions.  Windows
+ * reproduce it exactly.  Nothing in a window depends on another
+ * partition.  Mail keeps the stime_ and uid_ it was posted with.  An
+ * instant that partition 0 shares with the others is run event by
+ * event as in the sequential run.  The trace lines of a window are
+ * merged in that order too.  So for a given seed and partitioning,
+ * any number of threads gives the results of threads_ 0.
+ *
+ * That is all that is promised.  A run with several partitions is not
+ * the run of the plain calendar queue: packet uids are numbered per
+ * partition, events that fall due at the same instant are ordered by
+ * when and in which partition they were scheduled rather than by one
+ * global count, and partitions other than 0 draw from their own
+ * streams.  Traces therefore differ in uids, in the order of
+ * simultaneous events and in everything random decided outside
+ * partition 0.  Only with every node left in partition 0 are the
+ * results those of the calendar queue.
+ *
+ * Scheduler/Parallel needs a build with -DNS_PARALLEL, which
+ * "configure --enable-parallel" adds.  Otherwise only a stand-in is
+ * compiled: a calendar queue that refuses "partitions", so that
+ * sequential builds carry no partition state (Event has no stime_).
+ *
+ * C++ handlers running in a partition other than 0 must not call into
+ * Tcl, and objects shared between partitions (e.g., one flow monitor
+ * on links of two partitions) must not be used from them.  Events
+ * posted to another partition are not cancelled, as their uids are
+ * the sender's.
+ */
+
+#ifndef ns_parallel_h
+#define ns_parallel_h
+
+#include "scheduler.h"
+
+#ifdef NS_PARALLEL
+
+#include <pthread.h>
+#include <vector>
+
+#define PAR_MAXLP	64	/* partitions, including partition 0 */
+
+class RNG;
+class ParallelScheduler;
+
+struct ParallelMsg {
+	Handler* handler_;
+	Event* event_;
+	double time_;
+	double stime_;		// the sender's clock and uid
+	scheduler_uid_t uid_;
+};
+
+struct ParallelTraceRec {
+	double time_;		// with stime_ and uid_, the event's order
+	double stime_;
+	scheduler_uid_t uid_;
+	Tcl_Channel channel_;
+	int off_;
+	int len_;
+};
+
+/* the per-partition state switched in when a partition runs */
+struct ParallelLP {
+	int id_;
+	ParallelScheduler* par_;
+	CalendarScheduler* sched_;	// the ParallelScheduler for 0
+	scheduler_uid_t uid_;		// Scheduler::uid_
+	int pktuid_;			// Agent::uidcnt_
+	RNG* rng_;			// RNG::defaultrng()
+	double stime_;			// of the event being dispatched
+	scheduler_uid_t evuid_;
+	/*
+	 * Outboxes, by destination: messages posted in a window are
+	 * delivered at the start of the next one, while the window
+	 * after that posts into the other half.
+	 */
+	std::vector<ParallelMsg> out_[2][PAR_MAXLP];
+	double outmin_[2][PAR_MAXLP];
+	/* trace lines written in the current window */
+	std::vector<char> tbuf_;
+	std::vector<ParallelTraceRec> trec_;
+	int buffer_;			// in a window: buffer trace lines
+	long events_;
+};
+
+/* the queue of a partition other than 0 */
+class LPScheduler : public CalendarScheduler {
+public:
+	LPScheduler() : par_(0), lp_(0) {}
+	void cancel(Event*);
+	/* a partition cannot see what the others have due */
+	int runahead(double) { return (0); }
+	void runto(double end);
+	void runone();
+	ParallelScheduler* par_;
+	ParallelLP* lp_;
+};
+
+class ParallelScheduler : public CalendarScheduler {
+	friend class LPScheduler;
+public:
+	ParallelScheduler();
+	void run();
+	void cancel(Event*);
+	int runahead(double t) {	/* see LPScheduler */
+		return (nlp_ == 0 ? CalendarScheduler::runahead(t) : 0);
+	}
+
+	/* the partition the calling thread is running, or 0 */
+	static inline ParallelLP* current() { return current_; }
+	/* hand e to partition lp at time t; false if not running */
+	static int post(int lp, Handler* h, Event* e, double t);
+	/* keep a trace line until the end of the window */
+	static inline int buffered() { return (current_ && current_->buffer_); }
+	static void buffer(Tcl_Channel ch, const char* s, int n);
+	/* threads running windows now, besides main */
+	static inline int workers() { return workers_; }
+protected:
+	int command(int argc, const char*const* argv);
+	void partitions(int n);
+	int owner(Event* e) {
+		if (e->uid_ < base_)
+			return 0;
+		return (int)(e->uid_ % PAR_MAXLP);
+	}
+	void enter(ParallelLP* lp);
+	void leave(ParallelLP* lp);
+	static void put(CalendarScheduler* s, const ParallelMsg& m);
+	void deliver(ParallelLP* lp, int half);
+	double earliest(ParallelLP* lp);
+	void serial(double end);
+	void window(double end);
+	void runlps(int worker);
+	void flush();
+	void startthreads();
+	void stopthreads();
+	static void* worker(void* arg);
+
+	static NS_TLS ParallelLP* current_;
+	static int workers_;
+
+	int nlp_;
+	ParallelLP* lp_[PAR_MAXLP];
+	scheduler_uid_t base_;	// uids below this were issued before run
+	int half_;		// outbox half being posted to
+	int inhalf_;		// and the one delivered in this window
+	double end_;		// end of the current window
+	double lookahead_;
+	int threads_;
+	int nthreads_;		// threads running windows, with main
+	int quit_;
+	pthread_t tid_[PAR_MAXLP];
+	pthread_barrier_t start_, done_;
+	pthread_mutex_t lock0_;	// partition 0's queue, for cancels
+	long windows_;
+	long serial_;
+};
+
+#else /* NS_PARALLEL */
+
+struct ParallelLP;
+
+class ParallelScheduler : public CalendarScheduler {
+public:
+	ParallelScheduler();
+	static inline ParallelLP* current() { return (0); }
+	static inline int post(int, Handler*, Event*, double) { return (0); }
+	static inline int buffered() { return (0); }
+	static inline void buffer(Tcl_Channel, const char*, int) {}
+	static inline int workers() { return (0); }
+protected:
+	int command(int argc, const char*const* argv);
+	double lookahead_;
+	int threads_;
+};
+
+#endif /* NS_PARALLEL */
+
+#endif /* ns_parallel_h */
@@ -0,0 +1,222 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * profiler.cc
+ *
+ * Per-Handler event counts and time histograms; see profiler.h.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+#include "profiler.h"
+
+SchedProfiler::SchedProfiler(int every) :
+	lasttype_(0), lastclass_(0), every_(every > 0 ? every : 1),
+	countdown_(every_), vstart_(-1), vend_(0), tstart_(0), nstart_(0),
+	ticks_(0), ns_(0), running_(0)
+{
+}
+
+SchedProfiler::~SchedProfiler()
+{
+	for (size_t i = 0; i < classes_.size(); i++)
+		delete classes_[i];
+}
+
+double SchedProfiler::nanoseconds()
+{
+#ifndef WIN32
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (tv.tv_sec * 1e9 + tv.tv_usec * 1e3);
+#else
+	return (0);
+#endif
+}
+
+ProfileClass* SchedProfiler::find(const std::type_info* t)
+{
+	std::map<const std::type_info*, ProfileClass*>::iterator i;
+	i = index_.find(t);
+	ProfileClass* c;
+	if (i != index_.end())
+		c = i->second;
+	else {
+		c = new ProfileClass;
+		const char* name = t->name();
+#ifdef __GNUC__
+		int status;
+		char* s = abi::__cxa_demangle(name, 0, 0, &status);
+		if (s != 0) {
+			c->name_ = s;
+			free(s);
+		} else
+#endif
+			c->name_ = name;
+		c->events_ = c->ticks_ = c->maxticks_ = 0;
+		c->last_ = -1;
+		memset(c->tickhist_, 0, sizeof(c->tickhist_));
+		memset(c->gaphist_, 0, sizeof(c->gaphist_));
+		classes_.push_back(c);
+		index_[t] = c;
+	}
+	lasttype_ = t;
+	lastclass_ = c;
+	return (c);
+}
+
+void SchedProfiler::sample(double now, int depth)
+{
+	if ((int)sampletime_.size() >= PROF_MAXSAMPLES) {
+		size_t n = 0;
+		for (size_t i = 0; i < sampletime_.size(); i += 2) {
+			sampletime_[n] = sampletime_[i];
+			sampledepth_[n++] = sampledepth_[i];
+		}
+		sampletime_.resize(n);
+		sampledepth_.resize(n);
+		every_ *= 2;
+	}
+	sampletime_.push_back(now);
+	sampledepth_.push_back(depth);
+	countdown_ = every_;
+}
+
+void SchedProfiler::start(double now)
+{
+	if (vstart_ < 0)
+		vstart_ = now;
+	tstart_ = ticks();
+	nstart_ = nanoseconds();
+	running_ = 1;
+}
+
+void SchedProfiler::stop(double now)
+{
+	if (!running_)
+		return;
+	ticks_ += ticks() - tstart_;
+	ns_ += nanoseconds() - nstart_;
+	vend_ = now;
+	running_ = 0;
+}
+
+static bool byticks(const ProfileClass* a, const ProfileClass* b)
+{
+	return (a->ticks_ > b->ticks_);
+}
+
+static void append(std::string& s, const char* fmt, ...)
+{
+	char buf[512];
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+	s += buf;
+}
+
+static void appendhist(std::string& s, const double* h)
+{
+	int n = PROF_BINS;
+	while (n > 0 && h[n - 1] == 0)
+		n--;
+	s += "[";
+	for (int b = 0; b < n; b++)
+		append(s, b > 0 ? ", %.0f" : "%.0f", h[b]);
+	s += "]";
+}
+
+static void appendjson(std::string& s, const std::string& str)
+{
+	s += '"';
+	for (size_t i = 0; i < str.size(); i++) {
+		if (str[i] == '"' || str[i] == '\\')
+			s += '\\';
+		s += str[i];
+	}
+	s += '"';
+}
+
+void SchedProfiler::report(std::string& s, int json, double now)
+{
+	double total = ticks_, ns = ns_, vend = vend_;
+	if (running_) {
+		total += ticks() - tstart_;
+		ns += nanoseconds() - nstart_;
+		vend = now;
+	}
+	std::vector<ProfileClass*> c(classes_);
+	std::sort(c.begin(), c.end(), byticks);
+	double events = 0, handled = 0;
+	for (size_t i = 0; i < c.size(); i++) {
+		events += c[i]->events_;
+		handled += c[i]->ticks_;
+	}
+	double persec = ns > 0 ? total / ns * 1e9 : 0;
+	double depthsum = 0;
+	int depthmax = 0;
+	for (size_t i = 0; i < sampledepth_.size(); i++) {
+		depthsum += sampledepth_[i];
+		if (sampledepth_[i] > depthmax)
+			depthmax = sampledepth_[i];
+	}
+	double vstart = vstart_ < 0 ? 0 : vstart_;
+#ifdef PROF_RDTSC
+	const char* unit = "cycles";
+#else
+	const char* unit = "ns";
+#endif
+	if (!json) {
+		append(s, "# %.0f events, %.9g s of virtual time, %.6f s of "
+		       "wall time, %.1f%% in handlers (%.4g %s/s)\n",
+		       events, vend - vstart, ns * 1e-9,
+		       total > 0 ? 100 * handled / total : 0, persec, unit);
+		append(s, "# class events %%events %s %%%s %s/event max\n",
+		       unit, unit, unit);
+		for (size_t i = 0; i < c.size(); i++) {
+			const ProfileClass* p = c[i];
+			append(s, "%s %.0f %.2f %.0f %.2f %.1f %.0f\n",
+			       p->name_.c_str(), p->events_,
+			       100 * p->events_ / events, p->ticks_,
+			       total > 0 ? 100 * p->ticks_ / total : 0,
+			       p->ticks_ / p->events_, p->maxticks_);
+		}
+		append(s, "# pending events: %d samples, mean %.1f, max %d\n",
+		       (int)sampledepth_.size(), sampledepth_.empty() ? 0 :
+		       depthsum / sampledepth_.size(), depthmax);
+		return;
+	}
+	append(s, "{\"events\": %.0f, \"virtual_start\": %.17g, "
+	       "\"virtual_end\": %.17g, \"wall_seconds\": %.9f, "
+	       "\"tick_unit\": \"%s\", \"ticks\": %.0f, \"handler_ticks\": "
+	       "%.0f, \"ticks_per_second\": %.6g,\n \"classes\": [",
+	       events, vstart, vend, ns * 1e-9, unit, total, handled,
+	       persec);
+	for (size_t i = 0; i < c.size(); i++) {
+		const ProfileClass* p = c[i];
+		s += i > 0 ? ",\n  {\"name\": " : "\n  {\"name\": ";
+		appendjson(s, p->name_);
+		append(s, ", \"events\": %.0f, \"ticks\": %.0f, "
+		       "\"max_ticks\": %.0f,\n   \"ticks_log2_histogram\": ",
+		       p->events_, p->ticks_, p->maxticks_);
+		appendhist(s, p->tickhist_);
+		s += ",\n   \"gap_ns_log2_histogram\": ";
+		appendhist(s, p->gaphist_);
+		s += "}";
+	}
+	append(s, "],\n \"pending\": {\"every\": %d, \"samples\": [", every_);
+	for (size_t i = 0; i < sampletime_.size(); i++)
+		append(s, i > 0 ? ", [%.9g, %d]" : "[%.9g, %d]",
+		       sampletime_[i], sampledepth_[i]);
+	s += "]}}\n";
+}
@@ -0,0 +1,119 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * profiler.h
+ *
+ * Where the event loop goes, by Handler class.
+ *
+ * With "$ns profile on", Scheduler::run dispatches through a second
+ * loop that charges each event to the C++ class of its handler: the
+ * number of events, the time spent in handle() (in cycles of the time
+ * stamp counter on x86, nanoseconds elsewhere) with a log2 histogram,
+ * and a log2 histogram, in nanoseconds, of the virtual time between
+ * two events of the class.  The number of pending events is sampled
+ * every every_ events, at most PROF_MAXSAMPLES times (every_ doubles
+ * when the samples fill up).  When profiling is off, run() takes its
+ * usual loop and nothing is counted.
+ *
+ *	$ns profile on
+ *	$ns run
+ *	...
+ *	puts [$ns profile-report]	;# or "profile-report json"
+ */
+
+#ifndef ns_profiler_h
+#define ns_profiler_h
+
+#include <math.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <typeinfo>
+
+#include "scheduler.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PROF_RDTSC
+#endif
+
+#define PROF_BINS	48
+#define PROF_MAXSAMPLES	4096
+
+struct ProfileClass {
+	std::string name_;
+	double events_;
+	double ticks_;		// in handle()
+	double maxticks_;
+	double last_;		// virtual time of the last event, or -1
+	double tickhist_[PROF_BINS];	// bin b: [2^(b-1), 2^b) ticks
+	double gaphist_[PROF_BINS];	// bin b: [2^(b-1), 2^b) ns, 0: less
+};
+
+class SchedProfiler {
+public:
+	SchedProfiler(int every);
+	~SchedProfiler();
+	static inline double ticks() {
+#ifdef PROF_RDTSC
+		unsigned int lo, hi;
+		__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+		return (hi * 4294967296.0 + lo);
+#else
+		return (nanoseconds());
+#endif
+	}
+	ProfileClass* lookup(Handler* h, double now) {
+		const std::type_info* t = &typeid(*h);
+		ProfileClass* c;
+		if (t == lasttype_)
+			c = lastclass_;
+		else
+			c = find(t);
+		c->events_++;
+		if (c->last_ >= 0)
+			c->gaphist_[bin((now - c->last_) * 1e9)]++;
+		c->last_ = now;
+		return (c);
+	}
+	void charge(ProfileClass* c, double d) {
+		c->ticks_ += d;
+		if (d > c->maxticks_)
+			c->maxticks_ = d;
+		c->tickhist_[bin(d)]++;
+	}
+	int sampledue() {
+		return (--countdown_ <= 0);
+	}
+	void sample(double now, int depth);
+	void start(double now);
+	void stop(double now);
+	void report(std::string& s, int json, double now);
+protected:
+	static double nanoseconds();
+	static int bin(double x) {
+		if (x < 1)
+			return (0);
+		int b;
+		frexp(x, &b);
+		return (b < PROF_BINS ? b : PROF_BINS - 1);
+	}
+	ProfileClass* find(const std::type_info* t);
+
+	std::map<const std::type_info*, ProfileClass*> index_;
+	std::vector<ProfileClass*> classes_;
+	const std::type_info* lasttype_;
+	ProfileClass* lastclass_;
+
+	int every_;
+	int countdown_;
+	std::vector<double> sampletime_;
+	std::vector<int> sampledepth_;
+
+	double vstart_, vend_;	// virtual time profiled
+	double tstart_;		// ticks() and nanoseconds() at start()
+	double nstart_;
+	double ticks_;		// totals over the profiled runs
+	double ns_;
+	int running_;
+};
+
+#endif
@@ -0,0 +1,241 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * replicate.cc
+ *
+ * Independent replications of one simulation from a single setup.
+ *
+ * "ns-replicate n jobs" (Simulator replicate) forks n copies of the
+ * process, at most jobs at a time (the number of processors if jobs is
+ * 0), and returns 0 .. n-1 in each copy; the topology, routes and
+ * packet format built so far are shared copy-on-write rather than built
+ * again n times.  A copy sends its results to the parent with
+ * "ns-replicate stat name value" and exits as usual at the end of its
+ * run.  The parent returns -1 once every copy has exited, and
+ * "ns-replicate results" then gives {index status {name value ...}}
+ * for each replication, status being the exit code, or 128 plus the
+ * signal that killed it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "config.h"
+
+#ifndef WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#endif
+
+struct Replica {
+	int index_;
+	int pid_;
+	int fd_;		// read end of its pipe, or -1 at EOF
+	int status_;
+	std::vector<char> data_;	// Tcl list of name value pairs
+};
+
+static std::vector<Replica> replicas;
+static int repl_fd = -1;	// write end of the pipe, in a copy
+
+#ifndef WIN32
+
+static int finish(Replica& r)
+{
+	int st;
+	while (waitpid(r.pid_, &st, 0) < 0)
+		if (errno != EINTR)
+			return (-1);
+	if (WIFEXITED(st))
+		r.status_ = WEXITSTATUS(st);
+	else if (WIFSIGNALED(st))
+		r.status_ = 128 + WTERMSIG(st);
+	return (0);
+}
+
+/*
+ * Fork n copies, jobs at a time.  Returns the index in a copy and -1 in
+ * the parent when all have exited, or -2 with err set.
+ */
+static int replicate(int n, int jobs, const char** err)
+{
+	if (jobs <= 0) {
+		long c = sysconf(_SC_NPROCESSORS_ONLN);
+		jobs = c > 0 ? int(c) : 1;
+	}
+	replicas.clear();
+	replicas.resize(n);
+	std::vector<struct pollfd> pfd;
+	std::vector<int> slot;
+	int next = 0, running = 0;
+	fflush(NULL);
+	while (next < n || running > 0) {
+		while (next < n && running < jobs) {
+			Replica& r = replicas[next];
+			int p[2];
+			if (pipe(p) < 0) {
+				*err = strerror(errno);
+				return (-2);
+			}
+			r.index_ = next;
+			r.fd_ = -1;
+			r.status_ = -1;
+			r.pid_ = fork();
+			if (r.pid_ < 0) {
+				*err = strerror(errno);
+				close(p[0]);
+				close(p[1]);
+				return (-2);
+			}
+			if (r.pid_ == 0) {
+				for (int i = 0; i < next; i++)
+					if (replicas[i].fd_ >= 0)
+						close(replicas[i].fd_);
+				close(p[0]);
+				repl_fd = p[1];
+				replicas.clear();
+				return (next);
+			}
+			close(p[1]);
+			r.fd_ = p[0];
+			next++;
+			running++;
+		}
+		pfd.clear();
+		slot.clear();
+		for (int i = 0; i < next; i++) {
+			if (replicas[i].fd_ < 0)
+				continue;
+			struct pollfd f;
+			f.fd = replicas[i].fd_;
+			f.events = POLLIN;
+			f.revents = 0;
+			pfd.push_back(f);
+			slot.push_back(i);
+		}
+		if (poll(&pfd[0], pfd.size(), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			*err = strerror(errno);
+			return (-2);
+		}
+		for (size_t k = 0; k < pfd.size(); k++) {
+			if (pfd[k].revents == 0)
+				continue;
+			Replica& r = replicas[slot[k]];
+			char buf[4096];
+			ssize_t m = read(r.fd_, buf, sizeof(buf));
+			if (m < 0 && errno == EINTR)
+				continue;
+			if (m > 0) {
+				r.data_.insert(r.data_.end(), buf, buf + m);
+				continue;
+			}
+			close(r.fd_);
+			r.fd_ = -1;
+			if (finish(r) < 0) {
+				*err = strerror(errno);
+				return (-2);
+			}
+			running--;
+		}
+	}
+	return (-1);
+}
+
+static int send(const char* s, size_t len)
+{
+	while (len > 0) {
+		ssize_t m = write(repl_fd, s, len);
+		if (m < 0) {
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+		s += m;
+		len -= m;
+	}
+	return (0);
+}
+
+#endif /* !WIN32 */
+
+class ReplicateCommand : public TclCommand {
+public:
+	ReplicateCommand() : TclCommand("ns-replicate") {}
+	virtual int command(int argc, const char*const* argv);
+};
+
+int ReplicateCommand::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2 && strcmp(argv[1], "results") == 0) {
+		Tcl_DString ds;
+		Tcl_DStringInit(&ds);
+		for (size_t i = 0; i < replicas.size(); i++) {
+			Replica& r = replicas[i];
+			char num[32];
+			Tcl_DStringStartSublist(&ds);
+			sprintf(num, "%d", r.index_);
+			Tcl_DStringAppendElement(&ds, num);
+			sprintf(num, "%d", r.status_);
+			Tcl_DStringAppendElement(&ds, num);
+			r.data_.push_back('\0');
+			Tcl_DStringAppendElement(&ds, &r.data_[0]);
+			r.data_.pop_back();
+			Tcl_DStringEndSublist(&ds);
+		}
+		Tcl_DStringResult(tcl.interp(), &ds);
+		return (TCL_OK);
+	}
+#ifndef WIN32
+	if (argc == 3) {
+		int n = atoi(argv[1]);
+		if (n <= 0) {
+			tcl.add_error("ns-replicate: the number of "
+				      "replications must be positive");
+			return (TCL_ERROR);
+		}
+		const char* err = 0;
+		int r = replicate(n, atoi(argv[2]), &err);
+		if (r < -1) {
+			tcl.resultf("ns-replicate: %s", err);
+			return (TCL_ERROR);
+		}
+		tcl.resultf("%d", r);
+		return (TCL_OK);
+	}
+	if (argc == 4 && strcmp(argv[1], "stat") == 0) {
+		if (repl_fd < 0)
+			return (TCL_OK);
+		const char* pair[2] = { argv[2], argv[3] };
+		char* s = Tcl_Merge(2, pair);
+		int r = send(s, strlen(s));
+		if (r == 0)
+			r = send("\n", 1);
+		Tcl_Free(s);
+		if (r < 0) {
+			tcl.resultf("ns-replicate: %s", strerror(errno));
+			return (TCL_ERROR);
+		}
+		return (TCL_OK);
+	}
+#else
+	if (argc == 3) {
+		tcl.resultf("ns-replicate: replications are not supported here");
+		return (TCL_ERROR);
+	}
+	if (argc == 4 && strcmp(argv[1], "stat") == 0)
+		return (TCL_OK);
+#endif
+	tcl.add_error("usage: ns-replicate n jobs | stat name value | results");
+	return (TCL_ERROR);
+}
+
+void init_replicate()
+{
+	(void)new ReplicateCommand;
+}
@@ -55,6 +55,7 @@ public:
 	Event* lookup(scheduler_uid_t uid);
 	Event* deque();
 	const Event *head() { return *EventQueue_.begin(); }
+	int size() { return (EventQueue_.size()); }
 private:
 	struct event_less_adapter {
 		bool operator()(const Event *e1, const Event *e2) const
@@ -46,25 +46,29 @@ static const char rcsid[] =
 #include "config.h"
 #include "scheduler.h"
 #include "packet.h"
+#include "profiler.h"
 
 
 #ifdef MEMDEBUG_SIMULATIONS
 #include "mem-trace.h"
 #endif
 
-Scheduler* Scheduler::instance_;
-scheduler_uid_t Scheduler::uid_ = 1;
+NS_TLS Scheduler* Scheduler::instance_;
+NS_TLS scheduler_uid_t Scheduler::uid_ = 1;
+NS_TLS int Scheduler::uidstep_ = 1;
 
 // class AtEvent : public Event {
 // public:
 // 	char* proc_;
 // };
 
-Scheduler::Scheduler() : clock_(SCHED_START), halted_(0)
+Scheduler::Scheduler() : clock_(SCHED_START), halted_(0), profiler_(0),
+	profiling_(0), profgen_(0)
 {
 }
 
 Scheduler::~Scheduler(){
+	delete profiler_;
 	instance_ = NULL ;
 }
 
@@ -81,6 +85,41 @@ Scheduler::~Scheduler(){
  */
 void 
 Scheduler::schedule(Handler* h, Event* e, double delay)
+{
+	if (delay < 0) {
+		// You probably don't want to do this
+		// (it probably represents a bug in your simulation).
+		fprintf(stderr, 
+			"warning: ns Scheduler::schedule: scheduling event\n\t"
+			"with negative delay (%f) at time %f.\n", delay, clock_);
+	}
+	schedule_at(h, e, clock_ + delay);
+}
+
+/*
+ * Schedule an event at an absolute time.  This is for handlers that
+ * work out when an event is due before they schedule it (e.g., a
+ * LinkDelay sending a packet train): turning that time back into a
+ * delay relative to clock_ would not reproduce it bit for bit.
+ */
+void
+Scheduler::schedule_at(Handler* h, Event* e, double t)
+{
+	schedule_at(h, e, t, nextuid(), clock_);
+}
+
+/*
+ * The same with a uid reserved earlier by nextuid(), at clock() stime.
+ * Events due at the same time are dispatched in uid order, so the
+ * event takes the place among them that it would have had if it had
+ * been scheduled when the uid was reserved: a handler that defers
+ * placing its event can still reproduce the order of eager scheduling.
+ * (Scheduler/Parallel orders ties by stime first, as its partitions'
+ * uids do not follow one another; see common/parallel.h.)
+ */
+void
+Scheduler::schedule_at(Handler* h, Event* e, double t, scheduler_uid_t uid,
+		       double stime)
 {
 	// handler should ALWAYS be set... if it's not, it's a bug in the caller
 	if (!h) {
@@ -94,32 +133,49 @@ Scheduler::schedule(Handler* h, Event* e, double delay)
 		printf("Scheduler: Event UID not valid!\n\n");
 		abort();
 	}
-	
-	if (delay < 0) {
-		// You probably don't want to do this
-		// (it probably represents a bug in your simulation).
-		fprintf(stderr, 
-			"warning: ns Scheduler::schedule: scheduling event\n\t"
-			"with negative delay (%f) at time %f.\n", delay, clock_);
-	}
 
-	if (uid_ < 0) {
-		fprintf(stderr, "Scheduler: UID space exhausted!\n");
-		abort();
-	}
-	e->uid_ = uid_++;
+	e->uid_ = uid;
+#ifdef NS_PARALLEL
+	e->stime_ = stime;
+#endif
 	e->handler_ = h;
-	double t = clock_ + delay;
-
 	e->time_ = t;
 	insert(e);
 }
 
+/*
+ * Move the clock on to t for a handler that goes on from its own
+ * event to work of its own due then (a packet train), if no queued
+ * event is due at or before t, as the scheduler would otherwise have
+ * run that first.  Returns 0, leaving the clock, if one is.
+ */
+int
+Scheduler::runahead(double t)
+{
+	const Event* h = head();
+
+	if (t < clock_ || (h != 0 && h->time_ <= t))
+		return (0);
+	clock_ = t;
+	return (1);
+}
+
+void
+Scheduler::uidexhausted()
+{
+	fprintf(stderr, "Scheduler: UID space exhausted!\n");
+	abort();
+}
+
 void
 Scheduler::run()
 {
 	instance_ = this;
 	Event *p;
+	if (profiling_) {
+		runprofiled();
+		return;
+	}
 	/*
 	 * The order is significant: if halted_ is checked later,
 	 * event p could be lost when the simulator resumes.
@@ -130,6 +186,36 @@ Scheduler::run()
 	}
 }
 
+/*
+ * run() with each event charged to its handler's class.  An event
+ * that runs "$ns profile ..." ends the loop (prof may be gone), and
+ * the run resumes as that left profiling.
+ */
+void
+Scheduler::runprofiled()
+{
+	SchedProfiler* prof = profiler_;
+	int gen = profgen_;
+	Event *p;
+	prof->start(clock_);
+	while (!halted_ && (p = deque())) {
+		ProfileClass* c = prof->lookup(p->handler_, p->time_);
+		double t = SchedProfiler::ticks();
+		dispatch(p, p->time_);
+		if (profgen_ != gen)
+			break;
+		prof->charge(c, SchedProfiler::ticks() - t);
+		if (prof->sampledue())
+			prof->sample(clock_, size());
+	}
+	if (profgen_ == gen)
+		prof->stop(clock_);
+	else if (halted_ && profiler_ != 0)
+		profiler_->stop(clock_);
+	if (!halted_ && profgen_ != gen)
+		run();
+}
+
 /*
  * dispatch a single simulator event by setting the system
  * virtul clock to the event's timestamp and calling its handler.
@@ -208,6 +294,12 @@ Scheduler::command(int argc, const char*const* argv)
 		} else if (strcmp(argv[1], "halt") == 0) {
 			halted_ = 1;
 			return (TCL_OK);
+		} else if (strcmp(argv[1], "profile-report") == 0) {
+			std::string s;
+			if (profiler_ != 0)
+				profiler_->report(s, 0, clock_);
+			Tcl_SetResult(tcl.interp(), (char*)s.c_str(), TCL_VOLATILE);
+			return (TCL_OK);
 
 		} else if (strcmp(argv[1], "clearMemTrace") == 0) {
 #ifdef MEMDEBUG_SIMULATIONS
@@ -228,7 +320,35 @@ Scheduler::command(int argc, const char*const* argv)
 			dumpq();
 			return (TCL_OK);
 		}
-	} else if (argc == 3) {
+	} else if (argc == 3 || argc == 4) {
+		if (strcmp(argv[1], "profile") == 0) {
+			/* profile on|off|reset ?every? */
+			profgen_++;	// see runprofiled()
+			if (strcmp(argv[2], "reset") == 0) {
+				delete profiler_;
+				profiler_ = 0;
+				profiling_ = 0;
+				return (TCL_OK);
+			}
+			profiling_ = strcmp(argv[2], "on") == 0 ||
+				strcmp(argv[2], "1") == 0;
+			if (profiling_ && profiler_ == 0)
+				profiler_ = new SchedProfiler(argc == 4 ?
+					atoi(argv[3]) : 1000);
+			if (!profiling_ && profiler_ != 0)
+				profiler_->stop(clock_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "profile-report") == 0 && argc == 3) {
+			std::string s;
+			if (profiler_ != 0)
+				profiler_->report(s, strcmp(argv[2], "json") == 0,
+						  clock_);
+			Tcl_SetResult(tcl.interp(), (char*)s.c_str(), TCL_VOLATILE);
+			return (TCL_OK);
+		}
+	}
+	if (argc == 3) {
 		if (strcmp(argv[1], "at") == 0 ||
 		    strcmp(argv[1], "cancel") == 0) {
 			Event* p = lookup(STRTOUID(argv[2]));
@@ -304,7 +424,8 @@ ListScheduler::insert(Event* e)
 	double t = e->time_;
 	Event** p;
 	for (p = &queue_; *p != 0; p = &(*p)->next_)
-		if (t < (*p)->time_)
+		if (t < (*p)->time_ ||
+		    (t == (*p)->time_ && e->uid_ < (*p)->uid_))
 			break;
 	e->next_ = *p;
 	*p = e;
@@ -330,6 +451,15 @@ ListScheduler::cancel(Event* e)
 	e->uid_ = - e->uid_;
 }
 
+int
+ListScheduler::size()
+{
+	int n = 0;
+	for (Event* e = queue_; e != 0; e = e->next_)
+		n++;
+	return (n);
+}
+
 Event* 
 ListScheduler::lookup(scheduler_uid_t uid)
 {
@@ -435,7 +565,7 @@ Heap::heap_delete(void* elem)
  *	h[i] := key
  */
 void
-Heap::heap_insert(heap_key_t key, void* elem) 
+Heap::heap_insert(heap_key_t key, heap_secondary_key_t skey, void* elem) 
 {
 	unsigned int	i, par;
 	if (h_maxsize == h_size) {	/* Adjust heap_size */
@@ -450,14 +580,14 @@ Heap::heap_insert(heap_key_t key, void* elem)
 	i = h_size++;
 	par = parent(i);
 	while ((i > 0) && 
-	       (KEY_LESS_THAN(key, h_s_key,
+	       (KEY_LESS_THAN(key, skey,
 			      h_elems[par].he_key, h_elems[par].he_s_key))) {
 		h_elems[i] = h_elems[par];
 		i = par;
 		par = parent(i);
 	}
 	h_elems[i].he_key  = key;
-	h_elems[i].he_s_key= h_s_key++;
+	h_elems[i].he_s_key= skey;
 	h_elems[i].he_elem = elem;
 	return;
 }
@@ -624,24 +754,30 @@ CalendarScheduler::insert(Event* e)
 		++stat_qsize_; 
 		++(current->count_);
 	} else {
+		// same-time events are kept in uid order; a new uid is the
+		// largest, so normally e goes after all of them (FIFO)
 		insert_search_++;
-		if (newtime < head->time_) {
+		if (newtime < head->time_ ||
+		    (newtime == head->time_ && before(e, head))) {
 			//  e-> head -> ...
 			e->next_ = head;
 			e->prev_ = head->prev_;
 			e->prev_->next_ = e;
 			head->prev_ = e;
 			current->list_ = e;
-                        ++stat_qsize_;
-                        ++(current->count_);
+			if (newtime < head->time_) {
+				++stat_qsize_;
+				++(current->count_);
+			}
 		} else {
-                        for (after = head->prev_; newtime < after->time_; after = after->prev_) { insert_search_++; };
+                        for (after = head->prev_; newtime < after->time_ || (newtime == after->time_ && before(e, after)); after = after->prev_) { insert_search_++; };
 			//...-> after -> e -> ...
 			e->next_ = after->next_;
 			e->prev_ = after;
 			e->next_->prev_ = e;
 			after->next_ = e;
-			if (after->time_ < newtime) {
+			if (after->time_ < newtime &&
+			    e->next_->time_ != newtime) {
 				//unique timing
 				++stat_qsize_; 
 				++(current->count_);
@@ -60,7 +60,12 @@ public:
 	Handler* handler_;	/* handler to call when event ready */
 	double time_;		/* time at which event is ready */
 	scheduler_uid_t uid_;	/* unique ID */
+#ifdef NS_PARALLEL
+	double stime_;		/* time at which uid_ was taken */
+	Event() : time_(0), uid_(0), stime_(0) {}
+#else
 	Event() : time_(0), uid_(0) {}
+#endif
 };
 
 /*
@@ -74,6 +79,8 @@ class Handler {
 	virtual void handle(Event* event) = 0;
 };
 
+class SchedProfiler;
+
 #define	SCHED_START	0.0	/* start time (secs) */
 
 class Scheduler : public TclObject {
@@ -82,6 +89,16 @@ public:
 		return (*instance_);		// general access to scheduler
 	}
 	void schedule(Handler*, Event*, double delay);	// sched later event
+	void schedule_at(Handler*, Event*, double time); // sched at abs time
+	void schedule_at(Handler*, Event*, double time, scheduler_uid_t uid,
+			 double stime);
+	scheduler_uid_t nextuid() {		// reserve a uid, see schedule_at
+		scheduler_uid_t uid = uid_;
+		if (uid < 0)
+			uidexhausted();
+		uid_ += uidstep_;
+		return (uid);
+	}
 	virtual void run();			// execute the simulator
 	virtual void cancel(Event*) = 0;	// cancel event
 	virtual void insert(Event*) = 0;	// schedule event
@@ -91,12 +108,16 @@ public:
 	double clock() const {			// simulator virtual time
 		return (clock_);
 	}
+	virtual int runahead(double t);	// see NsObject::recvtrain
 	virtual void sync() {};
 	virtual double start() {		// start time
 		return SCHED_START;
 	}
 	virtual void reset();
+	virtual int size() { return (-1); }	// pending events, if known
 protected:
+	void runprofiled();
+	static void uidexhausted();
 	void dumpq();	// for debug: remove + print remaining events
 	void dispatch(Event*);	// execute an event
 	void dispatch(Event*, double);	// exec event, set clock_
@@ -105,8 +126,12 @@ protected:
 	int command(int argc, const char*const* argv);
 	double clock_;
 	int halted_;
-	static Scheduler* instance_;
-	static scheduler_uid_t uid_;
+	SchedProfiler* profiler_;	// "$ns profile on"
+	int profiling_;
+	int profgen_;		// count of "profile" commands
+	static NS_TLS Scheduler* instance_;
+	static NS_TLS scheduler_uid_t uid_;
+	static NS_TLS int uidstep_;	/* 1, except in Scheduler/Parallel */
 };
 
 class ListScheduler : public Scheduler {
@@ -117,6 +142,7 @@ public:
 	Event* deque();
 	const Event* head() { return queue_; }
 	Event* lookup(scheduler_uid_t uid);
+	int size();
 
 protected:
 	Event* queue_;
@@ -134,11 +160,12 @@ public:
 		hp_->heap_delete((void*) e);
 	}
 	void insert(Event* e) {
-		hp_->heap_insert(e->time_, (void*) e);
+		hp_->heap_insert(e->time_, e->uid_, (void*) e);
 	}
 	Event* lookup(scheduler_uid_t uid);
 	Event* deque();
 	const Event* head() { return (const Event *)hp_->heap_min(); }
+	int size() { return (hp_->heap_size()); }
 protected:
 	Heap* hp_;
 };
@@ -152,6 +179,7 @@ public:
 	Event* lookup(scheduler_uid_t uid);
 	Event* deque();
 	const Event* head();
+	int size() { return (qsize_); }
 
 protected:
 	double min_bin_width_;		// minimum bin width for Calendar Queue
@@ -180,6 +208,19 @@ protected:
 		
 	int qsize_;
 
+	/*
+	 * The order of same-time events: by uid, taken as (stime_, uid_)
+	 * in a parallel build so that it also holds for the uids of
+	 * several partitions.
+	 */
+	static int before(const Event* a, const Event* b) {
+#ifdef NS_PARALLEL
+		return (a->stime_ < b->stime_ ||
+			(a->stime_ == b->stime_ && a->uid_ < b->uid_));
+#else
+		return (a->uid_ < b->uid_);
+#endif
+	}
 	virtual void reinit(int nbuck, double bwidth, double start);
 	virtual void resize(int newsize, double start);
 	virtual double newwidth(int newsize);
@@ -199,6 +240,7 @@ public:
 	const Event *head();
 	void cancel(Event *);
 	Event *lookup(scheduler_uid_t);
+	int size() { return (qsize_); }
 
 	//void validate() { assert(validate(root_) == qsize_); };
     
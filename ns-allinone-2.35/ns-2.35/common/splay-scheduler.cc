@@ -97,6 +97,12 @@ public:
 #define LEFT(e)				((e)->prev_)	
 #define RIGHT(e)			((e)->next_)
 
+/* n goes before e: same-time events are ordered by uid, as cancel()
+   expects; a new uid is the largest, so that is FIFO */
+#define BEFORE(n, e)			\
+	((n)->time_ < (e)->time_ || 	\
+	 ((n)->time_ == (e)->time_ && (n)->uid_ < (e)->uid_))
+
 #define ROTATE_RIGHT(t, x)		\
     do {				\
     	LEFT(t) = RIGHT(x);	 	\
@@ -133,8 +139,6 @@ SplayScheduler::insert(Event *n)
     
 	++qsize_;
 
-	double time = n->time_;
-    
 	if (root_ == 0) {
 		LEFT(n) = RIGHT(n) = 0;
 		root_ = n;
@@ -146,14 +150,14 @@ SplayScheduler::insert(Event *n)
 	l = n;
 	r = n;
 	for (;;) {
-		if (time < t->time_) {
+		if (BEFORE(n, t)) {
 			x = LEFT(t);
 			if (x == 0) {
 				LEFT(r) = t;
 				RIGHT(l) = 0;
 				break;
 			}
-			if (time < x->time_) {
+			if (BEFORE(n, x)) {
 				ROTATE_RIGHT(t, x);
 			}
 			LINK_RIGHT(r, t);
@@ -168,7 +172,7 @@ SplayScheduler::insert(Event *n)
 				LEFT(r) = 0;
 				break;	
 			}
-			if (time >= x->time_) {
+			if (!BEFORE(n, x)) {
 				ROTATE_LEFT(t, x);
 			}
 			LINK_LEFT(l, t);
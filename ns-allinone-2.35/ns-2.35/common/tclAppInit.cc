@@ -17,6 +17,9 @@
 #include "config.h"
 
 extern void init_misc(void);
+extern void init_checkpoint(void);
+extern void checkpoint_main(int& argc, char**& argv);
+extern void init_replicate(void);
 extern EmbeddedTcl et_ns_lib;
 extern EmbeddedTcl et_ns_ptypes;
 
@@ -64,6 +67,7 @@ EXTERN int		Tcltest_Init _ANSI_ARGS_((Tcl_Interp *interp));
 extern "C" int
 nslibmain(int argc, char **argv)
 {
+    checkpoint_main(argc, argv);
     Tcl_Main(argc, argv, Tcl_AppInit);
     return 0;			/* Needed only to prevent compiler warning. */
 }
@@ -257,6 +261,8 @@ Tcl_AppInit(Tcl_Interp *interp)
 	Tcl_SetVar(interp, "tcl_rcFileName", "~/.ns.tcl", TCL_GLOBAL_ONLY);
 	Tcl::init(interp, "ns");
 	init_misc();
+	init_checkpoint();
+	init_replicate();
         et_ns_ptypes.load();
 	et_ns_lib.load();
 
@@ -78,6 +78,7 @@ TimerHandler::sched(double delay)
 		abort();
 	}
 	_sched(delay);
+	deadline_ = event_.time_;
 	status_ = TIMER_PENDING;
 }
 
@@ -87,14 +88,43 @@ TimerHandler::resched(double delay)
 	if (status_ == TIMER_PENDING)
 		_cancel();
 	_sched(delay);
+	deadline_ = event_.time_;
 	status_ = TIMER_PENDING;
 }
 
+/*
+ * A retransmission timer is put off by nearly every ACK and seldom
+ * expires.  resched() costs a cancel and an insert each time; here a
+ * later deadline is only noted, and the event already scheduled, when
+ * it comes, is scheduled again for the deadline.  That uses the same
+ * absolute time and the uid reserved here, which resched() would have
+ * used, so the timer fires in the same place among same-time events.
+ */
+void
+TimerHandler::resched_lazy(double delay)
+{
+	Scheduler& s = Scheduler::instance();
+	double t = s.clock() + delay;
+	if (status_ == TIMER_PENDING && t > event_.time_) {
+		deadline_ = t;
+		deaduid_ = s.nextuid();
+		deadstime_ = s.clock();
+		return;
+	}
+	resched(delay);
+}
+
 void
 TimerHandler::handle(Event *e)
 {
 	if (status_ != TIMER_PENDING)   // sanity check
 		abort();
+	if (deadline_ > e->time_) {
+		// put off by resched_lazy()
+		Scheduler::instance().schedule_at(this, &event_, deadline_,
+						  deaduid_, deadstime_);
+		return;
+	}
 	status_ = TIMER_HANDLING;
 	expire(e);
 	// if it wasn't rescheduled, it's done
@@ -78,12 +78,17 @@
 
 class TimerHandler : public Handler {
 public:
-	TimerHandler() : status_(TIMER_IDLE) { }
+	TimerHandler() : status_(TIMER_IDLE), deadline_(0), deaduid_(0),
+		deadstime_(0) { }
 
 	void sched(double delay);	// cannot be pending
 	void resched(double delay);	// may or may not be pending
 					// if you don't know the pending status
 					// call resched()
+	void resched_lazy(double delay);	// as resched(), but putting
+					// a pending timer off only moves its
+					// deadline; the event due first finds
+					// it and is scheduled again for it
 	void cancel();			// must be pending
 	inline void force_cancel() {	// cancel!
 		if (status_ == TIMER_PENDING) {
@@ -101,6 +106,9 @@ protected:
 	virtual void handle(Event *);
 	int status_;
 	Event event_;
+	double deadline_;	// event_.time_, or later by resched_lazy()
+	scheduler_uid_t deaduid_;	// the uid resched() would have used
+	double deadstime_;		// ... and when it was taken
 
 private:
 	inline void _sched(double delay) {
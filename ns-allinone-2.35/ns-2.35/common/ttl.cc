@@ -80,6 +80,18 @@ public:
 		iph->ttl() = ttl;
 		send(p, h);
 	}
+	// a train in which a packet expires is taken packet by packet
+	void recvtrain(Packet* p) {
+		Packet* q;
+		for (q = p; q != 0; q = q->next_)
+			if (hdr_ip::access(q)->ttl() <= tick_) {
+				NsObject::recvtrain(p);
+				return;
+			}
+		for (q = p; q != 0; q = q->next_)
+			hdr_ip::access(q)->ttl() -= tick_;
+		target_->recvtrain(p);
+	}
 protected:
 	int noWarn_;
 	int tick_;
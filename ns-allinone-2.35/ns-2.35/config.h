@@ -108,6 +108,20 @@ struct ns_addr_t {
 
 #define	NS_ALIGN	(8)	/* byte alignment for structs (eg packet.cc) */
 
+/*
+ * Thread-local storage, for the few globals that Scheduler/Parallel
+ * switches from one partition to another (see common/parallel.h).
+ * Only a build with -DNS_PARALLEL (configure --enable-parallel) has
+ * Scheduler/Parallel; elsewhere these stay plain globals.
+ */
+#ifndef NS_PARALLEL
+#define	NS_TLS
+#elif defined(WIN32)
+#define	NS_TLS	__declspec(thread)
+#else
+#define	NS_TLS	__thread
+#endif
+
 
 /* some global definitions */
 #define TINY_LEN        8
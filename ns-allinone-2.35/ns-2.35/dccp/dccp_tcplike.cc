@@ -466,6 +466,7 @@ void DCCPTCPlikeAgent::delay_bind_init_all(){
 	delay_bind_init_one("dack_delay_");
 	delay_bind_init_one("q_opt_ratio_");
 	delay_bind_init_one("ackv_size_lim_");
+	delay_bind_init_one("lazy_timer_");
 	DCCPAgent::delay_bind_init_all();
 }
 
@@ -492,6 +493,7 @@ int DCCPTCPlikeAgent::delay_bind_dispatch(const char *varName, const char *local
 	if (delay_bind(varName, localName, "dack_delay_", &dack_delay_, tracer)) return TCL_OK;
 	if (delay_bind(varName, localName, "q_opt_ratio_", &q_opt_ratio_, tracer)) return TCL_OK;
 	if (delay_bind(varName, localName, "ackv_size_lim_", &ackv_size_lim_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "lazy_timer_", &lazy_timer_, tracer)) return TCL_OK;
 	return DCCPAgent::delay_bind_dispatch(varName, localName, tracer);
 }
 
@@ -923,7 +925,10 @@ void DCCPTCPlikeAgent::send_packetRecv(Packet *pkt, int dataSize){
 				debug("%f, DCCP/TCPlike(%s)::send_packetRecv() - Pipe is zero, cancels timer\n", now(), name());
 			} else if (num_inc_cwnd > 0){
 				debug("%f, DCCP/TCPlike(%s)::send_packetRecv() - Newly acked packets, rescheduling timer. rto %f\n", now(), name(),(double) rto_);
-				timer_to_->resched(rto_);
+				if (lazy_timer_)
+					timer_to_->resched_lazy(rto_);
+				else
+					timer_to_->resched(rto_);
 			}
 
 			updateCwnd(num_inc_cwnd);
@@ -1146,6 +1151,7 @@ DCCPTCPlikeAgent::DCCPTCPlikeAgent() : DCCPAgent() {
 
 	ackv_size_lim_ = DCCP_TCPLIKE_ACKV_SIZE_LIM; 
 	ackv_lim_seq_ = 0; 
+	lazy_timer_ = 0;
 
 	sender_quiescent_ = false;
 	
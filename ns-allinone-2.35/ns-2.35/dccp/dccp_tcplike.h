@@ -199,6 +199,7 @@ private:
 	struct dccp_tcplike_send_recv_hist send_recv_hist_;
 
 	DCCPTCPlikeTOTimer *timer_to_;  //timeout timer
+	int lazy_timer_;                //put timer_to_ off with resched_lazy()
 
 	//quiescence
 	double t_last_data_sent_;  //timestamp of when last data pkt was sent 
@@ -40,6 +40,7 @@ static const char rcsid[] =
 #include "delay.h"
 #include "mcast_ctrl.h"
 #include "ctrMcast.h"
+#include "parallel.h"
 
 static class LinkDelayClass : public TclClass {
 public:
@@ -52,11 +53,35 @@ public:
 LinkDelay::LinkDelay() 
 	: dynamic_(0), 
 	  latest_time_(0),
-	  itq_(0)
+	  itq_(0),
+	  ring_(0), rsize_(0), rhead_(0), rlen_(0),
+	  home_(-1), lp_(-1), trainhead_(0), backlog_(0), fluidlast_(0)
 {
 	bind_bw("bandwidth_", &bandwidth_);
 	bind_time("delay_", &delay_);
 	bind_bool("avoidReordering_", &avoidReordering_);
+	bind_bool("fifo_", &fifo_);
+}
+
+LinkDelay::~LinkDelay()
+{
+	// only the head of the packets in transit is in the scheduler
+	if (rlen_ > 0)
+		Scheduler::instance().cancel(ringat(0));
+	while (rlen_ > 0) {
+		Packet::free(ringat(0));
+		rhead_ = (rhead_ + 1) & (rsize_ - 1);
+		rlen_--;
+	}
+	delete [] ring_;
+	if (trainhead_ != 0) {
+		Scheduler::instance().cancel(trainhead_);
+		while (trainhead_ != 0) {
+			Packet* p = trainhead_;
+			trainhead_ = p->next_;
+			Packet::free(p);
+		}
+	}
 }
 
 int LinkDelay::command(int argc, const char*const* argv)
@@ -67,6 +92,13 @@ int LinkDelay::command(int argc, const char*const* argv)
 			itq_ = new PacketQueue();
 			return TCL_OK;
 		}
+	} else if (argc == 4) {
+		if (strcmp(argv[1], "partition") == 0) {
+			// Scheduler/Parallel partitions of the two ends
+			home_ = atoi(argv[2]);
+			lp_ = atoi(argv[3]);
+			return TCL_OK;
+		}
 	} else if (argc == 6) {
 		if (strcmp(argv[1], "pktintran") == 0) {
 			int src = atoi(argv[2]);
@@ -86,7 +118,24 @@ void LinkDelay::recv(Packet* p, Handler* h)
 {
 	double txt = txtime(p);
 	Scheduler& s = Scheduler::instance();
-	if (dynamic_) {
+	if (lp_ >= 0 && ParallelScheduler::current()) {
+		/*
+		 * Partitioned: the packet goes to the mailbox of target_'s
+		 * partition.  When partition 0 sends for a link of another
+		 * partition (e.g., started from Tcl), the link's timer moves
+		 * to its own partition too, taking the queue along.
+		 */
+		double t = arrival(txt);
+		if (!ParallelScheduler::post(lp_, target_, p, t))
+			s.schedule_at(target_, p, t);
+		if (h != 0 && !ParallelScheduler::post(home_, h, &intr_,
+		    s.clock() + txt))
+			s.schedule(h, &intr_, txt);
+		return;
+	} else if (fifo_) {
+		// same delivery times as below, kept in the link's own ring
+		transit(p, arrival(txt));
+	} else if (dynamic_) {
 		Event* e = (Event*)p;
 		e->time_= txt + delay_;
 		itq_->enque(p); // for convinience, use a queue to store packets in transit
@@ -103,10 +152,103 @@ void LinkDelay::recv(Packet* p, Handler* h)
  			s.schedule(target_, p, txt + delay_);
  		}
 
+	} else if (backlog_ > 0 || fluidlast_ > 0) {
+		// behind the fluid queued ahead (see FluidModel), in order
+		double t = s.clock() + txt + delay_ + backlog_;
+		if (t < fluidlast_)
+			t = fluidlast_;
+		fluidlast_ = t;
+		s.schedule_at(target_, p, t);
 	} else {
 		s.schedule(target_, p, txt + delay_);
 	}
-	s.schedule(h, &intr_, txt);
+	// no callback for a Queue with lazy_resume_
+	if (h != 0)
+		s.schedule(h, &intr_, txt);
+}
+
+/*
+ * Send a train for a Queue with trains_: each packet's time_ is when
+ * the link starts on it, and becomes when it is delivered.  Packets
+ * sent before the train in the scheduler is delivered are added to
+ * it, so a window of packets crosses the link as a single event.
+ * When it is delivered, the packets the link has not yet started on
+ * stay behind, for more to join them.
+ */
+void LinkDelay::sendtrain(Packet* p)
+{
+	Packet* q;
+	for (q = p; ; q = q->next_) {
+		q->time_ += txtime(q) + delay_;
+		if (q->next_ == 0)
+			break;
+	}
+	if (trainhead_ != 0)
+		traintail_->next_ = p;
+	else {
+		trainhead_ = p;
+		Scheduler::instance().schedule_at(this, p, p->time_);
+	}
+	traintail_ = q;
+}
+
+/*
+ * The time a packet sent now is delivered, as computed in recv() for
+ * the packets handed straight to the scheduler.
+ */
+double LinkDelay::arrival(double txt)
+{
+	double now = Scheduler::instance().clock();
+	if (avoidReordering_) {
+		if (txt + delay_ < latest_time_ - now && latest_time_ > 0) {
+			latest_time_ += txt;
+			return (now + (latest_time_ - now));
+		}
+		latest_time_ = now + txt + delay_;
+	}
+	return (now + (txt + delay_));
+}
+
+/*
+ * Put a packet in transit, to be delivered at time t.  Delivery times
+ * only decrease when bandwidth_ or delay_ is changed, so the packet
+ * nearly always goes at the tail; otherwise it is moved in ahead of
+ * the packets due after it, and if it becomes the head it replaces
+ * the old head in the scheduler.  Packets due at the same time leave
+ * in the order they arrived.
+ */
+void LinkDelay::transit(Packet* p, double t)
+{
+	Scheduler& s = Scheduler::instance();
+
+	if (rlen_ == rsize_)
+		grow();
+	int mask = rsize_ - 1;
+	int i = rlen_;
+	while (i > 0 && ringat(i - 1)->time_ > t) {
+		ring_[(rhead_ + i) & mask] = ringat(i - 1);
+		i--;
+	}
+	ring_[(rhead_ + i) & mask] = p;
+	p->time_ = t;
+	rlen_++;
+	if (i == 0) {
+		if (rlen_ > 1)
+			s.cancel(ringat(1));
+		s.schedule_at(this, p, t);
+	}
+}
+
+void LinkDelay::grow()
+{
+	int n = rsize_ ? 2 * rsize_ : 64;
+	Packet** r = new Packet*[n];
+	for (int i = 0; i < rlen_; i++)
+		r[i] = ringat(i);
+	delete [] ring_;
+	ring_ = r;
+	rsize_ = n;
+	rhead_ = 0;
 }
 
 void LinkDelay::send(Packet* p, Handler*)
@@ -126,10 +268,49 @@ void LinkDelay::reset()
 			drop(np);
 		}
 	}
+	if (dynamic_ && rlen_ > 0) {
+		// only the head is in the scheduler
+		s.cancel(ringat(0));
+		while (rlen_ > 0) {
+			Packet *np = ringat(0);
+			rhead_ = (rhead_ + 1) & (rsize_ - 1);
+			rlen_--;
+			drop(np);
+		}
+	}
 }
 
 void LinkDelay::handle(Event* e)
 {
+	if (e == trainhead_) {
+		Packet* p = trainhead_;
+		double now = Scheduler::instance().clock();
+		Packet* q = p;
+		/* (leaving a margin for rounding in start times) */
+		while (q->next_ != 0 &&
+		    q->next_->time_ - txtime(q->next_) - delay_ < now - 1e-9)
+			q = q->next_;
+		trainhead_ = q->next_;
+		if (trainhead_ != 0) {
+			q->next_ = 0;
+			Scheduler::instance().schedule_at(this, trainhead_,
+			    trainhead_->time_);
+		}
+		if (p->next_ != 0)
+			target_->recvtrain(p);
+		else
+			send(p, (Handler*) NULL);
+		return;
+	}
+	if (rlen_ > 0 && e == ringat(0)) {
+		Packet *p = ringat(0);
+		rhead_ = (rhead_ + 1) & (rsize_ - 1);
+		if (--rlen_ > 0)
+			Scheduler::instance().schedule_at(this, ringat(0),
+							  ringat(0)->time_);
+		send(p, (Handler*) NULL);
+		return;
+	}
 	Packet *p = itq_->deque();
 	assert(p->time_ == e->time_);
 	send(p, (Handler*) NULL);
@@ -148,10 +329,12 @@ void LinkDelay::pktintran(int src, int group)
 	if (! dynamic_)
 		return;
 
+	// packets in transit are in itq_, or in the ring with fifo_
 	int len = itq_->length();
-	while (len) {
-		len--;
-		Packet* p = itq_->lookup(len);
+	int n = len + rlen_;
+	while (n) {
+		n--;
+		Packet* p = n < len ? itq_->lookup(n) : ringat(n - len);
 		hdr_ip* iph = hdr_ip::access(p);
 		if (iph->flowid() == prune) {
 			if (iph->saddr() == src && iph->daddr() == group) {
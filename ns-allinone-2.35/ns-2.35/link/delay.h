@@ -47,6 +47,7 @@
 class LinkDelay : public Connector {
  public:
 	LinkDelay();
+	~LinkDelay();
 	void recv(Packet* p, Handler*);
 	void send(Packet* p, Handler*);
 	void handle(Event* e);
@@ -56,9 +57,23 @@ class LinkDelay : public Connector {
 	}
 	double bandwidth() const { return bandwidth_; }
 	void pktintran(int src, int group);
+	void sendtrain(Packet* p);
+	int plain() const {
+		return (!dynamic_ && !fifo_ && !avoidReordering_ && lp_ < 0);
+	}
+	int trainok() const {		/* for sendtrain() */
+		return (plain() && fluidlast_ == 0);
+	}
+	void backlog(double b) { backlog_ = b; }	/* for FluidModel */
  protected:
 	int command(int argc, const char*const* argv);
 	void reset();
+	double arrival(double txt);
+	void transit(Packet* p, double t);
+	void grow();
+	inline Packet* ringat(int i) {
+		return ring_[(rhead_ + i) & (rsize_ - 1)];
+	}
 	double bandwidth_;	/* bandwidth of underlying link (bits/sec) */
 	double delay_;		/* line latency */
 	Event intr_;
@@ -70,6 +85,21 @@ class LinkDelay : public Connector {
 	int avoidReordering_;	/* indicates whether or not to avoid
 				 *  reordering when link bandwidth or delay 
 				 *  changes */
+	/*
+	 * With fifo_ set, packets in transit are kept in ring_, sorted by
+	 * delivery time, and only the head of the ring is in the scheduler.
+	 */
+	int fifo_;
+	Packet** ring_;
+	int rsize_;		/* slots in ring_, a power of 2 */
+	int rhead_;
+	int rlen_;
+	int home_;		/* Scheduler/Parallel partitions of the */
+	int lp_;		/*  link and of target_, or -1 */
+	Packet* trainhead_;	/* the train in the scheduler, and its */
+	Packet* traintail_;	/*  last packet, see sendtrain() */
+	double backlog_;	/* fluid queued ahead, seconds, and the */
+	double fluidlast_;	/*  latest delivery behind it, see recv() */
 };
 
 #endif
@@ -0,0 +1,126 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * airtime.cc
+ *
+ * Frame airtime lookup tables shared by the wireless MACs; see airtime.h.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "airtime.h"
+#include "wireless-phyExt.h"
+
+AirtimeModel::AirtimeModel(int lo) : lo_(lo), ncol_(0), last_(0)
+{
+	for (int i = 0; i < AIRTIME_MAXRATES; i++) {
+		col_[i].rate_ = 0.0;
+		col_[i].t_ = 0;
+	}
+}
+
+AirtimeModel::~AirtimeModel()
+{
+	for (int i = 0; i < ncol_; i++)
+		delete [] col_[i].t_;
+}
+
+/*
+ * Find the table for a rate, building it the first time the rate is
+ * seen.  A MAC uses one or two rates, so this is a short linear search.
+ * If a model is asked about more rates than it has room for, the
+ * extra ones are simply computed every time.
+ */
+AirtimeModel::AirtimeColumn*
+AirtimeModel::column(double rate)
+{
+	int i;
+
+	for (i = 0; i < ncol_; i++) {
+		if (col_[i].rate_ == rate) {
+			last_ = i;
+			return &col_[i];
+		}
+	}
+	if (ncol_ == AIRTIME_MAXRATES)
+		return 0;
+
+	AirtimeColumn *c = &col_[ncol_];
+	c->rate_ = rate;
+	c->t_ = new double[AIRTIME_MAXBYTES];
+	for (i = 0; i < AIRTIME_MAXBYTES; i++)
+		c->t_[i] = compute(lo_ + i, rate);
+	last_ = ncol_++;
+	return c;
+}
+
+/* ======================================================================
+   802.11 DSSS
+   ====================================================================== */
+Dot11Airtime *Dot11Airtime::all_ = 0;
+
+Dot11Airtime::Dot11Airtime(u_int32_t plcplen, double plcprate) :
+	AirtimeModel(plcplen), plcplen_(plcplen), plcprate_(plcprate)
+{
+	next_ = all_;
+	all_ = this;
+}
+
+Dot11Airtime*
+Dot11Airtime::get(u_int32_t plcplen, double plcprate)
+{
+	for (Dot11Airtime *m = all_; m; m = m->next_)
+		if (m->plcplen_ == plcplen && m->plcprate_ == plcprate)
+			return m;
+	return new Dot11Airtime(plcplen, plcprate);
+}
+
+/* the expression Mac802_11::txtime(double, double) used per frame */
+double
+Dot11Airtime::compute(double psz, double drt)
+{
+	double dsz = psz - plcplen_;
+	int plcp_hdr = plcplen_ << 3;
+	int datalen = (int)dsz << 3;
+	double t = (((double)plcp_hdr)/plcprate_) + (((double)datalen)/drt);
+	return(t);
+}
+
+/* ======================================================================
+   802.11a/p OFDM
+   ====================================================================== */
+OfdmAirtime *OfdmAirtime::all_ = 0;
+
+OfdmAirtime::OfdmAirtime(double hdrdur, double symdur, int dot11a) :
+	AirtimeModel(0), hdrdur_(hdrdur), symdur_(symdur), dot11a_(dot11a)
+{
+	next_ = all_;
+	all_ = this;
+}
+
+OfdmAirtime*
+OfdmAirtime::get(double hdrdur, double symdur, int dot11a)
+{
+	for (OfdmAirtime *m = all_; m; m = m->next_)
+		if (m->hdrdur_ == hdrdur && m->symdur_ == symdur &&
+		    m->dot11a_ == dot11a)
+			return m;
+	return new OfdmAirtime(hdrdur, symdur, dot11a);
+}
+
+/* the expression Mac802_11Ext::txtime(double, int) used per frame */
+double
+OfdmAirtime::compute(double psz, double mod)
+{
+	int datalen = (int) psz << 3;
+	int DBPS = modulation_table[(int)mod].NDBPS;
+
+	// 802.11p
+	if (dot11a_) {
+		datalen = datalen + 16 + 6; // 16 SYMBOL BITS, 6 TAIL BITS
+	}
+	int symbols = (int)(ceil((double)datalen/DBPS)); // PADDING BITS, FILL SYMBOl
+
+	double t = hdrdur_ + (double) symbols * symdur_;
+	return (t);
+}
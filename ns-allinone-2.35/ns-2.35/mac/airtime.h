@@ -0,0 +1,105 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * airtime.h
+ *
+ * Frame airtime lookup tables shared by the wireless MACs.
+ *
+ * The MACs work out how long a frame occupies the channel on nearly
+ * every frame they send or receive (data, RTS/CTS/ACK, NAV and timeout
+ * computations).  An AirtimeModel keeps, for each rate it has been
+ * asked about, a table of those durations indexed by frame length in
+ * bytes.  Each entry is computed once with exactly the expression the
+ * MAC used to evaluate per frame, so a lookup returns the same double
+ * bit for bit; lengths beyond the table fall back to that expression.
+ *
+ * Models are shared: every MAC configured with the same PHY parameters
+ * gets the same model, so a few thousand nodes cost one set of tables.
+ * A MAC should fetch its model through the family's get() whenever the
+ * parameters may have changed (they are bound Tcl variables); get() is
+ * a short list walk that normally hits on the first entry.
+ */
+
+#ifndef ns_airtime_h
+#define ns_airtime_h
+
+#include "config.h"
+
+#define AIRTIME_MAXBYTES	2400	// largest frame kept in the tables
+#define AIRTIME_MAXRATES	8	// rates tabulated per model
+
+class AirtimeModel {
+public:
+	/*
+	 * Airtime (sec) of an sz byte frame at "rate", where the meaning
+	 * of rate (bps, modulation index, ...) is up to the model.  Sizes
+	 * are doubles in the MAC interfaces, but only whole byte counts
+	 * can come from the tables.
+	 */
+	inline double airtime(double sz, double rate) {
+		int i = (int)sz - lo_;
+		if (i < 0 || i >= AIRTIME_MAXBYTES || (double)(int)sz != sz)
+			return compute(sz, rate);
+		AirtimeColumn *c = &col_[last_];
+		if (c->rate_ != rate || c->t_ == 0)
+			c = column(rate);
+		return (c ? c->t_[i] : compute(sz, rate));
+	}
+
+protected:
+	AirtimeModel(int lo);
+	virtual ~AirtimeModel();
+
+	/* the reference expression for one duration */
+	virtual double compute(double sz, double rate) = 0;
+
+	int		lo_;	// frame length of the first table entry
+
+private:
+	struct AirtimeColumn {
+		double	rate_;
+		double	*t_;
+	};
+	AirtimeColumn*	column(double rate);
+
+	AirtimeColumn	col_[AIRTIME_MAXRATES];
+	int		ncol_;
+	int		last_;	// column of the previous lookup
+};
+
+/*
+ * 802.11 DSSS/HR-DSSS (Mac802_11): the PLCP preamble and header go at
+ * the PLCP rate, the rest of the frame at the data rate.  Frame lengths
+ * include the PLCP bytes, as in PHY_MIB::getRTSlen() and friends.
+ */
+class Dot11Airtime : public AirtimeModel {
+public:
+	static Dot11Airtime* get(u_int32_t plcplen, double plcprate);
+protected:
+	Dot11Airtime(u_int32_t plcplen, double plcprate);
+	double compute(double sz, double rate);
+private:
+	u_int32_t	plcplen_;	// PLCP preamble + header (bytes)
+	double		plcprate_;
+	Dot11Airtime	*next_;
+	static Dot11Airtime *all_;
+};
+
+/*
+ * 802.11a/p OFDM (Mac802_11Ext): header duration plus a whole number
+ * of symbols; the rate is an index into modulation_table.
+ */
+class OfdmAirtime : public AirtimeModel {
+public:
+	static OfdmAirtime* get(double hdrdur, double symdur, int dot11a);
+protected:
+	OfdmAirtime(double hdrdur, double symdur, int dot11a);
+	double compute(double sz, double rate);
+private:
+	double		hdrdur_;
+	double		symdur_;
+	int		dot11a_;	// add SERVICE and tail bits
+	OfdmAirtime	*next_;
+	static OfdmAirtime *all_;
+};
+
+#endif /* ns_airtime_h */
@@ -308,6 +308,13 @@ int WirelessChannel::command(int argc, const char*const* argv)
 			removeNodeFromList((MobileNode*) obj);
 			return TCL_OK;
 		}
+		else if (strcmp(argv[1], "addif") == 0) {
+			int rv = Channel::command(argc, argv);
+			// interfaces are normally bound to their node first
+			if (((Phy*) obj)->node() != 0)
+				addIfToList((Phy*) obj);
+			return rv;
+		}
 	}
 	return Channel::command(argc, argv);
 }
@@ -317,12 +324,14 @@ void
 WirelessChannel::sendUp(Packet* p, Phy *tifp)
 {
 	Scheduler &s = Scheduler::instance();
-	Phy *rifp = ifhead_.lh_first;
+	Phy *rifp;
 	Node *tnode = tifp->node();
 	Node *rnode = 0;
+	ChannelNode *rcn;
 	Packet *newp;
 	double propdelay = 0.0;
 	struct hdr_cmn *hdr = HDR_CMN(p);
+	int i, j;
 
          /* list-based improvement */
          if(highestAntennaZ_ == -1) {
@@ -333,9 +342,13 @@ WirelessChannel::sendUp(Packet* p, Phy *tifp)
 	
 	 hdr->direction() = hdr_cmn::UP;
 
+	 /*
+	  * Each receiving interface gets its own copy of the packet, but
+	  * only the interfaces of a node that are on this channel do;
+	  * the node's radios on other channels never see it.
+	  */
 	 // still keep grid-keeper around ??
 	 if (GridKeeper::instance()) {
-	    int i;
 	    GridKeeper* gk = GridKeeper::instance();
 	    int size = gk->size_; 
 	    
@@ -345,43 +358,47 @@ WirelessChannel::sendUp(Packet* p, Phy *tifp)
 						         outlist);
 	    for (i=0; i < out_index; i ++) {
 		
-		  newp = p->copy();
 		  rnode = outlist[i];
+		  if ((rcn = ChannelNode::find(outlist[i], this)) == NULL)
+			  continue;
 		  propdelay = get_pdelay(tnode, rnode);
 
-		  rifp = (rnode->ifhead()).lh_first; 
-		  for(; rifp; rifp = rifp->nextnode()){
-			  if (rifp->channel() == this){
-				 s.schedule(rifp, newp, propdelay); 
-				 break;
-			  }
+		  for (j = 0; j < rcn->nifs_; j++) {
+			  newp = p->copy();
+			  s.schedule(rcn->ifs_[j], newp, propdelay);
 		  }
  	    }
 	    delete [] outlist; 
 	 
 	 } else { // use list-based improvement
 	 
-		 MobileNode *mtnode = (MobileNode *) tnode;
-		 MobileNode **affectedNodes;// **aN;
-		 int numAffectedNodes = -1, i;
+		 ChannelNode *tcn = ChannelNode::find((MobileNode *) tnode, this);
+		 ChannelNode **affectedNodes;
+		 int numAffectedNodes = -1;
 		 
+		 if (tcn == NULL) {
+			 fprintf(stderr, "WirelessChannel: node %d sends on channel %d without add-node\n",
+				 tnode->address(), index_);
+			 Packet::free(p);
+			 return;
+		 }
 		 if(!sorted_){
 			 sortLists();
 		 }
 		 
-		 affectedNodes = getAffectedNodes(mtnode, distCST_ + /* safety */ 5, &numAffectedNodes);
+		 affectedNodes = getAffectedNodes(tcn, distCST_ + /* safety */ 5, &numAffectedNodes);
 		 for (i=0; i < numAffectedNodes; i++) {
-			 rnode = affectedNodes[i];
+			 rcn = affectedNodes[i];
+			 rnode = rcn->node_;
 			 
 			 if(rnode == tnode)
 				 continue;
 			 
-			 newp = p->copy();
-			 
 			 propdelay = get_pdelay(tnode, rnode);
 			 
-			 rifp = (rnode->ifhead()).lh_first;
-			 for(; rifp; rifp = rifp->nextnode()){
+			 for (j = 0; j < rcn->nifs_; j++) {
+				 rifp = rcn->ifs_[j];
+				 newp = p->copy();
 				 s.schedule(rifp, newp, propdelay);
 			 }
 		 }
@@ -391,54 +408,135 @@ WirelessChannel::sendUp(Packet* p, Phy *tifp)
 }
 
 
+/* the node's entry for channel ch, if it has one */
+ChannelNode *
+ChannelNode::find(MobileNode *mn, Channel *ch)
+{
+	ChannelNode *cn;
+
+	for (cn = mn->chanlist_; cn != NULL; cn = cn->nextchan_)
+		if (cn->channel_ == ch)
+			return cn;
+	return NULL;
+}
+
+/* a new entry, chained to the node but not yet in ch's X list */
+ChannelNode *
+ChannelNode::create(MobileNode *mn, Channel *ch)
+{
+	ChannelNode *cn = new ChannelNode;
+
+	cn->node_ = mn;
+	cn->channel_ = ch;
+	cn->nextX_ = cn->prevX_ = NULL;
+	cn->ifs_ = NULL;
+	cn->nifs_ = 0;
+	cn->nextchan_ = mn->chanlist_;
+	mn->chanlist_ = cn;
+	return cn;
+}
+
+/* record one of the node's interfaces on the channel */
 void
+ChannelNode::addif(Phy *ifp)
+{
+	Phy **ifs;
+	int i;
+
+	for (i = 0; i < nifs_; i++)
+		if (ifs_[i] == ifp)
+			return;
+	ifs = new Phy*[nifs_ + 1];
+	for (i = 0; i < nifs_; i++)
+		ifs[i] = ifs_[i];
+	ifs[i] = ifp;
+	delete [] ifs_;
+	ifs_ = ifs;
+	nifs_++;
+}
+
+/* unchain from the node and free; the channel unlinks its X list */
+void
+ChannelNode::destroy()
+{
+	ChannelNode **cnp;
+
+	for (cnp = &node_->chanlist_; *cnp != this; cnp = &(*cnp)->nextchan_)
+		;
+	*cnp = nextchan_;
+	delete [] ifs_;
+	delete this;
+}
+
+ChannelNode *
 WirelessChannel::addNodeToList(MobileNode *mn)
 {
-	MobileNode *tmp;
+	ChannelNode *cn, *tmp;
+
+	// a node with several radios on this channel is listed once
+	if ((cn = ChannelNode::find(mn, this)) != NULL) {
+		if (cn->nifs_ == 0)
+			findIfs(cn);
+		return cn;
+	}
+	cn = ChannelNode::create(mn, this);
 
 	// create list of mobilenodes for this channel
 	if (xListHead_ == NULL) {
 		fprintf(stderr, "INITIALIZE THE LIST xListHead\n");
-		xListHead_ = mn;
+		xListHead_ = cn;
 		xListHead_->nextX_ = NULL;
 		xListHead_->prevX_ = NULL;
 	} else {
 		for (tmp = xListHead_; tmp->nextX_ != NULL; tmp=tmp->nextX_);
-		tmp->nextX_ = mn;
-		mn->prevX_ = tmp;
-		mn->nextX_ = NULL;
+		tmp->nextX_ = cn;
+		cn->prevX_ = tmp;
+		cn->nextX_ = NULL;
 	}
 	numNodes_++;
+	sorted_ = false;
+	return cn;
+}
+
+/* record an interface under its node's entry */
+void
+WirelessChannel::addIfToList(Phy *ifp)
+{
+	addNodeToList((MobileNode*) ifp->node())->addif(ifp);
+}
+
+/* for scripts that attach an interface before binding it to a node */
+void
+WirelessChannel::findIfs(ChannelNode *cn)
+{
+	for (Phy *ifp = ifhead_.lh_first; ifp; ifp = ifp->nextchnl())
+		if (ifp->node() == cn->node_)
+			addIfToList(ifp);
 }
 
 void
 WirelessChannel::removeNodeFromList(MobileNode *mn) {
 	
-	MobileNode *tmp;
-	// Find node in list
-	for (tmp = xListHead_; tmp->nextX_ != NULL; tmp=tmp->nextX_) {
-		if (tmp == mn) {
-			if (tmp == xListHead_) {
-				xListHead_ = tmp->nextX_;
-				if (tmp->nextX_ != NULL)
-					tmp->nextX_->prevX_ = NULL;
-			} else if (tmp->nextX_ == NULL) 
-				tmp->prevX_->nextX_ = NULL;
-			else {
-				tmp->prevX_->nextX_ = tmp->nextX_;
-				tmp->nextX_->prevX_ = tmp->prevX_;
-			}
-			numNodes_--;
-			return;
-		}
+	ChannelNode *cn;
+
+	if ((cn = ChannelNode::find(mn, this)) == NULL) {
+		fprintf(stderr, "Channel: node not found in list\n");
+		return;
 	}
-	fprintf(stderr, "Channel: node not found in list\n");
+	if (cn->prevX_ != NULL)
+		cn->prevX_->nextX_ = cn->nextX_;
+	else
+		xListHead_ = cn->nextX_;
+	if (cn->nextX_ != NULL)
+		cn->nextX_->prevX_ = cn->prevX_;
+	cn->destroy();
+	numNodes_--;
 }
 
 void
 WirelessChannel::sortLists(void) {
 	bool flag = true;
-	MobileNode *m, *q;
+	ChannelNode *m, *q;
 
 	sorted_ = true;
 	
@@ -450,7 +548,7 @@ WirelessChannel::sortLists(void) {
 		m = xListHead_;
 		while (m != NULL){
 			if(m->nextX_ != NULL)
-				if ( m->X() > m->nextX_->X() ){
+				if ( m->node_->X() > m->nextX_->node_->X() ){
 					flag = true;
 					//delete_after m;
 					q = m->nextX_;
@@ -477,10 +575,10 @@ WirelessChannel::sortLists(void) {
 }
 
 void
-WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
+WirelessChannel::updateNodesList(ChannelNode *mn, double oldX) {
 	
-	MobileNode* tmp;
-	double X = mn->X();
+	ChannelNode* tmp;
+	double X = mn->node_->X();
 	bool skipX=false;
 	
 	if(!sorted_) {
@@ -494,7 +592,7 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	// deleting mn from x-list
 	if(mn->nextX_ != NULL) {
 		if(mn->prevX_ != NULL){
-			if((mn->nextX_->X() >= X) && (mn->prevX_->X() <= X)) skipX = true; // the node doesn't change its position in the list
+			if((mn->nextX_->node_->X() >= X) && (mn->prevX_->node_->X() <= X)) skipX = true; // the node doesn't change its position in the list
 			else{
 				mn->nextX_->prevX_ = mn->prevX_;
 				mn->prevX_->nextX_ = mn->nextX_;
@@ -502,7 +600,7 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 		}
 		
 		else{
-			if(mn->nextX_->X() >= X) skipX = true; // skip updating the first element
+			if(mn->nextX_->node_->X() >= X) skipX = true; // skip updating the first element
 			else{
 				mn->nextX_->prevX_ = NULL;
 				xListHead_ = mn->nextX_;
@@ -511,7 +609,7 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	}
 	
 	else if(mn->prevX_ !=NULL){
-		if(mn->prevX_->X() <= X) skipX = true; // skip updating the last element
+		if(mn->prevX_->node_->X() <= X) skipX = true; // skip updating the last element
 		else mn->prevX_->nextX_ = NULL;
 	}
 	
@@ -521,16 +619,13 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 	//inserting mn in x-list
 	if(!skipX){
 		if(X > oldX){			
-			for(tmp = mn; tmp->nextX_ != NULL && tmp->nextX_->X() < X; tmp = tmp->nextX_);
-			//fprintf(stdout,"Scanning the element addr %d X=%0.f, next addr %d X=%0.f\n", tmp, tmp->X(), tmp->nextX_, tmp->nextX_->X());
+			for(tmp = mn; tmp->nextX_ != NULL && tmp->nextX_->node_->X() < X; tmp = tmp->nextX_);
 			if(tmp->nextX_ == NULL) { 
-				//fprintf(stdout, "tmp->nextX_ is NULL\n");
 				tmp->nextX_ = mn;
 				mn->prevX_ = tmp;
 				mn->nextX_ = NULL;
 			} 
 			else{ 
-				//fprintf(stdout, "tmp->nextX_ is not NULL, tmp->nextX_->X()=%0.f\n", tmp->nextX_->X());
 				mn->prevX_ = tmp->nextX_->prevX_;
 				mn->nextX_ = tmp->nextX_;
 				tmp->nextX_->prevX_ = mn;  	
@@ -538,17 +633,14 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 			} 
 		}
 		else{
-			for(tmp = mn; tmp->prevX_ != NULL && tmp->prevX_->X() > X; tmp = tmp->prevX_);
-				//fprintf(stdout,"Scanning the element addr %d X=%0.f, prev addr %d X=%0.f\n", tmp, tmp->X(), tmp->prevX_, tmp->prevX_->X());
+			for(tmp = mn; tmp->prevX_ != NULL && tmp->prevX_->node_->X() > X; tmp = tmp->prevX_);
 			if(tmp->prevX_ == NULL) {
-				//fprintf(stdout, "tmp->prevX_ is NULL\n");
 				tmp->prevX_ = mn;
 				mn->nextX_ = tmp;
 				mn->prevX_ = NULL;
 				xListHead_ = mn;
 			} 
 			else{
-				//fprintf(stdout, "tmp->prevX_ is not NULL, tmp->prevX_->X()=%0.f\n", tmp->prevX_->X());
 				mn->nextX_ = tmp->prevX_->nextX_;
 				mn->prevX_ = tmp->prevX_;
 				tmp->prevX_->nextX_ = mn;  	
@@ -559,13 +651,14 @@ WirelessChannel::updateNodesList(class MobileNode *mn, double oldX) {
 }
 
 
-MobileNode **
-WirelessChannel::getAffectedNodes(MobileNode *mn, double radius,
+ChannelNode **
+WirelessChannel::getAffectedNodes(ChannelNode *cn, double radius,
 				  int *numAffectedNodes)
 {
 	double xmin, xmax, ymin, ymax;
 	int n = 0;
-	MobileNode *tmp, **list, **tmpList;
+	MobileNode *mn = cn->node_;
+	ChannelNode *tmp, **list, **tmpList;
 
 	if (xListHead_ == NULL) {
 		*numAffectedNodes=-1;
@@ -579,27 +672,27 @@ WirelessChannel::getAffectedNodes(MobileNode *mn, double radius,
 	ymax = mn->Y() + radius;
 	
 	// First allocate as much as possibly needed
-	tmpList = new MobileNode*[numNodes_];
+	tmpList = new ChannelNode*[numNodes_];
 	
 	for(tmp = xListHead_; tmp != NULL; tmp = tmp->nextX_) tmpList[n++] = tmp;
 	for(int i = 0; i < n; ++i)
-		if(tmpList[i]->speed()!=0.0 && (Scheduler::instance().clock() -
-						tmpList[i]->getUpdateTime()) > XLIST_POSITION_UPDATE_INTERVAL )
-			tmpList[i]->update_position();
+		if(tmpList[i]->node_->speed()!=0.0 && (Scheduler::instance().clock() -
+						tmpList[i]->node_->getUpdateTime()) > XLIST_POSITION_UPDATE_INTERVAL )
+			tmpList[i]->node_->update_position();
 	n=0;
 	
-	for(tmp = mn; tmp != NULL && tmp->X() >= xmin; tmp=tmp->prevX_)
-		if(tmp->Y() >= ymin && tmp->Y() <= ymax){
+	for(tmp = cn; tmp != NULL && tmp->node_->X() >= xmin; tmp=tmp->prevX_)
+		if(tmp->node_->Y() >= ymin && tmp->node_->Y() <= ymax){
 			tmpList[n++] = tmp;
 		}
-	for(tmp = mn->nextX_; tmp != NULL && tmp->X() <= xmax; tmp=tmp->nextX_){
-		if(tmp->Y() >= ymin && tmp->Y() <= ymax){
+	for(tmp = cn->nextX_; tmp != NULL && tmp->node_->X() <= xmax; tmp=tmp->nextX_){
+		if(tmp->node_->Y() >= ymin && tmp->node_->Y() <= ymax){
 			tmpList[n++] = tmp;
 		}
 	}
 	
-	list = new MobileNode*[n];
-	memcpy(list, tmpList, n * sizeof(MobileNode *));
+	list = new ChannelNode*[n];
+	memcpy(list, tmpList, n * sizeof(ChannelNode *));
 	delete [] tmpList;
          
 	*numAffectedNodes = n;
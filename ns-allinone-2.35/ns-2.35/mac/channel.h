@@ -48,6 +48,7 @@
 
 class Trace;
 class Node;
+struct ChannelNode;
 /*=================================================================
 Channel:  a shared medium that supports contention and collision
         This class is used to represent the physical media to which
@@ -65,6 +66,8 @@ public:
 	TclObject* gridkeeper_;
 	double maxdelay() { return delay_; };
   	int index() {return index_;}
+	/* a node on the channel has moved from oldX (see ChannelNode) */
+	virtual void updateNodesList(ChannelNode *, double /* oldX */) {}
         
 private:
 	virtual void sendUp(Packet* p, Phy *txif); 
@@ -102,6 +105,33 @@ protected:
   This class is used to represent the physical media used by mobilenodes
 ====================================================================*/
 
+class MobileNode;
+class WirelessChannel;
+
+/*
+ * A node's membership in one wireless channel: its place in the
+ * channel's X-sorted list and the node's interfaces tuned to that
+ * channel.  A node with radios on several channels has one of these
+ * per channel, chained from MobileNode::chanlist_, so each channel
+ * keeps its own spatial list and a transmission is only handed to
+ * interfaces on the sending channel.  The channel owns the X list;
+ * a moving node calls Channel::updateNodesList() on each entry.
+ */
+struct ChannelNode {
+	MobileNode	*node_;
+	Channel		*channel_;
+	ChannelNode	*nextX_;	// channel's X-sorted list
+	ChannelNode	*prevX_;
+	ChannelNode	*nextchan_;	// same node, other channels
+	Phy		**ifs_;		// node's interfaces on channel_
+	int		nifs_;
+
+	static ChannelNode *find(MobileNode *mn, Channel *ch);
+	static ChannelNode *create(MobileNode *mn, Channel *ch);
+	void addif(Phy *ifp);
+	void destroy();		// off the node's chain; not the X list
+};
+
 class WirelessChannel : public Channel{
 	friend class Topography;
 public:
@@ -116,14 +146,18 @@ private:
 	/* For list-keeper, channel keeps list of mobilenodes 
 	   listening on to it */
 	int numNodes_;
-	MobileNode *xListHead_;
+	ChannelNode *xListHead_;
 	bool sorted_;
-	void addNodeToList(MobileNode *mn);
+	ChannelNode *addNodeToList(MobileNode *mn);
+	void addIfToList(Phy *ifp);
+	void findIfs(ChannelNode *cn);
 	void removeNodeFromList(MobileNode *mn);
 	void sortLists(void);
-	void updateNodesList(class MobileNode *mn, double oldX);
-	MobileNode **getAffectedNodes(MobileNode *mn, double radius, int *numAffectedNodes);
+	ChannelNode **getAffectedNodes(ChannelNode *cn, double radius, int *numAffectedNodes);
 	
+public:
+	virtual void updateNodesList(ChannelNode *cn, double oldX);
+
 protected:
 	static double distCST_;        
         static double highestAntennaZ_;
@@ -52,6 +52,7 @@
 #include "mac.h"
 #include "mac-timers.h"
 #include "mac-802_11.h"
+#include "airtime.h"
 #include "cmu-trace.h"
 
 // Added by Sushmita to support event tracing
@@ -1855,12 +1856,8 @@ Mac802_11::txtime(Packet *p)
 double
 Mac802_11::txtime(double psz, double drt)
 {
-	double dsz = psz - phymib_.getPLCPhdrLen();
-        int plcp_hdr = phymib_.getPLCPhdrLen() << 3;	
-	int datalen = (int)dsz << 3;
-	double t = (((double)plcp_hdr)/phymib_.getPLCPDataRate())
-                                       + (((double)datalen)/drt);
-	return(t);
+	return Dot11Airtime::get(phymib_.getPLCPhdrLen(),
+				 phymib_.getPLCPDataRate())->airtime(psz, drt);
 }
 
 
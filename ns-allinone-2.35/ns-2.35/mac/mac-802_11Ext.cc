@@ -64,6 +64,7 @@
 #include "ll.h"
 #include "mac.h"
 #include "mac-802_11Ext.h"
+#include "airtime.h"
 #include "cmu-trace.h"
 #include <iostream>
 
@@ -753,18 +754,10 @@ double Mac802_11Ext::txtime(double psz, double drt) {
  *                this is the function used in reality
  */
 double Mac802_11Ext::txtime(double psz, int mod_scheme) {
-	int datalen = (int) psz << 3;
-	int DBPS = modulation_table[mod_scheme].NDBPS;
-
-	// 802.11p
-	if (phymib_.use_802_11a()) {
-		datalen = datalen + 16 + 6; // 16 SYMBOL BITS, 6 TAIL BITS
-	}
-	int symbols = (int)(ceil((double)datalen/DBPS)); // PADDING BITS, FILL SYMBOl
-
-	double t = phymib_.getHeaderDuration() + (double) symbols
-			* phymib_.getSymbolDuration();
-	return (t);
+	// padding, fill symbol and 802.11p SERVICE/tail bits: see OfdmAirtime
+	return OfdmAirtime::get(phymib_.getHeaderDuration(),
+			phymib_.getSymbolDuration(),
+			phymib_.use_802_11a())->airtime(psz, mod_scheme);
 }
 
 /*new code ends here*/
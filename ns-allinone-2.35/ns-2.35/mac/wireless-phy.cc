@@ -226,7 +226,7 @@ WirelessPhy::sendDown(Packet *p)
 	 * Decrease node's energy
 	 */
 	if(em()) {
-		if (em()->energy() > 0) {
+		if (em()->alive()) {
 
 		    double txtime = hdr_cmn::access(p)->txtime();
 		    double start_time = MAX(channel_idle_time_, NOW);
@@ -280,17 +280,12 @@ WirelessPhy::sendDown(Packet *p)
 		   channel_idle_time_ = end_time;
 		   update_energy_time_ = end_time;
 
-		   if (em()->energy() <= 0) {
+		   if (!em()->alive() && !em()->lazy()) {
 			   em()->setenergy(0);
 			   ((MobileNode*)node())->log_energy(0);
 		   }
 
 		} else {
-
-			// log node energy
-			if (em()->energy() > 0) {
-				((MobileNode *)node_)->log_energy(1);
-			} 
 //
 			Packet::free(p);
 			return;
@@ -335,7 +330,7 @@ WirelessPhy::sendUp(Packet *p)
 	}
 	// if the energy goes to ZERO, drop the packet simply
 	if (em()) {
-		if (em()->energy() <= 0) {
+		if (!em()->alive()) {
 			pkt_recvd = 0;
 			goto DONE;
 		}
@@ -422,16 +417,8 @@ DONE:
 		  dfh->sender_id.port_, dfh->pk_num, node()->energy());
 		*/
 
-		// log node energy
-		if (em()->energy() > 0) {
-		((MobileNode *)node_)->log_energy(1);
-        	} 
-
-		if (em()->energy() <= 0) {  
-			// saying node died
-			em()->setenergy(0);
-			((MobileNode*)node())->log_energy(0);
-		}
+		// log node energy, or that the node died
+		log_energy();
 	}
 	
 	return pkt_recvd;
@@ -487,11 +474,7 @@ WirelessPhy::node_wakeup()
 	        update_energy_time_ = NOW;
 		
 		// log node energy
-		if (em()->energy() > 0) {
-			((MobileNode *)node_)->log_energy(1);
-	        } else {
-			((MobileNode *)node_)->log_energy(0);   
-	        }
+		log_energy();
 	}
 }
 
@@ -517,14 +500,27 @@ WirelessPhy::node_sleep()
 	        update_energy_time_ = NOW;
 
 	// log node energy
-		if (em()->energy() > 0) {
-			((MobileNode *)node_)->log_energy(1);
-	        } else {
-			((MobileNode *)node_)->log_energy(0);   
-	        }
+		log_energy();
 	}
 }
 //
+/*
+ * Trace the node's energy after a radio state change.  A lazily
+ * integrated EnergyModel traces only the node's death, when it
+ * finds it.
+ */
+void
+WirelessPhy::log_energy()
+{
+	if (em()->lazy())
+		return;
+	if (em()->energy() > 0) {
+		((MobileNode *)node_)->log_energy(1);
+	} else {
+		((MobileNode *)node_)->log_energy(0);
+	}
+}
+
 void
 WirelessPhy::dump(void) const
 {
@@ -549,11 +545,7 @@ void WirelessPhy::UpdateIdleEnergy()
 	}
 
 	// log node energy
-	if (em()->energy() > 0) {
-		((MobileNode *)node_)->log_energy(1);
-        } else {
-		((MobileNode *)node_)->log_energy(0);   
-        }
+	log_energy();
 
 //	idle_timer_.resched(10.0);
 }
@@ -579,11 +571,7 @@ void WirelessPhy::UpdateSleepEnergy()
 					P_sleep_);
 		  update_energy_time_ = NOW;
 		// log node energy
-		if (em()->energy() > 0) {
-			((MobileNode *)node_)->log_energy(1);
-        	} else {
-			((MobileNode *)node_)->log_energy(0);   
-        	}
+		log_energy();
 	}
 	
 	//A hack to make states consistent with those of in Energy Model for AF
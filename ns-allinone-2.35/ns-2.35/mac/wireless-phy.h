@@ -138,6 +138,7 @@ private:
 	}
 	void UpdateIdleEnergy();
 	void UpdateSleepEnergy();
+	void log_energy();	// trace energy after a state change
 
 	// Convenience method
 	EnergyModel* em() { return node()->energy_model(); }
@@ -60,8 +60,103 @@ public:
 	}
 } class_energy_model;
 
+EnergyModel::EnergyModel(MobileNode* n, double energy, double l1, double l2) :
+	energy_(energy), er_(0), et_(0),ei_(0), es_(0), 
+	initialenergy_(energy), 
+	level1_(l1), level2_(l2), node_(n), 
+	sleep_mode_(0), total_sleeptime_(0), total_rcvtime_(0), 
+	total_sndtime_(0), powersavingflag_(0), 
+	last_time_gosleep(0), max_inroute_time_(300), maxttl_(5), 
+	adaptivefidelity_(1),  node_on_(true), lazy_(0),
+	since_(0), Pmax_(0)
+{
+	neighbor_list.neighbor_cnt_ = 0;
+	neighbor_list.head = NULL;
+	for (int i = 0; i < EM_NSTATES; i++) {
+		res_[i].t_ = res_[i].P_ = 0.0;
+		total_res_[i] = 0.0;
+	}
+	bind_bool("lazy_", &lazy_);
+}
+
+int EnergyModel::command(int argc, const char*const* argv)
+{
+	if (argc == 2) {
+		Tcl& tcl = Tcl::instance();
+		if (strcmp(argv[1], "energy") == 0) {
+			tcl.resultf("%f", energy());
+			return TCL_OK;
+		} else if (strcmp(argv[1], "residency") == 0) {
+			// tx rx idle sleep transition, in seconds
+			tcl.resultf("%f %f %f %f %f", total_res_[EM_TX],
+				    total_res_[EM_RX], total_res_[EM_IDLE],
+				    total_res_[EM_SLEEP],
+				    total_res_[EM_TRANSITION]);
+			return TCL_OK;
+		}
+	}
+	return TclObject::command(argc, argv);
+}
+
+/*
+ * Charge t seconds in a radio state to a lazily integrated model.
+ * The sum only needs to be folded into energy_ before the node can
+ * have run out: until since_ * Pmax_ reaches the energy left at the
+ * last fold the node is certainly alive.
+ */
+void EnergyModel::accrue(int state, double t, double P)
+{
+	if (P != res_[state].P_) {
+		if (res_[state].t_ != 0.0)
+			fold();
+		res_[state].P_ = P;
+		if (P > Pmax_)
+			Pmax_ = P;
+	}
+	res_[state].t_ += t;
+	since_ += t;
+	if (since_ * Pmax_ >= energy_)
+		fold();
+}
+
+void EnergyModel::fold()
+{
+	double dEng[EM_NSTATES];
+	double total = 0.0;
+
+	Pmax_ = 0.0;
+	for (int i = 0; i < EM_NSTATES; i++) {
+		dEng[i] = res_[i].P_ * res_[i].t_;
+		total += dEng[i];
+		res_[i].t_ = 0.0;
+		if (res_[i].P_ > Pmax_)
+			Pmax_ = res_[i].P_;
+	}
+	since_ = 0.0;
+	et_ += dEng[EM_TX];
+	er_ += dEng[EM_RX];
+	ei_ += dEng[EM_IDLE];
+	es_ += dEng[EM_SLEEP];
+
+	if (energy_ <= 0.0)
+		return;
+	if (energy_ <= total) {
+		// the node died somewhere in this interval
+		energy_ = 0.0;
+		God::instance()->ComputeRoute();
+		if (node_)
+			node_->log_energy(0);
+	} else
+		energy_ = energy_ - total;
+}
+
 void EnergyModel::DecrTxEnergy(double txtime, double P_tx) 
 {
+	total_res_[EM_TX] += txtime;
+	if (lazy_) {
+		accrue(EM_TX, txtime, P_tx);
+		return;
+	}
 	double dEng = P_tx * txtime;
 	if (energy_ <= dEng)
 		energy_ = 0.0;
@@ -78,6 +173,11 @@ void EnergyModel::DecrTxEnergy(double txtime, double P_tx)
 
 void EnergyModel::DecrRcvEnergy(double rcvtime, double P_rcv) 
 {
+	total_res_[EM_RX] += rcvtime;
+	if (lazy_) {
+		accrue(EM_RX, rcvtime, P_rcv);
+		return;
+	}
 	double dEng = P_rcv * rcvtime;
 	if (energy_ <= dEng)
 		energy_ = 0.0;
@@ -93,6 +193,11 @@ void EnergyModel::DecrRcvEnergy(double rcvtime, double P_rcv)
 
 void EnergyModel::DecrIdleEnergy(double idletime, double P_idle) 
 {
+	total_res_[EM_IDLE] += idletime;
+	if (lazy_) {
+		accrue(EM_IDLE, idletime, P_idle);
+		return;
+	}
 	double dEng = P_idle * idletime;
 	if (energy_ <= dEng)
 		energy_ = 0.0;
@@ -109,6 +214,11 @@ void EnergyModel::DecrIdleEnergy(double idletime, double P_idle)
 //
 void EnergyModel::DecrSleepEnergy(double sleeptime, double P_sleep) 
 {
+	total_res_[EM_SLEEP] += sleeptime;
+	if (lazy_) {
+		accrue(EM_SLEEP, sleeptime, P_sleep);
+		return;
+	}
 	double dEng = P_sleep * sleeptime;
 	if (energy_ <= dEng)
 		energy_ = 0.0;
@@ -123,6 +233,11 @@ void EnergyModel::DecrSleepEnergy(double sleeptime, double P_sleep)
 
 void EnergyModel::DecrTransitionEnergy(double transitiontime, double P_transition) 
 {
+	total_res_[EM_TRANSITION] += transitiontime;
+	if (lazy_) {
+		accrue(EM_TRANSITION, transitiontime, P_transition);
+		return;
+	}
 	double dEng = P_transition * transitiontime;
 	if (energy_ <= dEng)
 		energy_ = 0.0;
@@ -329,3 +444,113 @@ void AdaptiveFidelityEntity::adapt_it()
 	}
 }
 
+
+static class EnergySnapshotClass : public TclClass
+{
+public:
+	EnergySnapshotClass() : TclClass("EnergySnapshot") {}
+	TclObject *create(int, const char*const*) {
+		return (new EnergySnapshot());
+	}
+} class_energy_snapshot;
+
+EnergySnapshot::EnergySnapshot() : channel_(0), running_(0), rec_(0), nrec_(0)
+{
+	bind("interval_", &interval_);
+}
+
+EnergySnapshot::~EnergySnapshot()
+{
+	delete [] rec_;
+}
+
+int EnergySnapshot::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "start") == 0) {
+			if (interval_ <= 0) {
+				tcl.resultf("EnergySnapshot: interval_ must be "
+					    "positive, not %g", interval_);
+				return TCL_ERROR;
+			}
+			if (!running_) {
+				running_ = 1;
+				Scheduler::instance().schedule(this, &intr_, 0);
+			}
+			return TCL_OK;
+		} else if (strcmp(argv[1], "stop") == 0) {
+			if (running_) {
+				running_ = 0;
+				Scheduler::instance().cancel(&intr_);
+			}
+			return TCL_OK;
+		} else if (strcmp(argv[1], "snapshot") == 0) {
+			snapshot();
+			return TCL_OK;
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "attach") == 0) {
+			int mode;
+			channel_ = Tcl_GetChannel(tcl.interp(), (char*)argv[2],
+						  &mode);
+			if (channel_ == 0) {
+				tcl.resultf("EnergySnapshot: can't attach %s",
+					    argv[2]);
+				return TCL_ERROR;
+			}
+			return TCL_OK;
+		}
+	}
+	return TclObject::command(argc, argv);
+}
+
+void EnergySnapshot::handle(Event *)
+{
+	snapshot();
+	if (interval_ > 0)
+		Scheduler::instance().schedule(this, &intr_, interval_);
+	else
+		running_ = 0;	// interval_ set to 0 since "start": stop
+}
+
+void EnergySnapshot::snapshot()
+{
+	EnergySnapshotHdr h;
+	Node *n;
+	int i = 0;
+
+	if (channel_ == 0)
+		return;
+	for (n = Node::nodehead_.lh_first; n; n = n->nextnode())
+		if (n->energy_model())
+			i++;
+	if (i > nrec_) {
+		delete [] rec_;
+		nrec_ = i;
+		rec_ = new EnergySnapshotRec[nrec_];
+	}
+
+	i = 0;
+	for (n = Node::nodehead_.lh_first; n; n = n->nextnode()) {
+		EnergyModel *em = n->energy_model();
+		if (em == 0)
+			continue;
+		EnergySnapshotRec *r = &rec_[i++];
+		r->node_ = n->address();
+		r->energy_ = em->energy();
+		r->et_ = em->et();
+		r->er_ = em->er();
+		r->ei_ = em->ei();
+		r->es_ = em->es();
+		r->flags_ = (em->alive() ? ES_ALIVE : 0) |
+			(em->sleep() ? ES_SLEEP : 0);
+	}
+	h.time_ = Scheduler::instance().clock();
+	h.nnodes_ = i;
+	h.reclen_ = sizeof(EnergySnapshotRec);
+	(void)Tcl_Write(channel_, (char*)&h, sizeof(h));
+	if (i > 0)
+		(void)Tcl_Write(channel_, (char*)rec_,
+				i * sizeof(EnergySnapshotRec));
+}
@@ -84,33 +84,42 @@ protected:
 	Event  intr;
 };
 
+/*
+ * Radio states a lazily integrated EnergyModel keeps residency for
+ */
+enum EnergyState {
+	EM_TX = 0, EM_RX = 1, EM_IDLE = 2, EM_SLEEP = 3, EM_TRANSITION = 4,
+	EM_NSTATES = 5
+};
+
 class MobileNode;
 class EnergyModel : public TclObject {
 public:
-	EnergyModel(MobileNode* n, double energy, double l1, double l2) :
-		energy_(energy), er_(0), et_(0),ei_(0), es_(0), 
-		initialenergy_(energy), 
-		level1_(l1), level2_(l2), node_(n), 
-		sleep_mode_(0), total_sleeptime_(0), total_rcvtime_(0), 
-		total_sndtime_(0), powersavingflag_(0), 
-		last_time_gosleep(0), max_inroute_time_(300), maxttl_(5), 
-		adaptivefidelity_(1),  node_on_(true)
-	{
-		neighbor_list.neighbor_cnt_ = 0;
-		neighbor_list.head = NULL;
-	}
+	EnergyModel(MobileNode* n, double energy, double l1, double l2);
+	int command(int argc, const char*const* argv);
 
-	inline double energy() const { return energy_; }
+	/*
+	 * With lazy_ set, the Decr*Energy() calls only add the time to
+	 * the residency of the radio state; energy_ and the per-state
+	 * totals are brought up to date (fold()) when somebody asks for
+	 * them, when a state's power draw changes, or when the residency
+	 * accrued since the last fold could have drained the battery.
+	 * alive() is exact in either mode without folding.
+	 */
+	inline double energy() { if (lazy_) fold(); return energy_; }
+	inline int alive() const { return (energy_ > 0.0); }
+	inline int lazy() const { return lazy_; }
 //
-	inline double et() const { return et_; }
-	inline double er() const { return er_; }
-	inline double ei() const { return ei_; }
-	inline double es() const { return es_; }
+	inline double et() { if (lazy_) fold(); return et_; }
+	inline double er() { if (lazy_) fold(); return er_; }
+	inline double ei() { if (lazy_) fold(); return ei_; }
+	inline double es() { if (lazy_) fold(); return es_; }
+	inline double residency(int s) const { return total_res_[s]; }
 //
 	inline double initialenergy() const { return initialenergy_; }
 	inline double level1() const { return level1_; }
 	inline double level2() const { return level2_; }
-	inline void setenergy(double e) { energy_ = e; }
+	inline void setenergy(double e) { if (lazy_) fold(); energy_ = e; }
    
 	virtual void DecrTxEnergy(double txtime, double P_tx);
 	virtual void DecrRcvEnergy(double rcvtime, double P_rcv);
@@ -120,13 +129,13 @@ public:
 	virtual void DecrTransitionEnergy(double transitiontime, double P_transition);
 //	
 	inline virtual double MaxTxtime(double P_tx) {
-		return(energy_/P_tx);
+		return(energy()/P_tx);
 	}
 	inline virtual double MaxRcvtime(double P_rcv) {
-		return(energy_/P_rcv);
+		return(energy()/P_rcv);
 	}
 	inline virtual double MaxIdletime(double P_idle) {
-		return(energy_/P_idle);
+		return(energy()/P_idle);
 	}
 
 	void add_neighbor(u_int32_t);      // for adaptive fidelity
@@ -164,6 +173,9 @@ public:
 	enum SleepState { WAITING = 0, POWERSAVING = 1, INROUTE = 2 };
 
 protected:
+	void accrue(int state, double t, double P);
+	void fold();
+
 	double energy_;
 //
 	double er_; // Total energy consumption in RECV
@@ -209,6 +221,54 @@ protected:
        	AdaptiveFidelityEntity *afe_;
 
 	bool node_on_;   	 // on-off status of this node -- Chalermek
+
+	int lazy_;		 // integrate energy on demand
+	struct {
+		double t_;	 // residency since the last fold
+		double P_;	 // power draw it accrued at
+	} res_[EM_NSTATES];
+	double total_res_[EM_NSTATES];	// residency over the whole run
+	double since_;		 // residency since the last fold, all states
+	double Pmax_;		 // largest power draw in res_
+};
+
+/*
+ * Periodic binary dump of every node's battery, for studies where
+ * a trace line per radio transition is too much.  Each snapshot is
+ * an EnergySnapshotHdr followed by one EnergySnapshotRec per node
+ * with an energy model, in host byte order; the Tcl channel given to
+ * "attach" should be configured with -translation binary.
+ */
+struct EnergySnapshotHdr {
+	double		time_;
+	int32_t		nnodes_;
+	int32_t		reclen_;	// sizeof(EnergySnapshotRec)
+};
+
+struct EnergySnapshotRec {
+	int32_t		node_;		// node address
+	int32_t		flags_;		// ES_ALIVE | ES_SLEEP
+	double		energy_;
+	double		et_, er_, ei_, es_;
+};
+
+#define ES_ALIVE	0x1
+#define ES_SLEEP	0x2
+
+class EnergySnapshot : public TclObject, public Handler {
+public:
+	EnergySnapshot();
+	~EnergySnapshot();
+	int command(int argc, const char*const* argv);
+	void handle(Event *);
+	void snapshot();
+protected:
+	Tcl_Channel channel_;
+	double interval_;
+	int running_;
+	EnergySnapshotRec *rec_;
+	int nrec_;
+	Event intr_;
 };
 
 
@@ -0,0 +1,59 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * fading.cc
+ *
+ * Block-buffered variates for the shadowing propagation model; see
+ * fading.h.
+ */
+
+#include <math.h>
+
+#include "fading.h"
+
+FadingStream::FadingStream(RNG *rng) : rng_(rng)
+{
+	reset();
+}
+
+void
+FadingStream::reset()
+{
+	nz_ = FADING_BLOCK;
+}
+
+/*
+ * Box-Muller in its trigonometric form: unlike the polar method used
+ * by RNG::normal it has no rejection loop, so every pair of uniforms
+ * gives a pair of normals and the transform is a straight array loop.
+ */
+void
+FadingStream::refill_normal()
+{
+	double *u1 = z_, *u2 = z_ + FADING_BLOCK / 2;
+	int i;
+
+	/* the uniform pairs are transformed in place */
+	for (i = 0; i < FADING_BLOCK / 2; i++) {
+		u1[i] = rng_->uniform();
+		u2[i] = rng_->uniform();
+	}
+	for (i = 0; i < FADING_BLOCK / 2; i++) {
+		double r = sqrt(-2.0 * log(u1[i]));
+		double th = 2.0 * M_PI * u2[i];
+		u2[i] = r * sin(th);
+		u1[i] = r * cos(th);
+	}
+	nz_ = 0;
+}
+
+void
+FadingStream::fill_shadow(double *v, int n, double std_db)
+{
+	double k = std_db * M_LN10 / 10.0;
+	int i;
+
+	for (i = 0; i < n; i++)
+		v[i] = normal();
+	for (i = 0; i < n; i++)
+		v[i] = exp(k * v[i]);
+}
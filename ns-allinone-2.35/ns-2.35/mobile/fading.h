@@ -0,0 +1,55 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * fading.h
+ *
+ * Block-buffered variates for the shadowing propagation model.
+ *
+ * Shadowing draws a normal variate for every receiver of every frame.
+ * A FadingStream draws them from one RNG in blocks: the uniforms of a
+ * block are taken from the stream in one loop, and the transforms
+ * (Box-Muller normals, the dB to linear shadowing factor) are then
+ * applied over the whole block in plain array loops that the compiler
+ * can vectorize.
+ *
+ * The variates depend only on the RNG's seed and on how many have been
+ * taken from the stream, never on other users of the default RNG, so a
+ * model's fading is reproducible per stream.  (RNG::normal keeps its
+ * spare Box-Muller sample in a static, shared by all streams.)
+ */
+
+#ifndef ns_fading_h
+#define ns_fading_h
+
+#include "rng.h"
+
+#define FADING_BLOCK	256	// variates drawn per refill (even)
+
+class FadingStream {
+public:
+	FadingStream(RNG *rng);
+
+	inline double normal() {
+		if (nz_ == FADING_BLOCK)
+			refill_normal();
+		return z_[nz_++];
+	}
+
+	/*
+	 * n fading power factors for receivers at mean power 1; shadowing
+	 * is 10^(N(0, std_db)/10), the log-normal factor as a power ratio
+	 */
+	void fill_shadow(double *v, int n, double std_db);
+
+	/* forget the buffered variates, e.g. after the RNG is reseeded */
+	void reset();
+	inline RNG* rng() { return rng_; }
+
+protected:
+	void refill_normal();
+
+	RNG	*rng_;
+	double	z_[FADING_BLOCK];	// standard normals
+	int	nz_;
+};
+
+#endif /* ns_fading_h */
@@ -68,6 +68,47 @@
 #include <ranvar.h>
 #include <nakagami.h>
 
+/*
+ * ErlangRandomVariable(lambda, k).value() and GammaRandomVariable(alpha,
+ * beta).value() on the default RNG, without creating a TclObject for
+ * every reception.
+ */
+static double erlang(RNG *rng, double lambda, int k)
+{
+	double result = 0;
+	for (int i = 0; i < k; i++) {
+		result += rng->exponential(lambda);
+	}
+	return result;
+}
+
+static double gamma(RNG *rng, double alpha, double beta)
+{
+	if (alpha < 1) {
+		double u = rng->uniform(1.0);
+		return gamma(rng, 1.0 + alpha, beta) * pow (u, 1.0 / alpha);
+	}
+
+	double x, v, u;
+	double d = alpha - 1.0 / 3.0;
+	double c = (1.0 / 3.0) / sqrt (d);
+
+	while (1) {
+		do {
+			x = rng->normal(0.0, 1.0);
+			v = 1.0 + c * x;
+		} while (v <= 0);
+
+		v = v * v * v;
+		u = rng->uniform(1.0);
+		if (u < 1 - 0.0331 * x * x * x * x)
+			break;
+		if (log (u) < 0.5 * x * x + d * (1 - v + log (v)))
+			break;
+	}
+	return beta * d * v;
+}
+
 static class NakagamiClass: public TclClass {
 public: 
 	NakagamiClass() : TclClass("Propagation/Nakagami") {}
@@ -114,6 +155,29 @@ Nakagami::~Nakagami()
 	//
 }
 
+double Nakagami::mfactor(double dist)
+{
+	if ( dist <= d0_m)
+		return m0;
+	else if ( dist <= d1_m)
+		return m1; 
+	else
+		return m2;
+}
+
+void Nakagami::fading(double *v, int n, double dist)
+{
+	double m = mfactor(dist);
+	unsigned int int_m = (unsigned int)(floor (m));
+
+	for (int i = 0; i < n; i++) {
+		if (int_m == m)
+			v[i] = erlang(RNG::defaultrng(), 1.0/m, int_m);
+		else
+			v[i] = gamma(RNG::defaultrng(), m, 1.0/m);
+	}
+}
+
 
 double Nakagami::Pr(PacketStamp *t, PacketStamp *r, WirelessPhy *ifp)
 {
@@ -168,28 +232,39 @@ double Nakagami::Pr(PacketStamp *t, PacketStamp *r, WirelessPhy *ifp)
  	if (!use_nakagami_dist_) {
  		return Pr; 
  	} else {
- 		double m;
- 		if ( dist <= d0_m)
- 			m = m0;
- 		else if ( dist <= d1_m)
- 			m = m1; 
- 		else
- 			m = m2;
+ 		double m = mfactor(dist);
  		unsigned int int_m = (unsigned int)(floor (m));
  		
  		double resultPower;
  		
-        if (int_m == m) {
- 			resultPower = ErlangRandomVariable(Pr/m, int_m).value();
+		if (int_m == m) {
+ 			resultPower = erlang(RNG::defaultrng(), Pr/m, int_m);
  		} else {
- 			resultPower = GammaRandomVariable(m, Pr/m).value();
+ 			resultPower = gamma(RNG::defaultrng(), m, Pr/m);
  		}
  		return resultPower;
 	}
 }	
 
-int Nakagami::command(int , const char* const* )
+int Nakagami::command(int argc, const char* const* argv)
 {
+	if (argc == 4 && strcmp(argv[1], "fading") == 0) {
+		// $prop fading <n> <dist>: mean of n fading factors
+		int n = atoi(argv[2]);
+		if (n <= 0) {
+			Tcl::instance().resultf("%s: fading needs n > 0, got %s",
+						TclObject::name(), argv[2]);
+			return(TCL_ERROR);
+		}
+		double *v = new double[n];
+		double sum = 0.0;
+		fading(v, n, atof(argv[3]));
+		for (int i = 0; i < n; i++)
+			sum += v[i];
+		delete [] v;
+		Tcl::instance().resultf("%g", sum / n);
+		return(TCL_OK);
+	}
 	return 0;
 }
 
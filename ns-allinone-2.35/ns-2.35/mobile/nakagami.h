@@ -71,7 +71,12 @@ public:
 	virtual double Pr(PacketStamp *tx, PacketStamp *rx, WirelessPhy *ifp);
 	virtual int command(int argc, const char*const* argv);
 	virtual double getDist(double Pr, double Pt, double Gt, double Gr, double hr, double ht, double L, double lambda);
+
+	/* fading factors (mean 1) of n receivers at distance dist */
+	void fading(double *v, int n, double dist);
 protected:
+	double mfactor(double dist);
+
 	RNG *ranVar;	// random number generator for normal distribution
 	double gamma0,gamma1, gamma2;
 	double d0_gamma,d1_gamma;
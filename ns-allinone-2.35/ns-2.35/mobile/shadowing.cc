@@ -81,13 +81,19 @@ Shadowing::Shadowing()
 	bind("dist0_", &dist0_);
 	bind("seed_", &seed_);
 	
+	bind_bool("batch_", &batch_);
+	
 	ranVar = new RNG;
 	ranVar->set_seed(RNG::PREDEF_SEED_SOURCE, seed_);
+	fading_ = new FadingStream(ranVar);
+	nf_ = FADING_BLOCK;
+	fstd_ = 0.0;
 }
 
 
 Shadowing::~Shadowing()
 {
+	delete fading_;
 	delete ranVar;
 }
 
@@ -123,6 +129,20 @@ double Shadowing::Pr(PacketStamp *t, PacketStamp *r, WirelessPhy *ifp)
 	// calculate receiving power at reference distance
 	double Pr0 = Friis(t->getTxPr(), Gt, Gr, lambda, L, dist0_);
 
+	if (batch_) {
+		// the same model, with the log-normal factor taken from a
+		// block of factors drawn by fading()
+		if (nf_ == FADING_BLOCK || fstd_ != std_db_) {
+			fading(fbuf_, FADING_BLOCK);
+			fstd_ = std_db_;
+			nf_ = 0;
+		}
+		double Pr = Pr0 * fbuf_[nf_++];
+		if (dist > dist0_)
+			Pr *= pow(dist/dist0_, -pathlossExp_);
+		return Pr;
+	}
+
 	// calculate average power loss predicted by path loss model
 	double avg_db;
         if (dist > dist0_) {
@@ -142,8 +162,36 @@ double Shadowing::Pr(PacketStamp *t, PacketStamp *r, WirelessPhy *ifp)
 }
 
 
+void Shadowing::fading(double *v, int n)
+{
+	if (batch_) {
+		fading_->fill_shadow(v, n, std_db_);
+		return;
+	}
+	for (int i = 0; i < n; i++)
+		v[i] = pow(10.0, ranVar->normal(0.0, std_db_)/10.0);
+}
+
+
 int Shadowing::command(int argc, const char* const* argv)
 {
+	if (argc == 3 && strcmp(argv[1], "fading") == 0) {
+		// $prop fading <n>: mean of n shadowing factors
+		int n = atoi(argv[2]);
+		if (n <= 0) {
+			Tcl::instance().resultf("%s: fading needs n > 0, got %s",
+						TclObject::name(), argv[2]);
+			return(TCL_ERROR);
+		}
+		double *v = new double[n];
+		double sum = 0.0;
+		fading(v, n);
+		for (int i = 0; i < n; i++)
+			sum += v[i];
+		delete [] v;
+		Tcl::instance().resultf("%g", sum / n);
+		return(TCL_OK);
+	}
 	if (argc == 4) {
 		if (strcmp(argv[1], "seed") == 0) {
 			int s = atoi(argv[3]);
@@ -156,6 +204,8 @@ int Shadowing::command(int argc, const char* const* argv)
 			} else if (strcmp(argv[2], "heuristic") == 0) {
 				ranVar->set_seed(RNG::HEURISTIC_SEED_SOURCE, 0);
 			}
+			fading_->reset();
+			nf_ = FADING_BLOCK;
 			return(TCL_OK);
 		}
 	}
@@ -60,6 +60,7 @@
 #include <propagation.h>
 #include <rng.h>
 #include <float.h>
+#include <fading.h>
 
 class Shadowing : public Propagation {
 public:
@@ -70,8 +71,16 @@ public:
 			       double hr, double ht, double L, double lambda);
 	virtual int command(int argc, const char*const* argv);
 
+	/* shadowing factors (mean power 1) of n receivers */
+	void fading(double *v, int n);
+
 protected:
 	RNG *ranVar;	// random number generator for normal distribution
+	FadingStream *fading_;	// ranVar in blocks, for batch_
+	int batch_;
+	double fbuf_[FADING_BLOCK];	// factors from fading(), for Pr()
+	int nf_;			// next unused in fbuf_
+	double fstd_;			// std_db_ fbuf_ was filled for
 	
 	double pathlossExp_;	// path-loss exponent
 	double std_db_;		// shadowing deviation (dB),
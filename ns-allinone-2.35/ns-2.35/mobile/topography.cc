@@ -125,13 +125,6 @@ Topography::load_demfile(const char *fname)
 }
 
 
-void 
-Topography::updateNodesList(class MobileNode* mn, double oldX)
-{
-	channel_->updateNodesList(mn, oldX);
-}
-
-
 int
 Topography::command(int argc, const char*const* argv)
 {
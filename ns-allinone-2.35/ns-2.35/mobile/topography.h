@@ -48,9 +48,6 @@ class Topography : public TclObject {
 public:
 	Topography() { maxX = maxY = grid_resolution = 0.0; grid = 0; }
 
-	/* List-keeper */
-	void updateNodesList(class MobileNode *mn, double oldX);
-	
 	double	lowerX() { return 0.0; }
 	double	upperX() { return maxX * grid_resolution; }
 	double	lowerY() { return 0.0; }
@@ -69,7 +66,8 @@ private:
 	double	grid_resolution;
 	int*	grid;
 
-	/* List-keeper */
+	/* channel given by "channel"; nodes now keep their own
+	   per-channel list entries (MobileNode::chanlist_) */
 	WirelessChannel *channel_;
 
 };
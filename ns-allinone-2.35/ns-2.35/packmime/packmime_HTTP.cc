@@ -67,7 +67,7 @@ PackMimeHTTP::PackMimeHTTP() :
 	interval_(0), ID_(-1), run_(0), debug_(0), 
 	cur_pairs_(0), warmup_(0), http_1_1_(false), 
 	use_pm_persist_rspsz_(true), use_pm_persist_reqsz_(true),
-	active_connections_(0), total_connections_(-1), running_(0), 
+	fast_setup_(false), active_connections_(0), total_connections_(-1), running_(0), 
 	flowarrive_rv_(NULL), reqsize_rv_(NULL), rspsize_rv_(NULL), 
 	persist_rspsize_rv_(NULL), persistent_rv_(NULL), num_pages_rv_(NULL),
 	single_obj_rv_(NULL), objs_per_page_rv_(NULL), time_btwn_pages_rv_(NULL),
@@ -75,7 +75,7 @@ PackMimeHTTP::PackMimeHTTP() :
 	flowarrive_rng_(NULL), reqsize_rng_(NULL), rspsize_rng_(NULL), 
 	persist_rspsize_rng_(NULL), persistent_rng_(NULL), num_pages_rng_(NULL), 
 	single_obj_rng_(NULL), objs_per_page_rng_(NULL), time_btwn_pages_rng_(NULL),
-	time_btwn_objs_rng_(NULL), server_delay_rng_(NULL)
+	time_btwn_objs_rng_(NULL), server_delay_rng_(NULL), nodePool_(0)
 {
 	int i;
 
@@ -148,6 +148,8 @@ PackMimeHTTP::~PackMimeHTTP()
 		tcl.evalf ("delete %s", tcp->name());
 		tcpPool_.pop();
 	}
+	while ((tcp = nodePool_.drain()) != NULL)
+		tcl.evalf ("delete %s", tcp->name());
 	
 	// delete RNGs and Random Variables
 	cleanup();
@@ -161,18 +163,79 @@ PackMimeHTTP::~PackMimeHTTP()
  		fclose(samplesfp_);
 }
 
+FullTcpAgent* PackMimeHTTP::alloctcp()
+{
+	Tcl& tcl = Tcl::instance();
+	tcl.evalf ("%s alloc-tcp %s", name(), tcptype_);
+	FullTcpAgent* a = (FullTcpAgent*) lookup_obj (tcl.result());
+	if (a == NULL) {
+		fprintf (stderr, "Failed to allocate a TCP agent\n");
+		abort();
+	}
+	return a;
+}
+
+/*
+ * With fast setup: an idle agent already attached to node, or a new
+ * one attached to it.
+ */
+FullTcpAgent* PackMimeHTTP::picktcp(Node* node)
+{
+	FullTcpAgent* a = nodePool_.get(node, now());
+	if (a != NULL) {
+		if (debug_ > 1)
+			fprintf (stderr, "\tflow %d got TCPAgent %s from pool "
+				 "(%d in pool)\n", total_connections_, 
+				 a->name(), nodePool_.size());
+		return a;
+	}
+	a = alloctcp();
+	Tcl::instance().evalf ("%s attach %s", node->name(), a->name());
+	home_[a] = node;
+	if (debug_ > 1)
+		fprintf (stderr, "\tflow %d created new TCPAgent %s\n",
+			 total_connections_, a->name());
+	return a;
+}
+
+/*
+ * Create n agents per client and server node, attached and ready in the
+ * node pools, and n client and server apps per node pair, before the
+ * simulation runs rather than as connections start.
+ */
+void PackMimeHTTP::prewarm(int n)
+{
+	Tcl& tcl = Tcl::instance();
+	int nodes = next_client_ind_ < next_server_ind_ ?
+		next_client_ind_ : next_server_ind_;
+	for (int i = 0; i < nodes; i++) {
+		for (int k = 0; k < n; k++) {
+			if (fast_setup_) {
+				Node* pair[2] = { client_[i], server_[i] };
+				for (int j = 0; j < 2; j++) {
+					FullTcpAgent* a = alloctcp();
+					tcl.evalf ("%s attach %s", 
+						   pair[j]->name(), a->name());
+					home_[a] = pair[j];
+					nodePool_.put (pair[j], a, now());
+				}
+			}
+			tcl.evalf ("%s alloc-client-app", name());
+			clientAppPool_.push ((PackMimeHTTPClientApp*) 
+					     lookup_obj (tcl.result()));
+			tcl.evalf ("%s alloc-server-app", name());
+			serverAppPool_.push ((PackMimeHTTPServerApp*) 
+					     lookup_obj (tcl.result()));
+		}
+	}
+}
+
 FullTcpAgent* PackMimeHTTP::picktcp()
 {
 	FullTcpAgent* a;
-	Tcl& tcl = Tcl::instance();
 
 	if (tcpPool_.empty()) {
-		tcl.evalf ("%s alloc-tcp %s", name(), tcptype_);
-		a = (FullTcpAgent*) lookup_obj (tcl.result());
-		if (a == NULL) {
-			fprintf (stderr, "Failed to allocate a TCP agent\n");
-			abort();
-		}
+		a = alloctcp();
 		if (debug_ > 1) {
 			fprintf (stderr, 
 				 "\tflow %d created new TCPAgent %s\n",
@@ -284,7 +347,10 @@ void PackMimeHTTP::recycle(FullTcpAgent* agent)
 	agent->reset();
 
 	// add to the inactive agent pool
-	tcpPool_.push (agent);
+	if (fast_setup_)
+		nodePool_.put (home_[agent], agent, now());
+	else
+		tcpPool_.push (agent);
 
 	if (debug_ > 2) {
 		fprintf (stderr, "\tTCPAgent %s moved to pool ", 
@@ -461,31 +527,47 @@ void PackMimeHTTP::setup_connection()
 		 name(), total_connections_, active_connections_, now());
 	}
 
-	// pick tcp agent for client and server
-	FullTcpAgent* ctcp = picktcp();
-	FullTcpAgent* stcp = picktcp();
-
 	// rotate through nodes assigning connections
 	current_node_++;
 	if (current_node_ >= total_nodes_)
 		current_node_ = 0;
 
-	// attach agents to nodes (server_ client_)
-	tcl.evalf ("%s attach %s", server_[current_node_]->name(), 
-		   stcp->name());
-	tcl.evalf ("%s attach %s", client_[current_node_]->name(), 
-		   ctcp->name());
+	FullTcpAgent* ctcp;
+	FullTcpAgent* stcp;
+	if (fast_setup_) {
+		// agents stay attached to their nodes; the rest of
+		// setup-tcp and "$ns connect" done here
+		ctcp = picktcp(client_[current_node_]);
+		stcp = picktcp(server_[current_node_]);
+		stcp->setup(total_connections_, -1, -1, this);
+		ctcp->setup(total_connections_, -1, -1, this);
+		ctcp->daddr() = stcp->addr();
+		ctcp->dport() = stcp->port();
+		stcp->daddr() = ctcp->addr();
+		stcp->dport() = ctcp->port();
+		((Agent*) stcp)->listen();
+	} else {
+		// pick tcp agent for client and server
+		ctcp = picktcp();
+		stcp = picktcp();
 
-	// set TCP options
-	tcl.evalf ("%s setup-tcp %s %d", name(), stcp->name(), 
-		   total_connections_);
-	tcl.evalf ("%s setup-tcp %s %d", name(), ctcp->name(),
-		   total_connections_);
+		// attach agents to nodes (server_ client_)
+		tcl.evalf ("%s attach %s", server_[current_node_]->name(), 
+			   stcp->name());
+		tcl.evalf ("%s attach %s", client_[current_node_]->name(), 
+			   ctcp->name());
 
-	// setup connection between client and server
-	tcl.evalf ("set ns [Simulator instance]");
-	tcl.evalf ("$ns connect %s %s", ctcp->name(), stcp->name());
-	tcl.evalf ("%s listen", stcp->name());
+		// set TCP options
+		tcl.evalf ("%s setup-tcp %s %d", name(), stcp->name(), 
+			   total_connections_);
+		tcl.evalf ("%s setup-tcp %s %d", name(), ctcp->name(),
+			   total_connections_);
+
+		// setup connection between client and server
+		tcl.evalf ("set ns [Simulator instance]");
+		tcl.evalf ("$ns connect %s %s", ctcp->name(), stcp->name());
+		tcl.evalf ("%s listen", stcp->name());
+	}
 
 	// create PackMimeHTTPApps
 	PackMimeHTTPClientApp* client_app = pickClientApp();
@@ -972,44 +1054,56 @@ int PackMimeHTTP::command(int argc, const char*const* argv) {
 		else if (strcmp (argv[1], "recycle") == 0) {
 			FullTcpAgent* tcp = (FullTcpAgent*) 
 				lookup_obj(argv[2]);
-			
-			/*
-			 * Need to wait to recycle server until client
-			 * is done.  Fortunately, client has
-			 * a handle to the server.
-			 */
-
-			// find client app associated with this agent
-			map<string, PackMimeHTTPClientApp*>::iterator ca_iter = 
-				clientAppActive_.find(tcp->name());
-			if (ca_iter == clientAppActive_.end()) {
-				// this isn't a client app, but a server app
-				return (TCL_OK);
-			}
-
-			PackMimeHTTPClientApp* ca = ca_iter->second;
-			PackMimeHTTPServerApp* sa = ca->get_server();
-			FullTcpAgent* stcp = (FullTcpAgent*) 
-				lookup_obj(sa->get_agent_name());
-
-			if (debug_ > 1)
-			      fprintf (stderr, "client %s (%d)> DONE at %f\n",
-					 ca->name(), ca->get_id(), now());
-
-			// remove apps from active pools and put 
-			// in inactive pools
-			recycle ((FullTcpAgent*) tcp);
-			recycle ((FullTcpAgent*) stcp);
-			recycle (ca);
-			recycle (sa);
-
-			active_connections_--;   // one less active conn
+			return crecycle(tcp);
+		}
+		else if (strcmp (argv[1], "set-fast-setup") == 0) {
+			fast_setup_ = atoi (argv[2]) != 0;
+			return (TCL_OK);
+		}
+		else if (strcmp (argv[1], "prewarm") == 0) {
+			prewarm (atoi (argv[2]));
 			return (TCL_OK);
 		}
 	}
 	return TclObject::command(argc, argv);
 }
 
+int PackMimeHTTP::crecycle(FullTcpAgent* tcp)
+{
+	/*
+	 * Need to wait to recycle server until client
+	 * is done.  Fortunately, client has
+	 * a handle to the server.
+	 */
+
+	// find client app associated with this agent
+	map<string, PackMimeHTTPClientApp*>::iterator ca_iter = 
+		clientAppActive_.find(tcp->name());
+	if (ca_iter == clientAppActive_.end()) {
+		// this isn't a client app, but a server app
+		return (TCL_OK);
+	}
+
+	PackMimeHTTPClientApp* ca = ca_iter->second;
+	PackMimeHTTPServerApp* sa = ca->get_server();
+	FullTcpAgent* stcp = (FullTcpAgent*) 
+		lookup_obj(sa->get_agent_name());
+
+	if (debug_ > 1)
+		fprintf (stderr, "client %s (%d)> DONE at %f\n",
+			 ca->name(), ca->get_id(), now());
+
+	// remove apps from active pools and put 
+	// in inactive pools
+	recycle ((FullTcpAgent*) tcp);
+	recycle ((FullTcpAgent*) stcp);
+	recycle (ca);
+	recycle (sa);
+
+	active_connections_--;   // one less active conn
+	return (TCL_OK);
+}
+
 
 /*:::::::::::::::::::::::::::: PACKMIMETIMER ::::::::::::::::::::::::::::::::*/
 
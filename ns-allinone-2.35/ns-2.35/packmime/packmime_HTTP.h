@@ -48,6 +48,8 @@
 #include "app.h"
 #include "node.h"
 #include "packmime_ranvar.h"
+#include "tcp-full.h"
+#include "conn-pool.h"
 #include <string>
 #include <stack>
 #include <queue>
@@ -180,12 +182,14 @@ class PackMimeHTTPServerApp : public Application {
 
 /*::::::::::::::::::::::::: class PACKMIME :::::::::::::::::::::::::::::::::*/
 
-class PackMimeHTTP : public TclObject {
+class PackMimeHTTP : public TclObject, public FullTcpDone {
  public:
 	PackMimeHTTP();
 	~PackMimeHTTP();
 	void recycle (PackMimeHTTPClientApp*);
 	void recycle (PackMimeHTTPServerApp*);
+	int crecycle (FullTcpAgent*);
+	void tcpdone (FullTcpAgent* tcp) { crecycle (tcp); }
 	void setup_connection ();
 	void incr_pairs();
 
@@ -227,8 +231,11 @@ class PackMimeHTTP : public TclObject {
 	void recycle (FullTcpAgent*);
 
 	FullTcpAgent* picktcp();
+	FullTcpAgent* picktcp(Node* node);
+	FullTcpAgent* alloctcp();
 	PackMimeHTTPServerApp* pickServerApp();
 	PackMimeHTTPClientApp* pickClientApp();	
+	void prewarm(int n);
 
 	PackMimeHTTPTimer timer_;
 	double connection_interval_;  // set in setup_connection()
@@ -259,6 +266,7 @@ class PackMimeHTTP : public TclObject {
 	bool http_1_1_;            // use HTTP 1.1?  (default: no)
 	bool use_pm_persist_rspsz_; // use PM response sizes for persistent conns (def: yes)
 	bool use_pm_persist_reqsz_; // use PM request size rule for persistent conns (def: yes)
+	bool fast_setup_;          // set up connections in C++, agents pooled by node
 
 	int active_connections_;   // number of active connections
 	int total_connections_;    // number of total connections
@@ -306,6 +314,8 @@ class PackMimeHTTP : public TclObject {
 
 	// Agent and App Pools	
 	std::queue<FullTcpAgent*> tcpPool_;
+	ConnPool<FullTcpAgent*> nodePool_;	// tcpPool_ with fast_setup_
+	map<FullTcpAgent*, Node*> home_;	// node of each agent in nodePool_
 	std::queue<PackMimeHTTPClientApp*> clientAppPool_;
 	std::queue<PackMimeHTTPServerApp*> serverAppPool_;
 
@@ -66,14 +66,20 @@ FX::~FX()
 
 double FX::LinearInterpolate (double xnew)
 {
-	int i;
-
-	// we should use binary search if nsteps is large, but for now...
-	for (i=0; i<nsteps_-2; i++) {
-		if (xnew < x_[i+1]) {
-			return (y_[i] + slope_[i]*(xnew-x_[i]));
-		}	
+	int lo, hi, mid;
+
+	// binary search for the first x_[i+1] above xnew, i < nsteps_-2
+	lo = 1;
+	hi = nsteps_-1;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (xnew < x_[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
+	if (lo < nsteps_-1)
+		return (y_[lo-1] + slope_[lo-1]*(xnew-x_[lo-1]));
 
 	return (y_[nsteps_-1] + slope_[nsteps_-1]*(xnew-x_[nsteps_-1]));
 }
@@ -105,7 +111,7 @@ FARIMA::FARIMA(RNG* rng, double d, int N, int pAR, int qMA) :
 
 	if (qMA)
 		MA_ = new double[qMA];
-	x_ = new double [N];
+	x_ = new double [2*N];
 	phi_ = new double [N];
 
 	/** use 1-theta[1] B-theta[2] B^2 - ..., and 
@@ -121,6 +127,13 @@ FARIMA::FARIMA(RNG* rng, double d, int N, int pAR, int qMA) :
 	/* skip the first few in simulation to stablize */
 	while (t_ < N + pAR + qMA)
 		NextLow();
+
+	/** from here on phi_ is fixed, and Next() keeps x_[N..2N) a
+	 * copy of x_[0..N) so that x_[N+tmod_-j] is x[t-j] for all j
+	 */
+	sd_ = pow(phi_[0], 0.5);
+	for (int i=0; i<N; i++)
+		x_[N+i] = x_[i];
 }
 
 FARIMA::~FARIMA()
@@ -194,19 +207,19 @@ double FARIMA::NextLow()
 double FARIMA::Next()
 {
 	double mt, xt, yt;
-	int j, m;
+	const double* x;
+	int j;
 
 	/* get m_t, v_t */
 	mt = 0;
-	for (j=1; j<=tmod_; j++)
-		mt += phi_[j] * x_[tmod_-j];
-
-	for (j=tmod_+1; j<=N_-1; j++)
-		mt += phi_[j] * x_[N_+tmod_-j];
+	x = x_ + N_ + tmod_;
+	for (j=1; j<=N_-1; j++)
+		mt += phi_[j] * x[-j];
 
 	/* get xt */
-	xt = rng_->rnorm() * pow(phi_[0], 0.5) + mt;
+	xt = rng_->rnorm() * sd_ + mt;
 	x_[tmod_] = xt;
+	x_[N_+tmod_] = xt;
 
 	/** add AR, MA parts only after enough points in the error 
 	 * fARIMA process 
@@ -214,11 +227,8 @@ double FARIMA::Next()
 	yt = xt;
 	if (t_>qMA_) {
 		if (qMA_>0) {
-			m = (tmod_ < qMA_) ? tmod_ : qMA_;
-			for(j=0; j<m; j++) 
-				yt -= x_[tmod_-1-j] * MA_[j];
-			for(j=m; j<qMA_; j++) 
-				yt -= x_[N_+tmod_-1-j] * MA_[j];
+			for(j=0; j<qMA_; j++) 
+				yt -= x[-1-j] * MA_[j];
 		}
 	}
 
@@ -82,6 +82,7 @@ private:
   RNG* rng_;
   int t_, N_, pAR_, qMA_, tmod_;
   double* AR_, *MA_, *x_, *y_, *phi_, d_;
+  double sd_;	// pow(phi_[0], 0.5), fixed once warmed up
   double NextLow();
 };
 
@@ -89,8 +89,10 @@ void DropTail::enque(Packet* p)
 	}
 
 	int qlimBytes = qlim_ * mean_pktsize_;
-	if ((!qib_ && (q_->length() + 1) >= qlim_) ||
-  	(qib_ && (q_->byteLength() + hdr_cmn::access(p)->size()) >= qlimBytes)){
+	// tlen_ and tbytes_: packets waiting for the link, see Queue::commit()
+	// fluidfull_: fluid traffic fills the queue, see FluidModel
+	if (fluidfull_ || (!qib_ && (q_->length() + tlen_ + 1) >= qlim_) ||
+  	(qib_ && (q_->byteLength() + tbytes_ + hdr_cmn::access(p)->size()) >= qlimBytes)){
 		// if the queue would overflow if we added this packet...
 		if (drop_front_) { /* remove from head of queue */
 			q_->enque(p);
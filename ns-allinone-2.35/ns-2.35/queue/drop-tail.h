@@ -38,6 +38,7 @@
 #define ns_drop_tail_h
 
 #include <string.h>
+#include <typeinfo>
 #include "queue.h"
 #include "config.h"
 
@@ -58,11 +59,19 @@ class DropTail : public Queue {
 	~DropTail() {
 		delete q_;
 	}
+	int limitbytes() { return (qib_ ? qlim_ * mean_pktsize_ : 0); }
   protected:
 	void reset();
 	int command(int argc, const char*const* argv); 
 	void enque(Packet*);
 	Packet* deque();
+	int lazyok() {
+		return (typeid(*this) == typeid(DropTail) && !summarystats);
+	}
+	int trainok() {
+		return (lazyok() && !drop_front_ &&
+			typeid(*q_) == typeid(PacketQueue));
+	}
 	void shrink_queue();	// To shrink queue and drop excessive packets.
 
 	PacketQueue *q_;	/* underlying FIFO queue */
@@ -0,0 +1,308 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * fluid-model.cc
+ *
+ * Fluid background TCP flows on a link; see fluid-model.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "fluid-model.h"
+#include "queue.h"
+#include "red.h"
+#include "delay.h"
+#include "integrator.h"
+#include "rng.h"
+
+static class FluidModelClass : public TclClass {
+public:
+	FluidModelClass() : TclClass("FluidModel") {}
+	TclObject* create(int, const char*const*) {
+		return (new FluidModel);
+	}
+} class_fluid_model;
+
+void FluidTimer::expire(Event*)
+{
+	m_->step();
+}
+
+FluidModel::FluidModel() : running_(0), queue_(0), red_(0), link_(0),
+	qInt_(0), rng_(new RNG), q_(0), x_(0), p_(0), hlen_(0), cur_(0),
+	over_(0), fgshare_(0), fgbytes_(0), fgrate_(0), tau_(0), timer_(this)
+{
+	bind_time("step_", &step_);
+	bind("pktsize_", &pktsize_);
+	bind("maxwnd_", &maxwnd_);
+	bind_time("minrto_", &minrto_);
+}
+
+double FluidModel::capacity()
+{
+	return (link_->bandwidth() / (8. * pktsize_));
+}
+
+double FluidModel::limit()
+{
+	int b = queue_->limitbytes();
+	return (b > 0 ? (double) b / pktsize_ : queue_->limit());
+}
+
+void FluidModel::start()
+{
+	double C = capacity();
+	double maxrtt = 0;
+	for (size_t i = 0; i < class_.size(); i++)
+		if (class_[i].a_ > maxrtt)
+			maxrtt = class_[i].a_;
+	/* far enough back for the longest round trip over a full queue */
+	hlen_ = (int) ((maxrtt + limit() / C) / step_) + 2;
+	tau_ = maxrtt;
+	cur_ = 0;
+	q_ = x_ = p_ = over_ = 0;
+	qhist_.assign(hlen_, 0.0);
+	phist_.assign(hlen_, 0.0);
+	for (size_t i = 0; i < class_.size(); i++) {
+		class_[i].off_ = 0.;
+		class_[i].hist_.assign(hlen_, class_[i].w_);
+	}
+	fgbytes_ = fgrate_ = 0;
+	running_ = 1;
+	if (qInt_)
+		qInt_->set(Scheduler::instance().clock(), 0.);
+	timer_.resched(step_);
+}
+
+void FluidModel::stop()
+{
+	timer_.force_cancel();
+	running_ = 0;
+	q_ = x_ = p_ = over_ = 0;
+	queue_->fluid(0, 0, 0);
+	link_->backlog(0.);
+}
+
+void FluidModel::step()
+{
+	double h = step_;
+	double C = capacity();
+	double limit = this->limit();
+	/*
+	 * The foreground, as a rate over a round trip: its packets come
+	 * in bursts, which the fluid does not, and would otherwise be
+	 * dropped for their own burst.
+	 */
+	fgrate_ += (fgbytes_ / pktsize_ / h - fgrate_) * (1. - exp(-h / tau_));
+	fgbytes_ = 0;
+	double lambda = fgrate_;
+
+	int next = (cur_ + 1) % hlen_;
+	for (size_t i = 0; i < class_.size(); i++) {
+		FluidClass& c = class_[i];
+		double R = c.a_ + q_ / C;
+		int j = ago(R);
+		double Rd = c.a_ + qhist_[j] / C;
+		double pd = phist_[j];
+		double wd = c.hist_[j];
+		/* loss events per flow and second, a round trip ago */
+		double e = (1. - pow(1. - pd, wd)) / Rd;
+		/* the share that end in a timeout, and how long it idles */
+		double to = wd > 3. ? 3. / wd : 1.;
+		double idle = (2. * R > minrto_ ? 2. * R : minrto_) *
+		    (1. + pd * (1. + pd * (2. + pd * (4. + pd * (8. + pd *
+		    (16. + pd * 32.))))));
+		double on = c.n_ - c.off_;
+		double back = c.off_ / idle;
+		double w = c.w_ + h * (1. / R - c.w_ / 2. * e * (1. - to));
+		if (on > 0.)	/* back at a window of 1 */
+			w += h * (1. - c.w_) * back / on;
+		c.off_ += h * (on * e * to - back);
+		if (c.off_ < 0.)
+			c.off_ = 0.;
+		else if (c.off_ > c.n_)
+			c.off_ = c.n_;
+		if (w < 1.)
+			w = 1.;
+		else if (w > maxwnd_)
+			w = maxwnd_;
+		c.w_ = w;
+		c.hist_[next] = w;
+		lambda += (c.n_ - c.off_) * w / R;
+	}
+	fgshare_ = lambda > 0. ? fgrate_ / lambda : 0.;
+	q_ += h * (lambda - C);
+	if (q_ < 0.)
+		q_ = 0.;
+	else if (q_ > limit)
+		q_ = limit;
+	/*
+	 * p(t): RED's at x(t), and what does not fit in a full queue,
+	 * over a round trip as the foreground.  Taken a step at a time
+	 * it swings the queue from full to far below, all of the fluid
+	 * halving at once, where the flows at packet level, out of step,
+	 * keep it near full.
+	 */
+	double full = (q_ >= limit && lambda > C) ? 1. - C / lambda : 0.;
+	over_ += (full - over_) * (1. - exp(-h / tau_));
+	if (red_ != 0) {
+		/* RED's average, sampled at every packet time */
+		double qw = red_->q_weight();
+		double unit = queue_->limitbytes() > 0 ? pktsize_ : 1.;
+		if (qw > 0. && qw < 1.)
+			x_ = q_ + (x_ - q_) * exp(log(1. - qw) * C * h);
+		else
+			x_ = q_;
+		p_ = 1. - (1. - red_->prob(x_ * unit, pktsize_)) * (1. - over_);
+		red_->setave(x_ * unit);
+	} else
+		p_ = over_;
+	link_->backlog(q_ / C);
+	qhist_[next] = q_;
+	phist_[next] = p_;
+	cur_ = next;
+	if (qInt_)
+		qInt_->newPoint(Scheduler::instance().clock(), q_);
+	timer_.resched(h);
+}
+
+/*
+ * A foreground packet, on its way to the queue, finds the background's
+ * share of q(t) queued ahead of it: the rest of q(t) is the foreground
+ * itself, already in the queue as packets.  A fraction over_ of all
+ * arrivals does not fit in the full queue, so each foreground packet
+ * finds it full with that probability, drawn from rng_, as every
+ * fluid packet does; otherwise there is room for it, which the queue
+ * does not decide from q(t) (see Queue::fluidfull_).
+ */
+void FluidModel::recv(Packet* p, Handler* h)
+{
+	if (running_) {
+		double bg = q_ * (1. - fgshare_);
+		queue_->fluid((int) bg, (int) (bg * pktsize_),
+		    over_ > 0. && rng_->uniform() < over_);
+		fgbytes_ += hdr_cmn::access(p)->size();
+	}
+	send(p, h);
+}
+
+int FluidModel::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "start") == 0) {
+			if (queue_ == 0 || link_ == 0) {
+				tcl.resultf("%s: no queue or link attached",
+					name());
+				return (TCL_ERROR);
+			}
+			if (!link_->plain()) {
+				tcl.resultf("%s: %s is not a plain DelayLink",
+					name(), link_->name());
+				return (TCL_ERROR);
+			}
+			start();
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "stop") == 0) {
+			stop();
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "queue") == 0) {
+			tcl.resultf("%g", q_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "loss") == 0) {
+			tcl.resultf("%g", p_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "delay") == 0) {
+			tcl.resultf("%g", link_ ? q_ / capacity() : 0.);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "get-integrator") == 0) {
+			if (qInt_)
+				tcl.resultf("%s", qInt_->name());
+			else
+				tcl.resultf("");
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "attach-queue") == 0) {
+			queue_ = (Queue*) TclObject::lookup(argv[2]);
+			if (queue_ == 0)
+				return (TCL_ERROR);
+			red_ = dynamic_cast<REDQueue*>(queue_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "attach-link") == 0) {
+			link_ = (LinkDelay*) TclObject::lookup(argv[2]);
+			if (link_ == 0)
+				return (TCL_ERROR);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "set-integrator") == 0) {
+			qInt_ = (Integrator*) TclObject::lookup(argv[2]);
+			if (qInt_ == 0)
+				return (TCL_ERROR);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "use-rng") == 0) {
+			RNG* rng = (RNG*) TclObject::lookup(argv[2]);
+			if (rng == 0) {
+				tcl.resultf("no such RNG %s", argv[2]);
+				return (TCL_ERROR);
+			}
+			rng_ = rng;
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "window") == 0 ||
+		    strcmp(argv[1], "rate") == 0) {
+			size_t i = atoi(argv[2]);
+			if (i >= class_.size()) {
+				tcl.resultf("%s: no class %s", name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			FluidClass& c = class_[i];
+			if (argv[1][0] == 'w')
+				tcl.resultf("%g", c.w_);
+			else if (link_ == 0)
+				tcl.resultf("0");
+			else	/* bits/s */
+				tcl.resultf("%g", (c.n_ - c.off_) * c.w_ /
+					(c.a_ + q_ / capacity()) * 8. *
+					pktsize_);
+			return (TCL_OK);
+		}
+	} else if (argc == 4) {
+		if (strcmp(argv[1], "add-class") == 0) {
+			FluidClass c;
+			c.n_ = atof(argv[2]);
+			c.a_ = atof(argv[3]);
+			c.w_ = 1.;
+			c.off_ = 0.;
+			if (c.a_ <= 0.) {
+				tcl.resultf("%s: round-trip time must be > 0",
+					name());
+				return (TCL_ERROR);
+			}
+			if (running_)
+				c.hist_.assign(hlen_, c.w_);
+			class_.push_back(c);
+			tcl.resultf("%d", (int) class_.size() - 1);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "set-flows") == 0) {
+			size_t i = atoi(argv[2]);
+			if (i >= class_.size()) {
+				tcl.resultf("%s: no class %s", name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			class_[i].n_ = atof(argv[3]);
+			return (TCL_OK);
+		}
+	}
+	return (Connector::command(argc, argv));
+}
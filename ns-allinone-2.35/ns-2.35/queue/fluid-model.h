@@ -0,0 +1,127 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * fluid-model.h
+ *
+ * FluidModel: long-lived background TCP flows on a link as a fluid.
+ *
+ * Each class of background flows is N flows of the same round-trip
+ * propagation delay, and is carried as one window W(t) in the
+ * Misra/Gong/Towsley fluid model, with M(t) of the flows waiting out
+ * a timeout, integrated by Euler steps of step_ seconds together with
+ * the queue q(t) and, for a Queue/RED, the RED average x(t):
+ *
+ *	dW/dt = 1/R - W/2 e (1-o) + (1-W) M/T / (N-M),	R = a + q/C
+ *	dM/dt = (N-M) e o - M/T
+ *	dq/dt = sum (N-M) W/R + foreground - C,		0 <= q <= limit_
+ *	dx/dt = ln(1-q_w) C (x - q)
+ *
+ * e = (1 - (1-p)^W) / R is the rate of loss events of a flow and
+ * o = min(1, 3/W) the share that end in a timeout (Padhye et al.),
+ * both as of a round trip ago, and T = max(minrto_, 2R) (1 + p + 2p^2
+ * + 4p^3 + ... + 32p^6) the timeout, backed off, after which a flow
+ * is back at a window of 1.  p(t) is the fraction of packets a
+ * Queue/RED drops at x (REDQueue::prob()), together with the fraction
+ * of the arrivals over C while the queue is full, over a round trip,
+ * which is all of it for any other queue.  Sizes are in packets of
+ * pktsize_ bytes, C is the DelayLink's bandwidth_ and limit_ the
+ * queue's limit_, converted from bytes if the queue is measured in
+ * bytes (Queue::limitbytes()).
+ *
+ * The model sits at the head of the link.  Packets of the foreground
+ * (packet-level) flows are counted into q(t) as a rate, and the fluid
+ * is put in the link's own queue and DelayLink.  Each arriving packet
+ * finds the background's share of q(t) queued ahead of it, and the
+ * queue full with the probability a fluid packet does (Queue::fluid(),
+ * for DropTail and RED), so that the queue drops it as it would
+ * behind that many packets; a Queue/RED's average is x(t) (REDQueue::
+ * setave()); and the DelayLink delivers it q(t)/C later (LinkDelay::
+ * backlog()).  The foreground sees the queueing delay and loss of the
+ * loaded link for a few events per step instead of per background
+ * packet.  Against the same background at packet level, 100 or 400
+ * Agent/TCP/Sack1 flows on a DropTail or RED link, its throughput is
+ * within 25% of theirs (tcl/ex/fluid-model.tcl; test-suite-fluid.tcl):
+ *
+ *	set fm [$ns fluid-model $r1 $r2]
+ *	$fm add-class 1000 0.1		;# 1000 flows, 100 ms RTT: class 0
+ *	$ns at 0 "$fm start"
+ *	...
+ *	$fm queue; $fm loss; $fm window 0; $fm rate 0
+ */
+
+#ifndef ns_fluid_model_h
+#define ns_fluid_model_h
+
+#include <vector>
+#include "connector.h"
+#include "timer-handler.h"
+
+class Queue;
+class REDQueue;
+class LinkDelay;
+class Integrator;
+class RNG;
+class FluidModel;
+
+class FluidTimer : public TimerHandler {
+public:
+	FluidTimer(FluidModel* m) : TimerHandler(), m_(m) { }
+protected:
+	virtual void expire(Event*);
+	FluidModel* m_;
+};
+
+struct FluidClass {
+	double n_;		/* flows */
+	double a_;		/* round-trip propagation delay */
+	double w_;		/* window of each flow, packets */
+	double off_;		/* flows waiting out a timeout */
+	std::vector<double> hist_;	/* w_ of the last steps */
+};
+
+class FluidModel : public Connector {
+public:
+	FluidModel();
+	void recv(Packet*, Handler*);
+	void step();
+protected:
+	int command(int argc, const char*const* argv);
+	void start();
+	void stop();
+	double capacity();	/* packets/s */
+	double limit();		/* the queue's limit, packets */
+	inline int ago(double d) {	/* history slot d seconds back */
+		int k = (int) (d / step_ + 0.5);
+		if (k >= hlen_)
+			k = hlen_ - 1;
+		return ((cur_ - k + hlen_) % hlen_);
+	}
+
+	double step_;		/* integration step */
+	int pktsize_;		/* fluid packet, bytes */
+	double maxwnd_;		/* window limit, packets */
+	double minrto_;		/* retransmission timeout floor */
+	int running_;
+
+	Queue* queue_;
+	REDQueue* red_;		/* queue_, if a Queue/RED */
+	LinkDelay* link_;
+	Integrator* qInt_;	/* q(t) integrator, if any */
+	RNG* rng_;		/* for drops while the queue is full */
+
+	std::vector<FluidClass> class_;
+	double q_;		/* queue, packets */
+	double x_;		/* RED average */
+	double p_;		/* drop probability */
+	std::vector<double> qhist_;	/* q_ and p_ of the last steps */
+	std::vector<double> phist_;
+	int hlen_;		/* steps kept */
+	int cur_;		/* slot of the last step */
+	double over_;		/* fraction over C while the queue is full */
+	double fgshare_;	/* the foreground's fraction of the arrivals */
+	double fgbytes_;	/* foreground arrivals this step */
+	double fgrate_;		/* their rate, packets/s */
+	double tau_;		/* over_ and fgrate_ are averaged over this */
+	FluidTimer timer_;
+};
+
+#endif
@@ -38,8 +38,10 @@ static const char rcsid[] =
 #endif
 
 #include "queue.h"
+#include "delay.h"
 #include <math.h>
 #include <stdio.h>
+#include <typeinfo>
 
 void PacketQueue::remove(Packet* target)
 {
@@ -86,9 +88,14 @@ void QueueHandler::handle(Event*)
 }
 
 Queue::~Queue() {
+	delete [] tslot_;
 }
 
 Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
+		 lazy_(0), free_at_(0), lazylink_(0), lazytarget_(0),
+		 tlen_(0), tbytes_(0), fluidlen_(0), fluidbytes_(0),
+		 fluidfull_(0), tslot_(0), thead_(0),
+		 tn_(0), tcap_(0), tsum_(0),
 		 pq_(0), 
 		 last_change_(0), /* temporarily NULL */
 		 old_util_(0), period_begin_(0), cur_util_(0), buf_slot_(0),
@@ -98,6 +105,8 @@ Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 	bind("util_weight_", &util_weight_);
 	bind_bool("blocked_", &blocked_);
 	bind_bool("unblock_on_resume_", &unblock_on_resume_);
+	bind_bool("lazy_resume_", &lazy_resume_);
+	bind_bool("trains_", &trains_);
 	bind("util_check_intv_", &util_check_intv_);
 	bind("util_records_", &util_records_);
 
@@ -116,6 +125,15 @@ Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 void Queue::recv(Packet* p, Handler*)
 {
 	double now = Scheduler::instance().clock();
+	if (trainable()) {
+		p->time_ = now;
+		p->next_ = 0;
+		take(p);
+		return;
+	}
+	advance(now);
+	if (lazy_)
+		settle(now);
 	enque(p);
 	if (!blocked_) {
 		/*
@@ -129,11 +147,183 @@ void Queue::recv(Packet* p, Handler*)
 			utilUpdate(last_change_, now, blocked_);
 			last_change_ = now;
 			blocked_ = 1;
-			target_->recv(p, &qh_);
+			transmit(p);
 		}
+	} else if (lazy_) {
+		/* the link is still busy: resume when it is free after all */
+		lazy_ = 0;
+		Scheduler::instance().schedule_at(&qh_, &resume_, free_at_);
 	}
 }
 
+void Queue::recvtrain(Packet* p)
+{
+	if (trainable())
+		take(p);
+	else
+		NsObject::recvtrain(p);
+}
+
+/*
+ * trains_ needs a discipline that allows it, a plain LinkDelay that
+ * does, and no packet being sent the usual way.
+ */
+int Queue::trainable()
+{
+	return (trains_ && unblock_on_resume_ && (lazy_ || !blocked_) &&
+		pq_ != 0 && pq_->length() == 0 && trainok() &&
+		plainlink() != 0 && lazylink_->trainok());
+}
+
+/*
+ * Take the packets of train p (or the single packet p, its time_ now)
+ * and send those kept on to the link at once.  After the first, each
+ * is taken at its own time as long as nothing else is due before it
+ * (see Scheduler::runahead); the rest come back to the queue later.
+ */
+void Queue::take(Packet* p)
+{
+	Scheduler& s = Scheduler::instance();
+	advance(s.clock());
+	do {
+		Packet* q = p;
+		p = q->next_;
+		if (commit(q, s.clock())) {
+			q->next_ = 0;
+			lazylink_->sendtrain(q);
+		}
+	} while (p != 0 && s.runahead(p->time_));
+	if (p != 0)
+		defertrain(p);
+}
+
+/*
+ * A packet arriving at time t (the clock is set to it): enque()
+ * decides whether to keep it, counting the packets still waiting for
+ * the link then, and if so the packet is sent as soon as they are.
+ * Its time_ becomes the time the link starts on it.  Returns 0 if the
+ * packet was dropped.
+ */
+int Queue::commit(Packet* p, double t)
+{
+	if (lazy_)
+		settle(t);
+	int lo = 0, hi = tn_;
+	while (lo < hi) {
+		int m = (lo + hi) / 2;
+		if (tslot_[(thead_ + m) & (tcap_ - 1)].start > t)
+			hi = m;
+		else
+			lo = m + 1;
+	}
+	/*
+	 * A packet due to start at t after waiting is still waiting: the
+	 * arrival was scheduled before the link's callback for it would
+	 * have been.
+	 */
+	if (lo > 0) {
+		TrainSlot& ts = tslot_[(thead_ + lo - 1) & (tcap_ - 1)];
+		if (ts.start == t && ts.arr < t)
+			lo--;
+	}
+	tlen_ = tn_ - lo;
+	tbytes_ = lo < tn_ ?
+		int(tsum_ - tslot_[(thead_ + lo) & (tcap_ - 1)].sum) : 0;
+	enque(p);
+	if (pq_->length() == 0)
+		return (0);
+	pq_->deque();
+	double start = free_at_ > t ? free_at_ : t;
+	if (!blocked_) {
+		if (t >= last_change_) {
+			utilUpdate(last_change_, t, blocked_);
+			last_change_ = t;
+		}
+		blocked_ = 1;
+	}
+	if (tn_ == tcap_) {
+		int n = tcap_ ? 2 * tcap_ : 64;
+		TrainSlot* ts = new TrainSlot[n];
+		for (int i = 0; i < tn_; i++)
+			ts[i] = tslot_[(thead_ + i) & (tcap_ - 1)];
+		delete [] tslot_;
+		tslot_ = ts;
+		tcap_ = n;
+		thead_ = 0;
+	}
+	TrainSlot& ts = tslot_[(thead_ + tn_) & (tcap_ - 1)];
+	ts.p = p;
+	ts.arr = t;
+	ts.start = start;
+	ts.sum = tsum_;
+	tn_++;
+	tsum_ += hdr_cmn::access(p)->size();
+	lazy_ = 1;
+	free_at_ = start + lazylink_->txtime(p);
+	p->time_ = start;
+	return (1);
+}
+
+/*
+ * By now the link has started on the packets it was to, and they no
+ * longer wait.  (One starting now still counts as waiting for a
+ * packet arriving now, see commit().)
+ */
+void Queue::advance(double now)
+{
+	while (tn_ > 0 && tslot_[thead_].start < now) {
+		thead_ = (thead_ + 1) & (tcap_ - 1);
+		tn_--;
+	}
+	tlen_ = tn_;
+	tbytes_ = tn_ > 0 ? int(tsum_ - tslot_[thead_].sum) : 0;
+}
+
+LinkDelay* Queue::plainlink()
+{
+	if (target_ != lazytarget_) {
+		lazytarget_ = target_;
+		lazylink_ = (target_ != 0 &&
+		    typeid(*target_) == typeid(LinkDelay)) ?
+			(LinkDelay*) target_ : 0;
+	}
+	return (lazylink_);
+}
+
+/*
+ * Send p on.  With lazy_resume_, and nothing left queued, a plain
+ * LinkDelay is not asked to call back when it is done sending p.
+ */
+void Queue::transmit(Packet* p)
+{
+	if (lazy_resume_ && lazyok() && unblock_on_resume_ && pq_ != 0 &&
+	    pq_->length() == 0 && plainlink() != 0) {
+		free_at_ = Scheduler::instance().clock() +
+			lazylink_->txtime(p);
+		lazy_ = 1;
+		lazylink_->recv(p, 0);
+		return;
+	}
+	target_->recv(p, &qh_);
+}
+
+/*
+ * If the link has been free since free_at_, do what resume() would
+ * have done then, with the queue empty.
+ */
+void Queue::settle(double now)
+{
+	if (now < free_at_)
+		return;
+	lazy_ = 0;
+	idle(free_at_);
+	if (free_at_ >= last_change_) {
+		utilUpdate(last_change_, free_at_, blocked_);
+		last_change_ = free_at_;
+	}
+	blocked_ = 0;
+}
+
 void Queue::utilUpdate(double int_begin, double int_end, int link_state) {
 double decay;
 
@@ -166,8 +356,12 @@ double Queue::utilization(void)
 {
 	double now = Scheduler::instance().clock();
 	
-	utilUpdate(last_change_, now, blocked_);
-	last_change_ = now;
+	if (lazy_)
+		settle(now);
+	if (now >= last_change_) {	/* trains_ may have gone ahead */
+		utilUpdate(last_change_, now, blocked_);
+		last_change_ = now;
+	}
 
 	return old_util_;
 			
@@ -184,8 +378,12 @@ double Queue::peak_utilization(void)
 	if (util_records_ == 0)
 		return utilization();
 
-	utilUpdate(last_change_, now, blocked_);
-	last_change_ = now;
+	if (lazy_)
+		settle(now);
+	if (now >= last_change_) {
+		utilUpdate(last_change_, now, blocked_);
+		last_change_ = now;
+	}
 
 	for (i = 0; i < util_records_; i++) {
 		if (util_buf_[i] > peak)
@@ -210,9 +408,10 @@ void Queue::updateStats(int queuesize)
 void Queue::resume()
 {
 	double now = Scheduler::instance().clock();
+	advance(now);
 	Packet* p = deque();
 	if (p != 0) {
-		target_->recv(p, &qh_);
+		transmit(p);
 	} else {
 		if (unblock_on_resume_) {
 			utilUpdate(last_change_, now, blocked_);
@@ -232,6 +431,9 @@ void Queue::reset()
 	Packet* p;
 	total_time_ = 0.0;
 	true_ave_ = 0.0;
+	lazy_ = 0;
+	free_at_ = 0.0;
+	tlen_ = tbytes_ = thead_ = tn_ = 0;
 	while ((p = deque()) != 0)
 		drop(p);
 }
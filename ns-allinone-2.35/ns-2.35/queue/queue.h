@@ -109,6 +109,7 @@ private:
 };
 
 class Queue;
+class LinkDelay;
 
 class QueueHandler : public Handler {
 public:
@@ -124,6 +125,7 @@ public:
 	virtual void enque(Packet*) = 0;
 	virtual Packet* deque() = 0;
 	virtual void recv(Packet*, Handler*);
+	void recvtrain(Packet*);
 	virtual void updateStats(int queuesize); 
 	void resume();
 	
@@ -135,6 +137,14 @@ public:
 						 * underlying packet queue */
 	int byteLength() { return pq_->byteLength(); }	/* number of bytes *
 						 * currently in packet queue */
+	/* for FluidModel: fluid queued ahead of an arrival, see below */
+	void fluid(int n, int bytes, int full) {
+		fluidlen_ = n;
+		fluidbytes_ = bytes;
+		fluidfull_ = full;
+	}
+	/* the limit in bytes, if the queue is measured in bytes, else 0 */
+	virtual int limitbytes() { return (0); }
 	/* mean utilization, decaying based on util_weight */
 	virtual double utilization (void);
 
@@ -149,6 +159,62 @@ protected:
 	int blocked_;		/* blocked now? */
 	int unblock_on_resume_;	/* unblock q on idle? */
 	QueueHandler qh_;
+	/*
+	 * With lazy_resume_, a packet that leaves the queue empty is
+	 * handed to a LinkDelay target without the link's callback, and
+	 * the queue only notes when the link is free again (free_at_).
+	 * An arrival before then has resume_ scheduled for free_at_;
+	 * one after it finds the link idle since free_at_.
+	 */
+	int lazy_resume_;
+	int lazy_;		/* free_at_ pending, nothing scheduled */
+	double free_at_;
+	Event resume_;
+	LinkDelay* lazylink_;	/* target_, if a plain LinkDelay */
+	NsObject* lazytarget_;	/* target_ lazylink_ was found for */
+	void transmit(Packet*);
+	void settle(double now);
+	LinkDelay* plainlink();
+	virtual void idle(double) { }	/* nothing queued since then */
+	/* deque() of an empty queue does no more than idle() */
+	virtual int lazyok() { return 0; }
+	/*
+	 * With trains_, a packet that enque() keeps is handed to a plain
+	 * LinkDelay target at once, with the time the link will start on
+	 * it, and trains (see NsObject::recvtrain) are taken in one
+	 * piece.  The packets waiting for the link when one arrives are
+	 * counted in tlen_ and tbytes_, which enque() adds to the length
+	 * of the queue; trainok() if that is all enque() needs.
+	 */
+	int trains_;
+	int tlen_;
+	int tbytes_;
+	/*
+	 * Packets of fluid background traffic (see FluidModel) queued
+	 * when a packet arrives, and their bytes, which enque() counts
+	 * in the length of the queue; and whether they fill it.  The
+	 * model decides that, so enque() drops the arrival for overflow
+	 * if fluidfull_ or if its own packets overflow the queue.
+	 */
+	int fluidlen_;
+	int fluidbytes_;
+	int fluidfull_;
+	struct TrainSlot {	/* a packet the link has not started on */
+		Packet* p;
+		double arr;	/* when it arrived */
+		double start;	/* when the link starts on it */
+		double sum;	/* tsum_ before it came */
+	};
+	TrainSlot* tslot_;	/* ring of tcap_, tn_ from thead_ */
+	int thead_;
+	int tn_;
+	int tcap_;
+	double tsum_;		/* bytes taken so far */
+	virtual int trainok() { return 0; }
+	int trainable();
+	void take(Packet*);
+	int commit(Packet*, double t);
+	void advance(double now);
 	PacketQueue *pq_;	/* pointer to actual packet queue 
 				 * (maintained by the individual disciplines
 				 * like DropTail and RED). */
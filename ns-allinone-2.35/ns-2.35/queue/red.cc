@@ -458,6 +458,48 @@ REDQueue::calculate_p_new(double v_ave, double th_max, int gentle, double v_a,
 	return p;
 }
 
+/*
+ * With lazy_resume_, the deque() that finds the queue empty when the
+ * link becomes free is not made; note the idle time it would have.
+ */
+void REDQueue::idle(double t)
+{
+	idle_ = 1;
+	idletime_ = t;
+}
+
+/*
+ * The fraction of packets of size bytes that drop_early() drops
+ * while the average queue stays at ave, in bytes if the queue is
+ * measured in bytes.  It spaces the drops by the count since the
+ * last one, uniformly over 0 to 1/p (1/p to 2/p with wait) packets,
+ * or bytes as packets of mean_pktsize with bytes; see modify_p().
+ */
+double
+REDQueue::prob(double ave, int size)
+{
+	if (ave < edp_.th_min)
+		return (0.0);
+	double p = calculate_p_new(ave, edp_.th_max, edp_.gentle, edv_.v_a,
+		edv_.v_b, edv_.v_c, edv_.v_d, edv_.cur_max_p);
+	if (p <= 0.0 || p >= 1.0)
+		return (p);
+	double k = edp_.bytes ? (double) size / edp_.mean_pktsize : 1.0;
+	double r = k / ((edp_.wait ? 1.5 : 0.5) / p + k / 2.0);
+	return (r < 1.0 ? r : 1.0);
+}
+
+/*
+ * Set the average queue to ave (in the units of prob()), as
+ * FluidModel integrates it for the fluid background traffic the
+ * queue does not see.
+ */
+void
+REDQueue::setave(double ave)
+{
+	edv_.v_ave = ave;
+}
+
 /*
  * Calculate the drop probability.
  * This is being kept for backwards compatibility.
@@ -655,7 +697,10 @@ void REDQueue::enque(Packet* pkt)
 	 * Run the estimator with either 1 new packet arrival, or with
 	 * the scaled version above [scaled by m due to idle time]
 	 */
-	edv_.v_ave = estimator(qib_ ? q_->byteLength() : q_->length(), m + 1, edv_.v_ave, edp_.q_w);
+	// tlen_ and tbytes_: packets waiting for the link, see Queue::commit()
+	// fluidlen_: fluid traffic queued, see FluidModel
+	edv_.v_ave = estimator(qib_ ? q_->byteLength() + tbytes_ + fluidbytes_ :
+	    q_->length() + tlen_ + fluidlen_, m + 1, edv_.v_ave, edp_.q_w);
 	//printf("v_ave: %6.4f (%13.12f) q: %d)\n", 
 	//	double(edv_.v_ave), double(edv_.v_ave), q_->length());
 	if (summarystats_) {
@@ -683,7 +728,8 @@ void REDQueue::enque(Packet* pkt)
 
 	register double qavg = edv_.v_ave;
 	int droptype = DTYPE_NONE;
-	int qlen = qib_ ? q_->byteLength() : q_->length();
+	int qlen = qib_ ? q_->byteLength() + tbytes_ + fluidbytes_ :
+	    q_->length() + tlen_ + fluidlen_;
 	int qlim = qib_ ? (qlim_ * edp_.mean_pktsize) : qlim_;
 
 	curq_ = qlen;	// helps to trace queue during arrival, if enabled
@@ -711,8 +757,9 @@ void REDQueue::enque(Packet* pkt)
 		edv_.v_prob = 0.0;
 		edv_.old = 0;		
 	}
-	if (qlen >= qlim) {
+	if (fluidfull_ || qlen - (qib_ ? fluidbytes_ : fluidlen_) >= qlim) {
 		// see if we've exceeded the queue size
+		// (fluid traffic fills it only if fluidfull_, see FluidModel)
 		droptype = DTYPE_FORCED;
 	}
 
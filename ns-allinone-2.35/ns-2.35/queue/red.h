@@ -59,6 +59,7 @@
 #ifndef ns_red_h
 #define ns_red_h
 
+#include <typeinfo>
 #include "queue.h"
 
 #include "trace.h"
@@ -143,6 +144,11 @@ class REDQueue : public Queue {
  public:	
 	/*	REDQueue();*/
 	REDQueue(const char * = "Drop");
+	/* for FluidModel: the drop rate at average ave, see red.cc */
+	double prob(double ave, int size);
+	void setave(double ave);
+	int limitbytes() { return (qib_ ? qlim_ * edp_.mean_pktsize : 0); }
+	double q_weight() { return edp_.q_w; }
  protected:
 	void initParams();
 	int command(int argc, const char*const* argv);
@@ -150,6 +156,16 @@ class REDQueue : public Queue {
 	virtual Packet *pickPacketForECN(Packet* pkt);
 	virtual Packet *pickPacketToDrop();
 	Packet* deque();
+	void idle(double t);
+	int lazyok() {
+		return (typeid(*this) == typeid(REDQueue) && !summarystats_);
+	}
+	int trainok() {
+		return (lazyok() && !drop_front_ && !drop_rand_ &&
+			de_drop_ == NULL && edp_.cautious != 1 &&
+			edp_.cautious != 2 &&
+			typeid(*q_) == typeid(PacketQueue));
+	}
 	void initialize_params();
 	void reset();
 	void run_estimator(int nqueued, int m);	/* Obsolete */
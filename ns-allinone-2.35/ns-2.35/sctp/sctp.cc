@@ -210,6 +210,7 @@ void SctpAgent::delay_bind_init_all()
   delay_bind_init_one("initialSwnd_");
   /* PN: 5/07. NR-Sacks */
   delay_bind_init_one("useNonRenegSacks_");
+  delay_bind_init_one("lazyRtxTimer_");
 
   delay_bind_init_one("trace_all_");
   delay_bind_init_one("cwnd_");
@@ -347,6 +348,10 @@ int SctpAgent::delay_bind_dispatch(const char *cpVarName,
 		"useNonRenegSacks_", (int *) &eUseNonRenegSacks, opTracer)) 
     return TCL_OK;
 
+  if(delay_bind(cpVarName, cpLocalName, 
+		"lazyRtxTimer_", (int *) &eLazyRtxTimer, opTracer)) 
+    return TCL_OK;
+
   if(delay_bind(cpVarName, cpLocalName, "cwnd_", &tiCwnd, opTracer)) 
     return TCL_OK;
 
@@ -2221,7 +2226,10 @@ void SctpAgent::StartT3RtxTimer(SctpDest_S *spDest)
   double dCurrTime = Scheduler::instance().clock();
   DBG_PL(StartT3RtxTimer, "spDest=%p dCurrTime=%f expires at %f "), 
     spDest, dCurrTime, dCurrTime+spDest->dRto DBG_PR;
-  spDest->opT3RtxTimer->resched(spDest->dRto);
+  if(eLazyRtxTimer == TRUE)
+    spDest->opT3RtxTimer->resched_lazy(spDest->dRto);
+  else
+    spDest->opT3RtxTimer->resched(spDest->dRto);
   spDest->eRtxTimerIsRunning = TRUE;
   DBG_X(StartT3RtxTimer);
 }
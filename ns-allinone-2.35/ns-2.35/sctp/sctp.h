@@ -914,6 +914,7 @@ protected:
   /* PN: 5/07. Use Non-renegable Sacks? 
    */
   Boolean_E	   eUseNonRenegSacks;
+  Boolean_E	   eLazyRtxTimer;  // put T3-rtx off with resched_lazy()
 
   Boolean_E        eTraceAll;     // trace all variables on one line?
   TracedInt        tiCwnd;        // trace cwnd for all destinations
@@ -0,0 +1,66 @@
+#
+# Example of Simulator checkpoint: one warm-up, many what-ifs.
+#
+# nflows TCP connections share a 10Mb bottleneck.  After warmup seconds
+# the simulation is written to checkpoint.img and carries on to stop
+# with the bottleneck unchanged; each "ns -restore" of the image carries
+# on from the same warm state with the bottleneck bandwidth given.
+#
+# usage: ns -checkpointable checkpoint.tcl [nflows] [warmup] [stop]
+#        ns -restore checkpoint.img [-branch tag] [bw]
+#
+# Prints the bottleneck bandwidth and the goodput from warmup to stop;
+# restoring with bw 10Mb prints what the first run did.
+#
+
+set val(nflows)	20
+set val(warmup)	50
+set val(stop)	60
+foreach v {nflows warmup stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+set ns [new Simulator]
+set r0 [$ns node]
+set r1 [$ns node]
+$ns duplex-link $r0 $r1 10Mb 20ms RED
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	set s [$ns node]
+	set d [$ns node]
+	$ns duplex-link $s $r0 100Mb [expr 1 + $i]ms DropTail
+	$ns duplex-link $r1 $d 100Mb 1ms DropTail
+	set tcp [new Agent/TCP/Sack1]
+	$ns attach-agent $s $tcp
+	set sink($i) [new Agent/TCPSink/Sack1]
+	$ns attach-agent $d $sink($i)
+	$ns connect $tcp $sink($i)
+	set ftp [$tcp attach-source FTP]
+	$ns at [expr 0.1 * $i] "$ftp start"
+}
+set mon [$ns monitor-queue $r0 $r1 ""]
+
+proc warm {} {
+	global ns val r0 r1 mon bw
+	set bw 10Mb
+	if [$ns checkpoint checkpoint.img] {
+		global argv
+		if {[llength $argv] > 0} {
+			set bw [lindex $argv 0]
+			[[$ns link $r0 $r1] link] set bandwidth_ $bw
+		}
+	}
+	$mon set bdepartures_ 0
+	$ns at $val(stop) "finish"
+}
+
+proc finish {} {
+	global ns val mon bw
+	puts "bottleneck $bw: goodput [format %.3f [expr [$mon set \
+	    bdepartures_] * 8.0 / ($val(stop) - $val(warmup)) / 1e6]] Mb/s"
+	$ns halt
+}
+
+$ns at $val(warmup) "warm"
+$ns run
@@ -0,0 +1,82 @@
+#
+# Example of compact-packet-headers.
+#
+# A dumbbell of nflows TCP connections and as many CBR sources.  By
+# default every packet carries all of ns's headers, some 4.5 KB that
+# Packet::alloc() zeroes and Packet::copy() copies; compacted, it
+# carries only the common, IP, flags, TCP and RTP headers.
+#
+# usage: ns compact-headers.tcl [compact] [nflows] [stop] [trace]
+#
+# Prints the packet format and the wall clock time of the run.  With
+# trace true, the trace written to compact-headers.tr is the same
+# either way.
+#
+
+set val(compact) true
+set val(nflows)	20
+set val(stop)	20
+set val(trace)	false
+foreach v {compact nflows stop trace} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+if $val(compact) {
+	compact-packet-headers IP Flags TCP RTP
+}
+set ns [new Simulator]
+set fmt [$ns packet-format]
+puts "hdrlen_ [lindex $fmt 0]:"
+foreach h [lrange $fmt 1 end] {
+	puts "\t[lindex $h 0]\toffset [lindex $h 1], [lindex $h 2] bytes"
+}
+
+if $val(trace) {
+	set tf [open compact-headers.tr w]
+	$ns trace-all $tf
+}
+
+set r0 [$ns node]
+set r1 [$ns node]
+$ns duplex-link $r0 $r1 10Mb 10ms RED
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	set s [$ns node]
+	set d [$ns node]
+	$ns duplex-link $s $r0 100Mb 1ms DropTail
+	$ns duplex-link $r1 $d 100Mb 1ms DropTail
+
+	set tcp [new Agent/TCP/Newreno]
+	$ns attach-agent $s $tcp
+	set sink [new Agent/TCPSink]
+	$ns attach-agent $d $sink
+	$ns connect $tcp $sink
+	set ftp [$tcp attach-source FTP]
+	$ns at [expr 0.01 * $i] "$ftp start"
+
+	set udp [new Agent/UDP]
+	$ns attach-agent $s $udp
+	set null [new Agent/Null]
+	$ns attach-agent $d $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr set rate_ 100Kb
+	$cbr attach-agent $udp
+	$ns at [expr 0.01 * $i] "$cbr start"
+}
+
+proc finish {} {
+	global ns val tf start_
+	if $val(trace) {
+		$ns flush-trace
+		close $tf
+	}
+	puts "[format %.2f [expr ([clock clicks -milliseconds] - $start_) \
+	    / 1000.0]] s"
+	$ns halt
+}
+
+$ns at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns run
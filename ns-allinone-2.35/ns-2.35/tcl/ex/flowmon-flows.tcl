@@ -0,0 +1,80 @@
+#
+# Many-flows benchmark for Classifier/Hash/Flow.
+#
+# A CBR source changes its flow id every millisecond, so a flow monitor
+# on its link sees nflows short flows.  With cltype SrcDestFid each new
+# flow is an "unknown-flow" call into Tcl and a Flow object; with
+# cltype Flow it is a record in the classifier's table.
+#
+# usage: ns flowmon-flows.tcl [cltype] [nflows] [idle] [snap]
+#
+# Prints the wall clock time and the flows seen; idle > 0 sets
+# idle_timeout_ on Classifier/Hash/Flow, and the expired flows are
+# counted too.  snap > 0 writes binary snapshots of the flow table every
+# snap seconds to flowmon-flows.snap (cltype Flow only).
+#
+
+set val(cltype) Flow
+set val(nflows)	20000
+set val(idle)	0
+set val(snap)	0
+foreach v {cltype nflows idle snap} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+set ns [new Simulator]
+set n0 [$ns node]
+set n1 [$ns node]
+$ns duplex-link $n0 $n1 100Mb 5ms DropTail
+
+set fm [$ns makeflowmon $val(cltype)]
+$ns attach-fmon [$ns link $n0 $n1] $fm
+set cl [$fm classifier]
+if {$val(cltype) == "Flow"} {
+	$cl set idle_timeout_ $val(idle)
+	if {$val(snap) > 0} {
+		set snapf [open flowmon-flows.snap w]
+		fconfigure $snapf -translation binary
+		$fm set snapshot_interval_ $val(snap)
+		$fm snapshot-to $snapf
+	}
+}
+
+set udp [new Agent/UDP]
+$ns attach-agent $n0 $udp
+set null [new Agent/Null]
+$ns attach-agent $n1 $null
+$ns connect $udp $null
+set cbr [new Application/Traffic/CBR]
+$cbr set packetSize_ 500
+$cbr set interval_ 0.0001
+$cbr attach-agent $udp
+
+proc nextflow fid {
+	global ns udp val
+	$udp set fid_ $fid
+	if {$fid + 1 < $val(nflows)} {
+		$ns at [expr [$ns now] + 0.001] "nextflow [expr $fid + 1]"
+	}
+}
+
+proc finish {} {
+	global ns val fm cl start_
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	if {$val(cltype) == "Flow"} {
+		set n [$cl nflows]
+		set flows "[lindex $n 0] active, [lindex $n 1] expired"
+	} else {
+		set flows "[llength [$fm flows]] flow objects"
+	}
+	puts "$val(cltype): [format %.2f $t] s, $flows,\
+	    [$fm set parrivals_] packets"
+	$ns halt
+}
+
+$ns at 0.0 "$cbr start; nextflow 0"
+$ns at [expr $val(nflows) * 0.001 + 0.1] "finish"
+set start_ [clock clicks -milliseconds]
+$ns run
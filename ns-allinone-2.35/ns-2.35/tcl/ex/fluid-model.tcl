@@ -0,0 +1,109 @@
+#
+# Example of FluidModel.
+#
+# nbg long-lived TCP flows and five foreground TCP flows share a
+# 100 Mb/s link, all with a round-trip propagation delay of 100 ms.
+# With "packet" the background flows are Agent/TCP/Sack1 flows like
+# the foreground ones; with "fluid" they are one class of a
+# FluidModel on the link.  Either way the foreground flows report
+# their throughput, packets sent and smoothed RTT, and the run its
+# wall-clock time, which the foreground packets mostly account for.
+# With "packet" the throughput of all the flows is reported too,
+# which is what the foreground's with "fluid" is to be compared with:
+# five flows are too few to go by.  The flows start at random in the
+# first second and send with a random overhead_, so that they are not
+# in step with each other, which the fluid assumes.
+#
+# usage: ns fluid-model.tcl [fluid|packet] [nbg] [queue]
+#
+
+set val(mode)	fluid
+set val(nbg)	400
+set val(queue)	RED
+foreach v {mode nbg queue} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(nfg)	5
+set val(stop)	20.0
+
+set ns [new Simulator]
+set r1 [$ns node]
+set r2 [$ns node]
+$ns duplex-link $r1 $r2 100Mb 40ms $val(queue)
+$ns queue-limit $r1 $r2 500
+if {$val(queue) == "RED"} {
+	set red [[$ns link $r1 $r2] queue]
+	$red set thresh_ 100
+	$red set maxthresh_ 300
+}
+
+proc flow {i} {
+	global ns r1 r2 val defaultRNG
+	set s [$ns node]
+	set d [$ns node]
+	$ns duplex-link $s $r1 1Gb 5ms DropTail
+	$ns duplex-link $r2 $d 1Gb 5ms DropTail
+	$ns queue-limit $s $r1 1000
+	set tcp [new Agent/TCP/Sack1]
+	$tcp set window_ 20
+	$tcp set overhead_ 0.001
+	$ns attach-agent $s $tcp
+	set sink [new Agent/TCPSink/Sack1]
+	$ns attach-agent $d $sink
+	$ns connect $tcp $sink
+	set ftp [$tcp attach-app FTP]
+	$ns at [$defaultRNG uniform 0 1] "$ftp start"
+	return $tcp
+}
+
+for {set i 0} {$i < $val(nfg)} {incr i} {
+	set fg($i) [flow $i]
+}
+if {$val(mode) == "packet"} {
+	for {set i 0} {$i < $val(nbg)} {incr i} {
+		set bg($i) [flow [expr $val(nfg) + $i]]
+	}
+} else {
+	set fm [$ns fluid-model $r1 $r2]
+	$fm add-class $val(nbg) 0.1
+	$ns at 0 "$fm start"
+}
+
+proc finish {} {
+	global ns val fg bg fm wall
+	set t [expr [clock clicks -milliseconds] - $wall]
+	set bytes 0
+	set pkts 0
+	set rtt 0
+	for {set i 0} {$i < $val(nfg)} {incr i} {
+		incr bytes [expr [$fg($i) set ack_] * 1000]
+		incr pkts [$fg($i) set ndatapack_]
+		set rtt [expr $rtt + [$fg($i) set srtt_] / 8.0 * \
+		    [$fg($i) set tcpTick_]]
+	}
+	puts [format "%s %d background flows: foreground %.2f Mb/s (%d packets), srtt %.1f ms" \
+	    $val(mode) $val(nbg) [expr $bytes * 8.0 / $val(stop) / 1e6 / $val(nfg)] \
+	    $pkts [expr $rtt / $val(nfg) * 1000]]
+	if [info exists bg] {
+		for {set i 0} {$i < $val(nbg)} {incr i} {
+			incr bytes [expr [$bg($i) set ack_] * 1000]
+		}
+		puts [format "all %d flows: %.2f Mb/s" \
+		    [expr $val(nfg) + $val(nbg)] [expr $bytes * 8.0 / \
+		    $val(stop) / 1e6 / ($val(nfg) + $val(nbg))]]
+	}
+	if [info exists fm] {
+		set int [$fm get-integrator]
+		puts [format "fluid: queue %.1f pkts (mean %.1f), loss %.4f, window %.2f" \
+		    [$fm queue] [expr [$int set sum_] / $val(stop)] [$fm loss] \
+		    [$fm window 0]]
+	}
+	puts "$t ms"
+	exit 0
+}
+
+set wall [clock clicks -milliseconds]
+$ns at $val(stop) "finish"
+$ns run
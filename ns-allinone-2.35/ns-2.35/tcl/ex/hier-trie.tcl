@@ -0,0 +1,104 @@
+#
+# Benchmark of Classifier/Trie against Classifier/Hier.
+#
+# ndom domains of ncl clusters of nnodes nodes: the nodes of a cluster
+# hang off its first node, the clusters of a domain off its first
+# cluster and the domains form a ring.  Every node sends CBR traffic to
+# the node half way across the topology, so most packets cross every
+# level of the address hierarchy.
+#
+# usage: ns hier-trie.tcl [trie] [ndom] [ncl] [nnodes] [stop]
+#
+# Prints the wall clock time of the run, the packets delivered and, with
+# trie true, the prefixes, trie nodes and bytes of a classifier.
+#
+
+set val(trie)	true
+set val(ndom)	4
+set val(ncl)	4
+set val(nnodes)	8
+set val(stop)	10
+foreach v {trie ndom ncl nnodes stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+RtModule/Hier set trie_ $val(trie)
+set ns [new Simulator]
+$ns set-address-format hierarchical
+AddrParams set domain_num_ $val(ndom)
+set cls {}
+set nds {}
+for {set d 0} {$d < $val(ndom)} {incr d} {
+	lappend cls $val(ncl)
+	for {set c 0} {$c < $val(ncl)} {incr c} {
+		lappend nds $val(nnodes)
+	}
+}
+AddrParams set cluster_num_ $cls
+AddrParams set nodes_num_ $nds
+
+set nn 0
+for {set d 0} {$d < $val(ndom)} {incr d} {
+	for {set c 0} {$c < $val(ncl)} {incr c} {
+		for {set i 0} {$i < $val(nnodes)} {incr i} {
+			set n($nn) [$ns node $d.$c.$i]
+			if {$i > 0} {
+				$ns duplex-link $n($nn) $n([expr $nn - $i]) \
+				    10Mb 1ms DropTail
+			}
+			incr nn
+		}
+		if {$c > 0} {
+			set head [expr $nn - $val(nnodes)]
+			$ns duplex-link $n($head) \
+			    $n([expr $head - $c * $val(nnodes)]) 100Mb 2ms DropTail
+		}
+	}
+}
+set per [expr $val(ncl) * $val(nnodes)]
+if {$val(ndom) > 1} {
+	for {set d 0} {$d < $val(ndom)} {incr d} {
+		set e [expr ($d + 1) % $val(ndom)]
+		if {$d != $e && !($val(ndom) == 2 && $d == 1)} {
+			$ns duplex-link $n([expr $d * $per]) $n([expr $e * $per]) \
+			    1Gb 5ms DropTail
+		}
+	}
+}
+
+for {set i 0} {$i < $nn} {incr i} {
+	set j [expr ($i + $nn / 2) % $nn]
+	set udp [new Agent/UDP]
+	$ns attach-agent $n($i) $udp
+	set null($i) [new Agent/LossMonitor]
+	$ns attach-agent $n($j) $null($i)
+	$ns connect $udp $null($i)
+	set cbr [new Application/Traffic/CBR]
+	$cbr set packetSize_ 200
+	$cbr set rate_ 400Kb
+	$cbr attach-agent $udp
+	$ns at [expr 0.001 * $i] "$cbr start"
+}
+
+proc finish {} {
+	global ns val nn n null start_
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	set pkts 0
+	for {set i 0} {$i < $nn} {incr i} {
+		incr pkts [$null($i) set npkts_]
+	}
+	puts "trie $val(trie): $nn nodes, [format %.2f $t] s,\
+	    $pkts packets delivered"
+	set cl [$n(0) entry]
+	if {[$cl info class] == "Classifier/Trie"} {
+		puts "node 0: [join [$cl stats] {, }]\
+		    (prefixes, trie nodes, bytes)"
+	}
+	$ns halt
+}
+
+$ns at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns run
@@ -0,0 +1,61 @@
+#
+# Long-fat-pipe benchmark for DelayLink fifo_.
+#
+# A chain of nlinks 10Gb/s, 50ms links is kept full by CBR traffic, so
+# every link has about 40000 packets in transit.  With fifo_ false each
+# of them is an event in the scheduler; with fifo_ true each link keeps
+# its packets in transit itself and has a single event scheduled.
+#
+# usage: ns link-fifo.tcl [fifo] [nlinks] [stop]
+#
+# Prints the wall clock time and the number of packets delivered; the
+# count is the same with either setting.
+#
+
+set val(fifo)	false
+set val(nlinks)	4
+set val(stop)	1.0
+foreach v {fifo nlinks stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(bw)	10Gb
+set val(delay)	50ms
+set val(psize)	1500
+
+DelayLink set fifo_ $val(fifo)
+
+set ns [new Simulator]
+
+set n(0) [$ns node]
+for {set i 1} {$i <= $val(nlinks)} {incr i} {
+	set n($i) [$ns node]
+	$ns duplex-link $n([expr $i - 1]) $n($i) $val(bw) $val(delay) DropTail
+	$ns queue-limit $n([expr $i - 1]) $n($i) 100
+}
+
+set udp [new Agent/UDP]
+$udp set packetSize_ $val(psize)
+$ns attach-agent $n(0) $udp
+set sink [new Agent/LossMonitor]
+$ns attach-agent $n($val(nlinks)) $sink
+$ns connect $udp $sink
+
+set cbr [new Application/Traffic/CBR]
+$cbr set packetSize_ $val(psize)
+$cbr set rate_ $val(bw)
+$cbr attach-agent $udp
+$ns at 0.0 "$cbr start"
+
+proc finish {} {
+	global ns val sink start_
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	puts "fifo_ $val(fifo), $val(nlinks) links: [format %.2f $t] s,\
+	    [$sink set npkts_] packets delivered"
+	$ns halt
+}
+
+$ns at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns run
@@ -0,0 +1,103 @@
+#
+# Backbone benchmark for Scheduler/Parallel.
+#
+# A grid of routers joined by 10ms links, each with a few hosts on 1ms
+# links, carries long-lived TCP flows between random hosts.  The nodes
+# are split into nparts partitions by "$ns partition", which keeps the
+# 1ms links inside partitions, so the lookahead is 10ms.
+#
+# usage: ns parallel-backbone.tcl [threads] [nparts] [side] [stop]
+#
+# Prints the wall clock time, the scheduler's statistics (windows,
+# serial events, events per partition) and the bytes received by all
+# sinks, which are the same for any number of threads.  nparts 0 runs
+# the topology on the ordinary calendar queue.
+#
+
+set val(threads) 4
+set val(nparts)	4
+set val(side)	8	;# routers per side of the grid
+set val(stop)	10.0
+foreach v {threads nparts side stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(hosts)	4	;# per router
+set val(flows)	[expr $val(side) * $val(side) * 2]
+
+set ns [new Simulator]
+if {$val(nparts) > 0} {
+	$ns use-scheduler Parallel
+	[$ns set scheduler_] set threads_ $val(threads)
+}
+$ns trace-all [open /dev/null w]
+
+for {set i 0} {$i < $val(side)} {incr i} {
+	for {set j 0} {$j < $val(side)} {incr j} {
+		set r($i,$j) [$ns node]
+		if {$i > 0} {
+			$ns duplex-link $r([expr $i - 1],$j) $r($i,$j) \
+			    100Mb 10ms DropTail
+		}
+		if {$j > 0} {
+			$ns duplex-link $r($i,[expr $j - 1]) $r($i,$j) \
+			    100Mb 10ms DropTail
+		}
+	}
+}
+set nh 0
+for {set i 0} {$i < $val(side)} {incr i} {
+	for {set j 0} {$j < $val(side)} {incr j} {
+		for {set k 0} {$k < $val(hosts)} {incr k} {
+			set h($nh) [$ns node]
+			$ns duplex-link $h($nh) $r($i,$j) 100Mb 1ms DropTail
+			incr nh
+		}
+	}
+}
+
+if {$val(nparts) > 0} {
+	set la [$ns partition $val(nparts)]
+	puts "$val(nparts) partitions, lookahead $la"
+}
+
+set rng [new RNG]
+$rng seed 1
+for {set f 0} {$f < $val(flows)} {incr f} {
+	set s [$rng integer $nh]
+	set d [$rng integer $nh]
+	if {$d == $s} {
+		set d [expr ($s + 1) % $nh]
+	}
+	set tcp [new Agent/TCP/Newreno]
+	$tcp set window_ 64
+	$ns attach-agent $h($s) $tcp
+	set sink($f) [new Agent/TCPSink]
+	$ns attach-agent $h($d) $sink($f)
+	$ns connect $tcp $sink($f)
+	set ftp [new Application/FTP]
+	$ftp attach-agent $tcp
+	$ns at [expr 0.1 + [$rng uniform 0 1]] "$ftp start"
+}
+
+proc finish {} {
+	global ns val sink start_
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	set bytes 0
+	for {set f 0} {$f < $val(flows)} {incr f} {
+		incr bytes [$sink($f) set bytes_]
+	}
+	set stats ""
+	if {$val(nparts) > 0} {
+		set stats " (windows, serial events, events:\
+		    [[$ns set scheduler_] stats])"
+	}
+	puts "threads $val(threads): [format %.2f $t] s$stats,\
+	    $bytes bytes received"
+	$ns halt
+}
+
+$ns at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns run
@@ -0,0 +1,55 @@
+#
+# Example of Simulator profile.
+#
+# nflows TCP flows and as many CBR flows cross a RED bottleneck, and
+# the event loop is profiled by handler class.  The table goes to
+# stdout; with a file name, the JSON report is written there too.
+#
+# usage: ns profile.tcl [nflows] [stop] [json-file]
+#
+
+set val(nflows)	20
+set val(stop)	20.0
+set val(json)	""
+foreach v {nflows stop json} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+set ns [new Simulator]
+set r0 [$ns node]
+set r1 [$ns node]
+$ns duplex-link $r0 $r1 20Mb 20ms RED
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	set s [$ns node]
+	set d [$ns node]
+	$ns duplex-link $s $r0 100Mb [expr 1 + $i % 10]ms DropTail
+	$ns duplex-link $r1 $d 100Mb 1ms DropTail
+	set tcp [$ns create-connection TCP/Sack1 $s TCPSink/Sack1 $d $i]
+	set ftp [$tcp attach-app FTP]
+	$ns at [expr $i * 0.05] "$ftp start"
+
+	set udp [new Agent/UDP]
+	$ns attach-agent $s $udp
+	set null [new Agent/Null]
+	$ns attach-agent $d $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr set rate_ 200Kb
+	$cbr attach-agent $udp
+	$ns at 0.0 "$cbr start"
+}
+
+proc finish {} {
+	global ns val
+	puts -nonewline [$ns profile-report]
+	if {$val(json) != ""} {
+		$ns profile-report json $val(json)
+	}
+	exit 0
+}
+
+$ns profile on
+$ns at $val(stop) "finish"
+$ns run
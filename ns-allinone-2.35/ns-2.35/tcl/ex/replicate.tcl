@@ -0,0 +1,78 @@
+#
+# Example of Simulator replicate.
+#
+# nflows TCP flows with random start times and exponential on/off UDP
+# cross traffic share a bottleneck.  The topology is built once; the
+# script then forks nrep replications, njobs at a time, each drawing
+# from its own substream of the random number generators, and the
+# throughput, drops and mean cwnd of each are summarized in out (or on
+# stdout).
+#
+# usage: ns replicate.tcl [nrep] [njobs] [nflows] [stop] [out]
+#
+
+set val(nrep)	10
+set val(njobs)	0
+set val(nflows)	8
+set val(stop)	20.0
+set val(out)	""
+foreach v {nrep njobs nflows stop out} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+set ns [new Simulator]
+set r0 [$ns node]
+set r1 [$ns node]
+$ns duplex-link $r0 $r1 10Mb 20ms DropTail
+$ns queue-limit $r0 $r1 50
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	set s($i) [$ns node]
+	set d($i) [$ns node]
+	$ns duplex-link $s($i) $r0 100Mb 1ms DropTail
+	$ns duplex-link $r1 $d($i) 100Mb 1ms DropTail
+	set tcp($i) [$ns create-connection TCP/Sack1 $s($i) TCPSink/Sack1 \
+	    $d($i) $i]
+	set ftp($i) [$tcp($i) attach-app FTP]
+}
+set udp [new Agent/UDP]
+$ns attach-agent $s(0) $udp
+set null [new Agent/Null]
+$ns attach-agent $d(0) $null
+$ns connect $udp $null
+set exp [new Application/Traffic/Exponential]
+$exp set rate_ 4Mb
+$exp set burst_time_ 200ms
+$exp set idle_time_ 300ms
+$exp attach-agent $udp
+
+set start [new RandomVariable/Uniform]
+$start set min_ 0
+$start set max_ 2
+
+set qm [$ns monitor-queue $r0 $r1 ""]
+
+# Everything above is shared by the replications.
+set rep [$ns replicate $val(nrep) $val(njobs) $val(out)]
+
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	$ns at [$start value] "$ftp($i) start"
+}
+$ns at 0.0 "$exp start"
+
+proc finish {} {
+	global ns val qm tcp
+	set cwnd 0.0
+	for {set i 0} {$i < $val(nflows)} {incr i} {
+		set cwnd [expr $cwnd + [$tcp($i) set cwnd_]]
+	}
+	$ns replication-stat thruput \
+	    [expr [$qm set bdepartures_] * 8.0 / $val(stop) / 1e6]
+	$ns replication-stat drops [$qm set pdrops_]
+	$ns replication-stat cwnd [expr $cwnd / $val(nflows)]
+	exit 0
+}
+
+$ns at $val(stop) "finish"
+$ns run
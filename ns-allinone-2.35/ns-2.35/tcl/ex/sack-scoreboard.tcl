@@ -0,0 +1,86 @@
+#
+# Benchmark of the SACK scoreboards with very large windows.
+#
+# One bulk TCP transfer over a bw, rtt path whose bottleneck queue
+# holds a tenth of the bandwidth-delay product, so that slow start
+# ends with thousands of drops spread over a window of 10^5 packets,
+# and the recovery walks a scoreboard of thousands of holes.  The
+# sender is Agent/TCP/Sack1 (ScoreBoardRQ), Agent/TCP/Fack
+# (ScoreBoardRQRetran) or Agent/TCP/FullTcp/Sack (its ReassemblyQueue).
+# Reports the goodput, the packets sent and the wall-clock time.
+#
+# usage: ns sack-scoreboard.tcl [Sack1|Fack|FullSack] [bw] [rtt] [stop]
+#
+# The defaults are a 10Gb/s, 200ms path (a window of about 170000
+# 1460-byte packets) for 6 simulated seconds, a few minutes of CPU.
+#
+
+set val(tcp)	Sack1
+set val(bw)	10Gb
+set val(rtt)	200ms
+set val(stop)	6.0
+foreach v {tcp bw rtt stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(size)	1460
+
+set ns [new Simulator]
+set s [$ns node]
+set r1 [$ns node]
+set r2 [$ns node]
+set d [$ns node]
+
+set bw [bw_parse $val(bw)]
+set owd [expr [time_parse $val(rtt)] / 2]
+set bdp [expr int($bw * 2 * $owd / 8 / ($val(size) + 40))]
+$ns duplex-link $s $r1 [expr 2 * $bw] 1ms DropTail
+$ns duplex-link $r1 $r2 $bw [expr $owd - 0.002] DropTail
+$ns duplex-link $r2 $d [expr 2 * $bw] 1ms DropTail
+$ns queue-limit $s $r1 [expr 4 * $bdp]
+$ns queue-limit $r1 $r2 [expr $bdp / 10]
+$ns queue-limit $r2 $d [expr 4 * $bdp]
+
+if {$val(tcp) == "FullSack"} {
+	set tcp [new Agent/TCP/FullTcp/Sack]
+	set sink [new Agent/TCP/FullTcp/Sack]
+	$tcp set segsize_ $val(size)
+	$sink set segsize_ $val(size)
+	$ns attach-agent $s $tcp
+	$ns attach-agent $d $sink
+	$ns connect $tcp $sink
+	$sink set window_ [expr 2 * $bdp]
+	$sink listen
+} else {
+	set tcp [new Agent/TCP/$val(tcp)]
+	set sink [new Agent/TCPSink/Sack1]
+	$tcp set packetSize_ $val(size)
+	$ns attach-agent $s $tcp
+	$ns attach-agent $d $sink
+	$ns connect $tcp $sink
+}
+$tcp set window_ [expr 2 * $bdp]
+$tcp set windowInit_ 10
+set ftp [$tcp attach-app FTP]
+$ns at 0 "$ftp start"
+
+proc finish {} {
+	global ns tcp val wall
+	set t [expr [clock clicks -milliseconds] - $wall]
+	if {$val(tcp) == "FullSack"} {
+		set acked [expr [$tcp set ack_] / $val(size)]
+	} else {
+		set acked [$tcp set ack_]
+	}
+	puts [format "%s %s %s: %.3f Gb/s, %d packets sent, %d retransmitted" \
+	    $val(tcp) $val(bw) $val(rtt) \
+	    [expr $acked * $val(size) * 8.0 / $val(stop) / 1e9] \
+	    [$tcp set ndatapack_] [$tcp set nrexmitpack_]]
+	puts "$t ms"
+	exit 0
+}
+
+set wall [clock clicks -milliseconds]
+$ns at $val(stop) "finish"
+$ns run
@@ -0,0 +1,81 @@
+#
+# Example of QueueMonitor/Sketch.
+#
+# A link carries nmice short flows (a CBR source that changes its flow
+# id every millisecond) and four long flows of 1, 2, 4 and 8 Mb/s.  A
+# sketch monitor on the link estimates the number of flows, finds the
+# heaviest ones and estimates the bytes of the long flows, in the same
+# few tens of kilobytes however many flows there are.
+#
+# usage: ns sketch-monitor.tcl [nmice] [sample]
+#
+
+set val(nmice)	20000
+set val(sample)	1
+foreach v {nmice sample} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(stop) [expr $val(nmice) * 0.001]
+
+set ns [new Simulator]
+set n0 [$ns node]
+set n1 [$ns node]
+$ns duplex-link $n0 $n1 100Mb 5ms DropTail
+$ns queue-limit $n0 $n1 1000
+
+QueueMonitor/Sketch set sample_ $val(sample)
+set sk [$ns monitor-sketch $n0 $n1]
+
+proc cbr {fid rate} {
+	global ns n0 n1
+	set udp [new Agent/UDP]
+	$udp set fid_ $fid
+	$ns attach-agent $n0 $udp
+	set null [new Agent/Null]
+	$ns attach-agent $n1 $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr set packetSize_ 1000
+	$cbr set rate_ $rate
+	$cbr attach-agent $udp
+	$ns at 0.0 "$cbr start"
+	return $udp
+}
+
+set mice [cbr 0 8Mb]
+for {set i 0} {$i < 4} {incr i} {
+	set long($i) [cbr [expr 1000000 + $i] [expr 1 << $i]Mb]
+}
+
+proc nextflow fid {
+	global ns mice val
+	$mice set fid_ $fid
+	if {$fid + 1 < $val(nmice)} {
+		$ns at [expr [$ns now] + 0.001] "nextflow [expr $fid + 1]"
+	}
+}
+
+proc finish {} {
+	global ns sk val long
+	puts "flows: [expr $val(nmice) + 4], estimated\
+	    [$sk cardinality]; sketch memory [$sk memory] bytes"
+	puts "heaviest (src sport dst dport fid bytes err):"
+	foreach e [lrange [$sk topk] 0 4] {
+		puts "\t$e"
+	}
+	for {set i 0} {$i < 4} {incr i} {
+		set u $long($i)
+		set bytes [expr (1 << $i) * 125000 * $val(stop)]
+		puts "long flow $i: about [format %.0f $bytes] bytes,\
+		    estimated [$sk estimate [$u set agent_addr_] \
+		    [$u set agent_port_] [$u set dst_addr_] \
+		    [$u set dst_port_] [$u set fid_]]"
+	}
+	$ns halt
+}
+
+$ns at 0.0 "nextflow 1"
+$ns at $val(stop) "finish"
+$ns run
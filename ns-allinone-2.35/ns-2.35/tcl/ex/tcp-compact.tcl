@@ -0,0 +1,67 @@
+#
+# Memory per connection of Agent/TCP/Compact against Agent/TCP/Newreno.
+#
+# Creates n agents of the given class, each connected to a TCPSink and
+# sending through a shared dumbbell, and reports the resident memory
+# per connection (from /proc/self/status, so Linux only) and, after
+# running the simulation, the aggregate goodput.
+#
+# usage: ns tcp-compact.tcl [Agent/TCP/Compact|Agent/TCP/Newreno] [n] [stop]
+#
+
+set val(cls)	Agent/TCP/Compact
+set val(n)	10000
+set val(stop)	10.0
+foreach v {cls n stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+
+proc rss {} {
+	if [catch {open /proc/self/status} f] {
+		return 0
+	}
+	set kb 0
+	while {[gets $f line] >= 0} {
+		if [regexp {^VmRSS:\s+([0-9]+)} $line dummy kb] {
+			break
+		}
+	}
+	close $f
+	return [expr $kb * 1024.0]
+}
+
+set ns [new Simulator]
+set s [$ns node]
+set d [$ns node]
+$ns duplex-link $s $d 100Mb 20ms DropTail
+$ns queue-limit $s $d 1000
+
+set m0 [rss]
+for {set i 0} {$i < $val(n)} {incr i} {
+	set tcp($i) [new $val(cls)]
+	$ns attach-agent $s $tcp($i)
+	set sink [new Agent/TCPSink]
+	$ns attach-agent $d $sink
+	$ns connect $tcp($i) $sink
+	$ns at [expr $i * $val(stop) / $val(n)] "$tcp($i) advanceby 20"
+}
+set m1 [rss]
+if {$m1 > 0} {
+	puts [format "%s: %d connections, %.0f bytes per connection" \
+	    $val(cls) $val(n) [expr ($m1 - $m0) / $val(n)]]
+}
+
+proc finish {} {
+	global tcp val
+	set acked 0
+	for {set i 0} {$i < $val(n)} {incr i} {
+		incr acked [expr [$tcp($i) set ack_] + 1]
+	}
+	puts "$acked packets acked"
+	exit 0
+}
+
+$ns at $val(stop) "finish"
+$ns run
@@ -0,0 +1,74 @@
+#
+# Benchmark of TCP-Linux with batched ACK processing.
+#
+# nflows Agent/TCP/Linux flows running a congestion control module
+# (cubic or htcp) share a bw, 50ms bottleneck with a queue of a
+# bandwidth-delay product.  With batch > 1 the senders process ACKs
+# as stretch ACKs of up to batch ACKs each, the way a Linux sender
+# sees them after GRO; see ack_batch_ in tcp-linux.h.  Reports the
+# aggregate goodput, the ACKs processed and the wall-clock time.
+#
+# usage: ns batch-ack.tcl [cubic|htcp] [batch] [bw] [nflows] [stop]
+#
+
+set val(ca)	cubic
+set val(batch)	1
+set val(bw)	1Gb
+set val(nflows)	4
+set val(stop)	20.0
+foreach v {ca batch bw nflows stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(size)	1460
+
+set ns [new Simulator]
+set r1 [$ns node]
+set r2 [$ns node]
+set bw [bw_parse $val(bw)]
+set bdp [expr int($bw * 0.1 / 8 / ($val(size) + 40))]
+$ns duplex-link $r1 $r2 $bw 20ms DropTail
+$ns queue-limit $r1 $r2 $bdp
+
+for {set i 0} {$i < $val(nflows)} {incr i} {
+	set s [$ns node]
+	set d [$ns node]
+	$ns duplex-link $s $r1 [expr 10 * $bw] 2ms DropTail
+	$ns duplex-link $r2 $d [expr 10 * $bw] [expr 3 + $i]ms DropTail
+	$ns queue-limit $s $r1 [expr 10 * $bdp]
+	$ns queue-limit $r2 $d [expr 10 * $bdp]
+	set tcp($i) [new Agent/TCP/Linux]
+	$tcp($i) set timestamps_ true
+	$tcp($i) set window_ [expr 10 * $bdp]
+	$tcp($i) set packetSize_ $val(size)
+	$tcp($i) set ack_batch_ $val(batch)
+	$ns attach-agent $s $tcp($i)
+	set sink [new Agent/TCPSink/Sack1]
+	$sink set ts_echo_rfc1323_ true
+	$ns attach-agent $d $sink
+	$ns connect $tcp($i) $sink
+	set ftp [$tcp($i) attach-app FTP]
+	$ns at 0 "$tcp($i) select_ca $val(ca)"
+	$ns at [expr $i * 0.5] "$ftp start"
+}
+
+proc finish {} {
+	global ns tcp val wall
+	set t [expr [clock clicks -milliseconds] - $wall]
+	set acked 0
+	set acks 0
+	for {set i 0} {$i < $val(nflows)} {incr i} {
+		incr acked [$tcp($i) set ack_]
+		incr acks [$tcp($i) set nackpack_]
+	}
+	puts [format "%s batch %d %s x %d: %.3f Gb/s, %d acks" \
+	    $val(ca) $val(batch) $val(bw) $val(nflows) \
+	    [expr $acked * $val(size) * 8.0 / $val(stop) / 1e9] $acks]
+	puts "$t ms"
+	exit 0
+}
+
+set wall [clock clicks -milliseconds]
+$ns at $val(stop) "finish"
+$ns run
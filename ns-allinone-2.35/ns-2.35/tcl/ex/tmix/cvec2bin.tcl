@@ -0,0 +1,19 @@
+#
+# cvec2bin.tcl - write a Tmix connection vector file in binary form
+#
+# The input is a text cvec file in either format (original, or the
+# output of tmix/cvec-orig2alt.pl).  Tmix and Tmix_DelayBox "set-cvfile"
+# take the output as they take the text, and map it rather than parse
+# it; see tmix/tmix_cvbin.h.
+#
+# usage: ns cvec2bin.tcl in.cvec out.cvb
+#
+
+if {[llength $argv] != 2} {
+	puts stderr "usage: ns cvec2bin.tcl in.cvec out.cvb"
+	exit 1
+}
+set tmix [new Tmix]
+$tmix set-cvfile [lindex $argv 0]
+puts "[$tmix write-cvbin [lindex $argv 1]] connection vectors"
+exit 0
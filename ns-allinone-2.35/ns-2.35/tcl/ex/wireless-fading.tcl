@@ -0,0 +1,122 @@
+#
+# Fading-model benchmark for Propagation/Shadowing and
+# Propagation/Nakagami.
+#
+# First times the model's fading draws alone ("$prop fading"); for
+# Shadowing both one at a time from the RNG (batch_ false) and in
+# blocks from the model's own stream (batch_ true).  Then runs a dense cell of 802.11 nodes
+# where a few nodes broadcast CBR traffic, so that nearly every frame
+# is received, and its fading drawn, at every other node.
+#
+# usage: ns wireless-fading.tcl [shadowing|nakagami] [batch] [nn] [stop]
+#
+# Prints the draw rates, then the wall clock time of the scenario
+# (with the given batch_, Shadowing only) and the number of frames
+# received.
+#
+
+set val(model)	nakagami
+set val(batch)	false
+set val(nn)	100
+set val(stop)	10.0
+foreach v {model batch nn stop} a $argv {
+	if {$a != ""} {
+		set val($v) $a
+	}
+}
+set val(senders) 4
+set val(x)	200
+set val(y)	200
+
+if {$val(model) == "shadowing"} {
+	set val(prop) Propagation/Shadowing
+	Propagation/Shadowing set batch_ $val(batch)
+	Propagation/Shadowing set pathlossExp_ 2.0
+	set batches {false true}
+} else {
+	set val(prop) Propagation/Nakagami
+	Propagation/Nakagami set use_nakagami_dist_ true
+	set val(batch) -
+	set batches -
+}
+
+set ndraws 1000000
+foreach b $batches {
+	set p [new $val(prop)]
+	if {$b != "-"} {
+		$p set batch_ $b
+	}
+	set t0 [clock clicks -milliseconds]
+	if {$val(model) == "shadowing"} {
+		set mean [$p fading $ndraws]
+	} else {
+		# beyond d1_m_, where m is not an integer
+		set mean [$p fading $ndraws 300]
+	}
+	set t [expr ([clock clicks -milliseconds] - $t0) / 1000.0]
+	puts "$val(model) fading, batch $b: [format %.2f $t] s for\
+	    $ndraws draws (mean factor [format %.3f $mean])"
+}
+
+set ns_ [new Simulator]
+set tracefd [open /dev/null w]
+$ns_ trace-all $tracefd
+set topo [new Topography]
+$topo load_flatgrid $val(x) $val(y)
+create-god $val(nn)
+
+$ns_ node-config -adhocRouting DumbAgent \
+		-llType LL \
+		-macType Mac/802_11 \
+		-ifqType Queue/DropTail/PriQueue \
+		-ifqLen 50 \
+		-antType Antenna/OmniAntenna \
+		-propType $val(prop) \
+		-phyType Phy/WirelessPhy \
+		-topoInstance $topo \
+		-agentTrace OFF \
+		-routerTrace OFF \
+		-macTrace OFF \
+		-movementTrace OFF \
+		-channel [new Channel/WirelessChannel]
+
+set rng [new RNG]
+$rng seed 1
+for {set i 0} {$i < $val(nn)} {incr i} {
+	set node_($i) [$ns_ node]
+	$node_($i) random-motion 0
+	$node_($i) set X_ [$rng uniform 0 $val(x)]
+	$node_($i) set Y_ [$rng uniform 0 $val(y)]
+	$node_($i) set Z_ 0
+	set sink_($i) [new Agent/LossMonitor]
+	$ns_ attach-agent $node_($i) $sink_($i)
+}
+
+for {set k 0} {$k < $val(senders)} {incr k} {
+	set udp [new Agent/UDP]
+	$ns_ attach-agent $node_($k) $udp
+	$udp set dst_addr_ -1
+	$udp set dst_port_ [$sink_(0) set agent_port_]
+	set cbr [new Application/Traffic/CBR]
+	$cbr set packetSize_ 256
+	$cbr set interval_ 0.01
+	$cbr set random_ 1
+	$cbr attach-agent $udp
+	$ns_ at [expr 0.1 + 0.01 * $k] "$cbr start"
+}
+
+proc finish {} {
+	global ns_ val sink_ start_
+	set frames 0
+	for {set i 0} {$i < $val(nn)} {incr i} {
+		incr frames [$sink_($i) set npkts_]
+	}
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	puts "$val(model) batch $val(batch), $val(nn) nodes:\
+	    [format %.2f $t] s, $frames frames received"
+	$ns_ halt
+}
+
+$ns_ at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns_ run
@@ -0,0 +1,108 @@
+#
+# Orthogonal-channel benchmark for Channel/WirelessChannel.
+#
+# Every node has one 802.11 radio on each of nchan channels, and on
+# every channel a few nodes broadcast CBR traffic.  Since the channels
+# are orthogonal, a frame sent on one channel should only be handed to
+# the radios tuned to that channel, so the work per frame does not grow
+# with the number of radios a node carries.
+#
+# usage: ns wireless-multichannel.tcl [nn] [nchan] [stop]
+#
+# Prints the wall clock time and the number of frames received per
+# channel; run it with increasing nchan to see the per-frame cost.
+#
+
+set val(nn)	[expr [llength $argv] > 0 ? [lindex $argv 0] : 50]
+set val(nchan)	[expr [llength $argv] > 1 ? [lindex $argv 1] : 4]
+set val(stop)	[expr [llength $argv] > 2 ? [lindex $argv 2] : 10.0]
+set val(senders) 3	;# broadcasters per channel
+set val(x)	500
+set val(y)	500
+
+set val(chan)	Channel/WirelessChannel
+set val(prop)	Propagation/TwoRayGround
+set val(netif)	Phy/WirelessPhy
+set val(mac)	Mac/802_11
+set val(ifq)	Queue/DropTail/PriQueue
+set val(ll)	LL
+set val(ant)	Antenna/OmniAntenna
+set val(ifqlen)	50
+
+set ns_ [new Simulator]
+set tracefd [open /dev/null w]
+$ns_ trace-all $tracefd
+set topo [new Topography]
+$topo load_flatgrid $val(x) $val(y)
+create-god $val(nn)
+
+for {set c 0} {$c < $val(nchan)} {incr c} {
+	set chan_($c) [new $val(chan)]
+}
+
+# the first radio comes from node-config, the others are added below
+$ns_ node-config -adhocRouting DumbAgent \
+		-llType $val(ll) \
+		-macType $val(mac) \
+		-ifqType $val(ifq) \
+		-ifqLen $val(ifqlen) \
+		-antType $val(ant) \
+		-propType $val(prop) \
+		-phyType $val(netif) \
+		-topoInstance $topo \
+		-agentTrace OFF \
+		-routerTrace OFF \
+		-macTrace OFF \
+		-movementTrace OFF \
+		-channel $chan_(0)
+
+set rng [new RNG]
+$rng seed 1
+set prop [$ns_ set propInstance_]
+for {set i 0} {$i < $val(nn)} {incr i} {
+	set node_($i) [$ns_ node]
+	$node_($i) random-motion 0
+	$node_($i) set X_ [$rng uniform 0 $val(x)]
+	$node_($i) set Y_ [$rng uniform 0 $val(y)]
+	$node_($i) set Z_ 0
+	for {set c 1} {$c < $val(nchan)} {incr c} {
+		$node_($i) add-interface $chan_($c) $prop $val(ll) $val(mac) \
+		    $val(ifq) $val(ifqlen) $val(netif) $val(ant) $topo "" "" ""
+	}
+	set sink_($i) [new Agent/LossMonitor]
+	$ns_ attach-agent $node_($i) $sink_($i)
+}
+
+# broadcast sources, sent straight into the radio for their channel
+for {set c 0} {$c < $val(nchan)} {incr c} {
+	for {set k 0} {$k < $val(senders)} {incr k} {
+		set n $node_([expr ($c * $val(senders) + $k) % $val(nn)])
+		set udp [new Agent/UDP]
+		$ns_ attach-agent $n $udp
+		$udp target [$n set ll_($c)]
+		$udp set dst_addr_ -1
+		$udp set dst_port_ [$sink_(0) set agent_port_]
+		set cbr [new Application/Traffic/CBR]
+		$cbr set packetSize_ 512
+		$cbr set interval_ 0.02
+		$cbr set random_ 1
+		$cbr attach-agent $udp
+		$ns_ at [expr 0.1 + 0.01 * $k] "$cbr start"
+	}
+}
+
+proc finish {} {
+	global ns_ val sink_ start_
+	set frames 0
+	for {set i 0} {$i < $val(nn)} {incr i} {
+		incr frames [$sink_($i) set npkts_]
+	}
+	set t [expr ([clock clicks -milliseconds] - $start_) / 1000.0]
+	puts "nodes $val(nn) channels $val(nchan): [format %.2f $t] s,\
+	    [expr $frames / $val(nchan)] frames received per channel"
+	$ns_ halt
+}
+
+$ns_ at $val(stop) "finish"
+set start_ [clock clicks -milliseconds]
+$ns_ run
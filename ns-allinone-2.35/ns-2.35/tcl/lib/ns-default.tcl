@@ -75,6 +75,11 @@ Scheduler/RealTime set maxslop_ 0.010; # max allowed slop b4 error (sec)
 Scheduler/Calendar set adjust_new_width_interval_ 10;	# the interval (in unit of resize times) we recalculate bin width. 0 means disable dynamic adjustment
 Scheduler/Calendar set min_bin_width_ 1e-18;		# the lower bound for the bin_width
 
+Scheduler/Parallel set adjust_new_width_interval_ 10
+Scheduler/Parallel set min_bin_width_ 1e-18
+Scheduler/Parallel set lookahead_ 0;	# set by "$ns partition"
+Scheduler/Parallel set threads_ 0;	# 0: sequential run, else windows
+
 #
 # Queues and associated
 #
@@ -86,6 +91,8 @@ Integrator set sum_ 0.0
 Queue set limit_ 50
 Queue set blocked_ false
 Queue set unblock_on_resume_ true
+Queue set lazy_resume_ false;		# true: no link callback when empty
+Queue set trains_ false;		# true: take packet trains in one piece
 
 Queue set interleave_ false
 Queue set acksfirst_ false
@@ -329,11 +336,20 @@ QueueMonitor/ED set ebdrops_ 0
 QueueMonitor/ED set mon_epdrops_ 0                     
 QueueMonitor/ED set mon_ebdrops_ 0
 
+QueueMonitor/Sketch set cm_width_ 2048
+QueueMonitor/Sketch set cm_depth_ 4
+QueueMonitor/Sketch set topk_ 32
+QueueMonitor/Sketch set hll_bits_ 12
+QueueMonitor/Sketch set ports_ true
+QueueMonitor/Sketch set bytes_ true;	# else count packets
+QueueMonitor/Sketch set sample_ 1;	# count 1 arrival in sample_
+
 QueueMonitor/ED/Flowmon set enable_in_ true
 QueueMonitor/ED/Flowmon set enable_out_ true
 QueueMonitor/ED/Flowmon set enable_drop_ true
 QueueMonitor/ED/Flowmon set enable_edrop_ true
 QueueMonitor/ED/Flowmon set enable_mon_edrop_ true
+QueueMonitor/ED/Flowmon set snapshot_interval_ 0;	# snapshots only on request
 
 QueueMonitor/ED/Flow set src_ -1
 QueueMonitor/ED/Flow set dst_ -1
@@ -362,9 +378,16 @@ DelayLink set debug_ false
 DelayLink set avoidReordering_ false ;	# Added 3/27/2003.
 					# Set to true to avoid reordering when
 					#   changing link bandwidth or delay.
+DelayLink set fifo_ false ;	# keep packets in transit in the link
 DynamicLink set status_ 1
 DynamicLink set debug_ false
 
+FluidModel set debug_ false
+FluidModel set step_ 1ms
+FluidModel set pktsize_ 1040;	# Agent/TCP packetSize_, and its header
+FluidModel set maxwnd_ 20;		# as Agent/TCP window_
+FluidModel set minrto_ 200ms;		# as Agent/TCP minrto_
+
 
 Filter set debug_ false
 Filter/Field set offset_ 0
@@ -379,6 +402,9 @@ Classifier set mask_ 0xffffffff
 Classifier set debug_ false
 
 Classifier/Hash set default_ -1; # none
+Classifier/Hash/Flow set ports_ true;	# key on the 5-tuple, not src/dst/fid
+Classifier/Hash/Flow set idle_timeout_ 0;	# never expire records
+Classifier/Trie set stride_ 8;	# address bits per trie node, 1 to 16
 Classifier/Replicator set ignore_ 0
 
 # MPLS Classifier
@@ -569,6 +595,9 @@ Node/MobileNode set delay_				0	;# not used
 Node/MobileNode set REGAGENT_PORT 0
 Node/MobileNode set DECAP_PORT 1
 
+EnergyModel set lazy_ false	;# integrate energy only when it is read
+EnergySnapshot set interval_ 1.0
+
 
 # Default settings for Hierarchical topology
 #
@@ -667,6 +696,7 @@ GAFPartner set debug_ false
 Mac set debug_ false
 ARPTable set debug_ false
 ARPTable set avoidReordering_ false ; #not used
+ARPTable set fifo_ false ; #not used
 God set debug_ false
 
 Mac/Tdma set slot_packet_len_	1500
@@ -677,6 +707,7 @@ LL set delay_                   25us
 LL set bandwidth_               0       ;# not used
 LL set debug_ false
 LL set avoidReordering_ false ;	#not used 
+LL set fifo_ false ;	#not used
 
 Snoop set debug_ false
 
@@ -791,6 +822,7 @@ Propagation/Shadowing set pathlossExp_ 2.0
 Propagation/Shadowing set std_db_ 4.0
 Propagation/Shadowing set dist0_ 1.0
 Propagation/Shadowing set seed_ 0
+Propagation/Shadowing set batch_ false	;# draw the shadowing in blocks
 
 Propagation/Nakagami set gamma0_ 1.9
 Propagation/Nakagami set gamma1_ 3.8
@@ -872,6 +904,7 @@ Agent/SCTP set dormantAction_ 0		;# 0 = change dest, 1 = use primary, 2 = use la
 ## PN: 5/2007. NR-Sacks & send window simulation 
 Agent/SCTP set initialSwnd_ 0          ;# initial send window; 0=No Send window
 Agent/SCTP set useNonRenegSacks_ 0     ;# turn off non-renegable sack option
+Agent/SCTP set lazyRtxTimer_ 0         ;# 1 = T3-rtx put off without resched
                                                                              
 ## These variables are for simulating reactive routing overheads (for         
 ## MANETs, etc). This feature is turned off is delay is 0. The cache lifetime 
@@ -978,6 +1011,9 @@ Agent/TCP set timerfix_ true ; 		# Variable added on 2001/05/11
 Agent/TCP set rfc2988_ true ;		# Default set to "true" on 2002/03/07.
 					# Set rfc2988_ "true" to give RFC2988-
 					#  compliant behavior for timers.
+Agent/TCP set lazy_timer_ false ;	# Set to "true" to put the retransmit
+					#  timer off without rescheduling it
+					#  on each ACK.
 Agent/TCP instproc done {} { }
 Agent/TCP set noFastRetrans_ false
 Agent/TCP set partial_ack_ false ;	# Variable added on 2002/12/28.
@@ -1414,6 +1450,7 @@ Simulator set nix-routing 0
 #Routing Module variable setting
 RtModule set classifier_ ""
 RtModule/Base set classifier_ ""
+RtModule/Hier set trie_ false
 #RtModule/Hier set classifier_ [new Classifier/Hier]
 #RtModule/Manual set classifier_ [new Classifier/Hash/Dest 2]
 #RtModule/VC set classifier_ [new Classifier/Virtual]
@@ -1551,6 +1588,7 @@ Agent/DCCP/TCPlike set q_opt_ratio_ 1
 Agent/DCCP/TCPlike set dack_delay_ 0.2
 
 Agent/DCCP/TCPlike set ackv_size_lim_ 10
+Agent/DCCP/TCPlike set lazy_timer_ 0
 
 Agent/DCCP/TFRC set ccid_ 3
 Agent/DCCP/TFRC set use_ecn_local_ 1
@@ -1605,6 +1643,8 @@ Agent/TCP/Linux set minrto_ 0.2
 Agent/TCP/Linux set ts_resetRTO_ true
 Agent/TCP/Linux set next_pkts_in_flight_ 0
 Agent/TCP/Linux set delay_growth_ false
+Agent/TCP/Linux set ack_batch_ 1;		# > 1: process ACKs as stretch ACKs
+Agent/TCP/Linux set ack_batch_time_ 0.0001
 
 Agent/PBC set payloadSize 200
 Agent/PBC set periodicBroadcastInterval 1
@@ -147,6 +147,7 @@ source ns-trace.tcl
 source ns-random.tcl
 source ns-agent.tcl
 source ns-route.tcl
+source ns-parallel.tcl
 source ns-errmodel.tcl
 source ns-intserv.tcl
 source ns-cmutrace.tcl
@@ -1042,6 +1043,151 @@ Simulator instproc dumpq {} {
 	$scheduler_ dumpq
 }
 
+#
+# "$ns profile on ?every?" charges each event of the following runs to
+# its handler's C++ class, sampling the number of pending events every
+# every events; "off" stops, "reset" discards what was gathered.
+#
+Simulator instproc profile {{what on} {every 1000}} {
+	$self instvar scheduler_
+	$scheduler_ profile $what $every
+}
+
+#
+# The profile as a table, or as JSON with "profile-report json"; with a
+# file, the report is written there instead of returned.
+#
+Simulator instproc profile-report {{format text} {file ""}} {
+	$self instvar scheduler_
+	set r [$scheduler_ profile-report $format]
+	if {$file == ""} {
+		return $r
+	}
+	set f [open $file w]
+	puts -nonewline $f $r
+	close $f
+}
+
+#
+# Write the whole simulation to file and return 0.  "ns -restore file
+# [-branch tag] args..." carries on from here, with 1 returned and argv
+# set to args, writing each output file open now to a copy named
+# file.tag (tag defaults to the pid).  ns must have been started as
+# "ns -checkpointable script ...", on Linux/x86-64.  Fails, taking
+# nothing, while a pipe or socket is open or Scheduler/Parallel runs
+# partitions on threads, since neither could be restored.
+#
+Simulator instproc checkpoint file {
+	$self flush-trace
+	foreach c [file channels] {
+		catch {flush $c}
+	}
+	return [ns-checkpoint $file]
+}
+
+#
+# Run the rest of the script n times, in n processes forked from this
+# one, at most jobs at a time (0: one per processor).  Returns the
+# replication index 0 .. n-1 in each process, after moving every RNG
+# that exists by then to substream index, so the replications draw
+# independent numbers from one setup; RNGs created after this call are
+# the same in all replications.  Each process should open its own trace
+# files and report its results with replication-stat.  When all have
+# exited, this process writes one line per replication and the mean,
+# standard deviation, extremes and 95% confidence interval of each
+# statistic to file (stdout if ""), and exits.
+#
+Simulator instproc replicate {n {jobs 0} {file ""}} {
+	$self flush-trace
+	foreach c [file channels] {
+		catch {flush $c}
+	}
+	set i [ns-replicate $n $jobs]
+	if {$i >= 0} {
+		foreach r [RNG info instances] {
+			for {set k 0} {$k < $i} {incr k} {
+				$r next-substream
+			}
+		}
+		return $i
+	}
+	$self replication-summary [ns-replicate results] $file
+	exit 0
+}
+
+Simulator instproc replication-stat {name value} {
+	ns-replicate stat $name $value
+}
+
+Simulator instproc replication-summary {results file} {
+	if {$file == ""} {
+		set f stdout
+	} else {
+		set f [open $file w]
+	}
+	set names {}
+	set failed 0
+	puts $f "# replication status name value ..."
+	foreach r $results {
+		set i [lindex $r 0]
+		set st [lindex $r 1]
+		puts $f "$i $st [join [lindex $r 2]]"
+		if {$st != 0} {
+			incr failed
+			continue
+		}
+		foreach {name v} [lindex $r 2] {
+			if {![info exists sum($name)]} {
+				lappend names $name
+				set cnt($name) 0
+				set sum($name) 0.0
+				set sq($name) 0.0
+				set min($name) $v
+				set max($name) $v
+			}
+			incr cnt($name)
+			set sum($name) [expr $sum($name) + $v]
+			set sq($name) [expr $sq($name) + $v * $v]
+			if {$v < $min($name)} {
+				set min($name) $v
+			}
+			if {$v > $max($name)} {
+				set max($name) $v
+			}
+		}
+	}
+	if {$failed > 0} {
+		puts $f "# $failed replications failed and are left out"
+	}
+	# Student t quantiles (0.975) for 1 .. 30 degrees of freedom
+	set t {12.706 4.303 3.182 2.776 2.571 2.447 2.365 2.306 2.262 2.228
+		2.201 2.179 2.160 2.145 2.131 2.120 2.110 2.101 2.093 2.086
+		2.080 2.074 2.069 2.064 2.060 2.056 2.052 2.048 2.045 2.042}
+	puts $f "# name n mean stddev min max ci95"
+	foreach name $names {
+		set m $cnt($name)
+		set mean [expr $sum($name) / $m]
+		if {$m > 1} {
+			set var [expr ($sq($name) - $m * $mean * $mean) / ($m - 1)]
+			set sd [expr $var > 0 ? sqrt($var) : 0.0]
+			if {$m <= 31} {
+				set q [lindex $t [expr $m - 2]]
+			} else {
+				set q 1.960
+			}
+			set ci [expr $q * $sd / sqrt($m)]
+		} else {
+			set sd 0.0
+			set ci 0.0
+		}
+		puts $f [format "%s %d %g %g %g %g %g" $name $m $mean $sd \
+		    $min($name) $max($name) $ci]
+	}
+	if {$file != ""} {
+		close $f
+	}
+}
+
 Simulator instproc is-started {} {
 	$self instvar started_
 	return [info exists started_]
@@ -1534,6 +1680,27 @@ Simulator instproc monitor-queue { n1 n2 qtrace { sampleInterval 0.1 } } {
 	return [$link_([$n1 id]:[$n2 id]) init-monitor $self $qtrace $sampleInterval]
 }
 
+# a QueueMonitor/Sketch on the link from n1 to n2
+Simulator instproc monitor-sketch { n1 n2 } {
+	$self instvar link_
+	set sk [new QueueMonitor/Sketch]
+	$link_([$n1 id]:[$n2 id]) attach-monitors [new SnoopQueue/In] \
+		[new SnoopQueue/Out] [new SnoopQueue/Drop] $sk
+	return $sk
+}
+
+# fluid background flows in the queue and link from n1 to n2
+Simulator instproc fluid-model { n1 n2 } {
+	$self instvar link_
+	set l $link_([$n1 id]:[$n2 id])
+	set fm [new FluidModel]
+	$fm attach-queue [$l queue]
+	$fm attach-link [$l link]
+	$fm set-integrator [new Integrator]
+	$l add-to-head $fm
+	return $fm
+}
+
 Simulator instproc queue-limit { n1 n2 limit } {
 	$self instvar link_
 	[$link_([$n1 id]:[$n2 id]) queue] set limit_ $limit
@@ -2036,6 +2203,23 @@ Simulator instproc makeflowmon { cltype { clslots 29 } } {
 	return $flowmon
 }
 
+# Snapshots follow snapshot_interval_: setting it restarts the timer
+QueueMonitor/ED/Flowmon instproc snapshot-to chan {
+	$self instvar snapchan_
+	$self cmd snapshot-to $chan
+	set snapchan_ $chan
+}
+
+QueueMonitor/ED/Flowmon instproc set args {
+	set val [eval $self next $args]
+	if { [lindex $args 0] == "snapshot_interval_" && \
+	    [llength $args] == 2 && [$self info vars snapchan_] != "" } {
+		$self instvar snapchan_
+		$self cmd snapshot-to $snapchan_
+	}
+	return $val
+}
+
 # attach a flow monitor to a link
 # 3rd argument dictates whether early drop support is to be used
 
@@ -68,8 +68,22 @@
 # IMPORTANT: You MUST never remove common header from your simulation. 
 # As you can see, this is also enforced by these header manipulation procs.
 #
+# A header left out this way still has offset 0, so a protocol that
+# touches it silently overwrites the common header.  Instead,
+#
+#   compact-packet-headers IP TCP Flags
+#   ...
+#   set ns [new Simulator]
+#
+# lays out only the headers named (and the common header) back to back,
+# those in "PacketHeaderManager set hot_" first, and stops ns with the
+# name of any other header the simulation touches.  "$ns packet-format"
+# returns the layout.
+#
 
 PacketHeaderManager set hdrlen_ 0
+PacketHeaderManager set compact_ 0
+PacketHeaderManager set hot_ {Common IP Mac LL Flags}
 
 # XXX Common header should ALWAYS be present
 PacketHeaderManager set tab_(Common) 1
@@ -99,6 +113,12 @@ proc remove-packet-header args {
 	}
 }
 
+proc compact-packet-headers args {
+	remove-all-packet-headers
+	eval add-packet-header $args
+	PacketHeaderManager set compact_ 1
+}
+
 proc remove-all-packet-headers {} {
 	PacketHeaderManager instvar tab_
 	foreach cl [PacketHeader info subclass] {
@@ -205,15 +225,59 @@ proc PktHdr_offset { hdrName {field ""} } {
 }
 
 Simulator instproc create_packetformat { } {
-	PacketHeaderManager instvar tab_
+	PacketHeaderManager instvar tab_ compact_
 	set pm [new PacketHeaderManager]
+	if $compact_ {
+		$pm compact
+	} else {
+		foreach cl [PacketHeader info subclass] {
+			if [info exists tab_($cl)] {
+				set off [$pm allochdr $cl]
+				$cl offset $off
+			}
+		}
+	}
+	$self set packetManager_ $pm
+}
+
+# Hot headers first, then the others in use; the rest get distinct
+# negative offsets, which Packet::access() rejects by name.
+PacketHeaderManager instproc compact {} {
+	PacketHeaderManager instvar tab_ hot_
+	set hdrs {}
+	foreach h $hot_ {
+		if [info exists tab_(PacketHeader/$h)] {
+			lappend hdrs PacketHeader/$h
+		}
+	}
+	foreach cl [PacketHeader info subclass] {
+		if {[info exists tab_($cl)] && [lsearch $hdrs $cl] < 0} {
+			lappend hdrs $cl
+		}
+	}
+	foreach cl $hdrs {
+		$cl offset [$self allochdr $cl]
+	}
+	set off 0
+	foreach cl [PacketHeader info subclass] {
+		if ![info exists tab_($cl)] {
+			$cl offset [incr off -1]
+		}
+	}
+}
+
+# {hdrlen {header offset size} ...}, in offset order
+Simulator instproc packet-format {} {
+	PacketHeaderManager instvar tab_
+	set l {}
 	foreach cl [PacketHeader info subclass] {
 		if [info exists tab_($cl)] {
-			set off [$pm allochdr $cl]
-			$cl offset $off
+			lappend l [list [string range $cl 13 end] \
+			    [$cl offset] [$cl set hdrlen_]]
 		}
 	}
-	$self set packetManager_ $pm
+	return [concat [[$self set packetManager_] set hdrlen_] \
+	    [lsort -integer -index 1 $l]]
 }
 
 PacketHeaderManager instproc allochdr cl {
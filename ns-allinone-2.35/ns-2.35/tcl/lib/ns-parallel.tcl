@@ -0,0 +1,153 @@
+#
+# Partitioning for Scheduler/Parallel (see common/parallel.h).
+#
+#	$ns use-scheduler Parallel
+#	... create the nodes and links ...
+#	$ns partition 4			;# 4 partitions, chosen by link delay
+# or
+#	$ns partition-node $n 2		;# for each node, then
+#	$ns partition
+#
+# Nodes not given a partition are in partition 0, which runs serially
+# on the main thread.  Every link hands its packets to the mailbox of
+# its far end's partition, and the shortest of the links between two
+# partitions sets the lookahead, which partition returns.  Dynamic links must not
+# cross partitions.  With threads_ 0 the scheduler runs the partitions
+# sequentially; set threads_ to run them in windows on that many
+# threads, with the same results.  Only a build configured with
+# --enable-parallel has Scheduler/Parallel.
+#
+
+Simulator instproc partition-node {node k} {
+	$self instvar partition_
+	set partition_([$node id]) $k
+}
+
+Simulator instproc partition-of id {
+	$self instvar partition_
+	if [info exists partition_($id)] {
+		return $partition_($id)
+	}
+	return 0
+}
+
+Simulator instproc partition {{n 0}} {
+	$self instvar scheduler_ partition_ link_
+	if {[$scheduler_ info class] != "Scheduler/Parallel"} {
+		error "partition needs \"\$ns use-scheduler Parallel\""
+	}
+	if {$n > 0} {
+		$self partition-auto $n
+	}
+	set nlp 1
+	foreach id [array names partition_] {
+		if {$partition_($id) >= $nlp} {
+			set nlp [expr $partition_($id) + 1]
+		}
+	}
+	set lookahead -1
+	foreach l [lsort [array names link_]] {
+		set ps [$self partition-of [[$link_($l) src] id]]
+		set pd [$self partition-of [[$link_($l) dst] id]]
+		set dyn [expr {[$link_($l) info vars dynamics_] != ""}]
+		if {$ps == $pd} {
+			if {!$dyn} {
+				[$link_($l) link] partition $ps $pd
+			}
+			continue
+		}
+		if $dyn {
+			error "dynamic link $l crosses partitions $ps and $pd"
+		}
+		set d [$link_($l) delay]
+		if {$d <= 0} {
+			error "link $l crosses partitions $ps and $pd\
+			    with no delay"
+		}
+		[$link_($l) link] partition $ps $pd
+		if {$lookahead < 0 || $d < $lookahead} {
+			set lookahead $d
+		}
+	}
+	if {$lookahead < 0} {
+		# the partitions never talk to each other
+		set lookahead 1e30
+	}
+	$scheduler_ partitions $nlp
+	$scheduler_ set lookahead_ $lookahead
+	return $lookahead
+}
+
+#
+# Split the nodes into n partitions of about the same size while
+# keeping the shortest links inside them: join the ends of the links
+# in order of increasing delay, as in Kruskal's algorithm, unless that
+# makes a group larger than its share, then place the groups, largest
+# first, in the least loaded partition.
+#
+Simulator instproc partition-auto n {
+	$self instvar partition_ link_ Node_
+	set ids [lsort -integer [array names Node_]]
+	foreach id $ids {
+		set root_($id) $id
+		set size_($id) 1
+	}
+	set cap [expr ([llength $ids] + $n - 1) / $n]
+
+	set edges {}
+	foreach l [array names link_] {
+		lappend edges [list [$link_($l) delay] \
+		    [[$link_($l) src] id] [[$link_($l) dst] id]]
+	}
+	set edges [lsort -integer -index 2 $edges]
+	set edges [lsort -integer -index 1 $edges]
+	foreach e [lsort -real -index 0 $edges] {
+		set a [lindex $e 1]
+		while {$root_($a) != $a} {
+			set a $root_($a)
+		}
+		set b [lindex $e 2]
+		while {$root_($b) != $b} {
+			set b $root_($b)
+		}
+		if {$a == $b || $size_($a) + $size_($b) > $cap} {
+			continue
+		}
+		if {$size_($a) < $size_($b) || \
+		    ($size_($a) == $size_($b) && $b < $a)} {
+			set t $a
+			set a $b
+			set b $t
+		}
+		set root_($b) $a
+		incr size_($a) $size_($b)
+	}
+
+	set groups {}
+	foreach id $ids {
+		set r $id
+		while {$root_($r) != $r} {
+			set r $root_($r)
+		}
+		if ![info exists members_($r)] {
+			lappend groups [list $size_($r) $r]
+		}
+		lappend members_($r) $id
+	}
+	for {set k 1} {$k <= $n} {incr k} {
+		set load_($k) 0
+	}
+	set groups [lsort -integer -index 1 $groups]
+	foreach g [lsort -integer -decreasing -index 0 $groups] {
+		set best 1
+		for {set k 2} {$k <= $n} {incr k} {
+			if {$load_($k) < $load_($best)} {
+				set best $k
+			}
+		}
+		foreach id $members_([lindex $g 1]) {
+			set partition_($id) $best
+		}
+		incr load_($best) [lindex $g 0]
+	}
+}
@@ -328,6 +328,11 @@ QueueMonitor instproc reset {} {
 	}
 }
 
+QueueMonitor/Sketch instproc reset {} {
+	$self next
+	$self clear
+}
+
 QueueMonitor/ED instproc reset {} {
 	$self next
 	$self instvar epdrops_ ebdrops_ mon_epdrops_ mon_ebdrops_
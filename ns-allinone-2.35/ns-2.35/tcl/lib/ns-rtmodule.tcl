@@ -190,7 +190,11 @@ RtModule/Mcast instproc register { node } {
 RtModule/Hier instproc register { node } {
 	$self next $node
 	$self instvar classifier_
-	set classifier_ [new Classifier/Hier]
+	if [RtModule/Hier set trie_] {
+		set classifier_ [new Classifier/Trie]
+	} else {
+		set classifier_ [new Classifier/Hier]
+	}
 	$node install-entry $self $classifier_
 }
 
@@ -231,6 +235,20 @@ Classifier/Hier instproc install { dst target } {
 	[$self cmd classifier $l] install [lindex $al [expr $l-1]] $target
 }
 
+Classifier/Trie instproc install { dst target } {
+	$self cmd install $dst $target
+}
+
+# "clear dst nullagent" (from delete-route) points dst at the null
+# agent; "clear a b c" removes the route to a.b.c.
+Classifier/Trie instproc clear args {
+	if {[llength $args] == 2 && ![string is integer [lindex $args 1]]} {
+		$self install [lindex $args 0] [lindex $args 1]
+	} else {
+		$self clear-prefix [join $args .]
+	}
+}
+
 
 #
 # Manual Routing Nodes:
@@ -0,0 +1,234 @@
+#
+# Copyright (c) 1995 The Regents of the University of California.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 3. All advertising materials mentioning features or use of this software
+#    must display the following acknowledgement:
+#	This product includes software developed by the Computer Systems
+#	Engineering Group at Lawrence Berkeley Laboratory.
+# 4. Neither the name of the University nor of the Laboratory may be used
+#    to endorse or promote products derived from this software without
+#    specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+# OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+# OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+#
+# Tests of "$ns checkpoint" and "ns -restore".  test-all-checkpoint
+# starts ns with -checkpointable; elsewhere than Linux on x86-64 the
+# tests are not implemented.
+#
+# restore:	checkpoint half way, finish, then restore the checkpoint
+#		and finish again; the restored branch's trace must be
+#		the same as the uninterrupted run's.  temp.rands is that
+#		trace.
+# refuse-pipe:	with a pipe open, the checkpoint must be refused.
+#
+# To view a list of available tests to run with this script:
+# ns test-suite-checkpoint.tcl
+#
+
+remove-all-packet-headers       ; # removes all except common
+add-packet-header Flags IP TCP  ; # hdrs reqd for validation test
+
+Class TestSuite
+
+# tf: a channel to trace-all to, which has to come before the links
+TestSuite instproc init {{tf ""}} {
+	$self instvar ns_ node_
+	set ns_ [new Simulator]
+	if {$tf != ""} {
+		$ns_ trace-all $tf
+	}
+	set node_(s1) [$ns_ node]
+	set node_(s2) [$ns_ node]
+	set node_(r1) [$ns_ node]
+	set node_(k1) [$ns_ node]
+	$ns_ duplex-link $node_(s1) $node_(r1) 10Mb 2ms DropTail
+	$ns_ duplex-link $node_(s2) $node_(r1) 10Mb 3ms DropTail
+	$ns_ duplex-link $node_(r1) $node_(k1) 1.5Mb 20ms DropTail
+	$ns_ queue-limit $node_(r1) $node_(k1) 20
+}
+
+# two TCPs and a CBR with random gaps, so the RNG is checkpointed too
+TestSuite instproc traffic {} {
+	$self instvar ns_ node_
+	set tcp1 [$ns_ create-connection TCP/Reno $node_(s1) TCPSink $node_(k1) 1]
+	set tcp2 [$ns_ create-connection TCP/Reno $node_(s2) TCPSink $node_(k1) 2]
+	set ftp1 [$tcp1 attach-app FTP]
+	set ftp2 [$tcp2 attach-app FTP]
+	set udp [new Agent/UDP]
+	$ns_ attach-agent $node_(s1) $udp
+	$udp set fid_ 3
+	set null [new Agent/Null]
+	$ns_ attach-agent $node_(k1) $null
+	$ns_ connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr attach-agent $udp
+	$cbr set rate_ 400Kb
+	$cbr set random_ 1
+	$ns_ at 0.0 "$ftp1 start"
+	$ns_ at 0.2 "$ftp2 start"
+	$ns_ at 0.5 "$cbr start"
+}
+
+# the checkpoint's error, or exit 2 where there are no checkpoints
+TestSuite instproc refused {msg} {
+	if [regexp {need Linux on x86-64} $msg] {
+		puts stderr $msg
+		exit 2
+	}
+	return $msg
+}
+
+TestSuite instproc lines {file} {
+	set f [open $file r]
+	set l [split [read $f] "\n"]
+	close $f
+	return $l
+}
+
+Class Test/restore -superclass TestSuite
+
+Test/restore instproc init {} {
+	$self instvar ns_ tf_ restored_
+	set tf_ [open temp.tr w]
+	$self next $tf_
+	$self traffic
+	set restored_ 0
+	$ns_ at 1.5 "$self checkpoint"
+	$ns_ at 3.0 "$self finish"
+}
+
+Test/restore instproc checkpoint {} {
+	$self instvar ns_ restored_
+	if [catch {$ns_ checkpoint temp.ckpt} r] {
+		error [$self refused $r]
+	}
+	set restored_ $r
+}
+
+Test/restore instproc finish {} {
+	$self instvar ns_ tf_ restored_
+	$ns_ flush-trace
+	close $tf_
+	if $restored_ {
+		exit 0
+	}
+	exec [info nameofexecutable] -restore temp.ckpt -branch restored \
+	    >@stdout 2>@stderr
+	set a [$self lines temp.tr]
+	set b [$self lines temp.tr.restored]
+	file delete temp.ckpt temp.tr temp.tr.restored
+	set f [open temp.rands w]
+	if {$a != $b} {
+		set n 0
+		while {[lindex $a $n] == [lindex $b $n]} {
+			incr n
+		}
+		puts stderr "restored trace differs at line [expr $n + 1]"
+		puts $f "restored trace differs at line [expr $n + 1]:"
+		puts $f "run:      [lindex $a $n]"
+		puts $f "restored: [lindex $b $n]"
+	} else {
+		puts -nonewline $f [join $a "\n"]
+	}
+	close $f
+	exit 0
+}
+
+Test/restore instproc run {} {
+	$self instvar ns_
+	$ns_ run
+}
+
+Class Test/refuse-pipe -superclass TestSuite
+
+Test/refuse-pipe instproc init {} {
+	$self next
+	$self instvar ns_ pipe_
+	$self traffic
+	set pipe_ [open "|cat" w]
+	$ns_ at 1.0 "$self checkpoint"
+	$ns_ at 2.0 "$self finish"
+}
+
+Test/refuse-pipe instproc checkpoint {} {
+	$self instvar ns_ result_
+	if [catch {$ns_ checkpoint temp.ckpt} r] {
+		set r [$self refused $r]
+		if [regexp {is not a file} $r] {
+			set result_ "checkpoint refused: descriptor not a file"
+		} else {
+			set result_ "checkpoint refused: $r"
+		}
+	} elseif $r {
+		# a restored branch: the refusal failed
+		exit 0
+	} else {
+		set result_ "checkpoint taken with a pipe open"
+	}
+}
+
+Test/refuse-pipe instproc finish {} {
+	$self instvar pipe_ result_
+	close $pipe_
+	file delete temp.ckpt
+	set f [open temp.rands w]
+	puts $f $result_
+	close $f
+	exit 0
+}
+
+Test/refuse-pipe instproc run {} {
+	$self instvar ns_
+	$ns_ run
+}
+
+proc usage {} {
+	global argv0
+	puts stderr "usage: ns -checkpointable $argv0 <tests> "
+	puts "Valid tests: restore refuse-pipe"
+	exit 1
+}
+
+proc runtest {arg} {
+	global quiet
+	set quiet 0
+
+	set b [llength $arg]
+	if {$b == 1} {
+		set test $arg
+	} elseif {$b == 2} {
+		set test [lindex $arg 0]
+		if {[lindex $arg 1] == "QUIET"} {
+			set quiet 1
+		}
+	} else {
+		usage
+	}
+	if {[info commands Test/$test] == ""} {
+		usage
+	}
+	set t [new Test/$test]
+	$t run
+}
+
+global argv arg0
+runtest $argv
@@ -0,0 +1,207 @@
+#
+# Copyright (c) 1995 The Regents of the University of California.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 3. All advertising materials mentioning features or use of this software
+#    must display the following acknowledgement:
+#	This product includes software developed by the Computer Systems
+#	Engineering Group at Lawrence Berkeley Laboratory.
+# 4. Neither the name of the University nor of the Laboratory may be used
+#    to endorse or promote products derived from this software without
+#    specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+# OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+# OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+#
+# Tests of FluidModel against the packet level.  Each test runs, on
+# two 100 Mb/s links of the same simulation, five foreground
+# Agent/TCP/Sack1 flows with nbg background flows: on one link at
+# packet level, on the other as a FluidModel class, all with a
+# round-trip propagation delay of 100 ms, as in tcl/ex/fluid-model.tcl.
+# The foreground flows over the fluid must get, per flow, within
+# 25% of the throughput of all the flows at packet level, which is
+# what temp.rands records; the throughputs themselves are printed
+# unless QUIET.
+#
+# droptail-100, droptail-400:	nbg 100 and 400 on a DropTail link.
+# red-100, red-400:		the same on a RED link.
+#
+# To view a list of available tests to run with this script:
+# ns test-suite-fluid.tcl
+#
+
+Class TestSuite
+
+# within this fraction of the packet level
+TestSuite set tolerance_ 0.25
+
+TestSuite instproc init {queue nbg} {
+	$self instvar ns_ queue_ nbg_ nfg_ stop_ fg_ bg_ fm_
+	set ns_ [new Simulator]
+	set queue_ $queue
+	set nbg_ $nbg
+	set nfg_ 5
+	set stop_ 20.0
+	# packet level
+	set l [$self bottleneck]
+	for {set i 0} {$i < $nfg_ + $nbg_} {incr i} {
+		set bg_($i) [$self flow $l]
+	}
+	# fluid
+	set l [$self bottleneck]
+	for {set i 0} {$i < $nfg_} {incr i} {
+		set fg_($i) [$self flow $l]
+	}
+	set fm_ [$ns_ fluid-model [lindex $l 0] [lindex $l 1]]
+	$fm_ add-class $nbg_ 0.1
+	$ns_ at 0 "$fm_ start"
+	$ns_ at $stop_ "$self finish"
+}
+
+# a link like tcl/ex/fluid-model.tcl's, as its two nodes
+TestSuite instproc bottleneck {} {
+	$self instvar ns_ queue_
+	set r1 [$ns_ node]
+	set r2 [$ns_ node]
+	$ns_ duplex-link $r1 $r2 100Mb 40ms $queue_
+	$ns_ queue-limit $r1 $r2 500
+	if {$queue_ == "RED"} {
+		set red [[$ns_ link $r1 $r2] queue]
+		$red set thresh_ 100
+		$red set maxthresh_ 300
+	}
+	return [list $r1 $r2]
+}
+
+# a flow over link l, starting at random in the first second
+TestSuite instproc flow {l} {
+	$self instvar ns_
+	global defaultRNG
+	set s [$ns_ node]
+	set d [$ns_ node]
+	$ns_ duplex-link $s [lindex $l 0] 1Gb 5ms DropTail
+	$ns_ duplex-link [lindex $l 1] $d 1Gb 5ms DropTail
+	$ns_ queue-limit $s [lindex $l 0] 1000
+	set tcp [new Agent/TCP/Sack1]
+	$tcp set window_ 20
+	$tcp set overhead_ 0.001
+	$ns_ attach-agent $s $tcp
+	set sink [new Agent/TCPSink/Sack1]
+	$ns_ attach-agent $d $sink
+	$ns_ connect $tcp $sink
+	set ftp [$tcp attach-app FTP]
+	$ns_ at [$defaultRNG uniform 0 1] "$ftp start"
+	return $tcp
+}
+
+# the throughput of each of n flows, Mb/s
+TestSuite instproc rate {flows n} {
+	$self instvar stop_
+	upvar $flows f
+	set bytes 0
+	for {set i 0} {$i < $n} {incr i} {
+		incr bytes [expr [$f($i) set ack_] * 1000]
+	}
+	return [expr $bytes * 8.0 / $stop_ / 1e6 / $n]
+}
+
+TestSuite instproc finish {} {
+	global quiet
+	$self instvar queue_ nbg_ nfg_ fg_ bg_
+	set tol [TestSuite set tolerance_]
+	set packet [$self rate bg_ [expr $nfg_ + $nbg_]]
+	set fluid [$self rate fg_ $nfg_]
+	set off [expr ($fluid - $packet) / $packet]
+	if {$quiet == 0} {
+		puts [format "%s, %d flows: packet level %.3f Mb/s, fluid %.3f Mb/s (%+.0f%%)" \
+		    $queue_ $nbg_ $packet $fluid [expr $off * 100]]
+	}
+	set f [open temp.rands w]
+	if {abs($off) <= $tol} {
+		puts $f [format "%s, %d flows: fluid within %.0f%% of packet level" \
+		    $queue_ $nbg_ [expr $tol * 100]]
+	} else {
+		puts $f [format "%s, %d flows: fluid off by %+.0f%% of packet level" \
+		    $queue_ $nbg_ [expr $off * 100]]
+	}
+	close $f
+	exit 0
+}
+
+TestSuite instproc run {} {
+	$self instvar ns_
+	$ns_ run
+}
+
+Class Test/droptail-100 -superclass TestSuite
+
+Test/droptail-100 instproc init {} {
+	$self next DropTail 100
+}
+
+Class Test/droptail-400 -superclass TestSuite
+
+Test/droptail-400 instproc init {} {
+	$self next DropTail 400
+}
+
+Class Test/red-100 -superclass TestSuite
+
+Test/red-100 instproc init {} {
+	$self next RED 100
+}
+
+Class Test/red-400 -superclass TestSuite
+
+Test/red-400 instproc init {} {
+	$self next RED 400
+}
+
+proc usage {} {
+	global argv0
+	puts stderr "usage: ns $argv0 <tests> "
+	puts "Valid tests: droptail-100 droptail-400 red-100 red-400"
+	exit 1
+}
+
+proc runtest {arg} {
+	global quiet
+	set quiet 0
+
+	set b [llength $arg]
+	if {$b == 1} {
+		set test $arg
+	} elseif {$b == 2} {
+		set test [lindex $arg 0]
+		if {[lindex $arg 1] == "QUIET"} {
+			set quiet 1
+		}
+	} else {
+		usage
+	}
+	if {[info commands Test/$test] == ""} {
+		usage
+	}
+	set t [new Test/$test]
+	$t run
+}
+
+global argv arg0
+runtest $argv
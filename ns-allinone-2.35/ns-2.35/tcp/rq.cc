@@ -50,6 +50,7 @@
 #include "rq.h"
 
 ReassemblyQueue::seginfo* ReassemblyQueue::freelist_ = NULL;
+unsigned ReassemblyQueue::seed_ = 1;
 
 ReassemblyQueue::seginfo* ReassemblyQueue::newseginfo()
 {
@@ -86,6 +87,7 @@ ReassemblyQueue::fremove(seginfo* p)
 		p->next_->prev_ = p->prev_;
 	else
 		tail_ = p->prev_;
+	tremove(p);
 }
 
 /*
@@ -123,6 +125,157 @@ ReassemblyQueue::push(seginfo *p)
 		bottom_ = p;
 }
 
+#define	TBLKS(s)	((s) ? (s)->nblk_ : 0)
+#define	TBYTES(s)	((s) ? (s)->nbytes_ : 0)
+
+/*
+ * recompute the subtree counts of p and of everything above it
+ */
+void
+ReassemblyQueue::tfix(seginfo* p)
+{
+	for (; p != NULL; p = p->up_) {
+		p->nblk_ = 1 + TBLKS(p->left_) + TBLKS(p->right_);
+		p->nbytes_ = (p->endseq_ - p->startseq_) +
+		    TBYTES(p->left_) + TBYTES(p->right_);
+	}
+}
+
+/*
+ * rotate x above its parent, keeping the seq# order
+ */
+void
+ReassemblyQueue::rotup(seginfo* x)
+{
+	seginfo* p = x->up_;
+	seginfo* g = p->up_;
+
+	if (p->left_ == x) {
+		p->left_ = x->right_;
+		if (x->right_)
+			x->right_->up_ = p;
+		x->right_ = p;
+	} else {
+		p->right_ = x->left_;
+		if (x->left_)
+			x->left_->up_ = p;
+		x->left_ = p;
+	}
+	p->up_ = x;
+	x->up_ = g;
+	if (g == NULL)
+		root_ = x;
+	else if (g->left_ == p)
+		g->left_ = x;
+	else
+		g->right_ = x;
+	x->nblk_ = p->nblk_;
+	x->nbytes_ = p->nbytes_;
+	p->nblk_ = 1 + TBLKS(p->left_) + TBLKS(p->right_);
+	p->nbytes_ = (p->endseq_ - p->startseq_) +
+	    TBYTES(p->left_) + TBYTES(p->right_);
+}
+
+/*
+ * put n in the treap right after p (first, if p is NULL)
+ */
+void
+ReassemblyQueue::tinsert(seginfo* n, seginfo* p)
+{
+	seginfo* s;
+
+	n->left_ = n->right_ = NULL;
+	seed_ = seed_ * 1103515245 + 12345;
+	n->pri_ = seed_;
+	if (root_ == NULL) {
+		n->up_ = NULL;
+		root_ = n;
+		tfix(n);
+		return;
+	}
+	if (p == NULL) {
+		for (s = root_; s->left_; s = s->left_)
+			;
+		s->left_ = n;
+	} else if (p->right_ == NULL) {
+		s = p;
+		s->right_ = n;
+	} else {
+		for (s = p->right_; s->left_; s = s->left_)
+			;
+		s->left_ = n;
+	}
+	n->up_ = s;
+	tfix(n);
+	while (n->up_ && n->up_->pri_ < n->pri_)
+		rotup(n);
+}
+
+void
+ReassemblyQueue::tremove(seginfo* n)
+{
+	// rotate it down to a leaf, then cut it off
+	while (n->left_ || n->right_) {
+		if (n->left_ == NULL)
+			rotup(n->right_);
+		else if (n->right_ == NULL ||
+		    n->left_->pri_ > n->right_->pri_)
+			rotup(n->left_);
+		else
+			rotup(n->right_);
+	}
+	seginfo* p = n->up_;
+	if (p == NULL)
+		root_ = NULL;
+	else if (p->left_ == n)
+		p->left_ = NULL;
+	else
+		p->right_ = NULL;
+	tfix(p);
+}
+
+ReassemblyQueue::seginfo*
+ReassemblyQueue::tfirst(TcpSeq seq)
+{
+	seginfo *p = root_, *r = NULL;
+	while (p) {
+		if (p->endseq_ >= seq) {
+			r = p;
+			p = p->left_;
+		} else
+			p = p->right_;
+	}
+	return (r);
+}
+
+ReassemblyQueue::seginfo*
+ReassemblyQueue::tafter(TcpSeq seq)
+{
+	seginfo *p = root_, *r = NULL;
+	while (p) {
+		if (p->startseq_ >= seq) {
+			r = p;
+			p = p->left_;
+		} else
+			p = p->right_;
+	}
+	return (r);
+}
+
+ReassemblyQueue::seginfo*
+ReassemblyQueue::tbefore(TcpSeq seq)
+{
+	seginfo *p = root_, *r = NULL;
+	while (p) {
+		if (p->endseq_ <= seq) {
+			r = p;
+			p = p->right_;
+		} else
+			p = p->left_;
+	}
+	return (r);
+}
+
 /*
  * counts: return the # of blks and byte counts in
  * them starting at the given node
@@ -130,13 +283,16 @@ ReassemblyQueue::push(seginfo *p)
 void
 ReassemblyQueue::cnts(seginfo *p, int& blkcnt, int& bytecnt)
 {
-	int blks = 0;
-	int bytes = 0;
-
-	while (p != NULL) {
-		++blks;
-		bytes += (p->endseq_ - p->startseq_);
-		p = p->next_;
+	int blks = 1 + TBLKS(p->right_);
+	int bytes = (p->endseq_ - p->startseq_) + TBYTES(p->right_);
+
+	// and each ancestor p is left of, with its right subtree
+	for (; p->up_ != NULL; p = p->up_) {
+		seginfo* u = p->up_;
+		if (u->left_ == p) {
+			blks += 1 + TBLKS(u->right_);
+			bytes += (u->endseq_ - u->startseq_) + TBYTES(u->right_);
+		}
 	}
 	blkcnt = blks;
 	bytecnt = bytes;
@@ -152,7 +308,7 @@ void
 ReassemblyQueue::clear()
 {
 	// clear stack and end of queue
-	tail_ = top_ = bottom_ = hint_ = NULL;
+	tail_ = top_ = bottom_ = hint_ = root_ = NULL;
 
 	seginfo *p = head_;
 	while (head_) {
@@ -191,6 +347,7 @@ ReassemblyQueue::clearto(TcpSeq seq)
 	if (p && p->startseq_ <= seq && p->endseq_ > seq) {
 		total_ -= (seq - p->startseq_);
 		p->startseq_ = seq;
+		tfix(p);
 		flag |= p->pflags_;
 	}
 	return flag;
@@ -328,6 +485,7 @@ ReassemblyQueue::add(TcpSeq start, TcpSeq end, TcpFlag tiflags, RqFlag rqflags)
 		head_->pflags_ = tiflags;
 		head_->rqflags_ = rqflags;
 		head_->cnt_ = initcnt;
+		tinsert(head_, NULL);
 
 		total_ = (end - start);
 
@@ -369,13 +527,8 @@ again2:
 		// search for segments before and after
 		// the new one; could be overlapped
 		//
-		q = head_;
-		while (q && q->startseq_ < end)
-			q = q->next_;
-
-		p = tail_;
-		while (p && p->endseq_ > start)
-			p = p->prev_;
+		q = tafter(end);
+		p = tbefore(start);
 
 #ifdef notdef
 printf("Thinking of merging (s:%d, e:%d), p:%p (%d,%d), q:%p (%d,%d) into: \n",
@@ -438,6 +591,7 @@ start, end, p, q,
 			if (start < p->startseq_) {
 				total_ += (p->startseq_ - start);
 				p->startseq_ = start;
+				tfix(p);
 			}
 			start = p->endseq_;
 			needmerge = TRUE;
@@ -457,6 +611,7 @@ start, end, p, q,
 			if (end > q->endseq_) {
 				total_ += (end - q->endseq_);
 				q->endseq_ = end;
+				tfix(q);
 			}
 			end = q->startseq_;
 			needmerge = TRUE;
@@ -511,6 +666,7 @@ endfast:
 			q->prev_ = n;
 		else
 			tail_ = n;
+		tinsert(n, p);
 
 
 		//
@@ -567,6 +723,7 @@ dumplist();
 		sremove(q);
 		fremove(q);
 		p->endseq_ = q->endseq_;
+		tfix(p);
 		p->cnt_ += (n->cnt_ + q->cnt_);
 		flags = (p->pflags_ |= n->pflags_);
 		ReassemblyQueue::deleteseginfo(n);
@@ -577,6 +734,7 @@ dumplist();
 		sremove(n);
 		fremove(n);
 		p->endseq_ = n->endseq_;
+		tfix(p);
 		flags = (p->pflags_ |= n->pflags_);
 		p->cnt_ += n->cnt_;
 		ReassemblyQueue::deleteseginfo(n);
@@ -586,6 +744,7 @@ dumplist();
 		sremove(n);
 		fremove(n);
 		q->startseq_ = n->startseq_;
+		tfix(q);
 		flags = (q->pflags_ |= n->pflags_);
 		q->cnt_ += n->cnt_;
 		ReassemblyQueue::deleteseginfo(n);
@@ -615,27 +774,25 @@ ReassemblyQueue::nexthole(TcpSeq seq, int& nxtcnt, int& nxtbytes)
 {
 
 	nxtbytes = nxtcnt = -1;
-	hint_ = head_;
-
-	seginfo* p;
-	for (p = hint_; p; p = p->next_) {
-		// seq# is prior to SACK region
-		// so seq# is a legit hole
-		if (p->startseq_ > seq) {
-			cnts(p, nxtcnt, nxtbytes);
-			return (seq);
-		}
 
-		// seq# is covered by SACK region
-		// so the hole is at the end of the region
-		if ((p->startseq_ <= seq) && (p->endseq_ >= seq)) {
-			if (p->next_) {
-				cnts(p->next_, nxtcnt, nxtbytes);
-			}
-			return (p->endseq_);
-		}
+	// the first block not wholly below seq
+	seginfo* p = hint_ = tfirst(seq);
+	if (p == NULL)
+		return (-1);
+
+	// seq# is prior to SACK region
+	// so seq# is a legit hole
+	if (p->startseq_ > seq) {
+		cnts(p, nxtcnt, nxtbytes);
+		return (seq);
+	}
+
+	// seq# is covered by SACK region
+	// so the hole is at the end of the region
+	if (p->next_) {
+		cnts(p->next_, nxtcnt, nxtbytes);
 	}
-	return (-1);
+	return (p->endseq_);
 }
 
 
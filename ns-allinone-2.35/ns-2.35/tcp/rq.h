@@ -87,6 +87,14 @@ typedef int	RqFlag;		// meta data (owned by ReassemblyQueue)
  * overhead in generating SACK blocks good for HSTCP; see scoreboard-rq
  */ 
 
+/*
+ * The FIFO is also kept as a treap (a randomized balanced search tree,
+ * in seq# order) whose nodes carry the block and byte counts of their
+ * subtrees, so add() finds its neighbours and nexthole() its block and
+ * the counts above it in O(log n) instead of walking the list: with
+ * the windows of 10Gb/s paths the SACK queue holds thousands of blocks.
+ */
+
 class ReassemblyQueue {
 	struct seginfo {
 		seginfo* next_;	// next on FIFO list
@@ -99,11 +107,18 @@ class ReassemblyQueue {
 		TcpFlag	pflags_;	// flags derived from tcp hdr
 		RqFlag	rqflags_;	// book-keeping flags
 		int	cnt_;		// refs to this block
+
+		seginfo* left_;	// treap links
+		seginfo* right_;
+		seginfo* up_;
+		unsigned pri_;	// treap priority
+		int	nblk_;		// blocks in this subtree
+		int	nbytes_;	// bytes in this subtree
 	};
 
 public:
 	ReassemblyQueue(TcpSeq& rcvnxt) :
-		head_(NULL), tail_(NULL), top_(NULL), bottom_(NULL), hint_(NULL), total_(0), rcv_nxt_(rcvnxt) { };
+		head_(NULL), tail_(NULL), top_(NULL), bottom_(NULL), hint_(NULL), root_(NULL), total_(0), rcv_nxt_(rcvnxt) { };
 	int empty() { return (head_ == NULL); }
 	int add(TcpSeq sseq, TcpSeq eseq, TcpFlag pflags, RqFlag rqflags = 0);
 	int maxseq() { return (tail_ ? (tail_->endseq_) : -1); }
@@ -135,6 +150,7 @@ protected:
 	seginfo* top_;		// top of stack
 	seginfo* bottom_;	// bottom of stack
 	seginfo* hint_;	// hint for nexthole() function
+	seginfo* root_;	// root of the treap
 	int total_;	// # bytes in Reassembly Queue
 
 	// rcv_nxt_ is a reference to an externally allocated TcpSeq
@@ -149,6 +165,16 @@ protected:
 	void sremove(seginfo*); // remove from LIFO
 	void push(seginfo*); // add to LIFO
 	void cnts(seginfo *, int&, int&); // byte/blk counts
+
+	// the treap
+	static unsigned seed_;
+	void tinsert(seginfo* n, seginfo* p);	// insert n after p
+	void tremove(seginfo*);
+	void tfix(seginfo*);	// counts changed, from here up
+	void rotup(seginfo*);	// rotate above its parent
+	seginfo* tfirst(TcpSeq);	// first block ending at or after seq
+	seginfo* tafter(TcpSeq);	// first block starting at or after seq
+	seginfo* tbefore(TcpSeq);	// last block ending at or before seq
 };
 
 #endif
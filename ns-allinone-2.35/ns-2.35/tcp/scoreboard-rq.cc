@@ -33,6 +33,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <map>
+#include <set>
 #include "scoreboard-rq.h"
 
 // Implementation of a ScoreBoard shim for 
@@ -125,3 +127,176 @@ void ScoreBoardRQ::MarkRetran (int retran_seqno, int)
 		h_seqno_ = retran_seqno+1;
 }
 
+
+// The retransmissions on the board, by seq and by snd_nxt.
+class RtxMap {
+public:
+	typedef std::map<int, int>::iterator iterator;
+	std::map<int, int> seq_;	// seq -> snd_nxt
+	std::set<std::pair<int, int> > nxt_;	// (snd_nxt, seq)
+
+	void clear() { seq_.clear(); nxt_.clear(); }
+	void mark(int seq, int snd_nxt, int keep) {
+		iterator it = seq_.find(seq);
+		if (it != seq_.end()) {
+			if (keep)
+				return;
+			nxt_.erase(std::make_pair(it->second, seq));
+		}
+		seq_[seq] = snd_nxt;
+		nxt_.insert(std::make_pair(snd_nxt, seq));
+	}
+	void erase(iterator it) {
+		nxt_.erase(std::make_pair(it->second, it->first));
+		seq_.erase(it);
+	}
+};
+
+ScoreBoardRQRetran::ScoreBoardRQRetran() : ScoreBoard(NULL, 0), hi_(0),
+	rtxok_(0), unused_(0), rtx_(new RtxMap), rq_(unused_)
+{
+}
+
+ScoreBoardRQRetran::~ScoreBoardRQRetran()
+{
+	rq_.clear();
+	delete rtx_;
+}
+
+void ScoreBoardRQRetran::ClearScoreBoard()
+{
+	hi_ = first_;
+	rq_.clear();
+	rtx_->clear();
+}
+
+int ScoreBoardRQRetran::UpdateScoreBoard(int last_ack, hdr_tcp* tcph)
+{
+	int retran_decr = 0;
+	RtxMap::iterator it;
+
+	changed_ = 0;
+
+	//  Advance the left edge of the board.
+	if (hi_ > first_ && first_ <= last_ack) {
+		int to = (last_ack + 1 < hi_) ? last_ack + 1 : hi_;
+		changed_ += to - first_;
+		first_ = to;
+		while (!rtx_->seq_.empty() && rtx_->seq_.begin()->first < first_) {
+			rtx_->erase(rtx_->seq_.begin());
+			retran_decr++;
+		}
+		rq_.clearto(first_);
+	}
+
+	//  If there is no board, start one.
+	if (hi_ <= first_ && tcph->sa_length()) {
+		first_ = rtxok_ = last_ack + 1;
+		hi_ = first_ + 1;
+		rq_.clear();
+		changed_++;
+	}
+
+	for (int i = 0; i < tcph->sa_length(); i++) {
+		int left = tcph->sa_left(i);
+		int right = tcph->sa_right(i);
+
+		//  Extend the board to the right.
+		if (right > hi_) {
+			changed_ += right - hi_;
+			hi_ = right;
+		}
+		if (left < first_)
+			left = first_;
+		if (left >= right)
+			continue;
+		int old_total = rq_.total();
+		rq_.add(left, right, 0);
+		changed_ += rq_.total() - old_total;
+		it = rtx_->seq_.lower_bound(left);
+		while (it != rtx_->seq_.end() && it->first < right) {
+			rtx_->erase(it++);
+			retran_decr++;
+		}
+	}
+	return (retran_decr);
+}
+
+int ScoreBoardRQRetran::CheckSndNxt(hdr_tcp* tcph)
+{
+	int force_timeout = 0;
+
+	for (int i = 0; i < tcph->sa_length(); i++) {
+		int sack_right = tcph->sa_right(i);
+
+		//  A retransmission whose snd_nxt_ is now covered was lost again.
+		std::set<std::pair<int, int> >::iterator it = rtx_->nxt_.begin();
+		while (it != rtx_->nxt_.end() && it->first < sack_right) {
+			int seq = it->second;
+			++it;
+			if (seq >= sack_right)
+				continue;
+			if (seq < rtxok_)
+				rtxok_ = seq;
+			rtx_->erase(rtx_->seq_.find(seq));
+			force_timeout = 1;
+		}
+	}
+	return (force_timeout);
+}
+
+// The first hole on the board not yet retransmitted.
+int ScoreBoardRQRetran::GetNextRetran()
+{
+	int fcnt, fbytes;
+	int seq = (rtxok_ > first_) ? rtxok_ : first_;
+
+	while (seq < hi_) {
+		int hole = rq_.nexthole(seq, fcnt, fbytes);
+		if (hole < 0)
+			hole = seq;	// above all the SACKed blocks
+		if (hole >= hi_)
+			break;
+		if (rtx_->seq_.find(hole) == rtx_->seq_.end()) {
+			rtxok_ = hole;
+			return (hole);
+		}
+		seq = hole + 1;
+	}
+	return (-1);
+}
+
+int ScoreBoardRQRetran::GetNextUnacked(int seqno)
+{
+	int fcnt, fbytes;
+
+	if (seqno < first_ || seqno >= hi_)
+		return (-1);
+	int hole = rq_.nexthole(seqno, fcnt, fbytes);
+	if (hole < 0)
+		hole = seqno;
+	return (hole < hi_ ? hole : -1);
+}
+
+void ScoreBoardRQRetran::MarkRetran(int retran_seqno, int snd_nxt)
+{
+	if (retran_seqno >= first_ && retran_seqno < hi_)
+		rtx_->mark(retran_seqno, snd_nxt, 0);
+}
+
+void ScoreBoardRQRetran::MarkRetran(int retran_seqno)
+{
+	if (retran_seqno >= first_ && retran_seqno < hi_)
+		rtx_->mark(retran_seqno, 0, 1);
+}
+
+void ScoreBoardRQRetran::Dump()
+{
+	RtxMap::iterator it;
+
+	printf("SB [%d, %d) retran:", first_, hi_);
+	for (it = rtx_->seq_.begin(); it != rtx_->seq_.end(); ++it)
+		printf(" %d<%d>", it->first, it->second);
+	printf("\n");
+	rq_.dumplist();
+}
@@ -65,4 +65,34 @@ protected:
 	ReassemblyQueue rq_;	
 };
 
+// ScoreBoardRQRetran: ScoreBoard as it is, with each retransmission
+// and its snd_nxt, but keeping the SACKed blocks in a ReassemblyQueue
+// rather than a ScoreBoardNode for every packet in the window, so that
+// it grows with the number of holes and not with the window.  Used by
+// FACK.
+
+class RtxMap;	// std::map of seq -> snd_nxt, kept out of the TCP headers
+
+class ScoreBoardRQRetran : public ScoreBoard {
+public:
+	ScoreBoardRQRetran();
+	virtual ~ScoreBoardRQRetran();
+	virtual int IsEmpty () {return (hi_ <= first_);}
+	virtual void ClearScoreBoard ();
+	virtual int GetNextRetran ();
+	virtual void MarkRetran (int retran_seqno);
+	virtual void MarkRetran (int retran_seqno, int snd_nxt);
+	virtual int UpdateScoreBoard (int last_ack_, hdr_tcp*);
+	virtual int CheckSndNxt (hdr_tcp*);
+	virtual int GetNextUnacked (int seqno);
+	virtual void Dump();
+protected:
+	int hi_;	// first_ to hi_-1 are on the board
+	int rtxok_;	// holes on the board below it are all retransmitted
+	int unused_;	// rq_'s rcv_nxt
+
+	RtxMap* rtx_;	// retransmitted, seq -> snd_nxt
+	ReassemblyQueue rq_;	// SACKed, all on the board
+};
+
 #endif
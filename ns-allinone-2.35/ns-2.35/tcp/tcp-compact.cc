@@ -0,0 +1,661 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * tcp-compact.cc
+ *
+ * A small-footprint one-way NewReno sender; see tcp-compact.h.  The
+ * algorithms are those of TcpAgent, RenoTcpAgent and NewRenoTcpAgent
+ * with their default options, cut down to the paths those take.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "ip.h"
+#include "tcp.h"
+#include "tcp-compact.h"
+#include "flags.h"
+#include "random.h"
+#include "basetrace.h"
+
+static class CompactTcpClass : public TclClass {
+public:
+	CompactTcpClass() : TclClass("Agent/TCP/Compact") {}
+	TclObject* create(int, const char*const*) {
+		return (new CompactTcpAgent());
+	}
+} class_compact_tcp;
+
+/* the variables "trace" accepts; see trace_value() */
+static const char* const ctrace_names[] = {
+	"cwnd_", "ssthresh_", "t_seqno_", "ack_", "maxseq_",
+	"dupacks_", "rtt_", "srtt_", "rttvar_", "backoff_", 0
+};
+
+void CompactRtxTimer::expire(Event*)
+{
+	a_->timeout(TCP_TIMER_RTX);
+}
+
+CompactTcpAgent::CompactTcpAgent() : Agent(PT_TCP),
+	cwnd_(0), dupwnd_(0), t_seqno_(0), highest_ack_(0), maxseq_(0),
+	curseq_(0), recover_(0), ssthresh_(0), dupacks_(0), t_rtt_(0),
+	t_srtt_(0), t_rttvar_(0), t_backoff_(0), rtt_seq_(-1), rtt_ts_(0.0),
+	t_rtxcur_(0.0), boot_time_(0.0), lastreset_(0.0), rtt_active_(0),
+	last_cwnd_action_(0), first_decrease_(1), firstpartial_(0),
+	cong_action_(0), closed_(0), syn_connects_(0), rtx_timer_(this),
+	ndatapack_(0), ndatabytes_(0), nackpack_(0), nrexmit_(0),
+	nrexmitpack_(0), nrexmitbytes_(0), ncwndcuts_(0), trace_(0)
+{
+}
+
+CompactTcpAgent::~CompactTcpAgent()
+{
+	delete trace_;
+}
+
+void
+CompactTcpAgent::delay_bind_init_all()
+{
+	delay_bind_init_one("window_");
+	delay_bind_init_one("windowInit_");
+	delay_bind_init_one("syn_");
+	delay_bind_init_one("max_connects_");
+	delay_bind_init_one("delay_growth_");
+	delay_bind_init_one("tcpTick_");
+	delay_bind_init_one("packetSize_");
+	delay_bind_init_one("tcpip_base_hdr_size_");
+	delay_bind_init_one("slow_start_restart_");
+	delay_bind_init_one("restart_bugfix_");
+	delay_bind_init_one("maxburst_");
+	delay_bind_init_one("maxcwnd_");
+	delay_bind_init_one("numdupacks_");
+	delay_bind_init_one("singledup_");
+	delay_bind_init_one("maxrto_");
+	delay_bind_init_one("minrto_");
+	delay_bind_init_one("srtt_init_");
+	delay_bind_init_one("rttvar_init_");
+	delay_bind_init_one("rtxcur_init_");
+	delay_bind_init_one("T_SRTT_BITS");
+	delay_bind_init_one("T_RTTVAR_BITS");
+	delay_bind_init_one("rttvar_exp_");
+	Agent::delay_bind_init_all();
+
+	reset();
+}
+
+int
+CompactTcpAgent::delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer)
+{
+	if (delay_bind(varName, localName, "window_", &wnd_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "windowInit_", &wnd_init_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "syn_", &syn_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "max_connects_", &max_connects_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "delay_growth_", &delay_growth_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "tcpTick_", &tcp_tick_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "packetSize_", &size_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "tcpip_base_hdr_size_", &tcpip_base_hdr_size_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "slow_start_restart_", &slow_start_restart_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "restart_bugfix_", &restart_bugfix_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "maxburst_", &maxburst_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "maxcwnd_", &maxcwnd_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "numdupacks_", &numdupacks_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "singledup_", &singledup_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "maxrto_", &maxrto_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "minrto_", &minrto_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "srtt_init_", &srtt_init_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "rttvar_init_", &rttvar_init_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "rtxcur_init_", &rtxcur_init_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "T_SRTT_BITS", &T_SRTT_BITS, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "T_RTTVAR_BITS", &T_RTTVAR_BITS, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "rttvar_exp_", &rttvar_exp_, tracer)) return TCL_OK;
+
+	/* state and statistics, bound only when a script asks for them */
+	if (delay_bind(varName, localName, "cwnd_", &cwnd_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "ssthresh_", &ssthresh_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "t_seqno_", &t_seqno_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "seqno_", &curseq_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "ack_", &highest_ack_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "maxseq_", &maxseq_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "dupacks_", &dupacks_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "rtt_", &t_rtt_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "srtt_", &t_srtt_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "rttvar_", &t_rttvar_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "backoff_", &t_backoff_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "ndatapack_", &ndatapack_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "ndatabytes_", &ndatabytes_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "nackpack_", &nackpack_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "nrexmit_", &nrexmit_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "nrexmitpack_", &nrexmitpack_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "nrexmitbytes_", &nrexmitbytes_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "ncwndcuts_", &ncwndcuts_, tracer)) return TCL_OK;
+	return Agent::delay_bind_dispatch(varName, localName, tracer);
+}
+
+int CompactTcpAgent::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 3) {
+		if (strcmp(argv[1], "advance") == 0) {
+			int newseq = atoi(argv[2]);
+			if (newseq > maxseq_)
+				advanceby(newseq - curseq_);
+			else
+				advanceby(maxseq_ - curseq_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "advanceby") == 0) {
+			advanceby(atoi(argv[2]));
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "eventtrace") == 0) {
+			et_ = (EventTrace *)TclObject::lookup(argv[2]);
+			return (TCL_OK);
+		}
+		/*
+		 * The fields are not TracedVars: take "trace" here rather
+		 * than let TclObject look for one.
+		 */
+		if (strcmp(argv[1], "trace") == 0) {
+			if (trace_var(argv[2]) < 0) {
+				tcl.resultf("trace: %s is not traced by %s",
+					    argv[2], name());
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
+	}
+	if (argc == 4 && strcmp(argv[1], "trace") == 0) {
+		tcl.resultf("trace: %s traces only to its own channel",
+			    name());
+		return (TCL_ERROR);
+	}
+	return (Agent::command(argc, argv));
+}
+
+void CompactTcpAgent::reset()
+{
+	rtt_init();
+	rtt_seq_ = -1;
+	dupacks_ = 0;
+	dupwnd_ = 0;
+	curseq_ = 0;
+	if (syn_ && delay_growth_) {
+		cwnd_ = 1.0;
+		syn_connects_ = 0;
+	} else
+		cwnd_ = wnd_init_;
+	t_seqno_ = 0;
+	maxseq_ = -1;
+	highest_ack_ = -1;
+	ssthresh_ = int(wnd_);
+	recover_ = 0;
+	closed_ = 0;
+	last_cwnd_action_ = 0;
+	boot_time_ = Random::uniform(tcp_tick_);
+	first_decrease_ = 1;
+	lastreset_ = Scheduler::instance().clock();
+
+	ndatapack_ = 0;
+	ndatabytes_ = 0;
+	nackpack_ = 0;
+	nrexmitbytes_ = 0;
+	nrexmit_ = 0;
+	nrexmitpack_ = 0;
+	ncwndcuts_ = 0;
+	rtx_timer_.force_cancel();
+	if (trace_)
+		trace_vars();
+}
+
+void CompactTcpAgent::rtt_init()
+{
+	t_rtt_ = 0;
+	t_srtt_ = int(srtt_init_ / tcp_tick_) << T_SRTT_BITS;
+	t_rttvar_ = int(rttvar_init_ / tcp_tick_) << T_RTTVAR_BITS;
+	t_rtxcur_ = rtxcur_init_;
+	t_backoff_ = 1;
+}
+
+double CompactTcpAgent::rtt_timeout()
+{
+	double timeout;
+	if (t_rtxcur_ < minrto_)
+		timeout = minrto_ * t_backoff_;
+	else
+		timeout = t_rtxcur_ * t_backoff_;
+	if (timeout > maxrto_)
+		timeout = maxrto_;
+	if (timeout < 2.0 * tcp_tick_) {
+		if (timeout < 0) {
+			fprintf(stderr, "CompactTcpAgent: negative RTO!  (%f)\n",
+				timeout);
+			exit(1);
+		}
+		timeout = 2.0 * tcp_tick_;
+	}
+	return (timeout);
+}
+
+void CompactTcpAgent::rtt_update(double tao)
+{
+	double now = Scheduler::instance().clock();
+	double sendtime = now - tao + boot_time_;
+	double tickoff = fmod(sendtime, tcp_tick_);
+	t_rtt_ = int((tao + tickoff) / tcp_tick_);
+	if (t_rtt_ < 1)
+		t_rtt_ = 1;
+	if (t_srtt_ != 0) {
+		short delta;
+		delta = t_rtt_ - (t_srtt_ >> T_SRTT_BITS);	// d = (m - a0)
+		if ((t_srtt_ += delta) <= 0)	// a1 = 7/8 a0 + 1/8 m
+			t_srtt_ = 1;
+		if (delta < 0)
+			delta = -delta;
+		delta -= (t_rttvar_ >> T_RTTVAR_BITS);
+		if ((t_rttvar_ += delta) <= 0)	// var1 = 3/4 var0 + 1/4 |d|
+			t_rttvar_ = 1;
+	} else {
+		t_srtt_ = t_rtt_ << T_SRTT_BITS;		// srtt = rtt
+		t_rttvar_ = t_rtt_ << (T_RTTVAR_BITS-1);	// rttvar = rtt / 2
+	}
+	t_rtxcur_ = (((t_rttvar_ << (rttvar_exp_ + (T_SRTT_BITS - T_RTTVAR_BITS))) +
+		t_srtt_)  >> T_SRTT_BITS ) * tcp_tick_;
+}
+
+void CompactTcpAgent::rtt_backoff()
+{
+	if (t_backoff_ < 64 || rtt_timeout() < maxrto_)
+		t_backoff_ <<= 1;
+	if (t_backoff_ > 8) {
+		/* backed off this far, keep srtt in the mean deviation */
+		t_rttvar_ += (t_srtt_ >> T_SRTT_BITS);
+		t_srtt_ = 0;
+	}
+}
+
+void CompactTcpAgent::reset_rtx_timer(int mild, int backoff)
+{
+	if (backoff)
+		rtt_backoff();
+	set_rtx_timer();
+	if (!mild)
+		t_seqno_ = highest_ack_ + 1;
+	rtt_active_ = 0;
+}
+
+void CompactTcpAgent::output(int seqno, int reason)
+{
+	int force_set_rtx_timer = 0;
+	Packet* p = allocpkt();
+	hdr_tcp *tcph = hdr_tcp::access(p);
+	hdr_cmn *ch = hdr_cmn::access(p);
+	int databytes = ch->size();
+	tcph->seqno() = seqno;
+	tcph->ts() = Scheduler::instance().clock();
+	tcph->ts_echo() = 0;
+	tcph->reason() = reason;
+	tcph->last_rtt() = int(t_rtt_ * tcp_tick_ * 1000);
+	if (cong_action_) {
+		hdr_flags::access(p)->cong_action() = TRUE;
+		cong_action_ = FALSE;
+	}
+	if (seqno == 0 && syn_) {
+		databytes = 0;
+		if (maxseq_ == -1)
+			curseq_ += 1;	/* increment only on initial SYN */
+		ch->size() = tcpip_base_hdr_size_;
+		++syn_connects_;
+		if (max_connects_ > 0 && syn_connects_ > max_connects_) {
+			/* give up on the connection */
+			Packet::free(p);
+			curseq_ = 0;
+			rtx_timer_.resched(10000);
+			return;
+		}
+	} else if (seqno != 0)
+		ch->size() += tcpip_base_hdr_size_;
+
+	/* if no outstanding data, be sure to set rtx timer again */
+	if (highest_ack_ == maxseq_)
+		force_set_rtx_timer = 1;
+	++ndatapack_;
+	ndatabytes_ += databytes;
+	send(p, 0);
+	if (seqno == curseq_ && seqno > maxseq_)
+		idle();		// tell the application we have sent all
+	if (seqno > maxseq_) {
+		maxseq_ = seqno;
+		if (!rtt_active_) {
+			rtt_active_ = 1;
+			if (seqno > rtt_seq_) {
+				rtt_seq_ = seqno;
+				rtt_ts_ = Scheduler::instance().clock();
+			}
+		}
+	} else {
+		++nrexmitpack_;
+		nrexmitbytes_ += databytes;
+	}
+	if (rtx_timer_.status() != TIMER_PENDING || force_set_rtx_timer)
+		set_rtx_timer();
+}
+
+void CompactTcpAgent::sendmsg(int nbytes, const char* /*flags*/)
+{
+	if (nbytes == -1 && curseq_ <= TCP_MAXSEQ)
+		curseq_ = TCP_MAXSEQ;
+	else
+		curseq_ += (nbytes/size_ + (nbytes%size_ ? 1 : 0));
+	send_much(0, maxburst_);
+	if (trace_)
+		trace_vars();
+}
+
+void CompactTcpAgent::advanceby(int delta)
+{
+	curseq_ += delta;
+	if (delta > 0)
+		closed_ = 0;
+	send_much(0, maxburst_);
+	if (trace_)
+		trace_vars();
+}
+
+void CompactTcpAgent::send_much(int reason, int maxburst)
+{
+	int win = window();
+	int npackets = 0;
+
+	while (t_seqno_ <= highest_ack_ + win && t_seqno_ < curseq_) {
+		output(t_seqno_, reason);
+		t_seqno_++;
+		win = window();
+		if (maxburst && ++npackets == maxburst)
+			break;
+	}
+}
+
+/*
+ * A first or second duplicate ACK: send a new packet if the windows
+ * allow one more than cwnd_ per duplicate ACK (limited transmit).
+ */
+void CompactTcpAgent::send_one()
+{
+	if (t_seqno_ <= highest_ack_ + wnd_ && t_seqno_ < curseq_ &&
+	    t_seqno_ <= highest_ack_ + cwnd_ + dupacks_) {
+		output(t_seqno_, 0);
+		t_seqno_++;
+	}
+}
+
+void CompactTcpAgent::newtimer(Packet* pkt)
+{
+	hdr_tcp *tcph = hdr_tcp::access(pkt);
+	if (t_seqno_ > tcph->seqno() || tcph->seqno() < maxseq_ || cwnd_ < 1)
+		set_rtx_timer();
+	else
+		rtx_timer_.force_cancel();
+}
+
+void CompactTcpAgent::newack(Packet* pkt)
+{
+	hdr_tcp *tcph = hdr_tcp::access(pkt);
+	dupacks_ = 0;
+	highest_ack_ = tcph->seqno();
+	if (t_seqno_ < highest_ack_ + 1)
+		t_seqno_ = highest_ack_ + 1;
+	if (!hdr_flags::access(pkt)->no_ts_ &&
+	    rtt_active_ && tcph->seqno() >= rtt_seq_) {
+		t_backoff_ = 1;
+		rtt_active_ = 0;
+		rtt_update(Scheduler::instance().clock() - rtt_ts_);
+	}
+	newtimer(pkt);
+}
+
+/*
+ * An ACK for data sent during fast recovery that leaves us in it:
+ * deflate the window by the amount acked and retransmit the next hole.
+ */
+void CompactTcpAgent::partialnewack(Packet* pkt)
+{
+	hdr_tcp *tcph = hdr_tcp::access(pkt);
+	if (firstpartial_ == 0) {
+		/* restart the timer only for the first partial ACK */
+		firstpartial_ = 1;
+		newtimer(pkt);
+	}
+	unsigned int deflate = tcph->seqno() - highest_ack_;
+	if (dupwnd_ > deflate)
+		dupwnd_ -= (deflate - 1);
+	else {
+		cwnd_ -= (deflate - dupwnd_);
+		dupwnd_ = 1;	/* still "in fast recovery" */
+	}
+	if (cwnd_ < 1)
+		cwnd_ = 1;
+	highest_ack_ = tcph->seqno();
+	if (t_seqno_ < highest_ack_ + 1)
+		t_seqno_ = highest_ack_ + 1;
+	if (rtt_active_ && tcph->seqno() >= rtt_seq_) {
+		rtt_active_ = 0;
+		t_backoff_ = 1;
+	}
+	output(highest_ack_ + 1, 0);
+}
+
+void CompactTcpAgent::opencwnd()
+{
+	if (cwnd_ < ssthresh_)
+		cwnd_ += 1;		/* slow-start */
+	else
+		cwnd_ += 1 / cwnd_;	/* congestion avoidance */
+	if (maxcwnd_ && (int(cwnd_) > maxcwnd_))
+		cwnd_ = maxcwnd_;
+}
+
+void CompactTcpAgent::slowdown(int how)
+{
+	int slowstart = 0;
+	++ncwndcuts_;
+	if (cwnd_ < ssthresh_)
+		slowstart = 1;
+	double halfwin = windowd() / 2;
+	if (how & CLOSE_SSTHRESH_HALF)
+		ssthresh_ = (int) halfwin;
+	if (how & CLOSE_CWND_HALF)
+		cwnd_ = halfwin;
+	else if (how & (CLOSE_CWND_RESTART|CLOSE_CWND_ONE))
+		cwnd_ = 1;
+	if (ssthresh_ < 2)
+		ssthresh_ = 2;
+	if (how & (CLOSE_CWND_HALF|CLOSE_CWND_RESTART|CLOSE_CWND_ONE))
+		cong_action_ = TRUE;
+	first_decrease_ = 0;
+	if (cwnd_ == 1 || slowstart)
+		trace_event("SLOW_START");
+}
+
+void CompactTcpAgent::dupack_action()
+{
+	if (highest_ack_ <= recover_ && highest_ack_ != 0) {
+		/* avoid multiple fast retransmits in one window */
+		return;
+	}
+	recover_ = maxseq_;
+	reset_rtx_timer(1, 0);
+	trace_event("NEWRENO_FAST_RETX");
+	last_cwnd_action_ = CWND_ACTION_DUPACK;
+	slowdown(CLOSE_SSTHRESH_HALF|CLOSE_CWND_HALF);
+	output(highest_ack_ + 1, TCP_REASON_DUPACK);
+	dupwnd_ = numdupacks_;
+}
+
+void CompactTcpAgent::recv(Packet *pkt, Handler*)
+{
+	hdr_tcp *tcph = hdr_tcp::access(pkt);
+	if (tcph->ts() < lastreset_) {
+		/* from a previous incarnation */
+		Packet::free(pkt);
+		return;
+	}
+	++nackpack_;
+	if (tcph->seqno() > highest_ack_) {
+		if (tcph->seqno() >= recover_ ||
+		    last_cwnd_action_ != CWND_ACTION_DUPACK) {
+			if (dupwnd_ > 0) {
+				dupwnd_ = 0;
+				if (last_cwnd_action_ == CWND_ACTION_DUPACK)
+					last_cwnd_action_ = CWND_ACTION_EXITED;
+			}
+			firstpartial_ = 0;
+			newack(pkt);
+			opencwnd();
+			if (highest_ack_ >= curseq_ - 1 && !closed_) {
+				closed_ = 1;
+				finish();
+			}
+			if (highest_ack_ == 0 && delay_growth_)
+				cwnd_ = wnd_init_;
+		} else
+			partialnewack(pkt);
+	} else if (tcph->seqno() == highest_ack_) {
+		if (++dupacks_ == numdupacks_)
+			dupack_action();
+		else if (dupacks_ > numdupacks_ &&
+			 last_cwnd_action_ == CWND_ACTION_DUPACK) {
+			trace_event("NEWRENO_FAST_RECOVERY");
+			++dupwnd_;	// fast recovery
+		} else if (dupacks_ < numdupacks_ && singledup_)
+			send_one();
+	}
+	Packet::free(pkt);
+
+	if (dupacks_ == 0)
+		send_much(0, maxburst_);
+	else if (dupacks_ > numdupacks_ - 1)
+		send_much(0, 2);
+	if (trace_)
+		trace_vars();
+}
+
+void CompactTcpAgent::timeout(int tno)
+{
+	if (tno != TCP_TIMER_RTX)
+		return;
+	dupwnd_ = 0;
+	dupacks_ = 0;
+	recover_ = maxseq_;
+	trace_event("TIMEOUT");
+	if (cwnd_ < 1)
+		cwnd_ = 1;
+	if (highest_ack_ != maxseq_ || slow_start_restart_) {
+		if (highest_ack_ == -1 && wnd_init_ > 1)
+			/* first packet dropped: no larger initial window */
+			wnd_init_ = 1;
+		if (highest_ack_ == maxseq_ && restart_bugfix_)
+			/* nothing outstanding: keep ssthresh_ */
+			slowdown(CLOSE_CWND_ONE);
+		else {
+			++nrexmit_;
+			last_cwnd_action_ = CWND_ACTION_TIMEOUT;
+			slowdown(CLOSE_SSTHRESH_HALF|CLOSE_CWND_RESTART);
+		}
+	}
+	/* if there is no outstanding data, don't back off the timer */
+	reset_rtx_timer(0, !(highest_ack_ == maxseq_ && restart_bugfix_));
+	last_cwnd_action_ = CWND_ACTION_TIMEOUT;
+	send_much(TCP_REASON_TIMEOUT, maxburst_);
+	if (trace_)
+		trace_vars();
+}
+
+void CompactTcpAgent::finish()
+{
+	Tcl::instance().evalf("%s done", this->name());
+}
+
+void CompactTcpAgent::trace_event(char *eventtype)
+{
+	if (et_ == NULL) return;
+	char *wrk = et_->buffer();
+	char *nwrk = et_->nbuffer();
+	if (wrk != 0)
+		sprintf(wrk,
+			"E " TIME_FORMAT " %d %d TCP %s %d %d %d",
+			et_->round(Scheduler::instance().clock()),
+			addr(), daddr(), eventtype, fid_, t_seqno_,
+			int(cwnd_));
+	if (nwrk != 0)
+		sprintf(nwrk,
+			"E -t " TIME_FORMAT " -o TCP -e %s -s %d.%d -d %d.%d",
+			et_->round(Scheduler::instance().clock()),
+			eventtype, addr(), port(), daddr(), dport());
+	et_->trace();
+}
+
+double CompactTcpAgent::trace_value(int i)
+{
+	switch (i) {
+	case 0: return (cwnd_);
+	case 1: return (ssthresh_);
+	case 2: return (t_seqno_);
+	case 3: return (highest_ack_);
+	case 4: return (maxseq_);
+	case 5: return (dupacks_);
+	case 6: return (t_rtt_ * tcp_tick_);
+	case 7: return ((t_srtt_ >> T_SRTT_BITS) * tcp_tick_);
+	case 8: return (t_rttvar_ * tcp_tick_ / 4.0);
+	default: return (t_backoff_);
+	}
+}
+
+/*
+ * Start tracing a variable, writing its value now as a TracedVar
+ * would.  Returns -1 if it is not one of ctrace_names.
+ */
+int CompactTcpAgent::trace_var(const char* name)
+{
+	int i;
+	for (i = 0; ctrace_names[i] != 0; i++)
+		if (strcmp(ctrace_names[i], name) == 0)
+			break;
+	if (ctrace_names[i] == 0)
+		return (-1);
+	if (trace_ == 0) {
+		trace_ = new CompactTcpTrace;
+		trace_->mask_ = 0;
+	}
+	trace_->mask_ |= 1 << i;
+	/* force a line for it */
+	trace_->last_[i] = trace_value(i) + 1;
+	trace_vars();
+	return (i);
+}
+
+/* Write a line, as TcpAgent::traceVar(), for each traced variable that changed */
+void CompactTcpAgent::trace_vars()
+{
+	char wrk[512];
+	for (int i = 0; ctrace_names[i] != 0; i++) {
+		if (!(trace_->mask_ & (1 << i)))
+			continue;
+		double v = trace_value(i);
+		if (v == trace_->last_[i])
+			continue;
+		trace_->last_[i] = v;
+		if (!channel_)
+			continue;
+		if (i == 0 || (i >= 6 && i <= 8))
+			snprintf(wrk, sizeof(wrk),
+				 "%-8.5f %-2d %-2d %-2d %-2d %s %-6.3f\n",
+				 Scheduler::instance().clock(), addr(),
+				 port(), daddr(), dport(), ctrace_names[i], v);
+		else
+			snprintf(wrk, sizeof(wrk),
+				 "%-8.5f %-2d %-2d %-2d %-2d %s %d\n",
+				 Scheduler::instance().clock(), addr(),
+				 port(), daddr(), dport(), ctrace_names[i],
+				 int(v));
+		(void)Tcl_Write(channel_, wrk, -1);
+	}
+}
@@ -0,0 +1,166 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * tcp-compact.h
+ *
+ * Agent/TCP/Compact: a one-way NewReno sender with a small footprint,
+ * for simulations with very many concurrent connections.
+ *
+ * TcpAgent carries every option and statistic of all its variants
+ * (TracedInt and TracedDouble members of 56 bytes each, three timers,
+ * Quick-Start, F-RTO, ECN, HighSpeed state, ...), some 2200 bytes of
+ * C++ state per connection.  CompactTcpAgent keeps only what NewReno
+ * needs, in plain ints and doubles: the hot per-ACK state first, then
+ * the statistics and the configuration, and behind a pointer the cold
+ * state that exists only when the connection is variable-traced.
+ *
+ * It behaves as Agent/TCP/Newreno with its default options, packet for
+ * packet.  The options it honors are window_, windowInit_, packetSize_,
+ * syn_, delay_growth_, max_connects_, tcpTick_, tcpip_base_hdr_size_,
+ * maxburst_, maxcwnd_, numdupacks_, singledup_, slow_start_restart_,
+ * restart_bugfix_, minrto_, maxrto_, srtt_init_, rttvar_init_,
+ * rtxcur_init_, T_SRTT_BITS, T_RTTVAR_BITS and rttvar_exp_; like
+ * TcpAgent it binds them with delay_bind(), so they take no per-instance
+ * Tcl variables.  The rest (ECN, timestamps, window options, overhead_,
+ * Quick-Start, F-RTO, ...) stay at the Agent/TCP defaults.
+ *
+ * "$tcp trace var" works for cwnd_, ssthresh_, t_seqno_, ack_, maxseq_,
+ * dupacks_, rtt_, srtt_, rttvar_ and backoff_, in the format of
+ * TcpAgent::traceVar(), but a variable is traced when its value has
+ * changed at the end of an ACK, a timeout or a send, not on every
+ * assignment.
+ */
+
+#ifndef ns_tcp_compact_h
+#define ns_tcp_compact_h
+
+#include "agent.h"
+#include "timer-handler.h"
+
+class CompactTcpAgent;
+
+class CompactRtxTimer : public TimerHandler {
+public:
+	CompactRtxTimer(CompactTcpAgent* a) : TimerHandler(), a_(a) { }
+protected:
+	virtual void expire(Event*);
+	CompactTcpAgent* a_;
+};
+
+/* cold state, allocated by the first "trace" */
+struct CompactTcpTrace {
+	int mask_;		/* traced variables, bit i for ctrace_names[i] */
+	double last_[10];	/* values last written */
+};
+
+class CompactTcpAgent : public Agent {
+	friend class CompactRtxTimer;
+public:
+	CompactTcpAgent();
+	~CompactTcpAgent();
+	virtual void recv(Packet*, Handler*);
+	virtual void timeout(int tno);
+	virtual void reset();
+	virtual void sendmsg(int nbytes, const char *flags = 0);
+	virtual void advanceby(int delta);
+	int command(int argc, const char*const* argv);
+protected:
+	virtual void delay_bind_init_all();
+	virtual int delay_bind_dispatch(const char *varName,
+					const char *localName,
+					TclObject *tracer);
+
+	int window() {
+		int win = int(cwnd_) + dupwnd_;
+		return (win > int(wnd_) ? int(wnd_) : win);
+	}
+	double windowd() {
+		double win = cwnd_ + dupwnd_;
+		return (win > wnd_ ? wnd_ : win);
+	}
+	void output(int seqno, int reason);
+	void send_much(int reason, int maxburst);
+	void send_one();
+	void newack(Packet*);
+	void partialnewack(Packet*);
+	void newtimer(Packet*);
+	void dupack_action();
+	void opencwnd();
+	void slowdown(int how);
+	void finish();
+
+	void rtt_init();
+	void rtt_update(double tao);
+	void rtt_backoff();
+	double rtt_timeout();
+	void set_rtx_timer() { rtx_timer_.resched(rtt_timeout()); }
+	void reset_rtx_timer(int mild, int backoff);
+
+	virtual void trace_event(char *eventtype);
+	int trace_var(const char* name);
+	void trace_vars();
+	double trace_value(int i);
+
+	/* hot: touched by every ACK */
+	double cwnd_;		/* congestion window */
+	unsigned int dupwnd_;	/* window inflation in fast recovery */
+	int t_seqno_;		/* next sequence number to send */
+	int highest_ack_;	/* highest cumulative ACK (last_ack_ too) */
+	int maxseq_;		/* highest sequence number sent */
+	int curseq_;		/* highest sequence number from the app */
+	int recover_;		/* maxseq_ at the last window cut */
+	int ssthresh_;
+	int dupacks_;
+	int t_rtt_;		/* RTT state, as in TcpAgent, in ticks */
+	int t_srtt_;
+	int t_rttvar_;
+	int t_backoff_;
+	int rtt_seq_;		/* sequence number being timed */
+	double rtt_ts_;		/* and when it was sent */
+	double t_rtxcur_;	/* current retransmit value */
+	double boot_time_;	/* offset of the tick clock */
+	double lastreset_;
+	char rtt_active_;
+	char last_cwnd_action_;
+	char first_decrease_;
+	char firstpartial_;
+	char cong_action_;
+	char closed_;
+	int syn_connects_;
+	CompactRtxTimer rtx_timer_;
+
+	/* statistics */
+	int ndatapack_;
+	int ndatabytes_;
+	int nackpack_;
+	int nrexmit_;
+	int nrexmitpack_;
+	int nrexmitbytes_;
+	int ncwndcuts_;
+
+	/* configuration */
+	double wnd_;		/* receiver's window */
+	double tcp_tick_;
+	double minrto_;
+	double maxrto_;
+	double rtxcur_init_;
+	int wnd_init_;
+	int syn_;
+	int delay_growth_;
+	int max_connects_;
+	int tcpip_base_hdr_size_;
+	int maxburst_;
+	int maxcwnd_;
+	int numdupacks_;
+	int singledup_;
+	int slow_start_restart_;
+	int restart_bugfix_;
+	int srtt_init_;
+	int rttvar_init_;
+	int T_SRTT_BITS;
+	int T_RTTVAR_BITS;
+	int rttvar_exp_;
+
+	CompactTcpTrace* trace_;
+};
+
+#endif
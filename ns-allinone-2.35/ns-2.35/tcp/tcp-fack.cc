@@ -29,7 +29,7 @@ static const char rcsid[] =
 #include "ip.h"
 #include "tcp.h"
 #include "flags.h"
-#include "scoreboard.h"
+#include "scoreboard-rq.h"
 #include "random.h"
 #include "tcp-fack.h"
 #include "template.h"
@@ -49,11 +49,15 @@ FackTcpAgent::FackTcpAgent() : 	timeout_(FALSE), wintrim_(0),
 {
 	bind_bool("ss-div4_", &ss_div4_);
 	bind_bool("rampdown_", &rampdown_);
-	scb_ = new ScoreBoard(new ScoreBoardNode[SBSIZE],SBSIZE);
+	/*
+	 * ScoreBoard is O(cwnd) per ack, which is bad with large windows
+	 * scb_ = new ScoreBoard(new ScoreBoardNode[SBSIZE],SBSIZE);
+	 */
+	scb_ = new ScoreBoardRQRetran();
 }
 
 FackTcpAgent::~FackTcpAgent(){
-	delete [] scb_;
+	delete scb_;
 }
 
 int FackTcpAgent::window() 
@@ -72,7 +72,6 @@ class FackTcpAgent : public TcpAgent {
 	int ss_div4_;
 
 	ScoreBoard* scb_;
-	static const int SBSIZE=1024;
 };
 
 
@@ -647,7 +647,10 @@ FullTcpAgent::reset()
 void
 FullTcpAgent::finish()
 {
-	Tcl::instance().evalf("%s done", this->name());
+	if (done_ != 0)
+		done_->tcpdone(this);
+	else
+		Tcl::instance().evalf("%s done", this->name());
 }
 /*
  * headersize:
@@ -2497,7 +2500,7 @@ step6:
 	// It cannot be put in the switch above because we might need to do
 	// send_much() (an ACK)
 	if (state_ == TCPS_CLOSED) 
-		Tcl::instance().evalf("%s done", this->name());
+		finish();
 
 	return;
 
@@ -105,6 +105,17 @@
 #define	TCP_PAWS_IDLE	(24 * 24 * 60 * 60)	/* 24 days in secs */
 
 class FullTcpAgent;
+
+/*
+ * Told when a FullTcpAgent closes, in place of "$tcp done", by the
+ * connection managers (Tmix, PackMimeHTTP) that recycle their agents.
+ */
+class FullTcpDone {
+public:
+	virtual ~FullTcpDone() {}
+	virtual void tcpdone(FullTcpAgent*) = 0;
+};
+
 class DelAckTimer : public TimerHandler {
 public:
 	DelAckTimer(FullTcpAgent *a) : TimerHandler(), a_(a) { }
@@ -120,7 +131,8 @@ public:
         	last_send_time_(-1.0), infinite_send_(FALSE), irs_(-1),
         	delack_timer_(this), flags_(0),
         	state_(TCPS_CLOSED), recent_ce_(FALSE),
-        	last_state_(TCPS_CLOSED), rq_(rcv_nxt_), last_ack_sent_(-1) { }
+        	last_state_(TCPS_CLOSED), rq_(rcv_nxt_), last_ack_sent_(-1),
+		done_(0) { }
 
 	~FullTcpAgent() { cancel_timers(); rq_.clear(); }
 	virtual void recv(Packet *pkt, Handler*);
@@ -132,6 +144,15 @@ public:
         virtual int& size() { return maxseg_; } //FullTcp uses maxseg_ for size_
 	virtual int command(int argc, const char*const* argv);
        	virtual void reset();       		// reset to a known point
+	/* what "setup-tcp" does in Tcl; window and mss unless -1 */
+	void setup(int fid, int window, int mss, FullTcpDone* done) {
+		fid_ = fid;
+		if (window >= 0)
+			wnd_ = window;
+		if (mss >= 0)
+			maxseg_ = mss;
+		done_ = done;
+	}
 protected:
 	virtual void delay_bind_init_all();
 	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
@@ -248,6 +269,8 @@ protected:
 	 * by TcpAgent::reset()
 	 */
 	void set_initial_window();
+
+	FullTcpDone* done_;	// or "$tcp done"
 };
 
 class NewRenoFullTcpAgent : public FullTcpAgent {
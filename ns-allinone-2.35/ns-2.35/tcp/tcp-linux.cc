@@ -100,9 +100,14 @@ public:
 
 LinuxTcpAgent::LinuxTcpAgent() :
 	initialized_(false),
-	next_pkts_in_flight_(0)
+	next_pkts_in_flight_(0),
+	held_ack_(NULL),
+	held_acks_(0),
+	ack_batch_timer_(this)
 {
 	bind("next_pkts_in_flight_", &next_pkts_in_flight_);
+	bind("ack_batch_", &ack_batch_);
+	bind_time("ack_batch_time_", &ack_batch_time_);
 	scb_ = new ScoreBoard1();
 	linux_.icsk_ca_ops = NULL;
         linux_.snd_cwnd_stamp = 0;
@@ -115,6 +120,9 @@ LinuxTcpAgent::LinuxTcpAgent() :
 }
 
 LinuxTcpAgent::~LinuxTcpAgent(){
+	ack_batch_timer_.force_cancel();
+	if (held_ack_)
+		Packet::free(held_ack_);
 	delete scb_;
 	remove_congestion_control();
 }
@@ -130,6 +138,12 @@ double LinuxTcpAgent::windowd()
 }
 void LinuxTcpAgent::reset()
 {
+	ack_batch_timer_.force_cancel();
+	if (held_ack_) {
+		Packet::free(held_ack_);
+		held_ack_ = NULL;
+		held_acks_ = 0;
+	}
 	scb_->ClearScoreBoard();
 	linux_.icsk_ca_state = TCP_CA_Open;
 	linux_.snd_cwnd_stamp = 0;
@@ -304,7 +318,63 @@ void LinuxTcpAgent::rtt_update(double tao, unsigned long pkt_seq_no)
 	return;
 }
 
+void AckBatchTimer::expire(Event*)
+{
+	a_->flush_acks();
+}
+
+/*
+ * An ACK that only moves snd_una on, and can be merged with the ACKs
+ * after it into one stretch ACK.
+ */
+bool LinuxTcpAgent::batchable(Packet* pkt)
+{
+	hdr_tcp *tcph = hdr_tcp::access(pkt);
+	int last = held_ack_ ? hdr_tcp::access(held_ack_)->seqno() :
+		int(highest_ack_);
+
+	return (tcph->sa_length() == 0 && !hdr_flags::access(pkt)->ecnecho() &&
+		tcph->seqno() > last && tcph->seqno() < t_seqno_ &&
+		linux_.icsk_ca_state == TCP_CA_Open && scb_->IsEmpty());
+}
+
+void LinuxTcpAgent::flush_acks()
+{
+	// the timer is only for the ACKs held now
+	ack_batch_timer_.force_cancel();
+	if (held_ack_) {
+		Packet* pkt = held_ack_;
+		int n = held_acks_;
+		held_ack_ = NULL;
+		held_acks_ = 0;
+		ack_received(pkt, n);
+	}
+}
+
 void LinuxTcpAgent::recv(Packet *pkt, Handler*)
+{
+	if (ack_batch_ <= 1) {
+		ack_received(pkt, 1);
+		return;
+	}
+	if (!batchable(pkt)) {
+		flush_acks();
+		ack_received(pkt, 1);
+		return;
+	}
+	// the later ACK covers the held one
+	if (held_ack_) {
+		++nackpack_;
+		Packet::free(held_ack_);
+	}
+	held_ack_ = pkt;
+	if (++held_acks_ >= ack_batch_)
+		flush_acks();
+	else if (ack_batch_timer_.status() != TIMER_PENDING)
+		ack_batch_timer_.sched(ack_batch_time_);
+}
+
+void LinuxTcpAgent::ack_received(Packet *pkt, int nacks)
 //equivalence to tcp_ack
 {
 	hdr_tcp *tcph = hdr_tcp::access(pkt);
@@ -416,7 +486,8 @@ void LinuxTcpAgent::recv(Packet *pkt, Handler*)
 	} else {
 		if ((flag & FLAG_DATA_ACKED)) {
 			prev_highest_ack_ = highest_ack_ ;
-			tcp_cong_avoid(ack, seq_rtt, prior_in_flight, 1);
+			for (int i = 0; i < nacks; i++)
+				tcp_cong_avoid(ack, seq_rtt, prior_in_flight, 1);
 		}
 	};
 	DEBUG(5, "cc all finished\n");
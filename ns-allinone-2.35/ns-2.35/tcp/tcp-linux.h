@@ -107,6 +107,17 @@ public:
 };
 
 
+class LinuxTcpAgent;
+
+/* Flushes the ACKs held by ack_batch_ */
+class AckBatchTimer : public TimerHandler {
+public:
+	AckBatchTimer(LinuxTcpAgent *a) : TimerHandler() { a_ = a; }
+protected:
+	virtual void expire(Event *e);
+	LinuxTcpAgent *a_;
+};
+
 /* TCP Linux */
 class LinuxTcpAgent : public TcpAgent {
 private:	
@@ -125,6 +136,7 @@ public:
 	virtual void send_much(int force, int reason, int maxburst = 0);
 	virtual int packets_in_flight();
 	virtual int command(int argc, const char*const* argv);
+	void flush_acks();
 
 protected:
 	ScoreBoard1 *scb_;
@@ -133,6 +145,20 @@ protected:
 					// ca_ops->init shall be run the first time an acknowledgment is processed (at least one RTT sample recorded).
 	TracedInt next_pkts_in_flight_;	//the # of packets in flight allowed, if we need rate halving
 
+	// Batched ACK processing, as a Linux sender sees ACKs after GRO:
+	// with ack_batch_ > 1, in-order cumulative ACKs (no SACK, no ECE,
+	// in TCP_CA_Open) are held for up to ack_batch_time_ and processed
+	// as one stretch ACK of up to ack_batch_ ACKs.  The congestion
+	// control module still gets one cong_avoid() per ACK.
+	int ack_batch_;
+	double ack_batch_time_;
+	Packet* held_ack_;		// the latest ACK held
+	int held_acks_;			// ACKs it stands for
+	AckBatchTimer ack_batch_timer_;
+
+	bool batchable(Packet* pkt);
+	void ack_received(Packet* pkt, int nacks);	// process nacks ACKs, the last being pkt
+
 
 	virtual bool is_congestion();	// whether the network is congested?
 
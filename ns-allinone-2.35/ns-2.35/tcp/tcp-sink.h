@@ -101,6 +101,7 @@ class TcpSink : public Agent {
 public:
 	TcpSink(Acker*);
 	void recv(Packet* pkt, Handler*);
+	void recvtrain(Packet* p) { recveach(p); }
 	void reset();
 	int command(int argc, const char*const* argv);
 	TracedInt& maxsackblocks() { return max_sack_blocks_; }
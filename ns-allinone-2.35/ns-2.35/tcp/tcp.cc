@@ -175,6 +175,7 @@ TcpAgent::delay_bind_init_all()
 	delay_bind_init_one("max_ssthresh_");
 	delay_bind_init_one("cwnd_range_");
 	delay_bind_init_one("timerfix_");
+	delay_bind_init_one("lazy_timer_");
 	delay_bind_init_one("rfc2988_");
 	delay_bind_init_one("singledup_");
 	delay_bind_init_one("LimTransmitFix_");
@@ -287,6 +288,7 @@ TcpAgent::delay_bind_dispatch(const char *varName, const char *localName, TclObj
 	if (delay_bind(varName, localName, "max_ssthresh_", &max_ssthresh_, tracer)) return TCL_OK;
 	if (delay_bind(varName, localName, "cwnd_range_", &cwnd_range_, tracer)) return TCL_OK;
 	if (delay_bind_bool(varName, localName, "timerfix_", &timerfix_, tracer)) return TCL_OK;
+	if (delay_bind_bool(varName, localName, "lazy_timer_", &lazy_timer_, tracer)) return TCL_OK;
 	if (delay_bind_bool(varName, localName, "rfc2988_", &rfc2988_, tracer)) return TCL_OK;
         if (delay_bind(varName, localName, "singledup_", &singledup_ , tracer)) return TCL_OK;
         if (delay_bind_bool(varName, localName, "LimTransmitFix_", &LimTransmitFix_ , tracer)) return TCL_OK;
@@ -978,7 +980,10 @@ void TcpAgent::reset_rtx_timer(int mild, int backoff)
  */
 void TcpAgent::set_rtx_timer()
 {
-	rtx_timer_.resched(rtt_timeout());
+	if (lazy_timer_)
+		rtx_timer_.resched_lazy(rtt_timeout());
+	else
+		rtx_timer_.resched(rtt_timeout());
 }
 
 /*
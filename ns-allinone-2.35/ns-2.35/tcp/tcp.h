@@ -177,6 +177,7 @@ public:
 	TcpAgent();
 	virtual ~TcpAgent() {free(tss);}
         virtual void recv(Packet*, Handler*);
+	void recvtrain(Packet* p) { recveach(p); }
 	virtual void timeout(int tno);
 	virtual void timeout_nonrtx(int tno);
 	int command(int argc, const char*const* argv);
@@ -336,6 +337,7 @@ protected:
 	void reset_rtx_timer(int mild, int backoff = 1);
 	int timerfix_;		/* set to true to update timer *after* */
 				/* update the RTT, instead of before   */
+	int lazy_timer_;	/* put the timer off with resched_lazy() */
 	int rfc2988_;		/* Use updated RFC 2988 timers */
 	/* End of timers. */ 
 
@@ -64,6 +64,32 @@ void ADU::print()
 	}
 }
 
+/*
+ * A trace-derived cvec file has as many ADUs as lines, all of one size,
+ * so they come from a free list rather than one malloc each.
+ */
+static ADU* adu_free = NULL;
+
+void* ADU::operator new(size_t size)
+{
+	if (adu_free == NULL) {
+		ADU* chunk = (ADU*) ::operator new(size * ADU_CHUNK);
+		for (int i = 0; i < ADU_CHUNK; i++) {
+			*(ADU**) &chunk[i] = adu_free;
+			adu_free = &chunk[i];
+		}
+	}
+	ADU* adu = adu_free;
+	adu_free = *(ADU**) adu;
+	return (adu);
+}
+
+void ADU::operator delete(void* p)
+{
+	*(ADU**) p = adu_free;
+	adu_free = (ADU*) p;
+}
+
 /*:::::::::::::::::::::::: CONNECTION VECTOR class :::::::::::::::::::::::::*/
 
 ConnVector::~ConnVector()
@@ -122,11 +148,13 @@ public:
 Tmix::Tmix() :
 	TclObject(), timer_(this), next_init_ind_(0), 
 	next_acc_ind_(0), total_nodes_(0), current_node_(0), outfp_(NULL),
-	cvfp_(NULL), ID_(-1), run_(0), debug_(0), pkt_size_(1460),
+	cvfp_(NULL), cvbin_(NULL), cv_file_type_(0), last_dir_(INITIATOR),
+	ID_(-1), run_(0), debug_(0), pkt_size_(1460),
 	step_size_(1000), warmup_(0), active_connections_(0), 
 	total_connections_(0), total_apps_(0), running_(false), 
 	agentType_(FULL), prefill_t_(0), prefill_a_(1), prefill_si_(0), 
-	scale_(1), end_(0), fin_time_(1000000), check_oneway_closed_(false)
+	scale_(1), end_(0), fin_time_(1000000), check_oneway_closed_(false),
+	fast_setup_(false), nodePool_(1.0)
 {
 	connections_.clear();
 	line[0] = '#';
@@ -184,6 +212,8 @@ Tmix::~Tmix()
 		tcl.evalf ("delete %s", tcp->name());
  		tcpPool_.pop();
 	}
+	while ((tcp = nodePool_.drain()) != NULL)
+		tcl.evalf ("delete %s", tcp->name());
 
 	/* delete connections */
 	for (list<ConnVector*>::iterator i = connections_.begin();
@@ -199,13 +229,25 @@ Tmix::~Tmix()
 	/* close input file, if not already closed */
         if (cvfp_)
 		fclose (cvfp_);
+	delete cvbin_;
 }
 
-TmixAgent* Tmix::picktcp()
+TmixAgent* Tmix::picktcp(Node* node)
 {
 	TmixAgent* a;
 
-	if (! tcpPool_.empty()) {
+	if (fast_setup()) {
+		/* an agent already attached to node, if one is free */
+		a = nodePool_.get(node, now());
+		if (a != NULL) {
+			if (debug_ >= 6)
+				fprintf (stderr, "\tflow %lu got TCPAgent %s "
+					 "from pool (%d in pool)\n",
+					 total_connections_, a->name(),
+					 nodePool_.size());
+			return a;
+		}
+	} else if (! tcpPool_.empty()) {
 		/* check to see if oldest agent has been in for 1 second */
 		a = tcpPool_.front();
 		if (a->inPoolFor1s(now())) {
@@ -275,6 +317,42 @@ TmixApp* Tmix::pickApp()
 	return a;
 }
 
+/*
+ * Create n agents per initiator and acceptor node, attached and ready
+ * in the node pools, and the apps for them, before the simulation
+ * runs rather than as connections start.
+ */
+void Tmix::prewarm(int n)
+{
+	Tcl& tcl = Tcl::instance();
+	int nodes = next_init_ind_ < next_acc_ind_ ? 
+		next_init_ind_ : next_acc_ind_;
+	if (fast_setup()) {
+		for (int i = 0; i < nodes; i++) {
+			for (int k = 0; k < n; k++) {
+				TmixAgent* a = agentFactory(this, tcptype_, 
+							    sinktype_);
+				a->attachToNode(initiator_[i]);
+				nodePool_.put (initiator_[i], a, 
+					       now() - nodePool_.hold_);
+				a = agentFactory(this, tcptype_, sinktype_);
+				a->attachToNode(acceptor_[i]);
+				nodePool_.put (acceptor_[i], a, 
+					       now() - nodePool_.hold_);
+			}
+		}
+	}
+	for (int k = 0; k < 2 * n * nodes; k++) {
+		tcl.evalf ("%s alloc-app", name());
+		TmixApp* a = (TmixApp*) lookup_obj (tcl.result());
+		if (a == NULL) {
+			fprintf (stderr, "Failed to allocate a Tmix app\n");
+			abort();
+		}
+		appPool_.push (a);
+	}
+}
+
 int Tmix::crecycle(Agent* tcp) {
 	/* Time to stop the TmixApp and recycle apps and agents */
 
@@ -363,7 +441,10 @@ void Tmix::recycle(TmixAgent* agent)
 	agent->setPoolTime(now());
 
 	/* add to the inactive agent pool */
-	tcpPool_.push (agent);
+	if (fast_setup())
+		nodePool_.put (agent->getNode(), agent, now());
+	else
+		tcpPool_.push (agent);
 
 	if (debug_ >= 6) {
 		fprintf (stderr, "\tTCPAgent %s moved to pool ", 
@@ -409,7 +490,7 @@ void Tmix::incr_next_active()
 
 	iter++;
 	if (iter == connections_.end()) {
-		while (!feof (cvfp_) && i < (int) step_size_) {
+		while (!cvec_eof() && i < (int) step_size_) {
 			/* all connections are started and there are still 
 			 * connection vectors in the file, so read a set */
 			cv = read_one_cvec();
@@ -438,19 +519,19 @@ void Tmix::setup_connection ()
 {
 	ConnVector* cv = get_current_cvec();
 
+	/* rotate through nodes assigning connections */
+	current_node_++;
+	if (current_node_ >= total_nodes_)
+		current_node_ = 0;
+
 	/* pick tcp agent for initiator and acceptor */
-	TmixAgent* init_tcp = picktcp();
-	TmixAgent* acc_tcp = picktcp();
+	TmixAgent* init_tcp = picktcp(initiator_[current_node_]);
+	TmixAgent* acc_tcp = picktcp(acceptor_[current_node_]);
 
 	/* increment total connections - must be done before 
 	   configuring tcp sources (sets flowid) */
 	incr_total();
 
-	/* rotate through nodes assigning connections */
-	current_node_++;
-	if (current_node_ >= total_nodes_)
-		current_node_ = 0;
-
 	/* attach agents to nodes (acceptor_ init_) */
 	init_tcp->attachToNode(initiator_[current_node_]);
 	acc_tcp->attachToNode(acceptor_[current_node_]);
@@ -551,24 +632,50 @@ int fpeek(FILE *stream)
     return c;
 }
 
+static void cvhdr_begin(CvbConn& h, u_int64_t id, u_int64_t start, bool type)
+{
+	memset(&h, 0, sizeof(h));
+	h.id_ = id;
+	h.start_ = start;
+	if (type == CONC)
+		h.flags_ = CVB_CONC;
+}
+
+static void cvhdr_win(CvbConn& h, int init_win, int acc_win)
+{
+	h.init_win_ = init_win;
+	h.acc_win_ = acc_win;
+	if (!(h.flags_ & CVB_MSS))
+		h.flags_ |= CVB_WIN_FIRST;
+	h.flags_ |= CVB_WIN;
+}
+
 #include <iostream>
 using namespace std;
 ConnVector* Tmix::read_one_cvec() {
-  static bool read = false;
-  static int cv_file_type = 0;
+  ConnVector* cv;
+
+  if (cvbin_ != NULL)
+    cv = read_one_cvec_bin();
+  else
+    cv = parse_one_cvec();
+  if (cv != NULL)
+    add_fin(cv);
+  return cv;
+}
 
-  if (!read) {
-    read = true;
+ConnVector* Tmix::parse_one_cvec() {
+  if (cv_file_type_ == 0) {
     char local_line[CVEC_LINE_MAX];
 
     do {
       fgets(local_line, CVEC_LINE_MAX, cvfp_);
     } while (local_line[0] == '#');
     if (local_line[1] == 'E' || local_line[1] == 'O') {
-      cv_file_type = CV_V1;
+      cv_file_type_ = CV_V1;
     }
     else {
-      cv_file_type = CV_V2;
+      cv_file_type_ = CV_V2;
     }
     fclose(cvfp_);
     cvfp_ = fopen(cvfn_.c_str(), "r");
@@ -576,15 +683,129 @@ ConnVector* Tmix::read_one_cvec() {
       cerr << "Error opening connection vector file" << endl;
     }
   }
-  if (cv_file_type == CV_V1) {
+  if (cv_file_type_ == CV_V1) {
 	  return read_one_cvec_v1();
   }
-  else if (cv_file_type == CV_V2) {
+  else if (cv_file_type_ == CV_V2) {
 	  return read_one_cvec_v2();
   } 
   return 0;
 }
 
+/*
+ * Both text readers leave the lines of the cvec in cvhdr_ and the
+ * direction of its last ADU in last_dir_.
+ */
+
+/* Was the last ADU a FIN?  If not, we need to add one */
+void Tmix::add_fin(ConnVector* cv)
+{
+	const vector<ADU*>& adus = (last_dir_ == INITIATOR) ?
+		cv->get_init_ADU() : cv->get_acc_ADU();
+	if (adus.empty() || adus.back()->get_size() != 0)
+		cv->add_ADU (new ADU (fin_time_, 0, 0), last_dir_);
+}
+
+void Tmix::set_mss(ConnVector* cv, int init_mss, int acc_mss)
+{
+	/* set the mss to the greater value for Full TCP */
+	if (agentType_ == FULL) {
+		cv->set_mss(max(init_mss,acc_mss));
+	}
+	/* set the initiator mss and acceptor mss for one-way TCP */
+	else {
+		cv->set_init_mss(init_mss);
+		cv->set_acc_mss(acc_mss);
+	}
+	cvhdr_.init_mss_ = init_mss;
+	cvhdr_.acc_mss_ = acc_mss;
+	cvhdr_.flags_ |= CVB_MSS;
+}
+
+/* the next ConnVector of a binary file, as read_one_cvec_v[12] build it */
+ConnVector* Tmix::read_one_cvec_bin()
+{
+	const CvbConn* c = cvbin_->next();
+	if (c == NULL)
+		return NULL;
+	ConnVector* cv = new ConnVector (c->id_, c->start_ / 1000000.0,
+					 (c->flags_ & CVB_CONC) ? CONC : SEQ,
+					 c->init_count_, c->acc_count_,
+					 pkt_size_);
+	if ((c->flags_ & CVB_WIN) && (c->flags_ & CVB_WIN_FIRST)) {
+		cv->set_init_win (c->init_win_);
+		cv->set_acc_win (c->acc_win_);
+	}
+	if (c->flags_ & CVB_MSS) {
+		if (agentType_ == FULL) {
+			cv->set_mss (max(c->init_mss_, c->acc_mss_));
+		} else {
+			cv->set_init_mss (c->init_mss_);
+			cv->set_acc_mss (c->acc_mss_);
+		}
+	}
+	if ((c->flags_ & CVB_WIN) && !(c->flags_ & CVB_WIN_FIRST)) {
+		cv->set_init_win (c->init_win_);
+		cv->set_acc_win (c->acc_win_);
+	}
+	const CvbADU* a = CvbReader::adus(c);
+	for (u_int32_t i = 0; i < c->nadu_; i++, a++) {
+		cv->add_ADU (new ADU (a->send_wait_, a->recv_wait_, a->size_),
+			     a->acc_ ? ACCEPTOR : INITIATOR);
+	}
+	last_dir_ = (c->flags_ & CVB_LAST_ACC) ? ACCEPTOR : INITIATOR;
+	return cv;
+}
+
+/*
+ * Parse the whole text cvec file and write it as a binary one; returns
+ * the number of connection vectors written, or -1.
+ */
+int Tmix::write_cvbin(const char* fn)
+{
+	CvbWriter w;
+	vector<CvbADU> adus;
+	int n = 0;
+
+	if (cvfp_ == NULL || cvbin_ != NULL) {
+		fprintf (stderr, "Tmix: write-cvbin needs a text cvec file\n");
+		return (-1);
+	}
+	if (w.open(fn) < 0)
+		return (-1);
+	while (!feof (cvfp_)) {
+		ConnVector* cv = parse_one_cvec();
+		if (cv == NULL)
+			continue;
+		adus.clear();
+		for (int dir = 0; dir < 2; dir++) {
+			const vector<ADU*>& l = dir ? cv->get_acc_ADU() :
+				cv->get_init_ADU();
+			for (size_t i = 0; i < l.size(); i++) {
+				CvbADU a;
+				a.send_wait_ = l[i]->get_send_wait();
+				a.recv_wait_ = l[i]->get_recv_wait();
+				a.size_ = l[i]->get_size();
+				a.acc_ = dir;
+				adus.push_back(a);
+			}
+		}
+		cvhdr_.init_count_ = cv->get_init_ADU_count();
+		cvhdr_.acc_count_ = cv->get_acc_ADU_count();
+		cvhdr_.nadu_ = adus.size();
+		if (last_dir_ == ACCEPTOR)
+			cvhdr_.flags_ |= CVB_LAST_ACC;
+		w.add(cvhdr_, adus.empty() ? NULL : &adus[0]);
+		delete cv;
+		n++;
+	}
+	if (w.close() < 0) {
+		fprintf (stderr, "Tmix: error writing %s\n", fn);
+		return (-1);
+	}
+	return (n);
+}
+
 #define A	0
 #define B	1
 #define TA	2
@@ -606,7 +827,6 @@ ConnVector* Tmix::read_one_cvec_v1() {
 	int global_id;
 
 	int int_junk;     /* Stores temporary integer input */
-	float float_junk; /* Stores temporary float input */
 		
 	int last_state = TB;   /* A, B, TA, or TB */
 
@@ -645,6 +865,7 @@ ConnVector* Tmix::read_one_cvec_v1() {
 			cv = new ConnVector(global_id, 
 					    (double)start_time/1000000.0, SEQ, 
 					    pkt_size_);
+			cvhdr_begin(cvhdr_, global_id, start_time, SEQ);
 		}
 		/*CONC connection vector construction*/
 		else if(line[0] == 'C'){
@@ -660,6 +881,7 @@ ConnVector* Tmix::read_one_cvec_v1() {
 					    (double)start_time/1000000.0, CONC,
 					    init_ADU_count, acc_ADU_count, 
 					    pkt_size_);
+			cvhdr_begin(cvhdr_, global_id, start_time, CONC);
 		}		  
 		/*Maximum Segment Size*/
 		else if (line[0] == 'm') {
@@ -669,16 +891,7 @@ ConnVector* Tmix::read_one_cvec_v1() {
 				parse_error=true;
 				break;
 			}
-			/* set the mss to the greater value for Full TCP*/
-			if (agentType_ == FULL) {
-				cv->set_mss(max(init_mss,acc_mss));
-			}
-			/* set the initiator mss and acceptor mss 
-			   for one-way TCP*/ 
-			else{
-				cv->set_init_mss(init_mss);
-				cv->set_acc_mss(acc_mss);
-			}
+			set_mss(cv, init_mss, acc_mss);
 		}
 		/*Window size*/
 		else if(line[0] == 'w'){ 
@@ -690,6 +903,7 @@ ConnVector* Tmix::read_one_cvec_v1() {
 			}
 			cv->set_init_win(init_win);
 			cv->set_acc_win(acc_win);
+			cvhdr_win(cvhdr_, init_win, acc_win);
 		}
 		/*Per flow delay*/
 		else if(line[0] == 'r'){ 
@@ -699,15 +913,18 @@ ConnVector* Tmix::read_one_cvec_v1() {
 				parse_error=true;
 				break;
 			}
+			cvhdr_.rtt_ = int_junk;
+			cvhdr_.flags_ |= CVB_RTT;
 		}
 		/*Per flow loss*/
 		else if(line[0] == 'l'){ 
-			if(sscanf(line, "l %f %f", &(float_junk), 
-				  &(float_junk)) != 2){
+			if(sscanf(line, "l %f %f", &(cvhdr_.fwdloss_), 
+				  &(cvhdr_.revloss_)) != 2){
 				fprintf(stderr, "Parse error on: %s\n", line);
 				parse_error=true;
 				break;
 			}
+			cvhdr_.flags_ |= CVB_LOSS;
 		}
 		/*Process ADU lines*/
 		else{
@@ -919,12 +1136,8 @@ ConnVector* Tmix::read_one_cvec_v1() {
 		last_direction = ACCEPTOR;
 	}
 
-	/* Was the last ADU a FIN?  If not, we need to add one */
-	if (adu->get_size() != 0) {
-		adu = (ADU*) new ADU (fin_time_, 0, 0);
-		cv->add_ADU (adu, last_direction);
-	}
-
+	/* read_one_cvec() adds a FIN if the last ADU is not one */
+	last_dir_ = last_direction;
 	return cv;
 }
 
@@ -969,6 +1182,7 @@ Tmix::read_one_cvec_v2()
  							   (double) 
 							   start/1000000.0, 
 							   SEQ, pkt_size_); 
+			cvhdr_begin(cvhdr_, id, start, SEQ);
 		}
 		else if (sym == 'C') {
 			/* start of new CONC connection vector */
@@ -979,22 +1193,30 @@ Tmix::read_one_cvec_v2()
 							   start/1000000.0, 
 							   CONC, numinit, 
 							   numacc, pkt_size_); 
+			cvhdr_begin(cvhdr_, id, start, CONC);
 		}
 		else if (sym == 'm') {
 			/* maximum segment size */
 			fscanf (cvfp_, "%c %d %d\n", &sym, &init_mss, &acc_mss);
-			if (agentType_ == FULL) {
-				cv->set_mss(max(init_mss,acc_mss));
-			} else {
-				cv->set_init_mss(init_mss);
-				cv->set_acc_mss(acc_mss);
-			}
+			set_mss(cv, init_mss, acc_mss);
 		}
 		else if (sym == 'w') {
 			/* window size */
 			fscanf (cvfp_, "%c %d %d\n", &sym, &initwin, &accwin);
 			cv->set_init_win (initwin);
 			cv->set_acc_win (accwin);
+			cvhdr_win(cvhdr_, initwin, accwin);
+		}
+		else if (sym == 'r') {
+			/* round-trip time, for Tmix_DelayBox */
+			fscanf (cvfp_, "%c %u\n", &sym, &cvhdr_.rtt_);
+			cvhdr_.flags_ |= CVB_RTT;
+		}
+		else if (sym == 'l') {
+			/* loss rates, for Tmix_DelayBox */
+			fscanf (cvfp_, "%c %f %f\n", &sym, &cvhdr_.fwdloss_,
+				&cvhdr_.revloss_);
+			cvhdr_.flags_ |= CVB_LOSS;
 		}
 		else if (sym == 'I') {
 			/* new initiator ADU */
@@ -1024,12 +1246,8 @@ Tmix::read_one_cvec_v2()
 		}
 	}
 
-	/* Was the last ADU a FIN?  If not, we need to add one */
-	if (adu->get_size() != 0) {
-		adu = (ADU*) new ADU (fin_time_, 0, 0);
-		cv->add_ADU (adu, last_direction);
-		adu = NULL;
-	}
+	/* read_one_cvec() adds a FIN if the last ADU is not one */
+	last_dir_ = last_direction;
 
 	/* return the cv ptr */
 	return cv;
@@ -1049,7 +1267,7 @@ void Tmix::start()
 	/* read from the connection vector file */
 	ConnVector* cv;
 	int i=0;
-	while (!feof (cvfp_) && i < (int) step_size_) {
+	while (!cvec_eof() && i < (int) step_size_) {
 		/* read in step_size_ ConnVectors and add to list */
 		cv = read_one_cvec();
 		if (cv != NULL) {
@@ -1157,6 +1375,11 @@ int Tmix::command(int argc, const char*const* argv) {
 				return (TCL_ERROR);
 		}
 		else if (strcmp (argv[1], "set-cvfile") == 0) {  
+			if (CvbReader::probe (argv[2])) {
+				cvbin_ = new CvbReader;
+				return (cvbin_->open (argv[2]) == 0 ?
+					TCL_OK : TCL_ERROR);
+			}
 			cvfp_ = fopen (argv[2], "r");
 			cvfn_ = argv[2];
 			if (cvfp_)
@@ -1164,6 +1387,23 @@ int Tmix::command(int argc, const char*const* argv) {
 			else 
 				return (TCL_ERROR);
 		}
+		else if (strcmp (argv[1], "write-cvbin") == 0) {
+			int n = write_cvbin (argv[2]);
+			if (n < 0)
+				return (TCL_ERROR);
+			Tcl::instance().resultf ("%d", n);
+			return (TCL_OK);
+		}
+		else if (strcmp (argv[1], "set-cvstart") == 0) {
+			/* skip connections that start before argv[2] s */
+			if (cvbin_ == NULL || cvbin_->seek ((u_int64_t) 
+			    (atof (argv[2]) * 1000000.0 + 0.5)) < 0) {
+				Tcl::instance().result ("set-cvstart needs a "
+					"binary cvec file in start order");
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
 		else if (strcmp (argv[1], "set-ID") == 0) {
 			ID_ = (int) atoi (argv[2]);
 			return (TCL_OK);
@@ -1239,6 +1479,14 @@ int Tmix::command(int argc, const char*const* argv) {
 			Agent* tcp = (Agent*) lookup_obj(argv[2]);
 			return crecycle(tcp);
 		}
+		else if (strcmp (argv[1], "set-fast-setup") == 0) {
+			fast_setup_ = atoi (argv[2]) != 0;
+			return (TCL_OK);
+		}
+		else if (strcmp (argv[1], "prewarm") == 0) {
+			prewarm (atoi (argv[2]));
+			return (TCL_OK);
+		}
 	}
 	return TclObject::command(argc, argv);
 }
@@ -50,6 +50,9 @@
 #include "timer-handler.h"
 #include "app.h"
 #include "node.h"
+#include "tcp-full.h"
+#include "conn-pool.h"
+#include "tmix_cvbin.h"
 #include <string>
 #include <stack>
 #include <queue>
@@ -68,6 +71,7 @@
 #define CVEC_LINE_MAX 100
 #define CV_V1 1
 #define CV_V2 2
+#define ADU_CHUNK 1024
 
 class FullTcpAgent;
 class Tmix;
@@ -97,9 +101,15 @@ public:
 		return recv_wait_ / 1000000.0;   /* in seconds */
 	}
 	inline unsigned long get_size() {return size_;}
+	inline unsigned long get_send_wait() {return send_wait_;}
+	inline unsigned long get_recv_wait() {return recv_wait_;}
 	
 	void print();
 
+	/* from a free list, carved ADU_CHUNK at a time */
+	void* operator new(size_t);
+	void operator delete(void*);
+
 private:
 	/* time (in usec) to wait after sending last ADU */
 	unsigned long send_wait_;  
@@ -144,8 +154,8 @@ public:
 	inline bool get_type() {return type_;}
 	inline int get_init_ADU_count() {return init_ADU_count_;}
 	inline int get_acc_ADU_count() {return acc_ADU_count_;}
-	inline vector<ADU*> get_init_ADU() {return init_ADU_;}
-	inline vector<ADU*> get_acc_ADU() {return acc_ADU_;}
+	inline const vector<ADU*>& get_init_ADU() {return init_ADU_;}
+	inline const vector<ADU*>& get_acc_ADU() {return acc_ADU_;}
 	inline vector<ADU*>::iterator get_init_ADU_end() 
 	{return init_ADU_.end();}
 	inline vector<ADU*>::iterator get_acc_ADU_end() 
@@ -290,13 +300,14 @@ protected:
 
 /*::::::::::::::::::::::::: TMIX class :::::::::::::::::::::::::::::::::*/
 
-class Tmix : public TclObject {
+class Tmix : public TclObject, public FullTcpDone {
 public:
 	Tmix();
 	~Tmix();
 
 	void recycle (TmixApp*);
 	int crecycle(Agent* tcp);
+	void tcpdone(FullTcpAgent* tcp) { crecycle(tcp); }
 	void stop();
 	void setup_connection();
   
@@ -329,6 +340,7 @@ public:
 
 	inline int getAgentType() { return agentType_; }
 	inline bool check_oneway_closed() { return check_oneway_closed_; }
+	inline bool fast_setup() { return fast_setup_ && agentType_ == FULL; }
 
 protected:
 	virtual int command (int argc, const char*const* argv);
@@ -336,11 +348,20 @@ protected:
 	void recycle (TmixAgent*);
 
 	ConnVector* read_one_cvec();
+	ConnVector* parse_one_cvec();
 	ConnVector* read_one_cvec_v1();
 	ConnVector* read_one_cvec_v2();
+	ConnVector* read_one_cvec_bin();
+	void add_fin(ConnVector* cv);
+	void set_mss(ConnVector* cv, int init_mss, int acc_mss);
+	inline bool cvec_eof() {
+		return (cvbin_ != NULL ? cvbin_->eof() : feof (cvfp_));
+	}
+	int write_cvbin(const char* fn);
 
-	TmixAgent* picktcp();
+	TmixAgent* picktcp(Node* node);
 	TmixApp* pickApp();	
+	void prewarm(int n);
 
 	TmixTimer timer_;
 
@@ -359,6 +380,10 @@ protected:
 	char sinktype_[20];        /* {DelAck, Sack1, ...} */
 	FILE* outfp_;
 	FILE* cvfp_;               /* connection vector file pointer */
+	CvbReader* cvbin_;         /* or the binary file being read */
+	int cv_file_type_;         /* CV_V1 or CV_V2, 0 until known */
+	CvbConn cvhdr_;            /* the lines of the cvec just parsed */
+	bool last_dir_;            /* and whose ADU came last */
 	int ID_;                   /* tmix cloud ID */
 	int run_;                  /* run number (for RNG stream selection) */
 	int debug_;
@@ -402,6 +427,9 @@ protected:
 
 	bool check_oneway_closed_; /* check to see if final ACK has returned
 				      before recycling the one-way TCP agent */
+
+	bool fast_setup_;          /* set up Full-TCP connections in C++,
+				      with agents pooled by node */
 	
 	TclObject* lookup_obj(const char* name) {
 		TclObject* obj = Tcl::instance().lookup(name);
@@ -413,6 +441,7 @@ protected:
 	/* Agent and App Pools */
 	queue<TmixAgent*> tcpPool_;
 	queue<TmixApp*> appPool_;
+	ConnPool<TmixAgent*> nodePool_;   /* tcpPool_ with fast_setup_ */
 
 	/* string = tcpAgent's name */
 	map<string, TmixApp*> appActive_;
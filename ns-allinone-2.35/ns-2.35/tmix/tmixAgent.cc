@@ -129,13 +129,24 @@ void TmixFullAgent::reset() {
 
 void TmixFullAgent::attachToNode(Node * node) {
   Tcl& tcl = Tcl::instance();
-	
+
+  // with fast setup, an agent stays on its node from one connection
+  // to the next
+  if (tmix->fast_setup() && node == node_)
+    return;
   tcl.evalf ("%s attach %s", node->name(), 
 	     name());
+  node_ = node;
 }
 	
 void TmixFullAgent::configureTcp(Tmix* tmixInstance, int window, int mss) {
   Tcl& tcl = Tcl::instance();
+
+  if (tmixInstance->fast_setup()) {
+    ((FullTcpAgent*) agent)->setup(tmixInstance->get_total(), window, mss,
+				   tmixInstance);
+    return;
+  }
 		
   // note that for fulltcp init_mss == acc_mss
   tcl.evalf ("%s setup-tcp %s %d %d %d", tmixInstance->name(), agent->name(), 
@@ -144,6 +155,15 @@ void TmixFullAgent::configureTcp(Tmix* tmixInstance, int window, int mss) {
 
 void TmixFullAgent::connect(TmixAgent * peer) {
   Tcl& tcl = Tcl::instance();
+
+  if (tmix->fast_setup()) {
+    // what "$ns connect" does
+    agent->daddr() = peer->addr();
+    agent->dport() = peer->port();
+    peer->getAgent()->daddr() = addr();
+    peer->getAgent()->dport() = port();
+    return;
+  }
 	
   tcl.evalf ("set ns [Simulator instance]");
   tcl.evalf ("$ns connect %s %s", name(), peer->name());
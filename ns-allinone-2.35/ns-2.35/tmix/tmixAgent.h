@@ -50,12 +50,13 @@
 class Tmix;
 class TmixAgent : public TclObject {
 public:
-  TmixAgent(Tmix * t) : TclObject(), agent(NULL), tmix(t) {}
+  TmixAgent(Tmix * t) : TclObject(), agent(NULL), node_(NULL), tmix(t) {}
   inline const char* name() { return agent->name(); }
   inline void sendmsg(int bytes) { agent->sendmsg(bytes); agent->clr_closed(); }
   inline nsaddr_t& port() { return agent->port(); }
   inline nsaddr_t& addr() { return agent->addr(); }
   inline Agent* getAgent() { return agent; }
+  inline Node* getNode() { return node_; }
   inline int getType() { return type; }
   inline int is_closed() { return agent->is_closed(); }
   inline double getTimeInPool(double now) {return (now - time_entered_pool);}
@@ -80,6 +81,7 @@ public:
 
 protected:
   Agent* agent;
+  Node* node_;                 /* node attached to, with fast setup */
   int type;
   double time_entered_pool;    /* time agent entered pool - to ensure agents
 				  aren't re-used until they've been in pool
@@ -0,0 +1,232 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * tmix_cvbin.cc
+ *
+ * Binary connection vector files for Tmix; see tmix_cvbin.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "tmix_cvbin.h"
+
+CvbReader::CvbReader() : base_(NULL), len_(0), end_(0), hdr_(NULL), off_(0),
+	next_(0), dropped_(0)
+{
+}
+
+CvbReader::~CvbReader()
+{
+	if (base_ == NULL)
+		return;
+#ifndef WIN32
+	munmap(base_, len_);
+#else
+	free(base_);
+#endif
+}
+
+int CvbReader::probe(const char* fn)
+{
+	char magic[8];
+	FILE* fp = fopen(fn, "rb");
+	if (fp == NULL)
+		return (0);
+	int n = fread(magic, 1, sizeof(magic), fp);
+	fclose(fp);
+	return (n == sizeof(magic) && memcmp(magic, CVB_MAGIC, 8) == 0);
+}
+
+int CvbReader::open(const char* fn)
+{
+#ifndef WIN32
+	int fd = ::open(fn, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "Tmix: %s: %s\n", fn, strerror(errno));
+		if (fd >= 0)
+			::close(fd);
+		return (-1);
+	}
+	len_ = st.st_size;
+	void* p = len_ > 0 ? mmap(0, len_, PROT_READ, MAP_SHARED, fd, 0) :
+		MAP_FAILED;
+	::close(fd);
+	if (p == MAP_FAILED) {
+		fprintf(stderr, "Tmix: cannot map %s\n", fn);
+		return (-1);
+	}
+	base_ = (char*) p;
+	/* read once, front to back */
+	madvise(base_, len_, MADV_SEQUENTIAL);
+#else
+	FILE* fp = fopen(fn, "rb");
+	if (fp == NULL) {
+		fprintf(stderr, "Tmix: %s: %s\n", fn, strerror(errno));
+		return (-1);
+	}
+	fseek(fp, 0, SEEK_END);
+	len_ = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	base_ = (char*) malloc(len_);
+	if (base_ == NULL || fread(base_, 1, len_, fp) != len_) {
+		fprintf(stderr, "Tmix: cannot read %s\n", fn);
+		fclose(fp);
+		return (-1);
+	}
+	fclose(fp);
+#endif
+	hdr_ = (const CvbHeader*) base_;
+	if (len_ < sizeof(CvbHeader) || memcmp(hdr_->magic_, CVB_MAGIC, 8)) {
+		fprintf(stderr, "Tmix: %s is not a binary cvec file\n", fn);
+		return (-1);
+	}
+	if (hdr_->order_ != CVB_ORDER) {
+		fprintf(stderr, "Tmix: %s was written on a host of the "
+			"other byte order\n", fn);
+		return (-1);
+	}
+	/* the records are checked as they are read, see conn() */
+	if (hdr_->index_off_ < sizeof(CvbHeader) || hdr_->index_off_ > len_ ||
+	    hdr_->index_n_ > (len_ - hdr_->index_off_) / sizeof(CvbIndex) ||
+	    hdr_->nconn_ > (hdr_->index_off_ - sizeof(CvbHeader)) /
+	    sizeof(CvbConn)) {
+		fprintf(stderr, "Tmix: %s is truncated or corrupt\n", fn);
+		return (-1);
+	}
+	end_ = hdr_->index_off_;
+	off_ = sizeof(CvbHeader);
+	next_ = 0;
+	return (0);
+}
+
+/* connection next_ is not all there: end the file before it */
+void CvbReader::corrupt()
+{
+	fprintf(stderr, "Tmix: binary cvec file corrupt at connection %lu "
+		"of %lu, stopping there\n", (unsigned long) next_,
+		(unsigned long) hdr_->nconn_);
+	next_ = hdr_->nconn_;
+}
+
+/* the connections before off_ have been read; drop their pages */
+void CvbReader::drop()
+{
+#ifndef WIN32
+	size_t page = getpagesize();
+	size_t end = off_ / page * page;
+	if (end > dropped_)
+		madvise(base_ + dropped_, end - dropped_, MADV_DONTNEED);
+	dropped_ = end;
+#else
+	dropped_ = off_;
+#endif
+}
+
+int CvbReader::seek(u_int64_t start)
+{
+	if (!hdr_->sorted_)
+		return (-1);
+	const CvbIndex* index = (const CvbIndex*) (base_ + hdr_->index_off_);
+	/* the last indexed connection starting before start */
+	int lo = 0, hi = hdr_->index_n_;
+	while (hi - lo > 1) {
+		int mid = (lo + hi) / 2;
+		if (index[mid].start_ < start)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	off_ = sizeof(CvbHeader);
+	next_ = 0;
+	dropped_ = 0;
+	if (hdr_->index_n_ > 0 && index[lo].start_ < start) {
+		if ((u_int64_t) lo * CVB_INDEX_EVERY >= hdr_->nconn_ ||
+		    conn(index[lo].off_) == NULL) {
+			fprintf(stderr, "Tmix: binary cvec index entry %d is "
+				"corrupt\n", lo);
+			return (-1);
+		}
+		off_ = index[lo].off_;
+		next_ = (u_int64_t) lo * CVB_INDEX_EVERY;
+	}
+	while (!eof()) {
+		const CvbConn* c = conn(off_);
+		if (c == NULL) {
+			corrupt();
+			break;
+		}
+		if (c->start_ >= start)
+			break;
+		next();
+	}
+	return (0);
+}
+
+CvbWriter::CvbWriter() : fp_(NULL), off_(0), last_(0)
+{
+	memset(&hdr_, 0, sizeof(hdr_));
+}
+
+CvbWriter::~CvbWriter()
+{
+	if (fp_ != NULL)
+		fclose(fp_);
+}
+
+int CvbWriter::open(const char* fn)
+{
+	fp_ = fopen(fn, "wb");
+	if (fp_ == NULL) {
+		fprintf(stderr, "Tmix: %s: %s\n", fn, strerror(errno));
+		return (-1);
+	}
+	memcpy(hdr_.magic_, CVB_MAGIC, 8);
+	hdr_.order_ = CVB_ORDER;
+	hdr_.sorted_ = 1;
+	/* the header is written again by close() */
+	fwrite(&hdr_, sizeof(hdr_), 1, fp_);
+	off_ = sizeof(hdr_);
+	return (0);
+}
+
+void CvbWriter::add(const CvbConn& c, const CvbADU* adus)
+{
+	if (hdr_.nconn_ % CVB_INDEX_EVERY == 0) {
+		CvbIndex e;
+		e.start_ = c.start_;
+		e.off_ = off_;
+		index_.push_back(e);
+	}
+	if (hdr_.nconn_ > 0 && c.start_ < last_)
+		hdr_.sorted_ = 0;
+	last_ = c.start_;
+	fwrite(&c, sizeof(c), 1, fp_);
+	if (c.nadu_ > 0)
+		fwrite(adus, sizeof(CvbADU), c.nadu_, fp_);
+	off_ += sizeof(c) + c.nadu_ * sizeof(CvbADU);
+	hdr_.nconn_++;
+	hdr_.nadu_ += c.nadu_;
+}
+
+int CvbWriter::close()
+{
+	hdr_.index_off_ = off_;
+	hdr_.index_n_ = index_.size();
+	if (!index_.empty())
+		fwrite(&index_[0], sizeof(CvbIndex), index_.size(), fp_);
+	fseek(fp_, 0, SEEK_SET);
+	fwrite(&hdr_, sizeof(hdr_), 1, fp_);
+	int err = ferror(fp_);
+	if (fclose(fp_) != 0)
+		err = 1;
+	fp_ = NULL;
+	return (err ? -1 : 0);
+}
@@ -0,0 +1,152 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * tmix_cvbin.h
+ *
+ * Binary connection vector files for Tmix.
+ *
+ * A text cvec file (either format, original or cvec-orig2alt.pl
+ * output) is parsed once and written as fixed-size records, so that a
+ * run maps the file and builds each ConnVector without scanning text:
+ *
+ *	set tmix [new Tmix]
+ *	$tmix set-cvfile trace.cvec
+ *	$tmix write-cvbin trace.cvb	;# see tcl/ex/tmix/cvec2bin.tcl
+ *	...
+ *	$tmix set-cvfile trace.cvb	;# either kind of file
+ *
+ * The file is a CvbHeader, one CvbConn per connection vector followed
+ * by its CvbADUs, and at index_off_ one CvbIndex entry for every
+ * CVB_INDEX_EVERY connections, by which "$tmix set-cvstart" finds the
+ * first connection starting at a given time.  The file is mapped and
+ * the pages already read are given back as the reader goes, so a run
+ * holds only the connections it has started.  The lines of the text
+ * file are kept as they were read (windows in bytes, m before or after
+ * w, no FIN added), so the ConnVectors are the same as from the text,
+ * whatever the agent type, packet size and FIN time of the run.  The
+ * records are in host byte order.
+ */
+
+#ifndef ns_tmix_cvbin_h
+#define ns_tmix_cvbin_h
+
+#include <stdio.h>
+#include <vector>
+#include "config.h"
+
+#define CVB_MAGIC	"TMIXCVB1"
+#define CVB_ORDER	0x01020304
+#define CVB_INDEX_EVERY	1024
+#define CVB_DROP	(4 << 20)	/* bytes read before unmapping them */
+
+/* CvbConn flags_: the lines the cvec had */
+#define CVB_MSS		0x01	/* m */
+#define CVB_WIN		0x02	/* w */
+#define CVB_WIN_FIRST	0x04	/* w came before m */
+#define CVB_RTT		0x08	/* r */
+#define CVB_LOSS	0x10	/* l */
+#define CVB_LAST_ACC	0x20	/* last ADU was the acceptor's */
+#define CVB_CONC	0x40	/* CONC, else SEQ */
+
+struct CvbHeader {
+	char magic_[8];
+	u_int32_t order_;	/* CVB_ORDER as written */
+	u_int32_t index_n_;
+	u_int64_t nconn_;
+	u_int64_t nadu_;
+	u_int64_t index_off_;
+	u_int32_t sorted_;	/* start times never decrease */
+	u_int32_t pad_;
+};
+
+struct CvbConn {
+	u_int64_t id_;
+	u_int64_t start_;	/* usec */
+	int32_t init_mss_, acc_mss_;
+	int32_t init_win_, acc_win_;	/* bytes */
+	int32_t init_count_, acc_count_;
+	u_int32_t rtt_;		/* usec */
+	float fwdloss_, revloss_;
+	u_int32_t nadu_;
+	u_int32_t flags_;
+	u_int32_t pad_;
+};
+
+struct CvbADU {
+	u_int64_t send_wait_;	/* usec */
+	u_int64_t recv_wait_;
+	u_int32_t size_;
+	u_int32_t acc_;		/* acceptor's, else initiator's */
+};
+
+struct CvbIndex {
+	u_int64_t start_;
+	u_int64_t off_;
+};
+
+/* reads a file by mapping it */
+class CvbReader {
+public:
+	CvbReader();
+	~CvbReader();
+	static int probe(const char* fn);	/* 1 if a binary cvec file */
+	int open(const char* fn);		/* 0, or -1 and a message */
+	inline int eof() { return (next_ >= hdr_->nconn_); }
+	/* the next connection, its ADUs following it; NULL at the end */
+	const CvbConn* next() {
+		if (eof())
+			return (NULL);
+		if (off_ - dropped_ >= CVB_DROP)
+			drop();
+		const CvbConn* c = conn(off_);
+		if (c == NULL) {
+			corrupt();
+			return (NULL);
+		}
+		off_ += sizeof(CvbConn) + c->nadu_ * sizeof(CvbADU);
+		next_++;
+		return (c);
+	}
+	static inline const CvbADU* adus(const CvbConn* c) {
+		return ((const CvbADU*) (c + 1));
+	}
+	int seek(u_int64_t start);	/* to the first starting at start */
+	inline u_int64_t count() { return (hdr_->nconn_); }
+protected:
+	void drop();
+	void corrupt();
+	/* the connection at off, or NULL if it runs past the records */
+	inline const CvbConn* conn(size_t off) {
+		if (off < sizeof(CvbHeader) || off > end_ || (off & 7) ||
+		    end_ - off < sizeof(CvbConn))
+			return (NULL);
+		const CvbConn* c = (const CvbConn*) (base_ + off);
+		if ((end_ - off - sizeof(CvbConn)) / sizeof(CvbADU) < c->nadu_)
+			return (NULL);
+		return (c);
+	}
+
+	char* base_;
+	size_t len_;
+	size_t end_;		/* of the connections, where the index is */
+	const CvbHeader* hdr_;
+	size_t off_;		/* of connection next_ */
+	u_int64_t next_;
+	size_t dropped_;	/* pages before this given back */
+};
+
+class CvbWriter {
+public:
+	CvbWriter();
+	~CvbWriter();
+	int open(const char* fn);
+	void add(const CvbConn& c, const CvbADU* adus);
+	int close();
+protected:
+	FILE* fp_;
+	CvbHeader hdr_;
+	u_int64_t off_;
+	u_int64_t last_;	/* start of the last connection */
+	std::vector<CvbIndex> index_;
+};
+
+#endif
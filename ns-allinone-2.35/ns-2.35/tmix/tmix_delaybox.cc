@@ -70,6 +70,11 @@ int Tmix_DelayBoxNode::command(int argc, const char*const* argv) {
 			return (TCL_OK);
 		}
 		else if (!strcmp(argv[1],"set-cvfile")) {
+			if (CvbReader::probe (argv[2])) {
+				return (classifier_->create_flow_table_bin
+					(argv[3], argv[4], argv[2]) == 0 ?
+					TCL_OK : TCL_ERROR);
+			}
 			cvecfp_ = fopen (argv[2], "r");
 			if (cvecfp_) {
 				classifier_->create_flow_table(argv[3], argv[4], cvecfp_);
@@ -149,13 +154,8 @@ void Tmix_DelayBoxClassifier::create_flow_table (const char* src,
     char cvec[100];
     int fid = 0;
     unsigned long us_delay;
-    double delay, fwdloss, revloss, linkspd; 
-    DelayBoxPair* pair;
-    DelayBoxQueue* q;
-    DelayBoxTimer* timer;
-    DelayBoxFlow* flow;
+    double delay, fwdloss, revloss;
 
-    linkspd = 0;
     while(!feof(fp)) {
 	    memset(cvec,'\0',100);
 	    fgets (cvec, 100, fp);
@@ -180,24 +180,62 @@ void Tmix_DelayBoxClassifier::create_flow_table (const char* src,
 
 		    /* lossrate is final thing tmix_delaybox needs, so
 		       create new flows */
-		    pair = new DelayBoxPair(atoi(src), atoi(dst), fid);
-		    q = new DelayBoxQueue();
-		    timer = new DelayBoxTimer(this, atoi(src), atoi(dst), fid);
-		    flow = new DelayBoxFlow(delay/2, fwdloss, linkspd, q,timer);
-		    flows_[*pair] = flow;
-		    delete pair;
-
-		    pair = new DelayBoxPair(atoi(dst), atoi(src), fid);
-		    q = new DelayBoxQueue();
-		    timer = new DelayBoxTimer(this, atoi(dst), atoi(src), fid);
-		    flow = new DelayBoxFlow(delay/2, revloss, linkspd, q,timer);
-		    flows_[*pair] = flow;
-		    delete pair;
+		    add_flows (src, dst, fid, delay, fwdloss, revloss);
 	    }
     }
     fclose (fp);
 }
 
+/* the same from a binary cvec file (see tmix_cvbin.h) */
+int Tmix_DelayBoxClassifier::create_flow_table_bin (const char* src, 
+						    const char* dst,
+						    const char* fn)
+{
+	CvbReader cvb;
+	int fid = 0;
+	double delay = 0;
+
+	if (cvb.open(fn) < 0)
+		return (-1);
+	while (!cvb.eof()) {
+		const CvbConn* c = cvb.next();
+		if (c == NULL)
+			return (-1);
+		fid++;
+		if (c->flags_ & CVB_RTT)
+			delay = (double) c->rtt_ / 1000000;
+		if (c->flags_ & CVB_LOSS)
+			add_flows (src, dst, fid, delay, c->fwdloss_, 
+				   c->revloss_);
+	}
+	return (0);
+}
+
+void Tmix_DelayBoxClassifier::add_flows (const char* src, const char* dst,
+					 int fid, double delay, 
+					 double fwdloss, double revloss)
+{
+	double linkspd = 0;
+	DelayBoxPair* pair;
+	DelayBoxQueue* q;
+	DelayBoxTimer* timer;
+	DelayBoxFlow* flow;
+
+	pair = new DelayBoxPair(atoi(src), atoi(dst), fid);
+	q = new DelayBoxQueue();
+	timer = new DelayBoxTimer(this, atoi(src), atoi(dst), fid);
+	flow = new DelayBoxFlow(delay/2, fwdloss, linkspd, q,timer);
+	flows_[*pair] = flow;
+	delete pair;
+
+	pair = new DelayBoxPair(atoi(dst), atoi(src), fid);
+	q = new DelayBoxQueue();
+	timer = new DelayBoxTimer(this, atoi(dst), atoi(src), fid);
+	flow = new DelayBoxFlow(delay/2, revloss, linkspd, q,timer);
+	flows_[*pair] = flow;
+	delete pair;
+}
+
 void Tmix_DelayBoxClassifier::recv (Packet* p, Handler* )
 {
 	DelayBoxFlow* flow;
@@ -37,6 +37,7 @@
  */
 
 #include "delaybox/delaybox.h"  // uses some DelayBox structures and functions
+#include "tmix_cvbin.h"
 
 class Tmix_DelayBoxClassifier;
 
@@ -51,9 +52,13 @@ public:
 	~Tmix_DelayBoxClassifier();
 	inline void set_lossless () {lossless_ = true;}
         void create_flow_table(const char* src, const char* dst, FILE* fp);
+	int create_flow_table_bin(const char* src, const char* dst, 
+				  const char* fn);
 
 protected:
 	virtual void recv(Packet *p, Handler *h);
+	void add_flows(const char* src, const char* dst, int fid, 
+		       double delay, double fwdloss, double revloss);
 	bool lossless_;
 };
 
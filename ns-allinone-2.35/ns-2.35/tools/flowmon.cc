@@ -44,6 +44,7 @@ static const char rcsid[] =
 //
 
 #include "flowmon.h"
+#include "tcp.h"
 
 void TaggerTSWFlow::tagging(Packet *pkt)
 {
@@ -253,9 +254,11 @@ Tagger::command(int argc, const char*const* argv)
  * ####################################
  */
 
-FlowMon::FlowMon() : classifier_(NULL), channel_(NULL),
-	enable_in_(1), enable_out_(1), enable_drop_(1), enable_edrop_(1), enable_mon_edrop_(1)
+FlowMon::FlowMon() : classifier_(NULL), flows_(NULL), channel_(NULL),
+	enable_in_(1), enable_out_(1), enable_drop_(1), enable_edrop_(1), enable_mon_edrop_(1),
+	snapch_(NULL), snaptimer_(this)
 {
+	bind_time("snapshot_interval_", &snapint_);
 	bind_bool("enable_in_", &enable_in_);
 	bind_bool("enable_out_", &enable_out_);
 	bind_bool("enable_drop_", &enable_drop_);
@@ -270,6 +273,13 @@ FlowMon::in(Packet *p)
 	EDQueueMonitor::in(p);
 	if (!enable_in_)
 		return;
+	if (flows_) {
+		FlowTable& t = flows_->table();
+		int k = flows_->flow(p);
+		t.parrivals_[k]++;
+		t.barrivals_[k] += hdr_cmn::access(p)->size();
+		return;
+	}
 	if ((desc = ((Flow *)classifier_->find(p))) != NULL) {
 		desc->setfields(p);
 		desc->in(p);
@@ -283,6 +293,21 @@ FlowMon::out(Packet *p)
 	EDQueueMonitor::out(p);
 	if (!enable_out_)
 		return;
+	if (flows_) {
+		FlowTable& t = flows_->table();
+		int k = flows_->flow(p);
+		hdr_cmn* ch = hdr_cmn::access(p);
+		t.pdepartures_[k]++;
+		t.bdepartures_[k] += ch->size();
+		if (ch->ptype() == PT_TCP) {
+			int rtt = hdr_tcp::access(p)->last_rtt();
+			if (rtt > 0) {
+				t.rttsum_[k] += rtt;
+				t.rttn_[k]++;
+			}
+		}
+		return;
+	}
 	if ((desc = ((Flow*)classifier_->find(p))) != NULL) {
 		desc->setfields(p);
 		desc->out(p);
@@ -296,6 +321,13 @@ FlowMon::drop(Packet *p)
 	EDQueueMonitor::drop(p);
 	if (!enable_drop_)
 		return;
+	if (flows_) {
+		FlowTable& t = flows_->table();
+		int k = flows_->flow(p);
+		t.pdrops_[k]++;
+		t.bdrops_[k] += hdr_cmn::access(p)->size();
+		return;
+	}
 	if ((desc = ((Flow*)classifier_->find(p))) != NULL) {
 		desc->setfields(p);
 		desc->drop(p);
@@ -309,6 +341,16 @@ FlowMon::edrop(Packet *p)
 	EDQueueMonitor::edrop(p);
 	if (!enable_edrop_)
 		return;
+	if (flows_) {
+		FlowTable& t = flows_->table();
+		int k = flows_->flow(p);
+		int size = hdr_cmn::access(p)->size();
+		t.epdrops_[k]++;
+		t.ebdrops_[k] += size;
+		t.pdrops_[k]++;
+		t.bdrops_[k] += size;
+		return;
+	}
 	if ((desc = ((Flow*)classifier_->find(p))) != NULL) {
 		desc->setfields(p);
 		desc->edrop(p);
@@ -323,6 +365,13 @@ FlowMon::mon_edrop(Packet *p)
 	EDQueueMonitor::mon_edrop(p);
 	if (!enable_mon_edrop_)
 		return;
+	if (flows_) {
+		FlowTable& t = flows_->table();
+		int k = flows_->flow(p);
+		t.pdrops_[k]++;
+		t.bdrops_[k] += hdr_cmn::access(p)->size();
+		return;
+	}
 	if ((desc = ((Flow*)classifier_->find(p))) != NULL) {
 		desc->setfields(p);
 		desc->mon_edrop(p);
@@ -335,6 +384,17 @@ FlowMon::dumpflows()
 	register int i, j = classifier_->maxslot();
 	Flow* f;
 
+	if (flows_) {
+		for (i = 0; i < flows_->table().size(); i++) {
+			fformat(flows_->table(), i);
+			if (channel_ != 0) {
+				int n = strlen(wrk_);
+				wrk_[n++] = '\n';
+				(void)Tcl_Write(channel_, wrk_, n);
+			}
+		}
+		return;
+	}
 	for (i = 0; i <= j; i++) {
 		if ((f = (Flow*)classifier_->slot(i)) != NULL)
 			dumpflow(channel_, f);
@@ -406,6 +466,23 @@ FlowMon::fformat(Flow* f)
 	);
 }
 
+/* the same line for flow k of a Classifier/Hash/Flow */
+void
+FlowMon::fformat(const FlowTable& f, int k)
+{
+	double now = Scheduler::instance().clock();
+#if defined(HAVE_INT64)
+	sprintf(wrk_, "%8.3f %d %d %d %d %d %d " STRTOI64_FMTSTR " " STRTOI64_FMTSTR " %d %d " STRTOI64_FMTSTR " " STRTOI64_FMTSTR " %d %d %d %d %d %d %d %d %d",
+#else /* no 64-bit int */
+	sprintf(wrk_, "%8.3f %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+#endif
+		now, f.fid_[k], 0, f.type_[k], f.fid_[k], f.src_[k], f.dst_[k],
+		f.parrivals_[k], f.barrivals_[k], f.epdrops_[k], f.ebdrops_[k],
+		parrivals(), barrivals(), epdrops(), ebdrops(),
+		pdrops(), bdrops(), f.pdrops_[k], f.bdrops_[k],
+		0, 0, 0);	// no Quick-Start counts per flow
+}
+
 void
 FlowMon::dumpflow(Tcl_Channel tc, Flow* f)
 {
@@ -419,6 +496,54 @@ FlowMon::dumpflow(Tcl_Channel tc, Flow* f)
 	}
 }
 
+void
+FlowMonSnapshotTimer::expire(Event*)
+{
+	fm_->snapshot();
+	if (fm_->snapint_ > 0)
+		resched(fm_->snapint_);
+}
+
+/*
+ * Write the flow table as a FlowSnapshotHdr and one array per column,
+ * the flows expired since the last snapshot first, then the others.
+ */
+void
+FlowMon::snapshot()
+{
+	if (snapch_ == NULL || flows_ == NULL)
+		return;
+	FlowTable& t = flows_->table();
+	FlowTable& x = flows_->expired();
+	FlowSnapshotHdr h;
+
+	h.time_ = Scheduler::instance().clock();
+	h.nflows_ = t.size();
+	h.nexpired_ = x.size();
+	h.ncols_ = FS_NCOLS;
+	h.cntlen_ = sizeof(flowcnt_t);
+	(void)Tcl_Write(snapch_, (char*)&h, sizeof(h));
+	column(x.src_, t.src_);
+	column(x.sport_, t.sport_);
+	column(x.dst_, t.dst_);
+	column(x.dport_, t.dport_);
+	column(x.fid_, t.fid_);
+	column(x.type_, t.type_);
+	column(x.start_, t.start_);
+	column(x.last_, t.last_);
+	column(x.parrivals_, t.parrivals_);
+	column(x.barrivals_, t.barrivals_);
+	column(x.pdepartures_, t.pdepartures_);
+	column(x.bdepartures_, t.bdepartures_);
+	column(x.pdrops_, t.pdrops_);
+	column(x.bdrops_, t.bdrops_);
+	column(x.epdrops_, t.epdrops_);
+	column(x.ebdrops_, t.ebdrops_);
+	column(x.rttsum_, t.rttsum_);
+	column(x.rttn_, t.rttn_);
+	flows_->drain();
+}
+
 int
 FlowMon::command(int argc, const char*const* argv)
 {
@@ -440,12 +565,17 @@ FlowMon::command(int argc, const char*const* argv)
 			tcl.result(flow_list());
 			return (TCL_OK);
 		}
+		if (strcmp(argv[1], "snapshot") == 0) {
+			snapshot();
+			return (TCL_OK);
+		}
 	} else if (argc == 3) {
 		if (strcmp(argv[1], "classifier") == 0) {
 			classifier_ = (Classifier*)
 				TclObject::lookup(argv[2]);
 			if (classifier_ == NULL)
 				return (TCL_ERROR);
+			flows_ = dynamic_cast<FlowHashClassifier*>(classifier_);
 			return (TCL_OK);
 		}
 		if (strcmp(argv[1], "attach") == 0) {
@@ -460,6 +590,31 @@ FlowMon::command(int argc, const char*const* argv)
 			}
 			return (TCL_OK);
 		}
+		if (strcmp(argv[1], "snapshot-to") == 0) {
+			/*
+			 * $fm snapshot-to $chan: write a snapshot of the
+			 * flow table every snapshot_interval_ seconds
+			 * (re-run by ns-lib.tcl when that changes)
+			 */
+			int mode;
+			Tcl_Channel ch = Tcl_GetChannel(tcl.interp(),
+							(char*)argv[2], &mode);
+			if (ch == NULL) {
+				tcl.resultf("FlowMon (%s): can't attach %s for writing",
+					name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			if (flows_ == NULL) {
+				tcl.resultf("FlowMon (%s): snapshots need a Classifier/Hash/Flow",
+					name());
+				return (TCL_ERROR);
+			}
+			snapch_ = ch;
+			snaptimer_.force_cancel();
+			if (snapint_ > 0)
+				snaptimer_.resched(snapint_);
+			return (TCL_OK);
+		}
 	}
 	return (EDQueueMonitor::command(argc, argv));
 }
@@ -46,6 +46,8 @@
 #include "config.h"
 #include "queue-monitor.h"
 #include "classifier.h"
+#include "classifier-flow.h"
+#include "timer-handler.h"
 #include "ip.h"
 #include "flags.h"
 #include "random.h"
@@ -190,7 +192,37 @@ protected:
  * mon_* stuff added to support monitored early drops - ratul
  */
 
+/*
+ * FlowMon snapshots: with a Classifier/Hash/Flow, "snapshot-to
+ * <channel>" writes the flow table every snapshot_interval_ seconds
+ * (0: only on "snapshot"), as a FlowSnapshotHdr followed by FS_NCOLS
+ * columns in the order of FlowTable's members, each holding nexpired_
+ * + nflows_ values: int32_t, double for the times and rttsum, and
+ * cntlen_ bytes for the arrival and departure counters.  The flows
+ * that expired since the previous snapshot come first.  Values are in
+ * host byte order; configure the channel with -translation binary.
+ */
+struct FlowSnapshotHdr {
+	double		time_;
+	int32_t		nflows_;
+	int32_t		nexpired_;
+	int32_t		ncols_;
+	int32_t		cntlen_;	// sizeof(flowcnt_t)
+};
+
+#define FS_NCOLS	18
+
+class FlowMon;
+class FlowMonSnapshotTimer : public TimerHandler {
+public:
+	FlowMonSnapshotTimer(FlowMon* fm) : fm_(fm) {}
+protected:
+	void expire(Event*);
+	FlowMon* fm_;
+};
+
 class FlowMon : public EDQueueMonitor {
+	friend class FlowMonSnapshotTimer;
 public:
 	FlowMon();
 	void in(Packet*);	// arrivals
@@ -203,6 +235,7 @@ public:
 	//added by ratul
 	void setClassifier(Classifier * classifier) {
 	  classifier_ = classifier;
+	  flows_ = dynamic_cast<FlowHashClassifier*>(classifier);
 	}
 
 	Flow * find(Packet* p) {
@@ -213,9 +246,21 @@ protected:
 	void	dumpflows();
 	void	dumpflow(Tcl_Channel, Flow*);
 	void	fformat(Flow*);
+	void	fformat(const FlowTable&, int k);
 	char*	flow_list();
+	void	snapshot();
+	template <class T> void column(const std::vector<T>& x,
+				       const std::vector<T>& t) {
+		if (!x.empty())
+			(void)Tcl_Write(snapch_, (char*)&x[0],
+					x.size() * sizeof(T));
+		if (!t.empty())
+			(void)Tcl_Write(snapch_, (char*)&t[0],
+					t.size() * sizeof(T));
+	}
 
 	Classifier*	classifier_;
+	FlowHashClassifier* flows_;	// classifier_, if it keeps records
 	Tcl_Channel	channel_;
 
 	int enable_in_;		// enable per-flow arrival state
@@ -226,6 +271,10 @@ protected:
 	
 	//an excessive high value for large simulations using flow monitor 
 	char	wrk_[65536];	// big enough to hold flow list
+
+	Tcl_Channel	snapch_;	// for snapshots of flows_
+	double		snapint_;	// snapshot_interval_
+	FlowMonSnapshotTimer snaptimer_;
 };
 
 #endif
@@ -52,6 +52,12 @@ RandomVariable::RandomVariable()
 	rng_ = RNG::defaultrng(); 
 }
 
+void RandomVariable::values(double* v, int n)
+{
+	for (int i = 0; i < n; i++)
+		v[i] = value();
+}
+
 int RandomVariable::command(int argc, const char*const* argv)
 {
 	Tcl& tcl = Tcl::instance();
@@ -63,6 +69,27 @@ int RandomVariable::command(int argc, const char*const* argv)
 		}
 	}
 	if (argc == 3) {
+		/*
+		 * $rv values <n>: a list of the next n values, the same
+		 * as n calls of "value" but drawn in one batch.
+		 */
+		if (strcmp(argv[1], "values") == 0) {
+			int n = atoi(argv[2]);
+			if (n < 0) {
+				tcl.resultf("%s values: bad count %s",
+					    name(), argv[2]);
+				return(TCL_ERROR);
+			}
+			double* v = new double[n > 0 ? n : 1];
+			values(v, n);
+			char buf[32];
+			for (int i = 0; i < n; i++) {
+				sprintf(buf, "%6e", v[i]);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			delete[] v;
+			return(TCL_OK);
+		}
 		if (strcmp(argv[1], "use-rng") == 0) {
 			rng_ = (RNG*)TclObject::lookup(argv[2]);
 			if (rng_ == 0) {
@@ -116,7 +143,7 @@ UniformRandomVariable::UniformRandomVariable(double min, double max)
 
 double UniformRandomVariable::value()
 {
-	return(rng_->uniform(min_, max_));
+	return(rng()->uniform(min_, max_));
 }
 
 
@@ -140,7 +167,7 @@ ExponentialRandomVariable::ExponentialRandomVariable(double avg)
 
 double ExponentialRandomVariable::value()
 {
-	return(rng_->exponential(avg_));
+	return(rng()->exponential(avg_));
 }
 
 /*
@@ -175,7 +202,7 @@ double ErlangRandomVariable::value()
 {
 	double result = 0;
 	for (int i = 0; i < k_; i++) {
-		result += rng_->exponential(lambda_);
+		result += rng()->exponential(lambda_);
 	}
 	return result;
 
@@ -215,7 +242,7 @@ double GammaRandomVariable::value()
 	// G. Marsaglia, W. W. Tsang: A simple method for gereating Gamma variables
 	// ACM Transactions on mathematical software, Vol. 26, No. 3, Sept. 2000
 	if (alpha_ < 1) {
-		double u = rng_->uniform(1.0);
+		double u = rng()->uniform(1.0);
 		return GammaRandomVariable(1.0 + alpha_, beta_).value() * pow (u, 1.0 / alpha_);
 	}
 	
@@ -225,12 +252,12 @@ double GammaRandomVariable::value()
 
 	while (1) {
 		do {
-			x = rng_->normal(0.0, 1.0);
+			x = rng()->normal(0.0, 1.0);
 			v = 1.0 + c * x;
 		} while (v <= 0);
 
 		v = v * v * v;
-		u = rng_->uniform(1.0);
+		u = rng()->uniform(1.0);
 		if (u < 1 - 0.0331 * x * x * x * x)
 			break;
 		if (log (u) < 0.5 * x * x + d * (1 - v + log (v)))
@@ -270,7 +297,7 @@ double ParetoRandomVariable::value()
 	 * can update the scale everytime the user updates shape
 	 * or avg.
 	 */
-	return(rng_->pareto(avg_ * (shape_ -1)/shape_, shape_));
+	return(rng()->pareto(avg_ * (shape_ -1)/shape_, shape_));
 }
 
 /* Pareto distribution of the second kind, aka. Lomax distribution */
@@ -296,7 +323,7 @@ ParetoIIRandomVariable::ParetoIIRandomVariable(double avg, double shape)
 
 double ParetoIIRandomVariable::value()
 {
-        return(rng_->paretoII(avg_ * (shape_ - 1), shape_));
+        return(rng()->paretoII(avg_ * (shape_ - 1), shape_));
 }
 
 static class NormalRandomVariableClass : public TclClass {
@@ -315,7 +342,7 @@ NormalRandomVariable::NormalRandomVariable()
  
 double NormalRandomVariable::value()
 {
-        return(rng_->normal(avg_, std_));
+        return(rng()->normal(avg_, std_));
 }
 
 static class LogNormalRandomVariableClass : public TclClass {
@@ -334,7 +361,7 @@ LogNormalRandomVariable::LogNormalRandomVariable()
  
 double LogNormalRandomVariable::value()
 {
-        return(rng_->lognormal(avg_, std_));
+        return(rng()->lognormal(avg_, std_));
 }
 
 static class ConstantRandomVariableClass : public TclClass {
@@ -449,7 +476,7 @@ double WeibullRandomVariable::avg(void)
 
 double WeibullRandomVariable::value()
 {
-        return(rng_->rweibull(scale_, shape_));
+        return(rng()->rweibull(scale_, shape_));
 }
                                                                                
 /*
@@ -469,7 +496,7 @@ public:
 	}
 } class_empiricalranvar;
 
-EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32), table_(0)
+EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32), table_(0), guide_(0), numGuide_(0), guideScale_(0)
 {
 	bind("minCDF_", &minCDF_);
 	bind("maxCDF_", &maxCDF_);
@@ -477,6 +504,12 @@ EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), max
 	bind("maxEntry_", &maxEntry_);
 }
 
+EmpiricalRandomVariable::~EmpiricalRandomVariable()
+{
+	delete[] table_;
+	delete[] guide_;
+}
+
 int EmpiricalRandomVariable::command(int argc, const char*const* argv)
 {
 	Tcl& tcl = Tcl::instance();
@@ -520,14 +553,39 @@ int EmpiricalRandomVariable::loadCDF(const char* filename)
 		sscanf(line, "%lf %*f %lf", &e->val_, &e->cdf_);
 	}
         fclose(fp);
+	buildGuide();
 	return numEntry_;
 }
 
+void EmpiricalRandomVariable::buildGuide()
+{
+	delete[] guide_;
+	guide_ = 0;
+	numGuide_ = 0;
+	if (numEntry_ < 4)
+		return;
+	for (int i = 1; i < numEntry_; i++)
+		if (table_[i].cdf_ < table_[i-1].cdf_)
+			return;		// not a CDF, keep the plain search
+	double range = table_[numEntry_-1].cdf_ - table_[0].cdf_;
+	if (!(range > 0))
+		return;
+	numGuide_ = numEntry_;
+	guideScale_ = numGuide_ / range;
+	guide_ = new int[numGuide_ + 1];
+	int i = 0;
+	for (int k = 0; k <= numGuide_; k++) {
+		while (i < numEntry_ && bucket(table_[i].cdf_) < k)
+			i++;
+		guide_[k] = i;
+	}
+}
+
 double EmpiricalRandomVariable::value()
 {
 	if (numEntry_ <= 0)
 		return 0;
-	double u = rng_->uniform(minCDF_, maxCDF_);
+	double u = rng()->uniform(minCDF_, maxCDF_);
 	int mid = lookup(u);
 	if (mid && interpolation_ && u < table_[mid].cdf_)
 		return interpolate(u, table_[mid-1].cdf_, table_[mid-1].val_,
@@ -535,6 +593,29 @@ double EmpiricalRandomVariable::value()
 	return table_[mid].val_;
 }
 
+void EmpiricalRandomVariable::values(double* v, int n)
+{
+	int i;
+	if (numEntry_ <= 0) {
+		for (i = 0; i < n; i++)
+			v[i] = 0;
+		return;
+	}
+	// draw the uniforms first, then map them through the table
+	for (i = 0; i < n; i++)
+		v[i] = rng()->uniform(minCDF_, maxCDF_);
+	for (i = 0; i < n; i++) {
+		double u = v[i];
+		int mid = lookup(u);
+		if (mid && interpolation_ && u < table_[mid].cdf_)
+			v[i] = interpolate(u, table_[mid-1].cdf_,
+					   table_[mid-1].val_,
+					   table_[mid].cdf_, table_[mid].val_);
+		else
+			v[i] = table_[mid].val_;
+	}
+}
+
 double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, double x2, double y2)
 {
 	double value = y1 + (x - x1) * (y2 - y1) / (x2 - x1);
@@ -549,7 +630,19 @@ int EmpiricalRandomVariable::lookup(double u)
 	int lo, hi, mid;
 	if (u <= table_[0].cdf_)
 		return 0;
-	for (lo=1, hi=numEntry_-1;  lo < hi; ) {
+	lo = 1;
+	hi = numEntry_ - 1;
+	if (guide_) {
+		// entries of lower buckets are < u, of higher ones > u
+		int k = bucket(u);
+		if (guide_[k] > lo)
+			lo = guide_[k];
+		if (guide_[k+1] < hi)
+			hi = guide_[k+1];
+		if (lo > hi)
+			lo = hi;
+	}
+	while (lo < hi) {
 		mid = (lo + hi) / 2;
 		if (u > table_[mid].cdf_)
 			lo = mid + 1;
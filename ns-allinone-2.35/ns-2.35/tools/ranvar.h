@@ -56,11 +56,14 @@ class RandomVariable : public TclObject {
  public:
 	virtual double value() = 0;
 	virtual double avg() = 0;
+	// fill v[0..n-1] with the next n values of this variable
+	virtual void values(double* v, int n);
 	int command(int argc, const char*const* argv);
 	RandomVariable();
 	// This is added by Debojyoti Dutta 12th Oct 2000
 	int seed(char *);
  protected:
+	RNG* rng() { return (RNG::local(rng_)); }
 	RNG* rng_;
 };
 
@@ -242,9 +245,11 @@ struct CDFentry {
 class EmpiricalRandomVariable : public RandomVariable {
 public:
 	virtual double value();
+	virtual void values(double* v, int n);
 	virtual double interpolate(double u, double x1, double y1, double x2, double y2);
 	virtual double avg(){ return value(); } // junk
 	EmpiricalRandomVariable();
+	~EmpiricalRandomVariable();
 	double& minCDF() { return minCDF_; }
 	double& maxCDF() { return maxCDF_; }
 	int loadCDF(const char* filename);
@@ -252,6 +257,11 @@ public:
 protected:
 	int command(int argc, const char*const* argv);
 	int lookup(double u);
+	void buildGuide();
+	int bucket(double u) {		// u >= table_[0].cdf_
+		double x = (u - table_[0].cdf_) * guideScale_;
+		return (x < numGuide_ ? int(x) : numGuide_ - 1);
+	}
 
 	double minCDF_;		// min value of the CDF (default to 0)
 	double maxCDF_;		// max value of the CDF (default to 1)
@@ -259,6 +269,14 @@ protected:
 	int numEntry_;		// number of entries in the CDF table
 	int maxEntry_;		// size of the CDF table (mem allocation)
 	CDFentry* table_;	// CDF table of (val_, cdf_)
+
+	// Guide table for lookup(): the CDF range is cut into numGuide_
+	// equal buckets, and guide_[k] is the number of entries whose
+	// cdf_ falls in a bucket below k, so a lookup only searches the
+	// entries of its own bucket.  0 if the CDF is not monotone.
+	int* guide_;
+	int numGuide_;
+	double guideScale_;	// buckets per unit of CDF
 };
 
 #endif
@@ -67,6 +67,7 @@ static const char rcsid[] =
 #include <stdio.h>
 #ifndef OLD_RNG
 #include <string.h>
+#include <time.h>			// for clock
 #endif /* !OLD_RNG */
 #include "rng.h"
 
@@ -188,7 +189,8 @@ public:
 
 /* default RNG */
 
-RNG* RNG::default_ = NULL;
+NS_TLS RNG* RNG::default_ = NULL;
+RNG* RNG::shared_ = NULL;
 
 double
 RNG::normal(double avg, double std)
@@ -245,6 +247,16 @@ RNG::command(int argc, const char*const* argv)
 			} else set_seed(HEURISTIC_SEED_SOURCE, 0);
 			return(TCL_OK);
 		}
+#ifndef OLD_RNG
+		if (strcmp(argv[1], "buffered") == 0) {
+			set_buffered(atoi(argv[2]) != 0);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "benchmark") == 0) {
+			RNGTest test; test.throughput(atol(argv[2]));
+			return (TCL_OK);
+		}
+#endif /* !OLD_RNG */
 	} else if (argc == 2) {
 		if (strcmp(argv[1], "next-random") == 0) {
 			tcl.resultf("%u", uniform_positive_int());
@@ -275,6 +287,10 @@ RNG::command(int argc, const char*const* argv)
 			reset_start_substream();
 			return (TCL_OK);
 		}
+		if (strcmp(argv[1], "benchmark") == 0) {
+			RNGTest test; test.throughput(10000000L);
+			return (TCL_OK);
+		}
 #endif /* !OLD_RNG */
 		if (strcmp(argv[1], "default") == 0) {
 			default_ = this;
@@ -408,7 +424,12 @@ RNG::set_seed(RNGSources source, int seed)
  * Simple test program:
  */
 #ifdef rng_stand_alone
-int main() { RNGTest test; test.verbose(); }
+int main() {
+	RNGTest test; test.verbose();
+#ifndef OLD_RNG
+	test.throughput(10000000L);
+#endif /* !OLD_RNG */
+}
 #endif /* rng_stand_alone */
 
 #ifdef rng_test
@@ -446,6 +467,54 @@ RNGTest::RNGTest()
 		  fprintf (stderr, "r (%lu) != 817829295L\n", r);
 		  exit(-1);
 	  }
+
+	  // the buffered mode must give the same stream, through
+	  // state queries, substreams, jumps and mode changes
+	  RNG a(RNG::RAW_SEED_SOURCE, 1L), b(RNG::RAW_SEED_SOURCE, 1L);
+	  unsigned long sa[6], sb[6];
+	  b.set_buffered(true);
+	  for (i = 0; i < 551246; i++) {
+		  if (a.uniform_positive_int() != b.uniform_positive_int())
+			  break;
+		  if (i % 100003 == 5000) {
+			  a.get_state(sa);
+			  b.get_state(sb);
+			  if (memcmp(sa, sb, sizeof(sa)) != 0)
+				  break;
+		  }
+		  switch (i) {
+		  case 3000:
+			  a.reset_start_substream();
+			  b.reset_start_substream();
+			  break;
+		  case 7777:
+			  a.reset_next_substream();
+			  b.reset_next_substream();
+			  break;
+		  case 20000:
+			  a.advance_state(10, -3);
+			  b.advance_state(10, -3);
+			  break;
+		  case 30000:
+			  a.set_antithetic(true);
+			  b.set_antithetic(true);
+			  a.increased_precis(true);
+			  b.increased_precis(true);
+			  break;
+		  case 40000:
+			  a.set_antithetic(false);
+			  b.set_antithetic(false);
+			  b.set_buffered(false);
+			  break;
+		  case 41000:
+			  b.set_buffered(true);
+			  break;
+		  }
+	  }
+	  if (i != 551246 || a.uniform() != b.uniform()) {
+		  fprintf (stderr, "buffered RNG differs at %d\n", i);
+		  exit(-1);
+	  }
 #endif /* OLD_RNG */
 
 }
@@ -512,6 +581,34 @@ RNGTest::verbose()
 	};
 }
 
+#ifndef OLD_RNG
+/*
+ * Time n numbers of the stream of RAW_SEED_SOURCE 1, unbuffered and
+ * buffered.
+ */
+void
+RNGTest::throughput(long n)
+{
+	RNG a(RNG::RAW_SEED_SOURCE, 1L), b(RNG::RAW_SEED_SOURCE, 1L);
+	double sa = 0, sb = 0;
+	clock_t t0, t1, t2;
+	long i;
+
+	b.set_buffered(true);
+	t0 = clock();
+	for (i = 0; i < n; i++)
+		sa += a.uniform();
+	t1 = clock();
+	for (i = 0; i < n; i++)
+		sb += b.uniform();
+	t2 = clock();
+	printf ("%ld numbers: unbuffered %.1f ns each, buffered %.1f ns each, %s\n",
+		n, 1e9 * (t1 - t0) / CLOCKS_PER_SEC / n,
+		1e9 * (t2 - t1) / CLOCKS_PER_SEC / n,
+		(sa == sb) ? "same numbers" : "NUMBERS DIFFER");
+}
+#endif /* !OLD_RNG */
+
 #endif /* rng_test */
 
 #ifndef OLD_RNG
@@ -581,6 +678,56 @@ namespace
 		{ 2824425944.0, 32183930.0, 2093834863.0 } 
 	}; 
 
+	// The same raised to the power 256 = RNG_BLOCK / RNG_LANES, the
+	// distance between the lanes of a block in the buffered mode.
+
+	const double A1p256[3][3] = { 
+		{ 1170096663.0, 49135452.0, 3441537107.0 }, 
+		{ 1857945175.0, 1649398389.0, 49135452.0 }, 
+		{ 333002869.0, 3109147376.0, 1649398389.0 } 
+	}; 
+
+	const double A2p256[3][3] = { 
+		{ 1463826069.0, 300842059.0, 3313769518.0 }, 
+		{ 1799677538.0, 1463826069.0, 3174861078.0 }, 
+		{ 1882279394.0, 1799677538.0, 3509975160.0 } 
+	}; 
+
+	//------------------------------------------------------------------- 
+	// The buffered mode computes U01() in integer arithmetic, with
+	// exactly the same results.  m1 = 2^32 - 209 and m2 = 2^32 - 22853,
+	// so a product is reduced by folding its high word back in (2^32 =
+	// 209 mod m1, 22853 mod m2) instead of a division, and the operand
+	// m - s0 keeps it positive.  The selects are done on the sign bit:
+	// at random, a branch on them is mispredicted far too often.
+	// 
+	const int64_t im1 = 4294967087LL; 
+	const int64_t im2 = 4294944443LL; 
+
+	// x_n of component 1 from x_{n-3} and x_{n-2}
+	inline int64_t Step1 (int64_t s0, int64_t s1) 
+	{ 
+		int64_t x = 1403580 * s1 + 810728 * (im1 - s0);	// < 2^54
+		x = (x >> 32) * 209 + (x & 0xffffffff) - im1;	// < m1
+		return x + (im1 & (x >> 63)); 
+	} 
+
+	// x_n of component 2 from x_{n-3} and x_{n-1}
+	inline int64_t Step2 (int64_t s3, int64_t s5) 
+	{ 
+		int64_t x = 527612 * s5 + 1370589 * (im2 - s3);	// < 2^53
+		x = (x >> 32) * 22853 + (x & 0xffffffff);	// < 2^36
+		x = (x >> 32) * 22853 + (x & 0xffffffff) - im2;	// < m2
+		return x + (im2 & (x >> 63)); 
+	} 
+
+	// the output of U01() for the new elements p1, p2
+	inline double Combine (int64_t p1, int64_t p2) 
+	{ 
+		int64_t d = p1 - p2; 
+		return (d + (im1 & ((d - 1) >> 63))) * norm;	// d <= 0: + m1
+	} 
+
 	//------------------------------------------------------------------- 
 	// Return (a*s + c) MOD m; a, s, c and m must be < 2^35 
 	// 
@@ -731,6 +878,12 @@ double RNG::U01 ()
 { 
 	long k; 
 	double p1, p2, u; 
+	if (block_) { 
+		if (block_->pos_ == block_->len_) 
+			fill_block (); 
+		u = block_->u_[block_->pos_++]; 
+		return (anti_ == false) ? u : (1 - u); 
+	} 
 	/* Component 1 */ 
 	p1 = a12 * Cg_[1] - a13n * Cg_[0]; 
 	k = static_cast<long> (p1 / m1); 
@@ -766,6 +919,84 @@ double RNG::U01d ()
 	} 
 } 
 
+//------------------------------------------------------------------------- 
+// Generate the next block of the buffered mode.  Lane l computes the
+// numbers l*256 .. l*256+255 of the block from the state jumped ahead
+// by l*256 steps, into its own column of x1 and x2 (the sequences of
+// the two components); the lanes are independent, so the inner loop
+// runs them side by side.  The stream continues after the last lane.
+// 
+void RNG::fill_block () 
+{ 
+	const int n = RNG_BLOCK / RNG_LANES; 
+	double lane[6]; 
+	int64_t x1[n + 3][RNG_LANES], x2[n + 3][RNG_LANES], p1, p2; 
+	int i, l, t; 
+
+	for (i = 0; i < 6; ++i) 
+		block_->start_[i] = lane[i] = Cg_[i]; 
+	for (l = 0; l < RNG_LANES; ++l) { 
+		if (l > 0) { 
+			MatVecModM (A1p256, lane, lane, m1); 
+			MatVecModM (A2p256, &lane[3], &lane[3], m2); 
+		} 
+		for (i = 0; i < 3; ++i) { 
+			x1[i][l] = static_cast<int64_t> (lane[i]); 
+			x2[i][l] = static_cast<int64_t> (lane[i + 3]); 
+		} 
+	} 
+	for (t = 0; t < n; ++t) { 
+		for (l = 0; l < RNG_LANES; ++l) { 
+			p1 = x1[t + 3][l] = Step1 (x1[t][l], x1[t + 1][l]); 
+			p2 = x2[t + 3][l] = Step2 (x2[t][l], x2[t + 2][l]); 
+			block_->u_[l * n + t] = Combine (p1, p2); 
+		} 
+	} 
+	for (i = 0; i < 3; ++i) { 
+		Cg_[i] = static_cast<double> (x1[n + i][RNG_LANES - 1]); 
+		Cg_[i + 3] = static_cast<double> (x2[n + i][RNG_LANES - 1]); 
+	} 
+	block_->pos_ = 0; 
+	block_->len_ = RNG_BLOCK; 
+} 
+
+//------------------------------------------------------------------------- 
+// The state before the next number: C g, or in the buffered mode the
+// state at the start of the block advanced by the numbers used.
+// 
+void RNG::current_state (double st[6]) const 
+{ 
+	int i, k; 
+	if (block_ == 0 || block_->pos_ == block_->len_) { 
+		for (i = 0; i < 6; ++i) 
+			st[i] = Cg_[i]; 
+		return; 
+	} 
+	int64_t s[6], p1, p2; 
+	for (i = 0; i < 6; ++i) 
+		s[i] = static_cast<int64_t> (block_->start_[i]); 
+	for (k = 0; k < block_->pos_; ++k) { 
+		p1 = Step1 (s[0], s[1]); 
+		p2 = Step2 (s[3], s[5]); 
+		s[0] = s[1]; s[1] = s[2]; s[2] = p1; 
+		s[3] = s[4]; s[4] = s[5]; s[5] = p2; 
+	} 
+	for (i = 0; i < 6; ++i) 
+		st[i] = static_cast<double> (s[i]); 
+} 
+
+//------------------------------------------------------------------------- 
+// Bring C g back to the state before the next number and drop the
+// rest of the block, before C g is used directly.
+// 
+void RNG::sync_block () 
+{ 
+	if (block_) { 
+		current_state (Cg_); 
+		drop_block (); 
+	} 
+} 
+
 //************************************************************************* 
 // Public members of the class start here 
 //------------------------------------------------------------------------- 
@@ -779,7 +1010,7 @@ double RNG::U01d ()
  *   long next()
  *   double next_double()
  */
-RNG::RNG (long seed) 
+RNG::RNG (long seed) : block_(0) 
 {
 	set_seed (seed);
 	init();
@@ -803,6 +1034,7 @@ void RNG::init()
 	} 
 	MatVecModM (A1p127, next_seed_, next_seed_, m1); 
 	MatVecModM (A2p127, &next_seed_[3], &next_seed_[3], m2); 
+	drop_block (); 
 }
 
 void RNG::set_seed (long seed) 
@@ -849,7 +1081,7 @@ double RNG::next_seed_[6] =
 //------------------------------------------------------------------------- 
 // constructor 
 // 
-RNG::RNG (const char *s) 
+RNG::RNG (const char *s) : block_(0) 
 { 
 	if (strlen (s) > 99) {
 		strncpy (name_, s, 99);
@@ -861,6 +1093,10 @@ RNG::RNG (const char *s)
 	init();
 }
 
+RNG::~RNG () 
+{ 
+	delete block_; 
+} 
 
 //------------------------------------------------------------------------- 
 // Reset Stream to beginning of Stream. 
@@ -869,6 +1105,7 @@ void RNG::reset_start_stream ()
 { 
 	for (int i = 0; i < 6; ++i) 
 		Cg_[i] = Bg_[i] = Ig_[i]; 
+	drop_block (); 
 } 
 
 //------------------------------------------------------------------------- 
@@ -878,6 +1115,7 @@ void RNG::reset_start_substream ()
 { 
 	for (int i = 0; i < 6; ++i) 
 		Cg_[i] = Bg_[i]; 
+	drop_block (); 
 } 
 
 //------------------------------------------------------------------------- 
@@ -889,6 +1127,7 @@ void RNG::reset_next_substream ()
 	MatVecModM(A2p76, &Bg_[3], &Bg_[3], m2); 
 	for (int i = 0; i < 6; ++i) 
 		Cg_[i] = Bg_[i]; 
+	drop_block (); 
 } 
 
 //------------------------------------------------------------------------- 
@@ -907,6 +1146,7 @@ void RNG::set_seed (const unsigned long seed[6])
 		abort();
 	for (int i = 0; i < 6; ++i) 
 		Cg_[i] = Bg_[i] = Ig_[i] = seed[i]; 
+	drop_block (); 
 } 
 
 //------------------------------------------------------------------------- 
@@ -918,6 +1158,7 @@ void RNG::set_seed (const unsigned long seed[6])
 void RNG::advance_state (long e, long c) 
 { 
 	double B1[3][3], C1[3][3], B2[3][3], C2[3][3]; 
+	sync_block (); 
 	if (e > 0) { 
 		MatTwoPowModM (A1p0, B1, m1, e); 
 		MatTwoPowModM (A2p0, B2, m2, e); 
@@ -943,19 +1184,23 @@ void RNG::advance_state (long e, long c)
 //------------------------------------------------------------------------- 
 void RNG::get_state (unsigned long seed[6]) const 
 { 
+	double st[6]; 
+	current_state (st); 
 	for (int i = 0; i < 6; ++i) 
-		seed[i] = static_cast<unsigned long> (Cg_[i]); 
+		seed[i] = static_cast<unsigned long> (st[i]); 
 } 
 
 //------------------------------------------------------------------------- 
 void RNG::write_state () const 
 { 
+	double st[6]; 
+	current_state (st); 
 	printf ("The current state of the Rngstream %s:\n", name_);
 	printf (" Cg_ = { ");
 	for(int i=0;i<5;i++) { 
-		printf ("%lu, ", (unsigned long) Cg_[i]);
+		printf ("%lu, ", (unsigned long) st[i]);
 	} 
-	printf ("%lu }\n\n", (unsigned long) Cg_[5]);
+	printf ("%lu }\n\n", (unsigned long) st[5]);
 } 
 
 //------------------------------------------------------------------------- 
@@ -978,11 +1223,13 @@ void RNG::write_state_full () const
 	} 
 	printf ("%lu }\n", (unsigned long) Bg_[5]);
 
+	double st[6]; 
+	current_state (st); 
 	printf (" Cg_ = { ");
 	for (i = 0; i < 5; i++) { 
-		printf ("%lu, ", (unsigned long) Cg_[i]);
+		printf ("%lu, ", (unsigned long) st[i]);
 	} 
-	printf ("%lu }\n\n", (unsigned long) Cg_[5]);
+	printf ("%lu }\n\n", (unsigned long) st[5]);
 } 
 
 //------------------------------------------------------------------------- 
@@ -997,6 +1244,19 @@ void RNG::set_antithetic (bool a)
 	anti_ = a; 
 } 
 
+//------------------------------------------------------------------------- 
+void RNG::set_buffered (bool b) 
+{ 
+	if (b && block_ == 0) { 
+		block_ = new RNGBlock; 
+		block_->pos_ = block_->len_ = 0; 
+	} else if (!b && block_) { 
+		sync_block (); 
+		delete block_; 
+		block_ = 0; 
+	} 
+} 
+
 //------------------------------------------------------------------------- 
 // Generate the next random number. 
 // 
@@ -70,6 +70,9 @@
 
 #ifndef stand_alone
 #include "config.h"
+#else
+#include <sys/types.h>			// for int64_t
+#define NS_TLS				// one thread, see config.h
 #endif   /* stand_alone */
 
 #ifndef MAXINT
@@ -94,6 +97,23 @@ private:
 };
 #endif /* OLD_RNG */
 
+#ifndef OLD_RNG
+/*
+ * A block of numbers of the buffered mode of RNG (see set_buffered()),
+ * generated RNG_LANES lanes at a time, each lane RNG_BLOCK/RNG_LANES
+ * consecutive numbers of the stream.
+ */
+#define RNG_LANES	4
+#define RNG_BLOCK	1024
+
+struct RNGBlock {
+	double u_[RNG_BLOCK];	// U01() values, before antithetic
+	double start_[6];	// state of the stream at u_[0]
+	int pos_;		// next value to return
+	int len_;		// values in u_, 0 if none
+};
+#endif /* !OLD_RNG */
+
 /*
  * Use class RNG in real programs.
  */
@@ -119,9 +139,26 @@ public:
 	double next_double();
 #endif /* OLD_RNG */
 
+#ifdef OLD_RNG
 	RNG(RNGSources source, int seed = 1) { set_seed(source, seed); };
+#else
+	RNG(RNGSources source, int seed = 1) : block_(0) {
+		set_seed(source, seed);
+	};
+	~RNG();
+#endif /* OLD_RNG */
 	void set_seed(RNGSources source, int seed = 1);
 	inline static RNG* defaultrng() { return (default_); }
+	inline static void defaultrng(RNG* r) { default_ = r; }
+	/*
+	 * r, unless it is the default RNG that Scheduler/Parallel gave
+	 * to partition 0: a RandomVariable created on it before the
+	 * partitions draws from the default of the partition it runs in.
+	 */
+	inline static RNG* local(RNG* r) {
+		return (r == shared_ ? default_ : r);
+	}
+	static RNG* shared_;
 
 #ifndef OLD_RNG
 	/*
@@ -179,6 +216,17 @@ public:
 	  bits of resolution.
 	*/
 
+	void set_buffered (bool b); 
+	/*
+	  If b = true, the stream is generated RNG_BLOCK numbers at a time
+	  into a buffer, with integer arithmetic over RNG_LANES lanes that
+	  the compiler can vectorize, and the generator returns them from
+	  there.  The numbers, and the semantics of all the other methods
+	  (state, substreams, antithetic and increased precision), are
+	  exactly those of the unbuffered stream.  Costs a block of
+	  RNG_BLOCK doubles; only worth it for streams drawn from heavily.
+	*/
+
 	void set_seed (const unsigned long seed[6]); 
 	/*
 	  Sets the initial seed I g of the stream to the vector seed. The
@@ -251,6 +299,10 @@ public:
 #ifdef OLD_RNG
 		return stream_.next_double();
 #else
+		if (block_ && block_->pos_ < block_->len_ && !inc_prec_) {
+			double u = block_->u_[block_->pos_++];
+			return (anti_ == false) ? u : (1 - u);
+		}
 		return next_double();
 #endif /* OLD_RNG */
 	}
@@ -351,8 +403,24 @@ protected:   // need to be public?
 	  The backbone uniform random number generator with increased 
 	  precision. 
 	*/	
+
+	RNGBlock* block_; 
+	/*
+	  Buffer of the buffered mode, 0 if not buffered.  While it holds
+	  numbers, C g is the state after its last one.
+	*/
+
+	void fill_block (); 
+	void drop_block () { if (block_) block_->pos_ = block_->len_ = 0; } 
+	void sync_block (); 
+	void current_state (double s[6]) const; 
+	/*
+	  Refill the buffer; empty it (C g set elsewhere); set C g back to
+	  the state of the next number and empty the buffer; return the
+	  state of the next number.
+	*/
 #endif /* OLD_RNG */
-	static RNG* default_;
+	static NS_TLS RNG* default_;
 }; 
 
 /*
@@ -367,6 +435,9 @@ public:
 	void verbose_mil();
 	void first_n(RNG::RNGSources source, long seed, int n);
 	void first_n_mil(RNG::RNGSources source, long seed, int n, FILE *out);
+#ifndef OLD_RNG
+	void throughput(long n);
+#endif /* !OLD_RNG */
 };
 #endif /* rng_test */
 
@@ -0,0 +1,410 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * sketch-monitor.cc
+ *
+ * Count-Min, SpaceSaving and HyperLogLog summaries of the flows
+ * crossing a link; see sketch-monitor.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sketch-monitor.h"
+#include "ip.h"
+
+static class SketchMonitorClass : public TclClass {
+public:
+	SketchMonitorClass() : TclClass("QueueMonitor/Sketch") {}
+	TclObject* create(int, const char*const*) {
+		return (new SketchMonitor);
+	}
+} class_sketch_monitor;
+
+/* seeds of the three hashes of a key */
+#define SK_SEED1	0x8f1bbcdcU
+#define SK_SEED2	0xca62c1d6U
+#define SK_SEED3	0x6ed9eba1U
+
+SketchMonitor::SketchMonitor() : skip_(0), w_(0), d_(0), k_(0), b_(0),
+	alloced_(0), cm_(0), ssn_(0),
+	sskey_(0), sshash_(0), sscnt_(0), sserr_(0), ssheap_(0), sspos_(0),
+	ssidx_(0), ssisize_(0), hll_(0)
+{
+	bind("cm_width_", &cmwidth_);
+	bind("cm_depth_", &cmdepth_);
+	bind("topk_", &topk_);
+	bind("hll_bits_", &hllbits_);
+	bind_bool("ports_", &ports_);
+	bind_bool("bytes_", &bytes_);
+	bind("sample_", &sample_);
+}
+
+SketchMonitor::~SketchMonitor()
+{
+	release();
+}
+
+/* murmur3's mixing of the five words of a key */
+unsigned int SketchMonitor::hash(const SketchKey& k, unsigned int seed)
+{
+	const int32_t* w = &k.src_;
+	unsigned int h = seed;
+	for (int i = 0; i < 5; i++) {
+		unsigned int x = (unsigned int)w[i] * 0xcc9e2d51U;
+		x = (x << 15) | (x >> 17);
+		h ^= x * 0x1b873593U;
+		h = (h << 13) | (h >> 19);
+		h = h * 5 + 0xe6546b64U;
+	}
+	h ^= 20;
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return (h);
+}
+
+/*
+ * The sizes are bound variables, so the structures are made when the
+ * first packet arrives (or on "reset"), after the script set them.
+ */
+void SketchMonitor::alloc()
+{
+	if (cmwidth_ < 1)
+		cmwidth_ = 1;
+	if (cmdepth_ < 1)
+		cmdepth_ = 1;
+	if (topk_ < 1)
+		topk_ = 1;
+	if (hllbits_ < 4)
+		hllbits_ = 4;
+	if (hllbits_ > 16)
+		hllbits_ = 16;
+
+	w_ = cmwidth_;
+	d_ = cmdepth_;
+	k_ = topk_;
+	b_ = hllbits_;
+
+	cm_ = new sketchcnt_t[d_ * w_];
+	memset(cm_, 0, d_ * w_ * sizeof(sketchcnt_t));
+
+	ssn_ = 0;
+	sskey_ = new SketchKey[k_];
+	sshash_ = new unsigned int[k_];
+	sscnt_ = new sketchcnt_t[k_];
+	sserr_ = new sketchcnt_t[k_];
+	ssheap_ = new int[k_];
+	sspos_ = new int[k_];
+	for (ssisize_ = 4; ssisize_ < 2 * k_; ssisize_ *= 2)
+		;
+	ssidx_ = new int[ssisize_];
+	memset(ssidx_, 0, ssisize_ * sizeof(int));
+
+	hll_ = new unsigned char[1 << b_];
+	memset(hll_, 0, 1 << b_);
+	skip_ = 0;
+	alloced_ = 1;
+}
+
+void SketchMonitor::release()
+{
+	delete [] cm_;
+	delete [] sskey_;
+	delete [] sshash_;
+	delete [] sscnt_;
+	delete [] sserr_;
+	delete [] ssheap_;
+	delete [] sspos_;
+	delete [] ssidx_;
+	delete [] hll_;
+	cm_ = 0;
+	sskey_ = 0;
+	sshash_ = 0;
+	sscnt_ = sserr_ = 0;
+	ssheap_ = sspos_ = ssidx_ = 0;
+	hll_ = 0;
+	alloced_ = 0;
+}
+
+void SketchMonitor::in(Packet* p)
+{
+	QueueMonitor::in(p);
+	if (!alloced_)
+		alloc();
+
+	hdr_ip* iph = hdr_ip::access(p);
+	SketchKey k;
+	k.src_ = iph->saddr();
+	k.dst_ = iph->daddr();
+	k.sport_ = ports_ ? iph->sport() : 0;
+	k.dport_ = ports_ ? iph->dport() : 0;
+	k.fid_ = iph->flowid();
+
+	hlladd(hash(k, SK_SEED3));
+	if (sample_ > 1) {
+		if (skip_ > 0) {
+			skip_--;
+			return;
+		}
+		skip_ = sample_ - 1;
+	}
+	sketchcnt_t w = bytes_ ? hdr_cmn::access(p)->size() : 1;
+	if (sample_ > 1)
+		w *= sample_;
+	unsigned int h1 = hash(k, SK_SEED1);
+	cmadd(h1, hash(k, SK_SEED2), w);
+	ssadd(k, h1, w);
+}
+
+/*
+ * Count-Min: row i uses the i-th hash h1 + i * h2, which is as good as
+ * independent hashes for this purpose (Kirsch and Mitzenmacher).
+ */
+void SketchMonitor::cmadd(unsigned int h1, unsigned int h2, sketchcnt_t w)
+{
+	for (int i = 0; i < d_; i++)
+		cm_[i * w_ + (h1 + i * h2) % w_] += w;
+}
+
+sketchcnt_t SketchMonitor::cmestimate(const SketchKey& k)
+{
+	unsigned int h1 = hash(k, SK_SEED1);
+	unsigned int h2 = hash(k, SK_SEED2);
+	sketchcnt_t m = cm_[h1 % w_];
+	for (int i = 1; i < d_; i++) {
+		sketchcnt_t c = cm_[i * w_ + (h1 + i * h2) % w_];
+		if (c < m)
+			m = c;
+	}
+	return (m);
+}
+
+/*
+ * SpaceSaving (Metwally et al.): a flow in the summary adds to its
+ * count; a new flow takes the place of the one with the smallest
+ * count, inheriting that count as its error.
+ */
+void SketchMonitor::ssadd(const SketchKey& k, unsigned int h, sketchcnt_t w)
+{
+	int e = ssfind(k, h);
+	if (e >= 0) {
+		sscnt_[e] += w;
+		sssiftdown(sspos_[e]);
+		return;
+	}
+	if (ssn_ < k_) {
+		e = ssn_++;
+		sskey_[e] = k;
+		sshash_[e] = h;
+		sscnt_[e] = w;
+		sserr_[e] = 0;
+		ssheap_[e] = e;
+		sspos_[e] = e;
+		ssinsert(e);
+		sssiftup(e);
+		return;
+	}
+	e = ssheap_[0];
+	ssremove(e);
+	sserr_[e] = sscnt_[e];
+	sscnt_[e] += w;
+	sskey_[e] = k;
+	sshash_[e] = h;
+	ssinsert(e);
+	sssiftdown(0);
+}
+
+int SketchMonitor::ssfind(const SketchKey& k, unsigned int h)
+{
+	int m = ssisize_ - 1;
+	for (int i = h & m; ssidx_[i] != 0; i = (i + 1) & m) {
+		int e = ssidx_[i] - 1;
+		if (sshash_[e] == h && sskey_[e] == k)
+			return (e);
+	}
+	return (-1);
+}
+
+void SketchMonitor::ssinsert(int e)
+{
+	int m = ssisize_ - 1;
+	int i = sshash_[e] & m;
+	while (ssidx_[i] != 0)
+		i = (i + 1) & m;
+	ssidx_[i] = e + 1;
+}
+
+/* take e out of the index, moving back the entries after it */
+void SketchMonitor::ssremove(int e)
+{
+	int m = ssisize_ - 1;
+	int i = sshash_[e] & m;
+	while (ssidx_[i] != e + 1)
+		i = (i + 1) & m;
+	int j = i;
+	for (;;) {
+		j = (j + 1) & m;
+		if (ssidx_[j] == 0)
+			break;
+		int h = sshash_[ssidx_[j] - 1] & m;
+		if (i <= j ? (i < h && h <= j) : (i < h || h <= j))
+			continue;
+		ssidx_[i] = ssidx_[j];
+		i = j;
+	}
+	ssidx_[i] = 0;
+}
+
+void SketchMonitor::sssiftdown(int i)
+{
+	int e = ssheap_[i];
+	for (;;) {
+		int c = 2 * i + 1;
+		if (c >= ssn_)
+			break;
+		if (c + 1 < ssn_ && sscnt_[ssheap_[c + 1]] < sscnt_[ssheap_[c]])
+			c++;
+		if (sscnt_[ssheap_[c]] >= sscnt_[e])
+			break;
+		ssheap_[i] = ssheap_[c];
+		sspos_[ssheap_[i]] = i;
+		i = c;
+	}
+	ssheap_[i] = e;
+	sspos_[e] = i;
+}
+
+void SketchMonitor::sssiftup(int i)
+{
+	int e = ssheap_[i];
+	while (i > 0) {
+		int p = (i - 1) / 2;
+		if (sscnt_[ssheap_[p]] <= sscnt_[e])
+			break;
+		ssheap_[i] = ssheap_[p];
+		sspos_[ssheap_[i]] = i;
+		i = p;
+	}
+	ssheap_[i] = e;
+	sspos_[e] = i;
+}
+
+/* HyperLogLog (Flajolet et al.) */
+void SketchMonitor::hlladd(unsigned int h)
+{
+	unsigned int j = h >> (32 - b_);
+	unsigned int w = h << b_;
+	unsigned char r = 1;
+	while (r <= 32 - b_ && (w & 0x80000000U) == 0) {
+		r++;
+		w <<= 1;
+	}
+	if (r > hll_[j])
+		hll_[j] = r;
+}
+
+double SketchMonitor::hllestimate()
+{
+	int m = 1 << b_;
+	double alpha;
+	switch (m) {
+	case 16:
+		alpha = 0.673;
+		break;
+	case 32:
+		alpha = 0.697;
+		break;
+	case 64:
+		alpha = 0.709;
+		break;
+	default:
+		alpha = 0.7213 / (1 + 1.079 / m);
+		break;
+	}
+	double sum = 0;
+	int zeros = 0;
+	for (int j = 0; j < m; j++) {
+		sum += ldexp(1.0, -hll_[j]);
+		if (hll_[j] == 0)
+			zeros++;
+	}
+	double e = alpha * m * m / sum;
+	const double two32 = 4294967296.0;
+	if (e <= 2.5 * m && zeros > 0)
+		e = m * log((double)m / zeros);		// linear counting
+	else if (e > two32 / 30)
+		e = -two32 * log(1 - e / two32);
+	return (e);
+}
+
+int SketchMonitor::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "clear") == 0) {
+			// called by "reset"; takes the sizes anew
+			release();
+			alloc();
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "cardinality") == 0) {
+			tcl.resultf("%.0f", alloced_ ? hllestimate() : 0.0);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "topk") == 0) {
+			// heaviest first
+			int* order = new int[ssn_];
+			int i, n = 0;
+			for (i = 0; i < ssn_; i++) {
+				int j = n++;
+				while (j > 0 &&
+				       sscnt_[order[j - 1]] < sscnt_[i]) {
+					order[j] = order[j - 1];
+					j--;
+				}
+				order[j] = i;
+			}
+			tcl.result("");
+			for (i = 0; i < n; i++) {
+				int e = order[i];
+				char buf[128];
+				sprintf(buf, "%d %d %d %d %d " SKETCHCNT_FMTSTR
+					" " SKETCHCNT_FMTSTR, sskey_[e].src_,
+					sskey_[e].sport_, sskey_[e].dst_,
+					sskey_[e].dport_, sskey_[e].fid_,
+					sscnt_[e], sserr_[e]);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			delete [] order;
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "memory") == 0) {
+			// bytes held by the three summaries
+			long n = (long)d_ * w_ * sizeof(sketchcnt_t) +
+				k_ * (sizeof(SketchKey) + sizeof(unsigned int)
+					 + 2 * sizeof(sketchcnt_t)
+					 + 2 * sizeof(int)) +
+				ssisize_ * sizeof(int) + (1 << b_);
+			tcl.resultf("%ld", alloced_ ? n : 0L);
+			return (TCL_OK);
+		}
+	} else if (argc == 7) {
+		/* $sk estimate $src $sport $dst $dport $fid */
+		if (strcmp(argv[1], "estimate") == 0) {
+			SketchKey k;
+			k.src_ = atoi(argv[2]);
+			k.sport_ = ports_ ? atoi(argv[3]) : 0;
+			k.dst_ = atoi(argv[4]);
+			k.dport_ = ports_ ? atoi(argv[5]) : 0;
+			k.fid_ = atoi(argv[6]);
+			tcl.resultf(SKETCHCNT_FMTSTR,
+				    alloced_ ? cmestimate(k) : (sketchcnt_t)0);
+			return (TCL_OK);
+		}
+	}
+	return (QueueMonitor::command(argc, argv));
+}
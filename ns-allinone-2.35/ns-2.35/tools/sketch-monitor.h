@@ -0,0 +1,112 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * sketch-monitor.h
+ *
+ * QueueMonitor/Sketch: per-flow estimates in fixed memory.
+ *
+ * A FlowMon keeps exact state for every flow it sees, which is more
+ * than a backbone with a monitor on every link can afford.  A
+ * SketchMonitor is a QueueMonitor (the aggregate counters are kept as
+ * usual) that also summarizes the arrivals of each flow (5-tuple, or
+ * src, dst, fid with ports_ false) in three structures whose size is
+ * fixed when the first packet arrives:
+ *
+ *  - a Count-Min sketch of cm_depth_ rows of cm_width_ counters, which
+ *    overestimates any flow's count by at most e/cm_width_ of the
+ *    total, with probability 1 - exp(-cm_depth_);
+ *  - a SpaceSaving summary of the topk_ heaviest flows, whose counts
+ *    are overestimated by at most their err;
+ *  - a HyperLogLog counter with 2^hll_bits_ registers of the number of
+ *    distinct flows, to within about 1.04/sqrt(2^hll_bits_).
+ *
+ * Counts are in bytes, or packets with bytes_ false.  With sample_ N >
+ * 1, only one arrival in N is counted, with weight N, by the first two;
+ * the HyperLogLog counter sees every packet.
+ *
+ *	set sk [$ns monitor-sketch $n1 $n2]
+ *	...
+ *	$sk estimate $src $sport $dst $dport $fid
+ *	$sk topk		;# {src sport dst dport fid count err} ...
+ *	$sk cardinality
+ */
+
+#ifndef ns_sketch_monitor_h
+#define ns_sketch_monitor_h
+
+#include "queue-monitor.h"
+
+#if defined(HAVE_INT64)
+typedef int64_t sketchcnt_t;
+#define SKETCHCNT_FMTSTR	STRTOI64_FMTSTR
+#else /* no 64-bit integer */
+typedef int sketchcnt_t;
+#define SKETCHCNT_FMTSTR	"%d"
+#endif
+
+struct SketchKey {
+	int32_t src_;
+	int32_t sport_;
+	int32_t dst_;
+	int32_t dport_;
+	int32_t fid_;
+	int operator==(const SketchKey& k) const {
+		return (src_ == k.src_ && sport_ == k.sport_ &&
+			dst_ == k.dst_ && dport_ == k.dport_ &&
+			fid_ == k.fid_);
+	}
+};
+
+class SketchMonitor : public QueueMonitor {
+public:
+	SketchMonitor();
+	~SketchMonitor();
+	void in(Packet*);
+protected:
+	int command(int argc, const char*const* argv);
+	static unsigned int hash(const SketchKey& k, unsigned int seed);
+	void alloc();
+	void release();
+
+	/* Count-Min */
+	void cmadd(unsigned int h1, unsigned int h2, sketchcnt_t w);
+	sketchcnt_t cmestimate(const SketchKey& k);
+
+	/* SpaceSaving */
+	void ssadd(const SketchKey& k, unsigned int h, sketchcnt_t w);
+	int ssfind(const SketchKey& k, unsigned int h);
+	void ssinsert(int e);
+	void ssremove(int e);
+	void sssiftdown(int i);
+	void sssiftup(int i);
+
+	/* HyperLogLog */
+	void hlladd(unsigned int h);
+	double hllestimate();
+
+	int cmwidth_;		// cm_width_
+	int cmdepth_;		// cm_depth_
+	int topk_;
+	int hllbits_;		// hll_bits_
+	int ports_;
+	int bytes_;
+	int sample_;
+	int skip_;		// arrivals until the next counted one
+	int w_, d_, k_, b_;	// the sizes in use, set by alloc()
+
+	int alloced_;
+	sketchcnt_t* cm_;	// d_ rows of w_ counters
+
+	int ssn_;		// entries in use, up to k_
+	SketchKey* sskey_;
+	unsigned int* sshash_;
+	sketchcnt_t* sscnt_;
+	sketchcnt_t* sserr_;
+	int* ssheap_;		// min-heap of entries by count
+	int* sspos_;		// entry's place in ssheap_
+	int* ssidx_;		// open-addressing index: entry + 1, or 0
+	int ssisize_;		// a power of 2, at least twice k_
+
+	unsigned char* hll_;
+};
+
+#endif
@@ -36,6 +36,7 @@
 
 #include "basetrace.h"
 #include "tcp.h"
+#include "parallel.h"
 
 class BaseTraceClass : public TclClass {
 public:
@@ -79,7 +80,10 @@ void BaseTrace::dump()
 		wrk_[n + 1] = 0;
  /* -NEW- */
 		//printf("%s",wrk_);
-		(void)Tcl_Write(channel_, wrk_, n + 1);
+		if (ParallelScheduler::buffered())
+			ParallelScheduler::buffer(channel_, wrk_, n + 1);
+		else
+			(void)Tcl_Write(channel_, wrk_, n + 1);
 
  /* END -NEW- */
 		//Tcl_Flush(channel_);
@@ -106,7 +110,10 @@ void BaseTrace::namdump()
 		 */
 		nwrk_[n] = '\n';
 		nwrk_[n + 1] = 0;
-		(void)Tcl_Write(namChan_, nwrk_, n + 1);
+		if (ParallelScheduler::buffered())
+			ParallelScheduler::buffer(namChan_, nwrk_, n + 1);
+		else
+			(void)Tcl_Write(namChan_, nwrk_, n + 1);
 		//Tcl_Flush(channel_);
 		nwrk_[n] = 0;
 	}
@@ -188,27 +188,26 @@ int
 Trace::get_seqno(Packet* p)
 {
 	hdr_cmn *th = hdr_cmn::access(p);
-	hdr_tcp *tcph = hdr_tcp::access(p);
-	hdr_rtp *rh = hdr_rtp::access(p);
-        hdr_rap *raph = hdr_rap::access(p);
-	hdr_tfrc *tfrch = hdr_tfrc::access(p);
-	hdr_tfrc_ack *tfrch_ack = hdr_tfrc_ack::access(p);
 	packet_t t = th->ptype();
 	int seqno;
 
+	/*
+	 * Only the header of the packet's own type is touched, so a
+	 * simulation may leave the others out of its packet format.
+	 */
 	/* UDP's now have seqno's too */
 	if (t == PT_RTP || t == PT_CBR || t == PT_UDP || t == PT_EXP ||
 	    t == PT_PARETO)
-		seqno = rh->seqno();
+		seqno = hdr_rtp::access(p)->seqno();
         else if (t == PT_RAP_DATA || t == PT_RAP_ACK)
-                seqno = raph->seqno();
+                seqno = hdr_rap::access(p)->seqno();
 	else if (t == PT_TCP || t == PT_ACK || t == PT_HTTP || t == PT_FTP ||
 	    t == PT_TELNET || t == PT_XCP)
-		seqno = tcph->seqno();
+		seqno = hdr_tcp::access(p)->seqno();
 	else if (t == PT_TFRC)
-		seqno = tfrch->seqno;
+		seqno = hdr_tfrc::access(p)->seqno;
 	else if (t == PT_TFRC_ACK)
-                seqno = tfrch_ack->seqno;
+                seqno = hdr_tfrc_ack::access(p)->seqno;
 	else
 		seqno = -1;
  	return seqno;
@@ -220,17 +219,16 @@ void Trace::format(int tt, int s, int d, Packet* p)
 {
 	hdr_cmn *th = hdr_cmn::access(p);
 	hdr_ip *iph = hdr_ip::access(p);
-	hdr_tcp *tcph = hdr_tcp::access(p);
-	hdr_sctp *sctph = hdr_sctp::access(p);
-	hdr_srm *sh = hdr_srm::access(p); 
 
 	const char* sname = "null";
 
 	packet_t t = th->ptype();
 	const char* name = packet_info.name(t);
 
-        /* SRM-specific */
-	if (strcmp(name,"SRM") == 0 || strcmp(name,"cbr") == 0 || strcmp(name,"udp") == 0) {
+        /* SRM-specific; a header left out of the packet format is unset */
+	if ((strcmp(name,"SRM") == 0 || strcmp(name,"cbr") == 0 || strcmp(name,"udp") == 0) &&
+	    hdr_srm::offset() >= 0) {
+	    hdr_srm *sh = hdr_srm::access(p);
             if ( sh->type() < 5 && sh->type() > 0 ) {
 	        sname = srm_names[sh->type()];
 	    }
@@ -288,6 +286,7 @@ void Trace::format(int tt, int s, int d, Packet* p)
 			dst_portaddr,
 			seqno,flags,sname);
 	} else if (show_sctphdr_ && t == PT_SCTP) {
+		hdr_sctp *sctph = hdr_sctp::access(p);
 		double timestamp;
 		timestamp = Scheduler::instance().clock();
 		
@@ -355,7 +354,9 @@ void Trace::format(int tt, int s, int d, Packet* p)
 			if(i < sctph->NumChunks() - 1)
 				pt_->dump();
 		}
-	} else if (!show_tcphdr_) {
+	} else if (!show_tcphdr_ || hdr_tcp::offset() < 0) {
+		/* show_tcphdr_ prints the TCP header of every packet, if
+		   the packet format has one */
 		sprintf(pt_->buffer(), "%c "TIME_FORMAT" %d %d %s %d %s %d %s.%s %s.%s %d %d",
 			tt,
 			pt_->round(Scheduler::instance().clock()),
@@ -376,6 +377,7 @@ void Trace::format(int tt, int s, int d, Packet* p)
 			seqno,
 			th->uid() /* was p->uid_ */);
 	} else {
+		hdr_tcp *tcph = hdr_tcp::access(p);
 		sprintf(pt_->buffer(), 
 			"%c "TIME_FORMAT" %d %d %s %d %s %d %s.%s %s.%s %d %d %d 0x%x %d %d",
 			tt,
@@ -514,13 +516,14 @@ DequeTrace::recv(Packet* p, Handler* h)
 	    (pt_->tagged() && pt_->channel() !=0)) {
 		hdr_cmn *th = hdr_cmn::access(p);
 		hdr_ip *iph = hdr_ip::access(p);
-		hdr_srm *sh = hdr_srm::access(p);
 		const char* sname = "null";   
 
 		packet_t t = th->ptype();
 		const char* name = packet_info.name(t);
 		
-		if (strcmp(name,"SRM") == 0 || strcmp(name,"cbr") == 0 || strcmp(name,"udp") == 0) {
+		if ((strcmp(name,"SRM") == 0 || strcmp(name,"cbr") == 0 || strcmp(name,"udp") == 0) &&
+		    hdr_srm::offset() >= 0) {
+		    hdr_srm *sh = hdr_srm::access(p);
 		    if ( sh->type() < 5 && sh->type() > 0  ) {
 		        sname = srm_names[sh->type()];
 		    }
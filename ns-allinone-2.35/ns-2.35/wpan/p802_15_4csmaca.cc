@@ -196,7 +196,7 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 	{
 		if (mac->macBeaconOrder2 != 15)
 		{
-			BI2 = mac->sfSpec2.BI / phy->getRate('s');
+			BI2 = phy->symTime(mac->sfSpec2.BI);
 			
 			/* Linux floating number compatibility
 			t_CAP = (UINT_16)((mac->macBcnRxTime + (mac->sfSpec2.FinCAP + 1) * mac->sfSpec2.sd ) / phy->getRate('s'));
@@ -205,7 +205,7 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 			double tmpf;
 			tmpf = (mac->sfSpec2.FinCAP + 1) * mac->sfSpec2.sd;
 			tmpf += mac->macBcnRxTime;
-			t_CAP = (UINT_16)(tmpf / phy->getRate('s'));
+			t_CAP = (UINT_16)phy->symTime(tmpf);
 			}
 
 			/* Linux floating number compatibility
@@ -273,12 +273,12 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 	}
 
 	//calculate the time needed to finish the transaction
-	t_CCATime = 8 / phy->getRate('s');
+	t_CCATime = phy->symTime(8);
 	if (HDR_CMN(txPkt)->size() <= aMaxSIFSFrameSize)
 		t_IFS = aMinSIFSPeriod;
 	else
 		t_IFS = aMinLIFSPeriod;
-	t_IFS /= phy->getRate('s');
+	t_IFS = phy->symTime(t_IFS);
 	t_transacTime  = mac->locateBoundary(mac->toParent(txPkt),wtime) - wtime;				//boundary location time -- should be 0 here, since we have already located the boundary
 	if (!afterCCA)
 	{
@@ -290,7 +290,7 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 	t_transacTime += phy->trxTime(txPkt);									//packet transmission time
 	if (ackReq)
 	{
-		t_transacTime += mac->mpib.macAckWaitDuration/phy->getRate('s');				//ack. waiting time (this value does not include round trip propagation delay)
+		t_transacTime += phy->symTime(mac->mpib.macAckWaitDuration);				//ack. waiting time (this value does not include round trip propagation delay)
 		t_transacTime += 2*max_pDelay;									//round trip propagation delay (802.15.4 ignores this, but it should be there even though it is very small)
 		t_transacTime += t_IFS;										//IFS time -- not only ensure that the sender can finish the transaction, but also the receiver
 		t_fCAP = mac->getCAP(true);
@@ -324,7 +324,7 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 		{
 			t_fCAP = mac->getCAPbyType(2);
 			t_transacTime += max_pDelay;						//one-way trip propagation delay (802.15.4 ignores this, but it should be there even though it is very small)
-			t_transacTime += 12/phy->getRate('s');					//transceiver turn-around time (receiver may need to do this to transmit next beacon)
+			t_transacTime += phy->symTime(12);					//transceiver turn-around time (receiver may need to do this to transmit next beacon)
 			t_transacTime += t_IFS;							//IFS time -- not only ensure that the sender can finish the transaction, but also the receiver
 
 			/* Linux floating number compatibility
@@ -366,11 +366,11 @@ bool CsmaCA802_15_4::canProceed(double wtime, bool afterCCA)
 			{
 			double tmpf;
 			tmpf = (mac->macBcnOtherRxTime + mac->sfSpec3.BI);
-			bcnOtherTime = tmpf / phy->getRate('s');
+			bcnOtherTime = phy->symTime(tmpf);
 			}
 
 			while (bcnOtherTime < CURRENT_TIME)
-				bcnOtherTime += (mac->sfSpec3.BI / phy->getRate('s'));
+				bcnOtherTime += phy->symTime(mac->sfSpec3.BI);
 			bcnOtherT->start(bcnOtherTime - CURRENT_TIME);
 		}
 #ifdef DEBUG802_15_4
@@ -460,7 +460,7 @@ void CsmaCA802_15_4::start(bool firsttime,Packet *pkt,bool ackreq)
 			bcnTxTime = mac->macBcnTxTime / rate;
 			bcnRxTime = mac->macBcnRxTime / rate;
 			//it's possible we missed some beacons
-			BI2 = (mac->sfSpec2.BI / phy->getRate('s'));
+			BI2 = phy->symTime(mac->sfSpec2.BI);
 			if (mac->macBeaconOrder2 != 15)
 			while (bcnRxTime + BI2 < CURRENT_TIME)
 				bcnRxTime += BI2;
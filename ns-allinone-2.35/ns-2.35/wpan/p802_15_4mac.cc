@@ -1702,7 +1702,7 @@ void Mac802_15_4::recvData(Packet *p)
 			ifs = aMinSIFSPeriod;
 		else
 			ifs = aMinLIFSPeriod;
-		Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), ifs/phy->getRate('s'));
+		Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), phy->symTime(ifs));
 	}
 	//else	//schedule and dispatch after finishing ack. transmission
 }
@@ -1746,8 +1746,8 @@ double Mac802_15_4::locateBoundary(bool parent,double wtime)
 	else				
 		align = (mpib.macBeaconOrder == 15)?2:1;
 
-	bcnTxRxTime = (align == 1)?(macBcnTxTime / phy->getRate('s')):(macBcnRxTime / phy->getRate('s'));
-	bPeriod = aUnitBackoffPeriod / phy->getRate('s');
+	bcnTxRxTime = (align == 1)?phy->symTime(macBcnTxTime):phy->symTime(macBcnRxTime);
+	bPeriod = phy->symTime(aUnitBackoffPeriod);
 
 	/* Linux floating number compatibility
 	   newtime = fmod(CURRENT_TIME + wtime - bcnTxRxTime, bPeriod);
@@ -2222,7 +2222,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 					ifs = aMinSIFSPeriod;
 				else
 					ifs = aMinLIFSPeriod;
-				Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), ifs/phy->getRate('s'));
+				Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), phy->symTime(ifs));
 				resetTRX();
 				taskSuccess('a');
 			}
@@ -2233,7 +2233,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 					ifs = aMinSIFSPeriod;
 				else
 					ifs = aMinLIFSPeriod;
-				Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), ifs/phy->getRate('s'));
+				Scheduler::instance().schedule(&IFSH, &(IFSH.nullEvent), phy->symTime(ifs));
 				resetTRX();
 				taskSuccess('a');
 			}
@@ -2254,7 +2254,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 			{
 				//enable the receiver
 				plme_set_trx_state_request(p_RX_ON);
-				txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+				txT->start(phy->symTime(mpib.macAckWaitDuration));
 				waitBcnCmdAck = true;
 			}
 			else		//assume success if ack. not required
@@ -2289,7 +2289,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 				{
 					//enable the receiver
 					plme_set_trx_state_request(p_RX_ON);
-					txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+					txT->start(phy->symTime(mpib.macAckWaitDuration));
 					waitBcnCmdAck2 = true;
 				}
 				else		//assume success if ack. not required
@@ -2324,7 +2324,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 						strcpy(taskP.taskFrFunc(TP_mcps_data_request),"recvAck");
 						//enable the receiver
 						plme_set_trx_state_request(p_RX_ON);
-						txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+						txT->start(phy->symTime(mpib.macAckWaitDuration));
 						waitDataAck = true;
 					}
 				}
@@ -2337,7 +2337,7 @@ void Mac802_15_4::dispatch(PHYenum status,const char *frFunc,PHYenum req_state,M
 				{
 					//enable the receiver
 					plme_set_trx_state_request(p_RX_ON);
-					txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+					txT->start(phy->symTime(mpib.macAckWaitDuration));
 					waitDataAck = true;
 				}
 				else		//assume success if ack. not required
@@ -2756,7 +2756,7 @@ void Mac802_15_4::mcps_data_request(UINT_8 SrcAddrMode,UINT_16 SrcPANId,IE3ADDR
 					   */
 					{
 						double tmpf;
-						tmpf = (aBaseSuperframeDuration * (1 << mpib.macBeaconOrder) / phy->getRate('s'));
+						tmpf = phy->symTime(aBaseSuperframeDuration * (1 << mpib.macBeaconOrder));
 						kpTime = mpib.macTransactionPersistenceTime * tmpf;		
 					}
 
@@ -2870,7 +2870,7 @@ void Mac802_15_4::mcps_data_request(UINT_8 SrcAddrMode,UINT_16 SrcPANId,IE3ADDR
 					strcpy(taskP.taskFrFunc(task),"recvAck");
 					//enable the receiver
 					plme_set_trx_state_request(p_RX_ON);
-					txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+					txT->start(phy->symTime(mpib.macAckWaitDuration));
 					waitDataAck = true;
 				}
 				else		//assume success if ack. not required
@@ -3001,7 +3001,7 @@ void Mac802_15_4::mlme_associate_request(UINT_8 LogicalChannel,UINT_8 CoordAddrM
 			taskP.taskStep(task)++;
 			strcpy(taskP.taskFrFunc(task),"recvAck");
 			plme_set_trx_state_request(p_RX_ON);	//waiting for ack.
-			txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+			txT->start(phy->symTime(mpib.macAckWaitDuration));
 			waitBcnCmdAck2 = true;
 			break;
 		case 3:
@@ -3013,7 +3013,7 @@ void Mac802_15_4::mlme_associate_request(UINT_8 LogicalChannel,UINT_8 CoordAddrM
 				if (Mac802_15_4::verbose)
 					fprintf(stdout,"[%f](node %d) ack for association request command received\n",CURRENT_TIME,index_);
 				taskSuccess('C',false);
-				extractT->start(aResponseWaitTime/phy->getRate('s'),false);
+				extractT->start(phy->symTime(aResponseWaitTime),false);
 			}
 			else				//time out when waiting for ack.
 			{
@@ -3076,7 +3076,7 @@ void Mac802_15_4::mlme_associate_request(UINT_8 LogicalChannel,UINT_8 CoordAddrM
 			strcpy(taskP.taskFrFunc(task),"recvAck");
 			//enable the receiver
 			plme_set_trx_state_request(p_RX_ON);
-			txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+			txT->start(phy->symTime(mpib.macAckWaitDuration));
 			waitBcnCmdAck2 = true;
 			break;
 		case 6:
@@ -3088,7 +3088,7 @@ void Mac802_15_4::mlme_associate_request(UINT_8 LogicalChannel,UINT_8 CoordAddrM
 				if (Mac802_15_4::verbose)
 					fprintf(stdout,"[%f](node %d) ack for data request command received\n",CURRENT_TIME,index_);
 				taskSuccess('C',false);
-				extractT->start(aResponseWaitTime/phy->getRate('s'),false);	//compare: for normal data, wait for <aMaxFrameResponseTime> symbols (or CAP symbols if beacon enabled) (see page 156, line 1-3)
+				extractT->start(phy->symTime(aResponseWaitTime),false);	//compare: for normal data, wait for <aMaxFrameResponseTime> symbols (or CAP symbols if beacon enabled) (see page 156, line 1-3)
 			}
 			else				//time out when waiting for ack.
 			{
@@ -3206,7 +3206,7 @@ void Mac802_15_4::mlme_associate_response(IE3ADDR DeviceAddress,UINT_16 AssocSho
 			*((UINT_16 *)wph->MSDU_Payload) = AssocShortAddress;
 			*((MACenum *)(wph->MSDU_Payload + 2)) = Status;
 			constructMPDU(4,rspPkt,frmCtrl.FrmCtrl,mpib.macDSN++,wph->MHR_DstAddrInfo,wph->MHR_SrcAddrInfo,0,0x02,0);
-			kpTime = (2 * aResponseWaitTime) / phy->getRate('s');
+			kpTime = phy->symTime(2 * aResponseWaitTime);
 			i = chkAddTransacLink(&transacLink1,&transacLink2,defFrmCtrl_AddrMode64,DeviceAddress,rspPkt,0,kpTime);
 			if (i != 0)	//overflow or failed
 			{
@@ -3316,7 +3316,7 @@ constructCommandHeader(txBcnCmd2,&frmCtrl,0x03,defFrmCtrl_AddrMode64,mpib.macPAN
 	//kpTime = mpib.macTransactionPersistenceTime * (aBaseSuperframeDuration * (1 << mpib.macBeaconOrder) / phy->getRate('s'));
 	{
 	double tmpf;
-	tmpf = (aBaseSuperframeDuration * (1 << mpib.macBeaconOrder) / phy->getRate('s'));
+	tmpf = phy->symTime(aBaseSuperframeDuration * (1 << mpib.macBeaconOrder));
 	kpTime = mpib.macTransactionPersistenceTime * tmpf;
 	}
 
@@ -3527,9 +3527,9 @@ void Mac802_15_4::mlme_rx_enable_request(bool DeferPermit,UINT_32 RxOnTime,UINT_
 				   */
 				{
 					double tmpf2;
-					tmpf = macBcnRxTime / phy->getRate('s');
+					tmpf = phy->symTime(macBcnRxTime);
 					tmpf = CURRENT_TIME - tmpf;
-					tmpf2 = RxOnTime / phy->getRate('s');
+					tmpf2 = phy->symTime(RxOnTime);
 					tmpf = tmpf2 - tmpf;
 					rxEnableT->start(tmpf);
 				}
@@ -3550,13 +3550,13 @@ void Mac802_15_4::mlme_rx_enable_request(bool DeferPermit,UINT_32 RxOnTime,UINT_
 					sscs->MLME_RX_ENABLE_confirm(m_SUCCESS);
 				//turn off the receiver before the CFP so as not to disturb it, and we see no reason to turn it on again after the CFP (i.e., inactive port of the superframe)
 				t_CAP = (sfSpec2.FinCAP + 1) * sfSpec2.sd;
-				cutTime = (RxOnTime + RxOnDuration - t_CAP) / phy->getRate('s');
+				cutTime = phy->symTime(RxOnTime + RxOnDuration - t_CAP);
 
 				/* Linux floating number compatibility
 				   rxEnableT->start(RxOnDuration / phy->getRate('s') - (CURRENT_TIME - taskP.mlme_rx_enable_request_currentTime) - cutTime);
 				   */
 				{
-					tmpf = RxOnDuration / phy->getRate('s');
+					tmpf = phy->symTime(RxOnDuration);
 					tmpf -= CURRENT_TIME;
 					tmpf += taskP.mlme_rx_enable_request_currentTime;
 					tmpf -= cutTime;
@@ -3595,7 +3595,7 @@ void Mac802_15_4::mlme_rx_enable_request(bool DeferPermit,UINT_32 RxOnTime,UINT_
 				   rxEnableT->start(RxOnDuration / phy->getRate('s') - (CURRENT_TIME - taskP.mlme_rx_enable_request_currentTime));
 				   */
 				{
-					tmpf = RxOnDuration / phy->getRate('s');
+					tmpf = phy->symTime(RxOnDuration);
 					tmpf -= CURRENT_TIME;
 					tmpf += taskP.mlme_rx_enable_request_currentTime;
 					rxEnableT->start(tmpf);
@@ -3826,7 +3826,7 @@ void Mac802_15_4::mlme_scan_request(UINT_8 ScanType,UINT_32 ScanChannels,UINT_8
 						taskP.taskStep(task)++;
 						strcpy(taskP.taskFrFunc(task),"recvBeacon");
 						//schedule for next channel
-						scanT->start((aBaseSuperframeDuration * ((1 << taskP.mlme_scan_request_ScanDuration) + 1)) / phy->getRate('s'));
+						scanT->start(phy->symTime(aBaseSuperframeDuration * ((1 << taskP.mlme_scan_request_ScanDuration) + 1)));
 						break;
 					}
 					//else	//fall through case 7
@@ -3991,7 +3991,7 @@ void Mac802_15_4::mlme_scan_request(UINT_8 ScanType,UINT_32 ScanChannels,UINT_8
 					{
 						taskP.taskStep(task)++;
 						strcpy(taskP.taskFrFunc(task),"IFSHandler");
-						scanT->start(aResponseWaitTime / phy->getRate('s'));
+						scanT->start(phy->symTime(aResponseWaitTime));
 						break;
 					}
 					//else	//fall through case 6
@@ -4233,7 +4233,7 @@ void Mac802_15_4::mlme_sync_request(UINT_8 LogicalChannel, bool TrackBeacon,bool
 			BO = (macBeaconOrder2 == 15)?14:macBeaconOrder2;
 			if (bcnSearchT->busy())
 				bcnSearchT->stop();
-			bcnSearchT->start(aBaseSuperframeDuration*((1 << BO)+1) / phy->getRate('s'));
+			bcnSearchT->start(phy->symTime(aBaseSuperframeDuration*((1 << BO)+1)));
 			break;
 		case 1:
 			if (status == p_SUCCESS)	//beacon received
@@ -4257,7 +4257,7 @@ void Mac802_15_4::mlme_sync_request(UINT_8 LogicalChannel, bool TrackBeacon,bool
 				{
 					plme_set_trx_state_request(p_RX_ON);
 					BO = (macBeaconOrder2 == 15)?14:macBeaconOrder2;
-					bcnSearchT->start(aBaseSuperframeDuration*((1 << BO)+1) / phy->getRate('s'));
+					bcnSearchT->start(phy->symTime(aBaseSuperframeDuration*((1 << BO)+1)));
 				}
 				else
 				{
@@ -4368,7 +4368,7 @@ void Mac802_15_4::mlme_poll_request(UINT_8 CoordAddrMode,UINT_16 CoordPANId,IE3A
 			strcpy(taskP.taskFrFunc(task),"recvAck");
 			//enable the receiver
 			plme_set_trx_state_request(p_RX_ON);
-			txT->start(mpib.macAckWaitDuration/phy->getRate('s'));
+			txT->start(phy->symTime(mpib.macAckWaitDuration));
 			waitBcnCmdAck2 = true;
 			break;
 		case 3:
@@ -4389,7 +4389,7 @@ void Mac802_15_4::mlme_poll_request(UINT_8 CoordAddrMode,UINT_16 CoordPANId,IE3A
 					strcpy(taskP.taskFrFunc(task),"IFSHandler");
 					plme_set_trx_state_request(p_RX_ON);		//wait for data
 					taskSuccess('C',false);
-					extractT->start(aMaxFrameResponseTime/phy->getRate('s'),true);	//wait for <aMaxFrameResponseTime> symbols (or CAP symbols if beacon enabled) (see page 156, line 1-3)
+					extractT->start(phy->symTime(aMaxFrameResponseTime),true);	//wait for <aMaxFrameResponseTime> symbols (or CAP symbols if beacon enabled) (see page 156, line 1-3)
 				}
 			}
 			else				//time out when waiting for ack.
@@ -4547,14 +4547,14 @@ double Mac802_15_4::getCAP(bool small)
 			&&(macBeaconOrder3 == 15))								//no beacons from outside PAN
 		return oneDay;									//transmission can always go ahead
 
-	bcnTxTime = macBcnTxTime / phy->getRate('s');
-	bcnRxTime = macBcnRxTime / phy->getRate('s');
-	bcnOtherRxTime = macBcnOtherRxTime / phy->getRate('s');
-	sSlotDuration = sfSpec.sd / phy->getRate('s');
-	sSlotDuration2 = sfSpec2.sd / phy->getRate('s');
-	sSlotDuration3 = sfSpec3.sd / phy->getRate('s');
-	BI2 = (sfSpec2.BI / phy->getRate('s'));
-	BI3 = (sfSpec3.BI / phy->getRate('s'));
+	bcnTxTime = phy->symTime(macBcnTxTime);
+	bcnRxTime = phy->symTime(macBcnRxTime);
+	bcnOtherRxTime = phy->symTime(macBcnOtherRxTime);
+	sSlotDuration = phy->symTime(sfSpec.sd);
+	sSlotDuration2 = phy->symTime(sfSpec2.sd);
+	sSlotDuration3 = phy->symTime(sfSpec3.sd);
+	BI2 = phy->symTime(sfSpec2.BI);
+	BI3 = phy->symTime(sfSpec3.BI);
 	if (mpib.macBeaconOrder != 15)
 	{
 		if (sfSpec.BLE)
@@ -4679,14 +4679,14 @@ double Mac802_15_4::getCAPbyType(int type)
 			&&(macBeaconOrder3 == 15))								//no beacons from outside PAN
 		return oneDay;									//transmission can always go ahead
 
-	bcnTxTime = macBcnTxTime / phy->getRate('s');
-	bcnRxTime = macBcnRxTime / phy->getRate('s');
-	bcnOtherRxTime = macBcnOtherRxTime / phy->getRate('s');
-	sSlotDuration = sfSpec.sd / phy->getRate('s');
-	sSlotDuration2 = sfSpec2.sd / phy->getRate('s');
-	sSlotDuration3 = sfSpec3.sd / phy->getRate('s');
-	BI2 = (sfSpec2.BI / phy->getRate('s'));
-	BI3 = (sfSpec3.BI / phy->getRate('s'));
+	bcnTxTime = phy->symTime(macBcnTxTime);
+	bcnRxTime = phy->symTime(macBcnRxTime);
+	bcnOtherRxTime = phy->symTime(macBcnOtherRxTime);
+	sSlotDuration = phy->symTime(sfSpec.sd);
+	sSlotDuration2 = phy->symTime(sfSpec2.sd);
+	sSlotDuration3 = phy->symTime(sfSpec3.sd);
+	BI2 = phy->symTime(sfSpec2.BI);
+	BI3 = phy->symTime(sfSpec3.BI);
 
 	if (type == 1)
 	{
@@ -4821,12 +4821,12 @@ bool Mac802_15_4::canProceedWOcsmaca(Packet *p)
 			t_IFS = aMinSIFSPeriod;
 		else
 			t_IFS = aMinLIFSPeriod;
-		t_IFS /= phy->getRate('s');
+		t_IFS = phy->symTime(t_IFS);
 		t_transacTime  = locateBoundary(toParent(p),wtime) - wtime;			//boundary location time
 		t_transacTime += phy->trxTime(p);						//packet transmission time
 		if (frmCtrl.ackReq)
 		{
-			t_transacTime += mpib.macAckWaitDuration/phy->getRate('s');		//ack. waiting time
+			t_transacTime += phy->symTime(mpib.macAckWaitDuration);		//ack. waiting time
 			t_transacTime += 2*max_pDelay;						//round trip propagation delay (802.15.4 ignores this, but it should be there even though it is very small)
 			t_transacTime += t_IFS;							//IFS time -- not only ensure that the sender can finish the transaction, but also the receiver
 			t_CAP = getCAP(true);
@@ -4855,7 +4855,7 @@ bool Mac802_15_4::canProceedWOcsmaca(Packet *p)
 				return false;
 			t_CAP = getCAPbyType(2);
 			t_transacTime += max_pDelay;						//one-way trip propagation delay (802.15.4 ignores this, but it should be there even though it is very small)
-			t_transacTime += 12/phy->getRate('s');					//transceiver turn-around time (receiver may need to do this to transmit next beacon)
+			t_transacTime += phy->symTime(12);					//transceiver turn-around time (receiver may need to do this to transmit next beacon)
 			t_transacTime += t_IFS;							//IFS time -- not only ensure that the sender can finish the transaction, but also the receiver
 
 			/* Linux floating number compatibility
@@ -135,6 +135,22 @@ Phy802_15_4::Phy802_15_4(PHY_PIB *pp)
 	}
 	mac = 0;
 	T_transition_local_ = T_transition_; // 2.31 change: set local variable since WirelessPhy::T_transition_ is not visible to CsmaCA802_15_4
+	buildTimes();
+}
+
+//the tables hold exactly what trxTime() and symTime() used to divide
+//out per call; they belong to this PHY and are rebuilt when its channel
+//(and so its band's rates) changes
+void Phy802_15_4::buildTimes(void)
+{
+	double brate = getRate('d');
+	double srate = getRate('s');
+	int i;
+
+	for (i=0;i<WPAN_TRXTAB;i++)
+		trxTab[i] = i * 8 / brate;
+	for (i=0;i<WPAN_SYMTAB;i++)
+		symTab[i] = i / srate;
 }
 
 void Phy802_15_4::macObj(Mac802_15_4 *m)
@@ -177,13 +193,23 @@ double Phy802_15_4::getRate(char dataOrSymbol)
 
 double Phy802_15_4::trxTime(Packet *p,bool phyPkt)
 {
-	int phyHeaderLen;
-	double trx;
+	int phyHeaderLen,len;
 	hdr_cmn* ch = HDR_CMN(p);
 	
 	phyHeaderLen = (phyPkt)?0:defPHY_HEADER_LEN;
-	trx = ((ch->size() + phyHeaderLen)*8/getRate('d'));
-	return trx;
+	len = ch->size() + phyHeaderLen;
+	if ((len >= 0)&&(len < WPAN_TRXTAB))
+		return trxTab[len];
+	return (len*8/getRate('d'));
+}
+
+double Phy802_15_4::symTime(double nsym)
+{
+	int i = (int)nsym;
+
+	if ((i >= 0)&&(i < WPAN_SYMTAB)&&(i == nsym))
+		return symTab[i];
+	return (nsym/getRate('s'));
 }
 
 void Phy802_15_4::construct_PPDU(UINT_8 psduLength,Packet *psdu)
@@ -269,7 +295,7 @@ void Phy802_15_4::PLME_CCA_request()
 		//perform CCA
 		//refer to sec 6.7.9 for CCA details
 		//we need to delay 8 symbols
-		CCAH.start(4/getRate('s')); // 2.32 change: start CCA at the end of 4th symbol
+		CCAH.start(symTime(4)); // 2.32 change: start CCA at the end of 4th symbol
 	}
 	else
 		mac->PLME_CCA_confirm(trx_state);
@@ -283,7 +309,7 @@ void Phy802_15_4::PLME_ED_request()
 		//refer to sec 6.7.7 for ED implementation details
 		//we need to delay 8 symbols
 		rxEDPeakPower = rxTotPower[ppib.phyCurrentChannel];
-		EDH.start(8/getRate('s'));
+		EDH.start(symTime(8));
 	}
 	else
 		mac->PLME_ED_confirm(trx_state,0);
@@ -384,7 +410,7 @@ void Phy802_15_4::PLME_SET_TRX_STATE_request(PHYenum state)
 		if (delay)
 		{
 			trx_state = p_TRX_OFF;	//should be disabled immediately (further transmission/reception will not succeed)
-			TRXH.start(aTurnaroundTime/getRate('s'));
+			TRXH.start(symTime(aTurnaroundTime));
 		}
 		else
 			mac->PLME_SET_TRX_STATE_confirm(t_status);
@@ -448,6 +474,7 @@ void Phy802_15_4::PLME_SET_request(PPIBAenum PIBAttribute,PHY_PIB *PIBAttributeV
 						trx_state_defer_set = p_IDLE;
 				}
 				ppib.phyCurrentChannel = PIBAttributeValue->phyCurrentChannel;
+				buildTimes();
 			}
 			break;
 		case phyChannelsSupported:
@@ -678,23 +705,23 @@ void Phy802_15_4::CCAHandler(void)
 	{
 		t_status = ((rxTotPower[ppib.phyCurrentChannel] >= CSThresh_)&&(rxTotNum[ppib.phyCurrentChannel] > 0))?p_BUSY:p_IDLE;
 	}
-	CCAReportH.start(4/getRate('s')); // 2.31 change: Report CCA at the end of 8th symbol (i.e. wait 4 more symbols)
+	CCAReportH.start(symTime(4)); // 2.31 change: Report CCA at the end of 8th symbol (i.e. wait 4 more symbols)
 	sensed_ch_state = t_status; // 2.31 change: CCA reporting is done by CCAReportHandler
 
 // 2.31 change: Decrement energy spent in CCA
 	if (node()->energy_model()) { 
-		if((NOW-4/getRate('s')-aTurnaroundTime/getRate('s'))-channel_idle_time_ > 0) {
-			node()->energy_model()->DecrIdleEnergy((NOW-4/getRate('s')-aTurnaroundTime/getRate('s'))-channel_idle_time_, P_idle_);
+		if((NOW-symTime(4)-symTime(aTurnaroundTime))-channel_idle_time_ > 0) {
+			node()->energy_model()->DecrIdleEnergy((NOW-symTime(4)-symTime(aTurnaroundTime))-channel_idle_time_, P_idle_);
 		}
-		if ((NOW-4/getRate('s')-aTurnaroundTime/getRate('s')+aCCATime/getRate('s'))-channel_idle_time_ > 0){
-			node()->energy_model()->DecrRcvEnergy((aTurnaroundTime+aCCATime)/getRate('s'),Pr_consume_);
-			channel_idle_time_ = NOW-4/getRate('s')+aCCATime/getRate('s');
-			update_energy_time_ = NOW-4/getRate('s')+aCCATime/getRate('s');
+		if ((NOW-symTime(4)-symTime(aTurnaroundTime)+symTime(aCCATime))-channel_idle_time_ > 0){
+			node()->energy_model()->DecrRcvEnergy(symTime(aTurnaroundTime+aCCATime),Pr_consume_);
+			channel_idle_time_ = NOW-symTime(4)+symTime(aCCATime);
+			update_energy_time_ = NOW-symTime(4)+symTime(aCCATime);
 		}
 		else {
-			node()->energy_model()->DecrRcvEnergy((aTurnaroundTime+aCCATime)/getRate('s'),2*Pr_consume_-P_idle_); // P_idle_ has already been decremented; just compensating for that
-			channel_idle_time_ = MAX(channel_idle_time_, NOW-4/getRate('s')+aCCATime/getRate('s'));
-			update_energy_time_ = MAX(channel_idle_time_,NOW-4/getRate('s')+aCCATime/getRate('s'));
+			node()->energy_model()->DecrRcvEnergy(symTime(aTurnaroundTime+aCCATime),2*Pr_consume_-P_idle_); // P_idle_ has already been decremented; just compensating for that
+			channel_idle_time_ = MAX(channel_idle_time_, NOW-symTime(4)+symTime(aCCATime));
+			update_energy_time_ = MAX(channel_idle_time_,NOW-symTime(4)+symTime(aCCATime));
 		}
 	} 
 }
@@ -792,7 +819,7 @@ void Phy802_15_4::recvOverHandler(Packet *p)
 			{
 				//we need to delay <aTurnaroundTime> symbols for Rx2Tx
 				trx_state = p_TRX_OFF;	//should be disabled immediately (further reception will not succeed)
-				TRXH.start(aTurnaroundTime/getRate('s'));
+				TRXH.start(symTime(aTurnaroundTime));
 			}
 		}
 	}
@@ -822,7 +849,7 @@ void Phy802_15_4::sendOverHandler(void)
 		{
 			//we need to delay <aTurnaroundTime> symbols for Rx2Tx
 			trx_state = p_TRX_OFF;	//should be disabled immediately (further transmission will not succeed)
-			TRXH.start(aTurnaroundTime/getRate('s'));
+			TRXH.start(symTime(aTurnaroundTime));
 		}
 	}
 }
@@ -54,6 +54,9 @@
 #include <wireless-phy.h>
 #include "p802_15_4def.h"
 
+#define WPAN_TRXTAB	160	//trxTime() table: frames of 0..159 bytes (a PPDU is at most 133)
+#define WPAN_SYMTAB	64	//symTime() table: 0..63 symbols (backoff periods, IFS, CCA, turnaround)
+
 //PHY enumerations description (Table 16)
 typedef enum
 {
@@ -127,6 +130,7 @@ public:
 	bool channelSupported(UINT_8 channel);
 	double getRate(char dataOrSymbol);
 	double trxTime(Packet *p,bool phyPkt = false);
+	double symTime(double nsym);	//duration of <nsym> symbols
 	void construct_PPDU(UINT_8 psduLength,Packet *psdu);
 	void PD_DATA_request(UINT_8 psduLength,Packet *psdu);
 	void PD_DATA_indication(UINT_8 psduLength,Packet *psdu,UINT_8 ppduLinkQuality);
@@ -155,6 +159,7 @@ protected:
 	void	recvOverHandler(Packet *p);
 	void	sendOverHandler(void);
 	void	CCAReportHandler(void); // 2.31 change: new timer added to report CCA
+	void	buildTimes(void);
 
 private:
 	PHY_PIB ppib;
@@ -180,6 +185,8 @@ private:
 	Phy802_15_4Timer recvOverH;
 	Phy802_15_4Timer sendOverH;
 	Phy802_15_4Timer CCAReportH; // 2.31 change: new timer to report CCA
+	double trxTab[WPAN_TRXTAB];	//trxTime() by frame length, at the current channel's bit rate
+	double symTab[WPAN_SYMTAB];	//symTime() by whole symbol count, at the current channel's symbol rate
 };
 
 #endif
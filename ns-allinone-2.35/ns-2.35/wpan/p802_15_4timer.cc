@@ -194,8 +194,8 @@ void macExtractTimer::backoffCAP(double time)
 {
 	double t_bcnRxTime,t_sSlotDuration,t_endCAP,t_endBackoff;
 
-	t_bcnRxTime = mac->macBcnRxTime / mac->phy->getRate('s');
-	t_sSlotDuration = mac->sfSpec2.sd / mac->phy->getRate('s');
+	t_bcnRxTime = mac->phy->symTime(mac->macBcnRxTime);
+	t_sSlotDuration = mac->phy->symTime(mac->sfSpec2.sd);
 
 	/* Linux floating number compatibility
 	t_endCAP = t_bcnRxTime + (mac->sfSpec2.FinCAP + 1) * t_sSlotDuration;
@@ -304,16 +304,16 @@ void macBeaconTxTimer::start(bool reset, bool fortx, double wt)
 		forTX = (!forTX);
 	}
 	if (!forTX)
-		Mac802_15_4Timer::start(12 / mac->phy->getRate('s'));
+		Mac802_15_4Timer::start(mac->phy->symTime(12));
 	else if (mac->mpib.macBeaconOrder != 15)
 	{
-		wtime = ((aBaseSuperframeDuration * (1 << mac->mpib.macBeaconOrder) - 12) / mac->phy->getRate('s'));
+		wtime = mac->phy->symTime(aBaseSuperframeDuration * (1 << mac->mpib.macBeaconOrder) - 12);
 		Mac802_15_4Timer::start(wtime);
 		macBeaconOrder_last = mac->mpib.macBeaconOrder;
 	}
 	else if (macBeaconOrder_last != 15)
 	{
-		wtime = ((aBaseSuperframeDuration * (1 << macBeaconOrder_last) - 12) / mac->phy->getRate('s'));
+		wtime = mac->phy->symTime(aBaseSuperframeDuration * (1 << macBeaconOrder_last) - 12);
 		Mac802_15_4Timer::start(wtime);
 	}
 }
@@ -331,12 +331,12 @@ void macBeaconRxTimer::start(void)
 	double BI,bcnRxTime,now,len12s,wtime;
 	double tmpf;
 
-	BI = (aBaseSuperframeDuration * (1 << mac->macBeaconOrder2)) / mac->phy->getRate('s');
-	bcnRxTime = mac->macBcnRxTime / mac->phy->getRate('s');
+	BI = mac->phy->symTime(aBaseSuperframeDuration * (1 << mac->macBeaconOrder2));
+	bcnRxTime = mac->phy->symTime(mac->macBcnRxTime);
 	now = CURRENT_TIME;
 	while (now - bcnRxTime > BI)
 		bcnRxTime += BI;
-	len12s = 12 / mac->phy->getRate('s');
+	len12s = mac->phy->symTime(12);
 
 	/* Linux floating number compatibility
 	wtime = BI - (now - bcnRxTime);
@@ -384,14 +384,14 @@ void macWakeupTimer::start(void)
 {
 	double BI,bcnRxTime,now,wtime;
 	double tmpf;
-	BI = (aBaseSuperframeDuration * (1 << mac->macBeaconOrder2)) / mac->phy->getRate('s');
-	bcnRxTime = mac->macBcnRxTime / mac->phy->getRate('s');
+	BI = mac->phy->symTime(aBaseSuperframeDuration * (1 << mac->macBeaconOrder2));
+	bcnRxTime = mac->phy->symTime(mac->macBcnRxTime);
 	now = CURRENT_TIME;
 	while (now - bcnRxTime > BI)
 	bcnRxTime += BI;
 	{
 		tmpf = (now - bcnRxTime);;
-		wtime = BI - tmpf-aTurnaroundTime/mac->phy->getRate('s');
+		wtime = BI - tmpf-mac->phy->symTime(aTurnaroundTime);
 //		wtime=wtime-3*mac->csmaca->bPeriod;
 		if (wtime < 0) {
 			printf("WARNING: negative time for wakeup timer");